@@ -315,6 +315,31 @@ class ArrayMetadata {
    */
   bool check_double_delta_compressor() const;
 
+  /**
+   * Returns false if dictionary encoding is used with an attribute that is
+   * not variable-sized char, and true otherwise.
+   */
+  bool check_dictionary_encoding() const;
+
+  /**
+   * Returns false if a ZSTD dictionary is requested for an attribute that is
+   * not compressed with ZSTD, and true otherwise.
+   */
+  bool check_zstd_dictionary() const;
+
+  /**
+   * Returns false if bit width reduction, which changes the data size, is
+   * followed by a compressor that needs whole values (RLE or double delta),
+   * and true otherwise.
+   */
+  bool check_filters() const;
+
+  /**
+   * Returns false if Gorilla compression is used with integer attributes
+   * or coordinates and true otherwise.
+   */
+  bool check_gorilla_compressor() const;
+
   /** Clears all members. Use with caution! */
   void clear();
 
@@ -38,6 +38,7 @@
 #include "buffer.h"
 #include "compressor.h"
 #include "datatype.h"
+#include "filter_pipeline.h"
 #include "status.h"
 
 namespace tiledb {
@@ -74,6 +75,9 @@ class Attribute {
   /*                 API               */
   /* ********************************* */
 
+  /** Appends a filter to the filters applied before compression. */
+  void add_filter(FilterType filter);
+
   /**
    * Returns the size in bytes of one cell for this attribute. If the attribute
    * is variable-sized, this function returns the size in bytes of an offset.
@@ -89,6 +93,12 @@ class Attribute {
   /** Returns the compression level. */
   int compression_level() const;
 
+  /**
+   * Returns *true* if the variable-sized values are dictionary-encoded per
+   * tile before compression.
+   */
+  bool dictionary_encoding() const;
+
   /**
    * Populates the object members from the data in the input binary buffer.
    *
@@ -100,6 +110,9 @@ class Attribute {
   /** Dumps the attribute contents in ASCII form in the selected output. */
   void dump(FILE* out) const;
 
+  /** Returns the filters applied to the tiles before compression. */
+  const FilterPipeline& filters() const;
+
   /** Returns the attribute name. */
   const std::string& name() const;
 
@@ -120,6 +133,15 @@ class Attribute {
   /** Sets the attribute compression level. */
   void set_compression_level(int compression_level);
 
+  /** Sets whether the variable-sized values are dictionary-encoded. */
+  void set_dictionary_encoding(bool dictionary_encoding);
+
+  /** Sets the filters applied to the tiles before compression. */
+  void set_filters(const FilterPipeline& filters);
+
+  /** Sets whether a ZSTD dictionary is trained for the attribute tiles. */
+  void set_zstd_dictionary(bool zstd_dictionary);
+
   /** Returns the attribute type. */
   Datatype type() const;
 
@@ -129,6 +151,12 @@ class Attribute {
    */
   bool var_size() const;
 
+  /**
+   * Returns *true* if the attribute tiles are compressed with a ZSTD
+   * dictionary, trained on sample tiles of the first fragment written.
+   */
+  bool zstd_dictionary() const;
+
  private:
   /* ********************************* */
   /*         PRIVATE ATTRIBUTES        */
@@ -143,11 +171,20 @@ class Attribute {
   /** The attribute compression level. */
   int compression_level_;
 
+  /** Whether the variable-sized values are dictionary-encoded. */
+  bool dictionary_encoding_;
+
+  /** The filters applied to the tiles before compression. */
+  FilterPipeline filters_;
+
   /** The attribute name. */
   std::string name_;
 
   /** The attribute type. */
   Datatype type_;
+
+  /** Whether a ZSTD dictionary is trained for the attribute tiles. */
+  bool zstd_dictionary_;
 };
 
 }  // namespace tiledb
@@ -306,6 +306,24 @@ class Domain {
   template <class T>
   bool is_contained_in_tile_slab_row(const T* range) const;
 
+  /**
+   * Returns true if the input subarrays (of the domain type) intersect,
+   * i.e., if their ranges intersect on every dimension.
+   */
+  bool overlap(const void* subarray_a, const void* subarray_b) const;
+
+  /**
+   * Returns true if the input subarrays intersect, i.e., if their ranges
+   * intersect on every dimension.
+   *
+   * @tparam T The coordinates type.
+   * @param subarray_a The first input subarray.
+   * @param subarray_b The second input subarray.
+   * @return True if the subarrays intersect.
+   */
+  template <class T>
+  bool overlap(const T* subarray_a, const T* subarray_b) const;
+
   /**
    * Serializes the object members into a binary buffer.
    *
@@ -55,7 +55,9 @@ class Buffer {
    * Constructor. Initializes a buffer with the input data and size.
    *
    * @param data The internal data of the buffer.
-   * @param size The size of the data.
+   * @param size The size of the data, which is also the capacity of the
+   *     buffer (e.g., after `reset_size`, it can be written up to *size*
+   *     bytes in place).
    * @param owns_data Indicates whether the object will own the data,
    *     i.e., if it has permission to reallocate the data and
    *     is responsible for freeing it.
@@ -81,6 +83,12 @@ class Buffer {
   /** Clears the buffer, deallocating memory. */
   void clear();
 
+  /**
+   * Marks *nbytes* written at the current offset (e.g., after `reserve`)
+   * as part of the buffer, advancing the offset and setting the size to it.
+   */
+  void commit(uint64_t nbytes);
+
   /** Returns the buffer data pointer at the current offset. */
   void* cur_data() const;
 
@@ -96,6 +104,9 @@ class Buffer {
   /** Returns the current offset in the buffer. */
   uint64_t offset() const;
 
+  /** Returns *true* if the buffer owns (and may reallocate) its data. */
+  bool owns_data() const;
+
   /**
    * Reads from the local data into the input buffer.
    *
@@ -106,13 +117,23 @@ class Buffer {
   Status read(void* buffer, uint64_t nbytes);
 
   /**
-   * Reallocates memory for the buffer with the input size.
+   * Reallocates memory for the buffer with the input size. A buffer that
+   * does not own its data can only be "reallocated" within its capacity.
    *
    * @param nbytes Number of bytes to allocate.
    * @return Status.
    */
   Status realloc(uint64_t nbytes);
 
+  /**
+   * Makes room for writing *nbytes* in place at the current offset (i.e.,
+   * through `cur_data`), reallocating if needed.
+   *
+   * @param nbytes The number of bytes to make room for.
+   * @return Status
+   */
+  Status reserve(uint64_t nbytes);
+
   /** Resets the buffer offset to 0. */
   void reset_offset();
 
@@ -0,0 +1,107 @@
+/**
+ * @file   buffer_pool.h
+ * @file   buffer.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class BufferPool.
+ */
+
+#ifndef TILEDB_BUFFER_POOL_H
+#define TILEDB_BUFFER_POOL_H
+
+#include <mutex>
+#include <vector>
+
+#include "buffer.h"
+
+namespace tiledb {
+
+/**
+ * A thread-safe pool of scratch buffers. Released buffers keep their
+ * memory, so that repeated (de)compressions of similarly sized chunks do
+ * not allocate on every call.
+ */
+class BufferPool {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param max_num The maximum number of buffers kept in the pool.
+   * @param max_size The maximum allocated size of a pooled buffer.
+   */
+  BufferPool(uint64_t max_num, uint64_t max_size);
+
+  /** Destructor. Frees all pooled buffers. */
+  ~BufferPool();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /**
+   * Returns an empty buffer, reusing a pooled one if available. The buffer
+   * must be handed back with *release* (or deleted by the caller).
+   */
+  Buffer* acquire();
+
+  /** Returns the number of buffers currently held by the pool. */
+  uint64_t pooled_num();
+
+  /**
+   * Hands a buffer back to the pool. The buffer is deleted instead if the
+   * pool is full or the buffer exceeds the maximum pooled size.
+   *
+   * @param buffer The buffer to release (may be nullptr).
+   */
+  void release(Buffer* buffer);
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The pooled buffers. */
+  std::vector<Buffer*> buffers_;
+
+  /** The maximum number of buffers kept in the pool. */
+  uint64_t max_num_;
+
+  /** The maximum allocated size of a pooled buffer. */
+  uint64_t max_size_;
+
+  /** Protects the pooled buffers. */
+  std::mutex mtx_;
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_BUFFER_POOL_H
@@ -135,6 +135,13 @@ typedef enum {
 #undef TILEDB_COMPRESSOR_ENUM
 } tiledb_compressor_t;
 
+/** Filter type, of the filters applied to tiles before compression. */
+typedef enum {
+#define TILEDB_FILTER_TYPE_ENUM(id) TILEDB_##id
+#include "tiledb_enum.inc"
+#undef TILEDB_FILTER_TYPE_ENUM
+} tiledb_filter_type_t;
+
 /* ****************************** */
 /*            VERSION             */
 /* ****************************** */
@@ -290,6 +297,47 @@ TILEDB_EXPORT int tiledb_attribute_set_compressor(
     tiledb_compressor_t compressor,
     int compression_level);
 
+/**
+ * Appends a filter to the filters an attribute's tiles go through before
+ * compression. The filters are applied in the order they are added, and
+ * reversed upon reading.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The target attribute.
+ * @param filter The filter to be added.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_add_filter(
+    tiledb_ctx_t* ctx, tiledb_attribute_t* attr, tiledb_filter_type_t filter);
+
+/**
+ * Sets whether the values of a variable-sized char attribute are stored
+ * dictionary-encoded: each tile keeps its distinct values once, plus a
+ * fixed-width code per cell. This suits low-cardinality strings.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The target attribute.
+ * @param dictionary_encoding `1` to enable dictionary encoding, `0` to
+ *     disable it.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_set_dictionary_encoding(
+    tiledb_ctx_t* ctx, tiledb_attribute_t* attr, int dictionary_encoding);
+
+/**
+ * Sets whether the tiles of a ZSTD-compressed attribute are compressed with
+ * a trained dictionary. The dictionary is trained on sample tiles when the
+ * first fragment is written (or consolidated), and is stored in the array
+ * directory. This improves the compression of small tiles.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The target attribute.
+ * @param zstd_dictionary `1` to enable the dictionary, `0` to disable it.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_set_zstd_dictionary(
+    tiledb_ctx_t* ctx, tiledb_attribute_t* attr, int zstd_dictionary);
+
 /**
  * Sets the number of values per cell for an attribute.
  *
@@ -338,6 +386,61 @@ TILEDB_EXPORT int tiledb_attribute_get_compressor(
     tiledb_compressor_t* compressor,
     int* compression_level);
 
+/**
+ * Retrieves the number of filters of an attribute.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The attribute.
+ * @param filter_num The number of filters to be retrieved.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_get_filter_num(
+    tiledb_ctx_t* ctx,
+    const tiledb_attribute_t* attr,
+    unsigned int* filter_num);
+
+/**
+ * Retrieves a filter of an attribute.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The attribute.
+ * @param index The position of the filter in the order they are applied.
+ * @param filter The filter to be retrieved.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_get_filter(
+    tiledb_ctx_t* ctx,
+    const tiledb_attribute_t* attr,
+    unsigned int index,
+    tiledb_filter_type_t* filter);
+
+/**
+ * Retrieves whether the values of an attribute are dictionary-encoded.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The attribute.
+ * @param dictionary_encoding Set to `1` if dictionary encoding is enabled,
+ *     and `0` otherwise.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_get_dictionary_encoding(
+    tiledb_ctx_t* ctx,
+    const tiledb_attribute_t* attr,
+    int* dictionary_encoding);
+
+/**
+ * Retrieves whether the tiles of an attribute are compressed with a trained
+ * ZSTD dictionary.
+ *
+ * @param ctx The TileDB context.
+ * @param attr The attribute.
+ * @param zstd_dictionary Set to `1` if the dictionary is enabled, and `0`
+ *     otherwise.
+ * @return TILEDB_OK for success and TILEDB_ERR for error.
+ */
+TILEDB_EXPORT int tiledb_attribute_get_zstd_dictionary(
+    tiledb_ctx_t* ctx, const tiledb_attribute_t* attr, int* zstd_dictionary);
+
 /**
  * Retrieves the number of values per cell for this attribute.
  *
@@ -1029,6 +1132,19 @@ TILEDB_EXPORT int tiledb_array_create(
 TILEDB_EXPORT int tiledb_array_consolidate(
     tiledb_ctx_t* ctx, const char* array_name);
 
+/**
+ * Packs the metadata of all the fragments of an array into a single
+ * consolidated file, which is read with a single I/O when the array is
+ * opened. Fragments written afterwards are still loaded from their own
+ * metadata files. Consolidating the array also rewrites this file.
+ *
+ * @param ctx The TileDB context.
+ * @param array_name The name of the TileDB array.
+ * @return TILEDB_OK on success, and TILEDB_ERR on error.
+ */
+TILEDB_EXPORT int tiledb_array_consolidate_metadata(
+    tiledb_ctx_t* ctx, const char* array_name);
+
 /* ********************************* */
 /*        RESOURCE MANAGEMENT        */
 /* ********************************* */
@@ -0,0 +1,105 @@
+/**
+ * @file   bit_packing.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class BitPacking.
+ */
+
+#ifndef TILEDB_BIT_PACKING_H
+#define TILEDB_BIT_PACKING_H
+
+#include <cinttypes>
+
+#include "constants.h"
+
+namespace tiledb {
+
+/**
+ * Packs 64-bit values of a fixed bit width in four interleaved 64-bit lanes
+ * (value i goes to lane i % 4), so that four values are shifted at a time
+ * with SIMD instructions. The values are packed in rows of four; each lane
+ * takes the bits of its values one after the other, from the LSB.
+ */
+class BitPacking {
+ public:
+  /* ****************************** */
+  /*            CONSTANTS           */
+  /* ****************************** */
+
+  /** The number of interleaved lanes. */
+  static const uint64_t LANE_NUM = 4;
+
+  /* ****************************** */
+  /*               API              */
+  /* ****************************** */
+
+  /**
+   * Packs values. AVX2 instructions are used if the CPU supports them.
+   *
+   * @param values The *rows* x LANE_NUM values, of at most *width* bits.
+   * @param rows The number of rows.
+   * @param width The bit width of the values (0 to 64).
+   * @param out The output, of `packed_size(rows, width)` bytes.
+   * @param simd If *false*, the scalar path is taken.
+   */
+  static void pack(
+      const uint64_t* values,
+      uint64_t rows,
+      int width,
+      uint64_t* out,
+      bool simd = constants::compressor_simd);
+
+  /** Returns the size of *rows* x LANE_NUM packed values of some width. */
+  static uint64_t packed_size(uint64_t rows, int width);
+
+  /** Returns the number of rows that hold *value_num* values. */
+  static uint64_t row_num(uint64_t value_num);
+
+  /**
+   * Unpacks values. AVX2 instructions are used if the CPU supports them.
+   *
+   * @param in The packed values, of `packed_size(rows, width)` bytes.
+   * @param rows The number of rows.
+   * @param width The bit width of the values (0 to 64).
+   * @param values The *rows* x LANE_NUM unpacked values.
+   * @param simd If *false*, the scalar path is taken.
+   */
+  static void unpack(
+      const uint64_t* in,
+      uint64_t rows,
+      int width,
+      uint64_t* values,
+      bool simd = constants::compressor_simd);
+
+  /** Returns the number of bits needed to represent a value. */
+  static int width(uint64_t value);
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_BIT_PACKING_H
@@ -44,8 +44,8 @@ namespace tiledb {
 class DoubleDelta {
  public:
   /**
-   * Constant overhead (equal to 1 byte for the bitsize, 8 bytes for
-   * the number of cells, and 8 bytes for a potential extra 64-bit chunk).
+   * Constant overhead (equal to 1 byte for the format, 8 bytes for the
+   * number of values, and 16 bytes for the first value and delta).
    */
   static const uint64_t OVERHEAD;
 
@@ -62,39 +62,30 @@ class DoubleDelta {
    *
    * The output buffer will contain the following after compression:
    *
-   * bitsize | n | in_0 | in_1 | b_2 | abs(dd_2) | b_3 | abs(dd_3) | ...
-   *   ...   | b_n | abs(dd_n)
+   * 0 | n | in_0 | in_1 - in_0 | block_0 | block_1 | ...
    *
    * where:
-   *  - *bitsize* (char) is the minimum number of bits required to represent
-   *    any abs(dd_i).
+   *  - *0* (char) marks the block-wise format (see below).
    *  - *n* (uint64_t) is the number of values in the input buffer.
-   *  - **b_i** is the sign of dd_i
-   *  - **dd_i** is equal to (in_{i} - in_{i-1}) - (in_{i-1} - in_{i-2})
+   *  - *in_0* and *in_1 - in_0* (int64_t) are present if n > 0 and n > 1.
+   *  - Each block holds 128 double deltas dd_i (fewer in the last one),
+   *    where dd_i = (in_{i} - in_{i-1}) - (in_{i-1} - in_{i-2}), as
+   *    *min* (int64_t) | *width* (uint8_t) | packed dd_i - min.
    *
-   *  In case the bitsize is equal to the size of the data type plus one (for
-   *  the sign), then it does not make sense to compress and, thus, the
-   *  algorithm simply copies the input to the output, though after *bitsize*
-   *  and *n* that are always written to the output buffer.
+   * The packed values take *width* bits each, the bit width of the block
+   * range. They are packed in four interleaved 64-bit lanes (value i goes to
+   * lane i % 4), so that packing and unpacking run on four values at a time
+   * with SIMD instructions. All arithmetic wraps around in 64 bits, so any
+   * input of the integer types is supported.
    *
-   *  The algorithm populates and writes to the output buffer a 64-bit chunk
-   *  at a time. Therefore, the output buffer may end up having a worst-case
-   *  overhead of 1 (bitsize) + 8 (n) + 8 (last, potentially almost empty chunk)
-   *  bytes.
+   * Buffers compressed by earlier versions start with the (non-zero) bitsize
+   * of their single, sign-magnitude encoded double delta width, and are still
+   * decompressed.
    *
    * @param type The type of the input values.
    * @param input_buffer Input buffer to read from.
    * @param output_buffer Output buffer to write to the compressed data.
    * @return Status
-   *
-   * @note The function will fail with an error in two cases: (i) the output
-   *     buffer incurs a memory allocation error, and (ii) some double delta
-   *     value is out of bounds. Note that all double deltas are represented
-   *     as int64_t. Therefore, the out of bounds case occurs when adding
-   *     two huge positive numbers (e.g., INT64_MAX) resulting in a negative
-   *     value, or adding to very small negative numbers (e.g., -INT64_MAX),
-   *     resulting in a positive number. However, both these two cases are
-   *     extreme.
    */
   static Status compress(
       Datatype type, ConstBuffer* input_buffer, Buffer* output_buffer);
@@ -123,20 +114,19 @@ class DoubleDelta {
   static Status compress(ConstBuffer* input_buffer, Buffer* output_buffer);
 
   /**
-   * Calculates the bitsize all the double deltas will have. Note that
-   * the sign bit is not counted.
+   * Decompression function.
    *
    * @tparam The datatype of the values.
-   * @param in The input buffer.
-   * @param num The number of values in the buffer.
-   * @param bitsize The bitsize of the double deltas to be retrieved.
+   * @param input_buffer Input buffer to read from.
+   * @param output_buffer Output buffer to write the decompressed data to.
    * @return Status
    */
   template <class T>
-  static Status compute_bitsize(T* in, uint64_t num, int* bitsize);
+  static Status decompress(ConstBuffer* input_buffer, Buffer* output_buffer);
 
   /**
-   * Decompression function.
+   * Decompresses a buffer in the format of earlier versions, with a single
+   * bitsize for all double deltas.
    *
    * @tparam The datatype of the values.
    * @param input_buffer Input buffer to read from.
@@ -144,10 +134,11 @@ class DoubleDelta {
    * @return Status
    */
   template <class T>
-  static Status decompress(ConstBuffer* input_buffer, Buffer* output_buffer);
+  static Status decompress_v1(ConstBuffer* input_buffer, Buffer* output_buffer);
 
   /**
-   * Reads/reconstructs a double delta value from a compressed buffer.
+   * Reads/reconstructs a double delta value from a compressed buffer in the
+   * format of earlier versions.
    *
    * @param buff The input buffer.
    * @param double_delta The double delta value to be retrieved.
@@ -164,27 +155,6 @@ class DoubleDelta {
       int bitsize,
       uint64_t* chunk,
       int* bit_in_chunk);
-
-  /**
-   * Writes a double delta value to a buffer, after reducing its bitsize
-   * to match the input one.
-   *
-   * @param buff The output buffer.
-   * @param double_delta The double delta value to write.
-   * @param bitsize The bitsize the double delta value will reduce to
-   *     before being written to the buffer.
-   * @param chunk The function writes to the buffer in whole 64-bit chunks.
-   *     This parameters represents some state about the current chunk.
-   * @param bit_in_chunk Part of the chunk state. Stores the current bit
-   *     in the chunk the next write will start from.
-   * @return Status
-   */
-  static Status write_double_delta(
-      Buffer* buff,
-      int64_t double_delta,
-      int bitsize,
-      uint64_t* chunk,
-      int* bit_in_chunk);
 };
 
 }  // namespace tiledb
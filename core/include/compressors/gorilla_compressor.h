@@ -0,0 +1,115 @@
+/**
+ * @file   gorilla_compressor.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines the Gorilla compressor class.
+ */
+
+#ifndef TILEDB_GORILLA_H
+#define TILEDB_GORILLA_H
+
+#include "buffer.h"
+#include "const_buffer.h"
+#include "datatype.h"
+#include "status.h"
+
+namespace tiledb {
+
+/**
+ * Implements an XOR compressor for floating point values, in the spirit of
+ * Facebook's Gorilla. Slowly varying values share their sign, exponent and
+ * leading mantissa bits, so the XOR of consecutive values has long runs of
+ * leading (and often trailing) zeros.
+ */
+class Gorilla {
+ public:
+  /* ****************************** */
+  /*               API              */
+  /* ****************************** */
+
+  /**
+   * Compression function. Let the input buffer contain values
+   * in_0 | in_1 | ... | in_n. The output buffer will contain:
+   *
+   * n | in_0 | block_0 | block_1 | ...
+   *
+   * where *n* (uint64_t) is the number of values and each block holds the
+   * XORs x_i = in_i ^ in_{i-1} of 128 values (fewer in the last one), as
+   * *shift* (uint8_t) | *width* (uint8_t) | packed x_i >> shift.
+   *
+   * *shift* and *width* are the trailing zeros and the remaining bit width of
+   * the bitwise OR of the block XORs. Unlike the original Gorilla, where
+   * every value carries its own control bits, whole blocks share a bit width,
+   * so that they are packed and unpacked with SIMD instructions (see
+   * BitPacking).
+   *
+   * @param type The type of the input values (FLOAT32 or FLOAT64).
+   * @param input_buffer Input buffer to read from.
+   * @param output_buffer Output buffer to write to the compressed data.
+   * @return Status
+   */
+  static Status compress(
+      Datatype type, ConstBuffer* input_buffer, Buffer* output_buffer);
+
+  /**
+   * Decompression function.
+   *
+   * @param type The type of the original decompressed values.
+   * @param input_buffer Input buffer to read from.
+   * @param output_buffer Output buffer to write the decompressed data to.
+   * @return Status
+   */
+  static Status decompress(
+      Datatype type, ConstBuffer* input_buffer, Buffer* output_buffer);
+
+  /** Returns the compression overhead for the given input. */
+  static uint64_t overhead(uint64_t nbytes);
+
+ private:
+  /* ****************************** */
+  /*         PRIVATE METHODS        */
+  /* ****************************** */
+
+  /**
+   * Templated version of *compress* on the (unsigned integer) type holding
+   * the bits of the values.
+   */
+  template <class T>
+  static Status compress(ConstBuffer* input_buffer, Buffer* output_buffer);
+
+  /**
+   * Templated version of *decompress* on the (unsigned integer) type holding
+   * the bits of the values.
+   */
+  template <class T>
+  static Status decompress(ConstBuffer* input_buffer, Buffer* output_buffer);
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_GORILLA_H
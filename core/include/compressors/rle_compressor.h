@@ -35,11 +35,16 @@
 
 #include "buffer.h"
 #include "const_buffer.h"
+#include "constants.h"
 #include "status.h"
 
 namespace tiledb {
 
-/** Handles compression/decompression Run-Length-Encoding. */
+/**
+ * Handles compression/decompression Run-Length-Encoding. Runs of 1, 2, 4 or
+ * 8-byte values are found and expanded with SSE2 or AVX2 instructions, picked
+ * at runtime.
+ */
 class RLE {
  public:
   /**
@@ -48,10 +53,14 @@ class RLE {
    * @param value_size The size of a single value.
    * @param input_buffer Input buffer to read from.
    * @param output_buffer Output buffer to write the compressed data to.
+   * @param simd If *false*, the scalar path is taken.
    * @return Status
    */
   static Status compress(
-      uint64_t value_size, ConstBuffer* input_buffer, Buffer* output_buffer);
+      uint64_t value_size,
+      ConstBuffer* input_buffer,
+      Buffer* output_buffer,
+      bool simd = constants::compressor_simd);
 
   /**
    * Decompression function.
@@ -59,10 +68,14 @@ class RLE {
    * @param value_size The size of a single.
    * @param input_buffer Input buffer to read from.
    * @param output_buffer Output buffer to write to the decompressed data.
+   * @param simd If *false*, the scalar path is taken.
    * @return Status
    */
   static Status decompress(
-      uint64_t value_size, ConstBuffer* input_buffer, Buffer* output_buffer);
+      uint64_t value_size,
+      ConstBuffer* input_buffer,
+      Buffer* output_buffer,
+      bool simd = constants::compressor_simd);
 
   /** Returns the compression overhead for the given input. */
   static uint64_t overhead(uint64_t nbytes, uint64_t value_size);
@@ -39,6 +39,8 @@
 
 namespace tiledb {
 
+class ZStdDictionary;
+
 /** Handles compression/decompression with the zstd library. */
 class ZStd {
  public:
@@ -48,19 +50,30 @@ class ZStd {
    * @param level Compression level.
    * @param input_buffer Input buffer to read from.
    * @param output_buffer Output buffer to write to the compressed data.
+   * @param dict A trained dictionary to compress with (the level is then
+   *     the one the dictionary was loaded with), or *nullptr*.
    * @return Status
    */
   static Status compress(
-      int level, ConstBuffer* input_buffer, Buffer* output_buffer);
+      int level,
+      ConstBuffer* input_buffer,
+      Buffer* output_buffer,
+      const ZStdDictionary* dict = nullptr);
 
   /**
    * Decompression function.
    *
    * @param input_buffer Input buffer to read from.
    * @param output_buffer Output buffer to write the decompressed data to.
+   * @param dict The dictionary the data may have been compressed with, or
+   *     *nullptr*. Data compressed without a dictionary are decompressed
+   *     without it.
    * @return Status
    */
-  static Status decompress(ConstBuffer* input_buffer, Buffer* output_buffer);
+  static Status decompress(
+      ConstBuffer* input_buffer,
+      Buffer* output_buffer,
+      const ZStdDictionary* dict = nullptr);
 
   /** Returns the default compression level. */
   static int default_level() {
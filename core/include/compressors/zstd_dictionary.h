@@ -0,0 +1,119 @@
+/**
+ * @file   zstd_dictionary.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class ZStdDictionary.
+ */
+
+#ifndef TILEDB_ZSTD_DICTIONARY_H
+#define TILEDB_ZSTD_DICTIONARY_H
+
+#include "buffer.h"
+#include "status.h"
+
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace tiledb {
+
+/**
+ * A ZSTD dictionary trained on sample tiles of an attribute. It primes the
+ * compression of small tiles, which otherwise start with no history. The
+ * dictionary is digested once, for compression at a fixed level and for
+ * decompression, and is then shared (read-only) by all tiles using it.
+ */
+class ZStdDictionary {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /** Constructor. */
+  ZStdDictionary();
+
+  /** Destructor. */
+  ~ZStdDictionary();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /** Returns the digested dictionary for compression. */
+  const ZSTD_CDict_s* cdict() const;
+
+  /** Returns the digested dictionary for decompression. */
+  const ZSTD_DDict_s* ddict() const;
+
+  /** Returns the dictionary id, which ZSTD records in the frames using it. */
+  unsigned id() const;
+
+  /**
+   * Digests a dictionary.
+   *
+   * @param data The dictionary, as produced by `train`.
+   * @param size The dictionary size.
+   * @param level The compression level.
+   * @return Status
+   */
+  Status init(const void* data, uint64_t size, int level);
+
+  /**
+   * Trains a dictionary.
+   *
+   * @param samples The sample tiles, stored contiguously.
+   * @param sample_sizes The size of each sample.
+   * @param dict_size The maximum dictionary size.
+   * @param dict The buffer the dictionary is written to.
+   * @return Status
+   */
+  static Status train(
+      const Buffer* samples,
+      const std::vector<size_t>& sample_sizes,
+      uint64_t dict_size,
+      Buffer* dict);
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The digested dictionary for compression. */
+  ZSTD_CDict_s* cdict_;
+
+  /** The digested dictionary for decompression. */
+  ZSTD_DDict_s* ddict_;
+
+  /** The dictionary id. */
+  unsigned id_;
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_ZSTD_DICTIONARY_H
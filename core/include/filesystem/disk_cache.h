@@ -0,0 +1,260 @@
+/**
+ * @file   disk_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class DiskCache.
+ */
+
+#ifndef TILEDB_DISK_CACHE_H
+#define TILEDB_DISK_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "status.h"
+#include "uri.h"
+
+namespace tiledb {
+
+/**
+ * A read-through cache of remote, immutable files on a local directory.
+ * Files are cached in blocks of a fixed size, keyed by file URI and block
+ * offset, and evicted in LRU order to stay within a size budget. Each block
+ * is a local file, so the cache survives the process.
+ */
+class DiskCache {
+ public:
+  /* ********************************* */
+  /*           TYPE DEFINITIONS        */
+  /* ********************************* */
+
+  /**
+   * Reads a byte range of a remote file: `fetch(offset, buffer, nbytes)`.
+   */
+  typedef std::function<Status(uint64_t, void*, uint64_t)> Fetch;
+
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param dir The local cache directory.
+   * @param max_size The maximum total size of the cached blocks.
+   * @param block_size The size of the cached blocks.
+   */
+  DiskCache(const std::string& dir, uint64_t max_size, uint64_t block_size);
+
+  /** Destructor. The cached blocks are kept on disk. */
+  ~DiskCache();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /**
+   * Creates the cache directory, or picks up the blocks cached in it
+   * previously.
+   *
+   * @return Status
+   */
+  Status init();
+
+  /**
+   * Retrieves the memoized size of a file.
+   *
+   * @param uri The file URI.
+   * @param size The file size to be retrieved.
+   * @return *True* if the size is known.
+   */
+  bool file_size(const URI& uri, uint64_t* size) const;
+
+  /** Returns the number of blocks served from the cache. */
+  uint64_t hits() const;
+
+  /** Checks if a directory was marked immutable. */
+  bool is_immutable(const URI& dir) const;
+
+  /** Checks if a directory was marked mutable, and the mark has not expired. */
+  bool is_mutable(const URI& dir) const;
+
+  /** Returns the number of blocks fetched from the remote files. */
+  uint64_t misses() const;
+
+  /**
+   * Reads a byte range of a file through the cache. Consecutive missing
+   * blocks are fetched with a single request and then cached.
+   *
+   * @param uri The file URI.
+   * @param file_size The file size.
+   * @param offset The offset where the range starts.
+   * @param buffer The buffer to read into.
+   * @param nbytes The size of the range.
+   * @param fetch Reads byte ranges of the remote file.
+   * @return Status
+   */
+  Status read(
+      const URI& uri,
+      uint64_t file_size,
+      uint64_t offset,
+      void* buffer,
+      uint64_t nbytes,
+      const Fetch& fetch);
+
+  /**
+   * Drops everything cached for a file, or for all files under a directory.
+   */
+  void remove(const URI& uri);
+
+  /** Memoizes the size of an (immutable) file. */
+  void set_file_size(const URI& uri, uint64_t size);
+
+  /** Marks a directory whose files will not change again. */
+  void set_immutable(const URI& dir);
+
+  /**
+   * Marks a directory whose files may still change, for a limited time.
+   *
+   * @param dir The directory URI.
+   * @param ttl For how long (in milliseconds) the mark holds.
+   */
+  void set_mutable(const URI& dir, uint64_t ttl);
+
+  /** Returns the total size of the cached blocks. */
+  uint64_t size() const;
+
+ private:
+  /* ********************************* */
+  /*          TYPE DEFINITIONS         */
+  /* ********************************* */
+
+  /** A cached block. */
+  struct Block {
+    /** The block file name. */
+    std::string name_;
+    /** The size of the block data. */
+    uint64_t size_;
+    /** The URI of the cached file. */
+    std::string uri_;
+  };
+
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The size of the cached blocks. */
+  uint64_t block_size_;
+
+  /** The cache directory. */
+  std::string dir_;
+
+  /** Memoized file sizes, keyed by file URI. */
+  std::unordered_map<std::string, uint64_t> file_sizes_;
+
+  /** Number of blocks served from the cache. */
+  std::atomic<uint64_t> hits_;
+
+  /** The immutable directories. */
+  std::unordered_set<std::string> immutable_dirs_;
+
+  /** The cached blocks, keyed by block file name. */
+  std::unordered_map<std::string, std::list<Block>::iterator> index_;
+
+  /** The LRU list of cached blocks (most recently used first). */
+  std::list<Block> lru_;
+
+  /** The maximum total size of the cached blocks. */
+  uint64_t max_size_;
+
+  /** The expiration times of the mutable directory marks. */
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+      mutable_dirs_;
+
+  /** Number of blocks fetched from the remote files. */
+  std::atomic<uint64_t> misses_;
+
+  /** Protects the state of the cache. */
+  mutable std::mutex mtx_;
+
+  /** The total size of the cached blocks. */
+  uint64_t size_;
+
+  /** Counter making temporary block file names unique. */
+  std::atomic<uint64_t> tmp_counter_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /** Returns the file name of the block of a file at an offset. */
+  static std::string block_name(const std::string& uri, uint64_t offset);
+
+  /** Checks if the block at an offset is cached with the expected size. */
+  bool contains(const URI& uri, uint64_t offset, uint64_t size) const;
+
+  /**
+   * Removes the least recently used blocks while over budget. Must be called
+   * with `mtx_` held; returns the files to delete.
+   */
+  std::vector<std::string> evict();
+
+  /**
+   * Copies part of a cached block.
+   *
+   * @param uri The file URI.
+   * @param offset The block offset.
+   * @param size The expected block size.
+   * @param begin The offset in the block where the copied part starts.
+   * @param nbytes The size of the copied part.
+   * @param buffer The buffer to copy into.
+   * @return *True* on a hit.
+   */
+  bool read_block(
+      const URI& uri,
+      uint64_t offset,
+      uint64_t size,
+      uint64_t begin,
+      uint64_t nbytes,
+      char* buffer);
+
+  /** Writes a block to the cache (failures are ignored). */
+  void store_block(
+      const URI& uri, uint64_t offset, const char* data, uint64_t size);
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_DISK_CACHE_H
@@ -0,0 +1,163 @@
+/**
+ * @file   fd_cache.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class FDCache.
+ */
+
+#ifndef TILEDB_FD_CACHE_H
+#define TILEDB_FD_CACHE_H
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "status.h"
+
+namespace tiledb {
+
+/**
+ * A bounded cache of open POSIX file descriptors, keyed by file path and
+ * evicted in LRU order. A descriptor is pinned between `acquire` and
+ * `release`, and pinned descriptors are never closed by eviction.
+ */
+class FDCache {
+ public:
+  /* ********************************* */
+  /*           TYPE DEFINITIONS        */
+  /* ********************************* */
+
+  /** The mode in which a cached descriptor is opened. */
+  enum class Mode : char {
+    /** Read-only. */
+    READ,
+    /** Write-only, appending (the file is created if it does not exist). */
+    APPEND
+  };
+
+  /** A cache entry, holding the descriptors of a single file. */
+  struct Entry;
+
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param capacity The maximum number of files kept open.
+   */
+  explicit FDCache(uint64_t capacity);
+
+  /** Destructor. Closes all cached descriptors. */
+  ~FDCache();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /**
+   * Retrieves a descriptor for the input file, opening it on a miss. The
+   * entry is pinned until `release` is called on it. Descriptors may be
+   * used by several threads at once, so reads must be positional.
+   *
+   * @param path The file path.
+   * @param mode The mode the descriptor must be opened in.
+   * @param entry The pinned cache entry, to be passed to `release`.
+   * @param fd The retrieved file descriptor.
+   * @return Status
+   */
+  Status acquire(const std::string& path, Mode mode, Entry** entry, int* fd);
+
+  /** Closes the cached descriptors of a file (no-op if not cached). */
+  Status close(const std::string& path);
+
+  /**
+   * Closes the cached descriptors of the input path and of every file
+   * nested under it (used when a directory is removed or moved).
+   */
+  Status close_path(const std::string& path);
+
+  /** Returns the number of lookups that found an open descriptor. */
+  uint64_t hits() const;
+
+  /** Returns the number of lookups that had to open a descriptor. */
+  uint64_t misses() const;
+
+  /** Unpins an entry retrieved with `acquire`. */
+  void release(Entry* entry);
+
+  /** Returns the number of files currently in the cache. */
+  uint64_t size() const;
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The maximum number of files kept open. */
+  uint64_t capacity_;
+
+  /** Cached entries, keyed by file path. */
+  std::unordered_map<std::string, Entry*> entries_;
+
+  /** Number of lookups that found an open descriptor. */
+  std::atomic<uint64_t> hits_;
+
+  /** The LRU list of cached entries (most recently used first). */
+  std::list<Entry*> lru_;
+
+  /** Number of lookups that had to open a descriptor. */
+  std::atomic<uint64_t> misses_;
+
+  /** Protects the entry map and the LRU list. */
+  mutable std::mutex mtx_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /**
+   * Detaches an entry from the cache. Its descriptors are closed right away
+   * if it is not pinned, otherwise upon its last `release`. Must be called
+   * with `mtx_` held.
+   */
+  Status detach(Entry* entry);
+
+  /** Closes the descriptors of an entry and deletes it. */
+  static Status destroy(Entry* entry);
+
+  /** Evicts unpinned entries while over capacity. Called with `mtx_` held. */
+  void evict();
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_FD_CACHE_H
@@ -94,6 +94,20 @@ bool is_dir(hdfsFS fs, const URI& uri);
  */
 Status move_path(hdfsFS fs, const URI& old_uri, const URI& new_uri);
 
+/**
+ * Moves a file, unless the new URI exists. HDFS renames are atomic and never
+ * replace an existing path.
+ *
+ * @param fs Reference to a connected hdfsFS filesystem handle.
+ * @param old_uri The URI of the file to move.
+ * @param new_uri The new URI.
+ * @param moved Set to *false* if the new URI exists, in which case the file
+ *     is left in place.
+ * @return Status
+ */
+Status move_file_no_replace(
+    hdfsFS fs, const URI& old_uri, const URI& new_uri, bool* moved);
+
 /**
  * Checks if the given URI is an existing HDFS directory.
  *
@@ -168,6 +182,21 @@ Status write_to_file(
  */
 Status ls(hdfsFS fs, const URI& uri, std::vector<std::string>* paths);
 
+/**
+ * Lists the files one level deep under a given path, along with their types.
+ *
+ * @param fs Connected hdfsFS filesystem handle.
+ * @param uri The URI of the parent directory path.
+ * @param paths Pointer ot a vector of URIs to store the retrieved paths.
+ * @param is_dirs For each retrieved path, *true* if it is a directory.
+ * @return Status
+ */
+Status ls_with_types(
+    hdfsFS fs,
+    const URI& uri,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs);
+
 /**
  * Returns the size of the input file with a given URI in bytes.
  *
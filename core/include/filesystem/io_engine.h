@@ -0,0 +1,168 @@
+/**
+ * @file   io_engine.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines classes IOBatch and IOEngine.
+ */
+
+#ifndef TILEDB_IO_ENGINE_H
+#define TILEDB_IO_ENGINE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "fd_cache.h"
+#include "status.h"
+
+namespace tiledb {
+
+class IOBatch;
+
+/** An asynchronous positional read from an open POSIX file. */
+struct IORequest {
+  /** The file descriptor. */
+  int fd;
+  /** The offset in the file where the read starts. */
+  uint64_t offset;
+  /** The number of bytes to read. */
+  uint64_t nbytes;
+  /** The buffer to read into. */
+  void* buffer;
+  /** The batch the request belongs to. */
+  IOBatch* batch;
+};
+
+/**
+ * Tracks a group of asynchronous reads, which callers submit and then wait
+ * on as a whole.
+ */
+class IOBatch {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /** Constructor. */
+  IOBatch();
+
+  /** Destructor. */
+  ~IOBatch();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /** Records the completion of a request, along with its status. */
+  void complete(const Status& st);
+
+  /** Announces *n* requests that are about to be submitted. */
+  void expect(uint64_t n);
+
+  /** Returns the number of requests that have not completed yet. */
+  uint64_t pending() const;
+
+  /**
+   * Blocks until all requests complete.
+   *
+   * @return The status of the first failed request, or Ok.
+   */
+  Status wait();
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** Signals the completion of all requests. */
+  std::condition_variable cv_;
+
+  /**
+   * Descriptors pinned in the VFS descriptor cache by the requests of the
+   * batch, released once the batch completes.
+   */
+  std::vector<FDCache::Entry*> fd_entries_;
+
+  /** Protects the state of the batch. */
+  mutable std::mutex mtx_;
+
+  /** Number of requests not completed yet. */
+  uint64_t pending_;
+
+  /** The status of the first failed request. */
+  Status status_;
+
+  friend class VFS;
+};
+
+/**
+ * An engine executing asynchronous reads in the background. Completed
+ * requests are reported to their batch.
+ */
+class IOEngine {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /** Destructor. Waits for all submitted requests to complete. */
+  virtual ~IOEngine() = default;
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /**
+   * Creates the best engine available: io_uring where TileDB was built with
+   * it and the kernel supports it, otherwise a thread pool issuing
+   * positional reads.
+   *
+   * @param queue_depth The io_uring queue depth.
+   * @param thread_num The number of threads of the thread pool.
+   * @return The new engine.
+   */
+  static IOEngine* create(unsigned queue_depth, unsigned thread_num);
+
+  /** Returns the engine name (for diagnostics). */
+  virtual const char* name() const = 0;
+
+  /**
+   * Submits requests for execution. Each request is reported to its batch
+   * upon completion, which must have been announced with `IOBatch::expect`.
+   * Requests are reported even if the submission fails, with the error of
+   * the submission if they were never submitted.
+   *
+   * @param requests The requests to submit.
+   * @return Status
+   */
+  virtual Status submit(const std::vector<IORequest>& requests) = 0;
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_IO_ENGINE_H
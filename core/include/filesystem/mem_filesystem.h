@@ -0,0 +1,199 @@
+/**
+ * @file   mem_filesystem.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file includes declarations of in-memory filesystem functions.
+ *
+ * The in-memory filesystem (URI scheme "mem://") lives in the process and
+ * is shared by all contexts. Its namespace is an ordered map of paths,
+ * while file contents are kept in a lock-striped hash map, so that reads
+ * and writes of different files rarely contend.
+ */
+
+#ifndef TILEDB_FILESYSTEM_MEM_H
+#define TILEDB_FILESYSTEM_MEM_H
+
+#include <string>
+#include <vector>
+
+#include "status.h"
+#include "uri.h"
+
+namespace tiledb {
+
+namespace mem {
+
+/**
+ * Creates a new directory. Its parent must exist.
+ *
+ * @param uri The URI of the directory.
+ * @return Status
+ */
+Status create_dir(const URI& uri);
+
+/**
+ * Creates an empty file, unless it exists already. Its parent must exist.
+ *
+ * @param uri The URI of the file.
+ * @return Status
+ */
+Status create_file(const URI& uri);
+
+/**
+ * Retrieves the size of a file.
+ *
+ * @param uri The URI of the file.
+ * @param nbytes The file size to be retrieved.
+ * @return Status
+ */
+Status file_size(const URI& uri, uint64_t* nbytes);
+
+/**
+ * Locks a file, blocking until the lock is available. Locks are shared by
+ * all contexts of the process.
+ *
+ * @param uri The URI of the file.
+ * @param fd A handle of the lock, used in unlocking it.
+ * @param shared *True* for a shared lock, *false* for an exclusive lock.
+ * @return Status
+ */
+Status filelock_lock(const URI& uri, int* fd, bool shared);
+
+/**
+ * Unlocks a file.
+ *
+ * @param fd The handle returned by `filelock_lock`.
+ * @return Status
+ */
+Status filelock_unlock(int fd);
+
+/** Checks if the URI is an existing directory. */
+bool is_dir(const URI& uri);
+
+/** Checks if the URI is an existing file. */
+bool is_file(const URI& uri);
+
+/**
+ * Lists the files and directories one level deep under a directory, in
+ * lexicographic order.
+ *
+ * @param uri The URI of the directory.
+ * @param paths The URIs of the retrieved paths.
+ * @return Status
+ */
+Status ls(const URI& uri, std::vector<std::string>* paths);
+
+/**
+ * Lists the files and directories one level deep under a directory, in
+ * lexicographic order, along with their types.
+ *
+ * @param uri The URI of the directory.
+ * @param paths The URIs of the retrieved paths.
+ * @param is_dirs For each retrieved path, *true* if it is a directory.
+ * @return Status
+ */
+Status ls_with_types(
+    const URI& uri,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs);
+
+/**
+ * Moves a file or directory. An existing target is replaced if it is a
+ * file or an empty directory.
+ *
+ * @param old_uri The URI of the path to move.
+ * @param new_uri The new URI.
+ * @return Status
+ */
+Status move_path(const URI& old_uri, const URI& new_uri);
+
+/**
+ * Moves a file, unless the new URI exists. The check and the move are
+ * atomic.
+ *
+ * @param old_uri The URI of the file to move.
+ * @param new_uri The new URI.
+ * @param moved Set to *false* if the new URI exists, in which case the file
+ *     is left in place.
+ * @return Status
+ */
+Status move_file_no_replace(
+    const URI& old_uri, const URI& new_uri, bool* moved);
+
+/**
+ * Reads from a file.
+ *
+ * @param uri The URI of the file.
+ * @param offset The offset where the read begins.
+ * @param buffer The buffer to read into.
+ * @param nbytes The number of bytes to read.
+ * @return Status
+ */
+Status read_from_file(
+    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes);
+
+/**
+ * Removes a file.
+ *
+ * @param uri The URI of the file.
+ * @return Status
+ */
+Status remove_file(const URI& uri);
+
+/**
+ * Removes a file or directory (recursively).
+ *
+ * @param uri The URI of the path.
+ * @return Status
+ */
+Status remove_path(const URI& uri);
+
+/**
+ * Syncs a file or directory. Contents are always up to date, so this only
+ * checks that the path exists.
+ *
+ * @param uri The URI of the path.
+ * @return Status
+ */
+Status sync(const URI& uri);
+
+/**
+ * Appends to a file, creating it if it does not exist.
+ *
+ * @param uri The URI of the file.
+ * @param buffer The data to append.
+ * @param buffer_size The data size.
+ * @return Status
+ */
+Status write_to_file(const URI& uri, const void* buffer, uint64_t buffer_size);
+
+}  // namespace mem
+
+}  // namespace tiledb
+
+#endif  // TILEDB_FILESYSTEM_MEM_H
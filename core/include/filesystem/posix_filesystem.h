@@ -34,6 +34,7 @@
 #define TILEDB_POSIX_FILESYSTEM_H
 
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <string>
 #include <vector>
 
@@ -102,6 +103,15 @@ Status remove_file(const std::string& path);
  */
 Status file_size(const std::string& path, uint64_t* size);
 
+/**
+ * Returns the size of an open file.
+ *
+ * @param fd The file descriptor.
+ * @param size The file size to be retrieved.
+ * @return Status
+ */
+Status file_size(int fd, uint64_t* size);
+
 /**
  * Lock a given filename and retrieve an open file descriptor handle.
  *
@@ -147,6 +157,32 @@ bool is_file(const std::string& path);
  */
 Status ls(const std::string& path, std::vector<std::string>* paths);
 
+/**
+ * Lists the files and directories one level deep under a given path, along
+ * with their types, without stat'ing them where the filesystem reports the
+ * types in the directory entries. "." and ".." are skipped.
+ *
+ * @param path The parent path.
+ * @param paths The retrieved paths.
+ * @param is_dirs For each retrieved path, *true* if it is a directory.
+ * @return Status
+ */
+Status ls_with_types(
+    const std::string& path,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs);
+
+/**
+ * Maps an open file into memory. Writes to the mapping are private to the
+ * process and never reach the file.
+ *
+ * @param fd The file descriptor.
+ * @param size The number of bytes to map, starting at the file beginning.
+ * @param data The address of the mapping to be retrieved.
+ * @return Status
+ */
+Status map_file(int fd, uint64_t size, void** data);
+
 /**
  * Move a given filesystem path.
  *
@@ -156,6 +192,19 @@ Status ls(const std::string& path, std::vector<std::string>* paths);
  */
 Status move_path(const std::string& old_path, const std::string& new_path);
 
+/**
+ * Moves a file, unless the new path exists. The check and the move are
+ * atomic, also across processes.
+ *
+ * @param old_path The old path.
+ * @param new_path The new path.
+ * @param moved Set to *false* if the new path exists, in which case the file
+ *     is left in place.
+ * @return Status
+ */
+Status move_file_no_replace(
+    const std::string& old_path, const std::string& new_path, bool* moved);
+
 /**
  * It takes as input an **absolute** path, and returns it in its canonicalized
  * form, after appropriately replacing "./" and "../" in the path.
@@ -181,6 +230,30 @@ void purge_dots_from_path(std::string* path);
 Status read_from_file(
     const std::string& path, uint64_t offset, void* buffer, uint64_t nbytes);
 
+/**
+ * Reads data from an open file into a buffer.
+ *
+ * @param fd The file descriptor.
+ * @param offset The offset in the file from which the read will start.
+ * @param buffer The buffer into which the data will be written.
+ * @param nbytes The size of the data to be read from the file.
+ * @return Status.
+ */
+Status read_from_file(int fd, uint64_t offset, void* buffer, uint64_t nbytes);
+
+/**
+ * Reads a contiguous range of an open file into multiple buffers, with a
+ * single vectored system call where possible. The input I/O vector is
+ * modified while the read progresses.
+ *
+ * @param fd The file descriptor.
+ * @param offset The offset in the file from which the read will start.
+ * @param iov The buffers to read into, filled in order.
+ * @param iovcnt The number of buffers (at most IOV_MAX).
+ * @return Status.
+ */
+Status read_from_file(int fd, uint64_t offset, struct iovec* iov, int iovcnt);
+
 /**
  * Syncs a file or directory.
  *
@@ -189,6 +262,23 @@ Status read_from_file(
  */
 Status sync(const std::string& path);
 
+/**
+ * Syncs an open file.
+ *
+ * @param fd The file descriptor.
+ * @return Status
+ */
+Status sync(int fd);
+
+/**
+ * Unmaps a memory region mapped with `map_file`.
+ *
+ * @param data The address of the mapping.
+ * @param size The size of the mapping.
+ * @return Status
+ */
+Status unmap_file(void* data, uint64_t size);
+
 /**
  * Writes the input buffer to a file.
  *
@@ -203,6 +293,16 @@ Status sync(const std::string& path);
 Status write_to_file(
     const std::string& path, const void* buffer, uint64_t buffer_size);
 
+/**
+ * Appends the input buffer to a file opened in append mode.
+ *
+ * @param fd The file descriptor.
+ * @param buffer The input buffer.
+ * @param buffer_size The size of the input buffer.
+ * @return Status
+ */
+Status write_to_file(int fd, const void* buffer, uint64_t buffer_size);
+
 }  // namespace posix
 
 }  // namespace tiledb
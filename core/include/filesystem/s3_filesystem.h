@@ -0,0 +1,410 @@
+/**
+ * @file   s3_filesystem.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class S3, a client of S3-compatible object stores.
+ */
+
+#ifndef TILEDB_FILESYSTEM_S3_H
+#define TILEDB_FILESYSTEM_S3_H
+
+#ifdef HAVE_S3
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer.h"
+#include "config.h"
+#include "status.h"
+#include "uri.h"
+
+namespace tiledb {
+
+/**
+ * A client of S3-compatible object stores, speaking the S3 REST API over
+ * libcurl with AWS Signature Version 4 authentication.
+ *
+ * URIs have the form "s3://bucket/key". Object stores have no directories:
+ * a directory exists as long as objects with its path as prefix exist.
+ * Object stores have no appends either: the writes to an object are
+ * accumulated in an upload buffer, sent as the parts of a parallel multipart
+ * upload, and the object becomes visible once flushed.
+ *
+ * Credentials are taken from the standard AWS_ACCESS_KEY_ID,
+ * AWS_SECRET_ACCESS_KEY and AWS_SESSION_TOKEN environment variables
+ * (requests are anonymous otherwise). AWS_REGION and AWS_ENDPOINT_URL
+ * (e.g., "http://localhost:9999") override the region and the endpoint of
+ * the S3 parameters.
+ */
+class S3 {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param params The S3 parameters.
+   */
+  explicit S3(const Config::S3Params& params = Config::S3Params());
+
+  /** Destructor. Pending uploads are flushed. */
+  ~S3();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /**
+   * Reads the configuration (see the S3 parameters) and the credentials from
+   * the environment. No request is made.
+   *
+   * @return Status
+   */
+  Status connect();
+
+  /**
+   * Creates a bucket.
+   *
+   * @param uri The URI of the bucket ("s3://bucket").
+   * @return Status
+   */
+  Status create_bucket(const URI& uri) const;
+
+  /**
+   * Creates a directory. Directories are implicit, so this only checks that
+   * the directory does not exist yet, unless *uri* names a bucket, in which
+   * case the bucket is created.
+   *
+   * @param uri The URI of the directory.
+   * @return Status
+   */
+  Status create_dir(const URI& uri) const;
+
+  /**
+   * Creates an empty object, unless it exists already.
+   *
+   * @param uri The URI of the object.
+   * @return Status
+   */
+  Status create_file(const URI& uri) const;
+
+  /**
+   * Flushes all pending uploads.
+   *
+   * @return Status
+   */
+  Status disconnect();
+
+  /**
+   * Retrieves the size of an object.
+   *
+   * @param uri The URI of the object.
+   * @param nbytes The object size to be retrieved.
+   * @return Status
+   */
+  Status file_size(const URI& uri, uint64_t* nbytes) const;
+
+  /**
+   * Completes the uploads of an object, or of all objects under a
+   * directory, making them visible.
+   *
+   * @param uri The URI of the object or directory.
+   * @return Status
+   */
+  Status flush(const URI& uri);
+
+  /** Checks if a bucket exists. */
+  bool is_bucket(const URI& uri) const;
+
+  /** Checks if a directory exists, i.e., if any object has it as prefix. */
+  bool is_dir(const URI& uri) const;
+
+  /** Checks if an object exists. */
+  bool is_file(const URI& uri) const;
+
+  /**
+   * Lists the objects and directories directly under a directory.
+   *
+   * @param uri The URI of the directory.
+   * @param paths The full URIs of the entries, in lexicographic order.
+   * @return Status
+   */
+  Status ls(const URI& uri, std::vector<std::string>* paths) const;
+
+  /**
+   * Lists the objects and directories directly under a directory, along
+   * with their types, with the same requests as `ls`.
+   *
+   * @param uri The URI of the directory.
+   * @param paths The full URIs of the entries, in lexicographic order.
+   * @param is_dirs For each entry, *true* if it is a directory.
+   * @return Status
+   */
+  Status ls_with_types(
+      const URI& uri,
+      std::vector<std::string>* paths,
+      std::vector<bool>* is_dirs) const;
+
+  /**
+   * Moves an object, or all objects under a directory, by copying them
+   * within the store and removing the originals.
+   *
+   * @param old_uri The old URI.
+   * @param new_uri The new URI.
+   * @return Status
+   */
+  Status move_path(const URI& old_uri, const URI& new_uri);
+
+  /**
+   * Moves an object, unless the new URI exists. The object is copied within
+   * the store with a conditional PUT, which the store rejects if the new URI
+   * exists, and the original is then removed.
+   *
+   * @param old_uri The URI of the object to move.
+   * @param new_uri The new URI.
+   * @param moved Set to *false* if the new URI exists, in which case the
+   *     object is left in place.
+   * @return Status
+   */
+  Status move_file_no_replace(
+      const URI& old_uri, const URI& new_uri, bool* moved);
+
+  /**
+   * Runs operations concurrently, on at most as many threads as the maximum
+   * parallel operations of the S3 parameters.
+   *
+   * @param n The number of operations.
+   * @param op The operation, invoked with the indexes 0 to *n* - 1.
+   * @return The status of a failed operation, or Ok.
+   */
+  Status parallel(
+      uint64_t n, const std::function<Status(uint64_t)>& op) const;
+
+  /**
+   * Reads a byte range of an object with a ranged GET.
+   *
+   * @param uri The URI of the object.
+   * @param offset The offset where the range starts.
+   * @param buffer The buffer to read into.
+   * @param nbytes The size of the range.
+   * @return Status
+   */
+  Status read_from_file(
+      const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const;
+
+  /**
+   * Removes an object. Its pending upload, if any, is discarded.
+   *
+   * @param uri The URI of the object.
+   * @return Status
+   */
+  Status remove_file(const URI& uri);
+
+  /**
+   * Removes all objects under a directory, or an entire (emptied) bucket.
+   *
+   * @param uri The URI of the directory or bucket.
+   * @return Status
+   */
+  Status remove_path(const URI& uri);
+
+  /**
+   * Appends data to the upload buffer of an object. Full parts are uploaded
+   * in parallel as soon as enough of them accumulate. An object that was
+   * already flushed cannot be appended to.
+   *
+   * @param uri The URI of the object.
+   * @param buffer The data to write.
+   * @param nbytes The size of the data.
+   * @return Status
+   */
+  Status write_to_file(const URI& uri, const void* buffer, uint64_t nbytes);
+
+ private:
+  /* ********************************* */
+  /*          TYPE DEFINITIONS         */
+  /* ********************************* */
+
+  /** The response to a request. */
+  struct Response;
+
+  /** The state of the upload of an object. */
+  struct Upload;
+
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The access key id (empty for anonymous requests). */
+  std::string access_key_id_;
+
+  /** The endpoint host (and port). */
+  std::string endpoint_;
+
+  /** Idle libcurl handles, reused to keep connections alive. */
+  mutable std::vector<void*> handles_;
+
+  /** Protects `handles_`. */
+  mutable std::mutex handles_mtx_;
+
+  /** The S3 parameters. */
+  const Config::S3Params params_;
+
+  /** The region. */
+  std::string region_;
+
+  /** The scheme, "http" or "https". */
+  std::string scheme_;
+
+  /** The secret access key. */
+  std::string secret_access_key_;
+
+  /** The session token of temporary credentials (optional). */
+  std::string session_token_;
+
+  /**
+   * The uploads in progress, indexed by object URI. An upload is pinned
+   * while in use, and deleted once dropped from the index and unpinned.
+   */
+  std::unordered_map<std::string, Upload*> uploads_;
+
+  /** Protects `uploads_`. */
+  std::mutex uploads_mtx_;
+
+  /** *True* if buckets are addressed as hosts, *false* as paths. */
+  bool virtual_addressing_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /** Aborts the multipart upload of an object. */
+  Status abort_upload(
+      const std::string& bucket,
+      const std::string& key,
+      const std::string& upload_id) const;
+
+  /**
+   * Appends data to an upload, uploading the full parts once there are
+   * enough of them. Upon error, the upload is aborted and dropped. The
+   * caller must hold the lock of the upload and pin it.
+   */
+  Status append_upload(Upload* upload, const void* buffer, uint64_t nbytes);
+
+  /**
+   * Completes an upload, uploading the remaining buffered data. The caller
+   * must hold the lock of the upload.
+   */
+  Status complete_upload(Upload* upload) const;
+
+  /**
+   * Completes and drops the uploads of an object, or of all objects under a
+   * directory.
+   *
+   * @param path The object or directory URI, or "" for all uploads.
+   * @return Status
+   */
+  Status complete_uploads(const std::string& path);
+
+  /** Copies an object within the store. */
+  Status copy_object(const URI& old_uri, const URI& new_uri) const;
+
+  /**
+   * Removes an upload from the index, if it is still the upload indexed
+   * for its object. The caller must hold the lock of the upload and pin it.
+   */
+  void drop_upload(Upload* upload);
+
+  /**
+   * Lists the keys with a prefix (recursively), and the directories right
+   * under it if *delimited*.
+   */
+  Status list(
+      const std::string& bucket,
+      const std::string& prefix,
+      bool delimited,
+      uint64_t max_keys,
+      std::vector<std::string>* keys) const;
+
+  /**
+   * Pins the uploads of an object, or of all objects under a directory
+   * ("" for all uploads), so that they are not deleted while in use.
+   */
+  void pin_uploads(const std::string& path, std::vector<Upload*>* uploads);
+
+  /** Unpins an upload, deleting it if it was dropped. */
+  void release_upload(Upload* upload);
+
+  /**
+   * Signs and sends a request.
+   *
+   * @param method The HTTP method.
+   * @param bucket The bucket ("" for the service).
+   * @param key The object key ("" for the bucket).
+   * @param query The query parameters.
+   * @param headers Extra headers (names in lower case).
+   * @param body The request body.
+   * @param body_size The size of the request body.
+   * @param response The response. Its body is read into its `buffer_`, if
+   *     set.
+   * @return Status, not ok if the request could not be sent, or if the
+   *     response has an error code.
+   */
+  Status request(
+      const std::string& method,
+      const std::string& bucket,
+      const std::string& key,
+      const std::map<std::string, std::string>& query,
+      const std::map<std::string, std::string>& headers,
+      const void* body,
+      uint64_t body_size,
+      Response* response) const;
+
+  /**
+   * Uploads data as parts of the multipart part size of the S3 parameters
+   * (the last one may be smaller) in parallel, starting the multipart upload if
+   * needed.
+   */
+  Status upload_parts(Upload* upload, const char* data, uint64_t nbytes) const;
+
+  /** The libcurl callback receiving the body of a response. */
+  static size_t write_callback(
+      char* data, size_t size, size_t nmemb, void* userdata);
+};
+
+}  // namespace tiledb
+
+#endif  // HAVE_S3
+
+#endif  // TILEDB_FILESYSTEM_S3_H
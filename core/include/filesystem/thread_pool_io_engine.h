@@ -0,0 +1,104 @@
+/**
+ * @file   thread_pool_io_engine.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class ThreadPoolIOEngine.
+ */
+
+#ifndef TILEDB_THREAD_POOL_IO_ENGINE_H
+#define TILEDB_THREAD_POOL_IO_ENGINE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "io_engine.h"
+
+namespace tiledb {
+
+/** An I/O engine executing positional reads on a pool of threads. */
+class ThreadPoolIOEngine : public IOEngine {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param thread_num The number of threads, i.e., the maximum number of
+   *     reads in flight.
+   */
+  explicit ThreadPoolIOEngine(unsigned int thread_num);
+
+  /** Destructor. */
+  ~ThreadPoolIOEngine();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /** Returns the engine name. */
+  const char* name() const;
+
+  /** Queues requests for the worker threads. */
+  Status submit(const std::vector<IORequest>& requests);
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** Signals new requests (or termination) to the workers. */
+  std::condition_variable cv_;
+
+  /** Protects the request queue. */
+  std::mutex mtx_;
+
+  /** The queued requests. */
+  std::queue<IORequest> requests_;
+
+  /** *True* when the workers must terminate. */
+  bool stop_;
+
+  /** The worker threads. */
+  std::vector<std::thread*> threads_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /** The worker thread loop. */
+  void worker();
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_THREAD_POOL_IO_ENGINE_H
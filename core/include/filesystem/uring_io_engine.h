@@ -0,0 +1,196 @@
+/**
+ * @file   uring_io_engine.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class UringIOEngine.
+ */
+
+#ifndef TILEDB_URING_IO_ENGINE_H
+#define TILEDB_URING_IO_ENGINE_H
+
+#ifdef HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "io_engine.h"
+
+namespace tiledb {
+
+/**
+ * An I/O engine submitting reads to a Linux io_uring instance. Submissions
+ * are made by the caller; a dedicated thread reaps the completions.
+ */
+class UringIOEngine : public IOEngine {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /** Constructor. */
+  UringIOEngine();
+
+  /** Destructor. */
+  ~UringIOEngine();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /**
+   * Sets up the ring. It fails if the kernel does not support io_uring (or
+   * forbids its use), in which case the engine must not be used.
+   *
+   * @param entries The submission queue size.
+   * @return Status
+   */
+  Status init(unsigned int entries);
+
+  /** Returns the engine name. */
+  const char* name() const;
+
+  /**
+   * Submits requests to the ring. Upon failure, the requests the kernel did
+   * not take are completed with the error.
+   */
+  Status submit(const std::vector<IORequest>& requests);
+
+ protected:
+  /* ********************************* */
+  /*         PROTECTED METHODS         */
+  /* ********************************* */
+
+  /**
+   * Enters the kernel to submit *n* queued entries. Upon failure, some of
+   * the entries may remain queued.
+   */
+  virtual Status enter(unsigned n);
+
+ private:
+  /* ********************************* */
+  /*          TYPE DEFINITIONS         */
+  /* ********************************* */
+
+  /** A submitted read, identified in the rings by its address. */
+  struct Op;
+
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The completion queue entries (mapped). */
+  struct io_uring_cqe* cqes_;
+
+  /** The completion queue head (mapped). */
+  unsigned* cq_head_;
+
+  /** The completion queue index mask (mapped). */
+  unsigned* cq_mask_;
+
+  /** The completion queue size (mapped). */
+  unsigned cq_entries_;
+
+  /** The completion queue tail (mapped). */
+  unsigned* cq_tail_;
+
+  /** The size of the completion queue ring mapping. */
+  size_t cq_ring_size_;
+
+  /** The completion queue ring mapping. */
+  void* cq_ring_;
+
+  /** Number of requests submitted and not yet reaped. */
+  unsigned inflight_;
+
+  /** Signals free completion queue slots to submitters. */
+  std::condition_variable inflight_cv_;
+
+  /** The completion reaper thread. */
+  std::thread* reaper_;
+
+  /** The ring file descriptor. */
+  int ring_fd_;
+
+  /** The submission queue index array (mapped). */
+  unsigned* sq_array_;
+
+  /** The submission queue size. */
+  unsigned sq_entries_;
+
+  /** The submission queue head (mapped). */
+  unsigned* sq_head_;
+
+  /** The submission queue index mask (mapped). */
+  unsigned* sq_mask_;
+
+  /** The size of the submission queue ring mapping. */
+  size_t sq_ring_size_;
+
+  /** The submission queue ring mapping. */
+  void* sq_ring_;
+
+  /** The submission queue tail (mapped). */
+  unsigned* sq_tail_;
+
+  /** The submission queue entries (mapped). */
+  struct io_uring_sqe* sqes_;
+
+  /** Serializes submissions. */
+  std::mutex submit_mtx_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /** Queues an operation in the submission ring (nullptr queues a NOP). */
+  void queue(Op* op);
+
+  /** The completion reaper loop. */
+  void reap();
+
+  /**
+   * Waits for a free completion slot and reserves it. Must be called with
+   * *lck* holding `submit_mtx_`.
+   */
+  void reserve(std::unique_lock<std::mutex>* lck);
+
+  /**
+   * Removes the entries the kernel has not consumed from the submission
+   * ring, completing their requests with *st*. Must be called while holding
+   * `submit_mtx_`.
+   */
+  void unqueue(const Status& st);
+};
+
+}  // namespace tiledb
+
+#endif  // HAVE_IO_URING
+
+#endif  // TILEDB_URING_IO_ENGINE_H
@@ -34,16 +34,26 @@
 #define TILEDB_VFS_H
 
 #include "buffer.h"
+#include "config.h"
+#include "disk_cache.h"
+#include "fd_cache.h"
+#include "io_engine.h"
 #include "status.h"
 #include "uri.h"
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #ifdef HAVE_HDFS
 #include "hdfs.h"
 #endif
 
+#ifdef HAVE_S3
+#include "s3_filesystem.h"
+#endif
+
 namespace tiledb {
 
 /**
@@ -52,12 +62,30 @@ namespace tiledb {
  */
 class VFS {
  public:
+  /* ********************************* */
+  /*           TYPE DEFINITIONS        */
+  /* ********************************* */
+
+  /** A byte range of a file, along with the buffer it is read into. */
+  struct ReadRange {
+    /** The offset in the file where the range starts. */
+    uint64_t offset;
+    /** The size of the range in bytes. */
+    uint64_t nbytes;
+    /** The buffer to read into (of at least *nbytes* size). */
+    void* buffer;
+  };
+
   /* ********************************* */
   /*     CONSTRUCTORS & DESTRUCTORS    */
   /* ********************************* */
 
-  /** Constructor. */
-  VFS();
+  /**
+   * Constructor.
+   *
+   * @param params The VFS parameters.
+   */
+  explicit VFS(const Config::VFSParams& params = Config::VFSParams());
 
   /** Destructor. */
   ~VFS();
@@ -75,6 +103,15 @@ class VFS {
    */
   static std::string abs_path(const std::string& path);
 
+  /**
+   * Closes a file, releasing any descriptors the VFS keeps open for it.
+   * Subsequent operations on the file reopen it.
+   *
+   * @param uri The URI of the file.
+   * @return Status
+   */
+  Status close_file(const URI& uri) const;
+
   /**
    * Creates a directory.
    *
@@ -91,6 +128,9 @@ class VFS {
    */
   Status create_file(const URI& uri) const;
 
+  /** Returns the cache of open POSIX file descriptors. */
+  const FDCache* fd_cache() const;
+
   /**
    * Removes a given path (recursive)
    * @param uri The uri of the path to be removed
@@ -136,6 +176,11 @@ class VFS {
    */
   Status file_size(const URI& uri, uint64_t* size) const;
 
+  /**
+   * Returns the asynchronous I/O engine, which is created upon first use.
+   */
+  IOEngine* io_engine() const;
+
   /**
    * Checks if a directory exists.
    *
@@ -161,6 +206,33 @@ class VFS {
    */
   Status ls(const URI& parent, std::vector<URI>* uris) const;
 
+  /**
+   * Retrieves all the URIs that have the first input as parent, along with
+   * their types. Backends report the types with the listing itself (e.g.,
+   * `readdir` entry types on POSIX), so no path is stat'ed separately.
+   *
+   * @param parent The target directory to list.
+   * @param uris The URIs that are contained in the parent.
+   * @param is_dirs For each URI, *true* if it is a directory.
+   * @return Status
+   */
+  Status ls_with_types(
+      const URI& parent,
+      std::vector<URI>* uris,
+      std::vector<bool>* is_dirs) const;
+
+  /**
+   * Maps an entire file into memory. Writes to the mapping are private to
+   * the process. Only POSIX files can be mapped.
+   *
+   * @param uri The URI of the file.
+   * @param data The address of the mapping to be retrieved.
+   * @param size The size of the mapping (i.e., the file size) to be
+   *     retrieved.
+   * @return Status
+   */
+  Status map_file(const URI& uri, void** data, uint64_t* size) const;
+
   /**
    * Renames a TileDB resource path.
    *
@@ -170,6 +242,46 @@ class VFS {
    */
   Status move_path(const URI& old_uri, const URI& new_uri);
 
+  /**
+   * Moves a file, unless the new URI exists. The check and the move are
+   * atomic, also across processes, so that exactly one of concurrent moves
+   * to the same URI succeeds. Both URIs must have the same scheme.
+   *
+   * @param old_uri The URI of the file to move.
+   * @param new_uri The new URI.
+   * @param moved Set to *false* if the new URI exists, in which case the file
+   *     is left in place.
+   * @return Status
+   */
+  Status move_file_no_replace(
+      const URI& old_uri, const URI& new_uri, bool* moved);
+
+  /**
+   * Reads multiple ranges from a file. Consecutive ranges that are adjacent
+   * in the file are read with a single vectored read where the backend
+   * supports it.
+   *
+   * @param uri The URI of the file.
+   * @param ranges The ranges to read, along with their target buffers.
+   * @return Status
+   */
+  Status read_batch(const URI& uri, const std::vector<ReadRange>& ranges) const;
+
+  /**
+   * Submits reads of multiple ranges from a file, which complete in the
+   * background. The buffers must remain valid until `wait_reads` returns
+   * for the batch. Backends without asynchronous I/O read synchronously.
+   *
+   * @param uri The URI of the file.
+   * @param ranges The ranges to read, along with their target buffers.
+   * @param batch The batch the reads are added to.
+   * @return Status
+   */
+  Status read_async(
+      const URI& uri,
+      const std::vector<ReadRange>& ranges,
+      IOBatch* batch) const;
+
   /**
    * Reads the entire file into a buffer.
    *
@@ -192,7 +304,8 @@ class VFS {
       const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const;
 
   /**
-   * Syncs (flushes) a file.
+   * Syncs (flushes) a file, including its buffered writes. If the URI is a
+   * directory, the buffered writes of all files under it are flushed.
    *
    * @param uri The URI of the file.
    * @return Status
@@ -200,7 +313,28 @@ class VFS {
   Status sync(const URI& uri) const;
 
   /**
-   * Writes the contents of a buffer into a file.
+   * Unmaps a file mapped with `map_file`.
+   *
+   * @param uri The URI of the file.
+   * @param data The address of the mapping.
+   * @param size The size of the mapping.
+   * @return Status
+   */
+  Status unmap_file(const URI& uri, void* data, uint64_t size) const;
+
+  /**
+   * Waits for the reads of a batch submitted with `read_async`.
+   *
+   * @param batch The batch.
+   * @return The status of the first failed read, or Ok.
+   */
+  Status wait_reads(IOBatch* batch) const;
+
+  /**
+   * Writes (appends) the contents of a buffer into a file. Small writes are
+   * buffered per file and reach the backend upon `sync`, `close_file`, any
+   * read of the file, or when the buffer exceeds the write buffer size of
+   * the VFS parameters.
    *
    * @param uri The URI of the file.
    * @param buffer The buffer to write from.
@@ -211,12 +345,114 @@ class VFS {
       const URI& uri, const void* buffer, uint64_t buffer_size) const;
 
  private:
+  /* ********************************* */
+  /*      PRIVATE TYPE DEFINITIONS     */
+  /* ********************************* */
+
+  /** The write-behind buffer of a file. */
+  struct WriteBuffer;
+
   /* ********************************* */
   /*         PRIVATE ATTRIBUTES        */
   /* ********************************* */
+
+  /**
+   * Caches blocks of remote fragment files on local disk (nullptr if the
+   * disk cache directory of the VFS parameters is empty).
+   */
+  DiskCache* disk_cache_;
+
+  /** Caches open descriptors of POSIX files across reads and writes. */
+  FDCache* fd_cache_;
+
+  /** Executes asynchronous reads (nullptr until first used). */
+  mutable IOEngine* io_engine_;
+
+  /** Protects the creation of the asynchronous I/O engine. */
+  mutable std::mutex io_engine_mtx_;
+
+  /** The VFS parameters. */
+  const Config::VFSParams params_;
+
+  /** The write-behind buffers, indexed by file URI. */
+  mutable std::unordered_map<std::string, WriteBuffer*> write_buffers_;
+
+  /** Protects the write-behind buffer index. */
+  mutable std::mutex write_buffers_mtx_;
+
 #ifdef HAVE_HDFS
   hdfsFS hdfs_;
 #endif
+
+#ifdef HAVE_S3
+  /** The S3 client. */
+  S3* s3_;
+#endif
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /**
+   * Drops the write-behind buffers of a file, or of all files under a
+   * directory, without flushing them.
+   */
+  void discard_write_buffers(const URI& uri) const;
+
+  /**
+   * Removes a write-behind buffer from the index. The caller must hold the
+   * lock of the buffer and pin it.
+   */
+  void drop_write_buffer(WriteBuffer* write_buffer) const;
+
+  /** Reads a byte range of a remote (HDFS, S3) file from its backend. */
+  Status fetch_remote(
+      const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const;
+
+  /**
+   * Writes the buffered data of a file to the backend, clearing the buffer
+   * only on success. The caller must hold the lock of the buffer.
+   */
+  Status flush_write_buffer(WriteBuffer* write_buffer) const;
+
+  /**
+   * Flushes the write-behind buffers of a file, or of all files under a
+   * directory.
+   *
+   * @param uri The URI of the file or directory.
+   * @param drop If *true*, the buffers that flushed successfully are also
+   *     deleted.
+   * @return Status
+   */
+  Status flush_write_buffers(const URI& uri, bool drop) const;
+
+  /**
+   * Checks if a remote file is immutable, i.e., if it belongs to a fragment
+   * whose metadata has been written. Positive answers are memoized, and
+   * negative ones for the mutable TTL of the VFS parameters.
+   */
+  bool is_immutable(const URI& uri) const;
+
+  /**
+   * Pins the write-behind buffers of a file, or of all files under a
+   * directory, so that they are not deleted while in use.
+   */
+  void pin_write_buffers(
+      const URI& uri, std::vector<WriteBuffer*>* write_buffers) const;
+
+  /**
+   * Reads a byte range of a remote (HDFS, S3) file, through the disk cache
+   * if the file is immutable.
+   */
+  Status read_remote(
+      const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const;
+
+  /** Unpins a write-behind buffer, deleting it if it was dropped. */
+  void release_write_buffer(WriteBuffer* write_buffer) const;
+
+  /** Appends to a file directly through the backend. */
+  Status write_direct(
+      const URI& uri, const void* buffer, uint64_t buffer_size) const;
 };
 
 }  // namespace tiledb
@@ -0,0 +1,215 @@
+/**
+ * @file   filter_pipeline.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class FilterPipeline.
+ */
+
+#ifndef TILEDB_FILTER_PIPELINE_H
+#define TILEDB_FILTER_PIPELINE_H
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer.h"
+#include "const_buffer.h"
+#include "datatype.h"
+#include "filter_type.h"
+#include "status.h"
+
+namespace tiledb {
+
+/**
+ * An ordered list of filters that transform the chunks of a tile before
+ * they are compressed, e.g., shuffling the bytes of the values so that the
+ * compressor finds longer runs. All filters are lossless, and are reversed
+ * in the opposite order upon decompression.
+ */
+class FilterPipeline {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /** Constructor. */
+  FilterPipeline();
+
+  /** Destructor. */
+  ~FilterPipeline();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /** Appends a filter to the pipeline. */
+  void add_filter(FilterType filter);
+
+  /**
+   * Populates the object members from the data in the input binary buffer.
+   *
+   * @param buff The buffer to deserialize from.
+   * @return Status
+   */
+  Status deserialize(ConstBuffer* buff);
+
+  /** Dumps the pipeline contents in ASCII form in the selected output. */
+  void dump(FILE* out) const;
+
+  /** Returns *true* if the pipeline has no filters. */
+  bool empty() const;
+
+  /** Returns the filter at the input position of the pipeline. */
+  FilterType filter(unsigned int i) const;
+
+  /** Returns the number of filters in the pipeline. */
+  unsigned int filter_num() const;
+
+  /**
+   * Returns the maximum number of bytes the filters may add to *nbytes* of
+   * input.
+   */
+  uint64_t overhead(uint64_t nbytes) const;
+
+  /**
+   * Applies the filters in order.
+   *
+   * @param type The type of the filtered values.
+   * @param input The data to be filtered.
+   * @param output The buffer the filtered data are written to.
+   * @return Status
+   */
+  Status run_forward(Datatype type, ConstBuffer* input, Buffer* output) const;
+
+  /**
+   * Reverses the filters, in the opposite order.
+   *
+   * @param type The type of the filtered values.
+   * @param input The filtered data.
+   * @param output The buffer the original data are written to.
+   * @return Status
+   */
+  Status run_reverse(Datatype type, ConstBuffer* input, Buffer* output) const;
+
+  /**
+   * Serializes the object members into a binary buffer.
+   *
+   * @param buff The buffer to serialize the data into.
+   * @return Status
+   */
+  Status serialize(Buffer* buff) const;
+
+ private:
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The filters, in the order they are applied. */
+  std::vector<FilterType> filters_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /**
+   * Applies or reverses a single filter.
+   *
+   * @param filter The filter.
+   * @param type The type of the filtered values.
+   * @param reverse If *true*, the filter is reversed.
+   * @param input The input data.
+   * @param output The buffer the output data are written to.
+   * @return Status
+   */
+  static Status apply(
+      FilterType filter,
+      Datatype type,
+      bool reverse,
+      ConstBuffer* input,
+      Buffer* output);
+
+  /**
+   * Applies the filters in order, or reverses them in the opposite order.
+   *
+   * @param type The type of the filtered values.
+   * @param reverse If *true*, the filters are reversed.
+   * @param input The input data.
+   * @param output The buffer the output data are written to.
+   * @return Status
+   */
+  Status run(
+      Datatype type, bool reverse, ConstBuffer* input, Buffer* output) const;
+
+  /**
+   * Bit width reduction: each window of values is stored as its minimum,
+   * followed by the differences from the minimum, packed in as many bits as
+   * the largest difference needs. Non-integer values pass through as is.
+   */
+  static Status bit_width_reduce(
+      Datatype type, ConstBuffer* input, Buffer* output);
+
+  /** Reverses `bit_width_reduce`. */
+  static Status bit_width_expand(
+      Datatype type, ConstBuffer* input, Buffer* output);
+
+  /**
+   * Bit shuffle: the values are stored one bit plane after the other, i.e.,
+   * first bit 0 of all values, then bit 1 etc.
+   */
+  static Status bitshuffle(
+      uint64_t value_size, ConstBuffer* input, Buffer* output);
+
+  /** Reverses `bitshuffle`. */
+  static Status bitunshuffle(
+      uint64_t value_size, ConstBuffer* input, Buffer* output);
+
+  /**
+   * Byte shuffle: the values are stored one byte position after the other,
+   * i.e., first byte 0 of all values, then byte 1 etc.
+   */
+  static Status byteshuffle(
+      uint64_t value_size, ConstBuffer* input, Buffer* output);
+
+  /** Reverses `byteshuffle`. */
+  static Status byteunshuffle(
+      uint64_t value_size, ConstBuffer* input, Buffer* output);
+
+  /**
+   * Delta encoding: each value is replaced by its difference from the
+   * previous one, in wrap-around unsigned arithmetic of the value width.
+   */
+  static Status delta_encode(
+      uint64_t value_size, ConstBuffer* input, Buffer* output);
+
+  /** Reverses `delta_encode`. */
+  static Status delta_decode(
+      uint64_t value_size, ConstBuffer* input, Buffer* output);
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_FILTER_PIPELINE_H
@@ -40,10 +40,13 @@
 #include "status.h"
 
 #include <zlib.h>
+#include <mutex>
 #include <vector>
 
 namespace tiledb {
 
+class StorageManager;
+
 /** Stores the metadata structures of a fragment. */
 class FragmentMetadata {
  public:
@@ -115,6 +118,9 @@ class FragmentMetadata {
    */
   void append_tile_var_size(unsigned int attribute_id, uint64_t size);
 
+  /** Returns the array metadata. */
+  const ArrayMetadata* array_metadata() const;
+
   /** Returns the bounding coordinates. */
   const std::vector<void*>& bounding_coords() const;
 
@@ -128,13 +134,35 @@ class FragmentMetadata {
   bool dense() const;
 
   /**
-   * Loads the fragment metadata structures from the input binary buffer.
+   * Loads the fragment metadata structures from the input binary buffer,
+   * which holds the single generic tile written by older versions.
    *
    * @param buff The binary buffer to deserialize from.
    * @return Status
    */
   Status deserialize(ConstBuffer* buff);
 
+  /**
+   * Loads the index at the start of the fragment metadata file, i.e., the
+   * section offsets, the number of tiles, the last tile cell number and the
+   * non-empty domain. The remaining sections are loaded on demand through
+   * the storage manager.
+   *
+   * @param storage_manager The storage manager that loads the sections.
+   * @param buff The binary buffer to deserialize from.
+   * @return Status
+   */
+  Status deserialize_index(StorageManager* storage_manager, ConstBuffer* buff);
+
+  /**
+   * Loads a single section from the input binary buffer.
+   *
+   * @param section The section id.
+   * @param buff The binary buffer to deserialize from.
+   * @return Status
+   */
+  Status deserialize_section(uint64_t section, ConstBuffer* buff);
+
   /** Returns the (expanded) domain in which the fragment is constrained. */
   const void* domain() const;
 
@@ -153,19 +181,61 @@ class FragmentMetadata {
   /** Returns the number of cells in the last tile. */
   uint64_t last_tile_cell_num() const;
 
+  /** Loads the bounding coordinates, if they are not loaded yet. */
+  Status load_bounding_coords();
+
+  /** Loads the MBRs, if they are not loaded yet. */
+  Status load_mbrs();
+
+  /** Loads the tile offsets of an attribute, if they are not loaded yet. */
+  Status load_tile_offsets(unsigned int attribute_id);
+
+  /**
+   * Loads the variable tile offsets of an attribute, if they are not loaded
+   * yet.
+   */
+  Status load_tile_var_offsets(unsigned int attribute_id);
+
+  /**
+   * Loads the variable tile sizes of an attribute, if they are not loaded
+   * yet.
+   */
+  Status load_tile_var_sizes(unsigned int attribute_id);
+
   /** Returns the MBRs. */
   const std::vector<void*>& mbrs() const;
 
+  /** Returns the (approximate) main memory the loaded metadata occupy. */
+  uint64_t memory_size() const;
+
   /** Returns the non-empty domain in which the fragment is constrained. */
   const void* non_empty_domain() const;
 
+  /** Returns the number of sections of the fragment metadata file. */
+  uint64_t section_num() const;
+
+  /** Returns the offset of a section in the fragment metadata file. */
+  uint64_t section_offset(uint64_t section) const;
+
   /**
-   * Serializes the metadata structures into a binary buffer.
+   * Serializes the index of the fragment metadata file into a binary buffer.
    *
+   * @param section_sizes The sizes the sections occupy in the file, in the
+   *     order they follow the index.
    * @param buff The buffer to serialize into.
    * @return Status
    */
-  Status serialize(Buffer* buff);
+  Status serialize_index(
+      const std::vector<uint64_t>& section_sizes, Buffer* buff);
+
+  /**
+   * Serializes a single section into a binary buffer.
+   *
+   * @param section The section id.
+   * @param buff The buffer to serialize into.
+   * @return Status
+   */
+  Status serialize_section(uint64_t section, Buffer* buff);
 
   /**
    * Simply sets the number of cells for the last tile.
@@ -218,6 +288,9 @@ class FragmentMetadata {
   /** The MBRs (applicable only to the sparse case with irregular tiles). */
   std::vector<void*> mbrs_;
 
+  /** Protects the sections loaded on demand. */
+  mutable std::mutex mtx_;
+
   /** The offsets of the next tile for each attribute. */
   std::vector<uint64_t> next_tile_offsets_;
 
@@ -230,12 +303,30 @@ class FragmentMetadata {
    */
   void* non_empty_domain_;
 
+  /**
+   * Indicates which sections of the fragment metadata file are loaded. It
+   * is empty if the metadata are entirely in memory.
+   */
+  std::vector<bool> section_loaded_;
+
+  /** The offsets of the sections in the fragment metadata file. */
+  std::vector<uint64_t> section_offsets_;
+
+  /** The storage manager that loads the sections on demand. */
+  StorageManager* storage_manager_;
+
   /**
    * The tile offsets in their corresponding attribute files. Meaningful only
    * when there is compression.
    */
   std::vector<std::vector<uint64_t>> tile_offsets_;
 
+  /**
+   * The number of tiles, kept for sparse fragments whose MBRs are loaded
+   * on demand.
+   */
+  uint64_t tile_num_;
+
   /**
    * The variable tile offsets in their corresponding attribute files.
    * Meaningful only for variable-sized tiles.
@@ -285,28 +376,57 @@ class FragmentMetadata {
   Status load_non_empty_domain(ConstBuffer* buff);
 
   /**
-   * Loads the tile offsets from the fragment metadata buffer.
+   * Loads a section through the storage manager, if it is not loaded yet.
    *
+   * @param section The section id.
+   * @return Status
+   */
+  Status load_section(uint64_t section);
+
+  /**
+   * Loads the tile offsets of an attribute from the fragment metadata
+   * buffer.
+   *
+   * @param attribute_id The attribute id.
    * @param buff Metadata buffer.
    * @return Status
    */
-  Status load_tile_offsets(ConstBuffer* buff);
+  Status load_tile_offsets(unsigned int attribute_id, ConstBuffer* buff);
 
   /**
-   * Loads the variable tile offsets from the fragment metadata buffer.
+   * Loads the variable tile offsets of an attribute from the fragment
+   * metadata buffer.
    *
+   * @param attribute_id The attribute id.
    * @param buff Metadata buffer.
    * @return Status
    */
-  Status load_tile_var_offsets(ConstBuffer* buff);
+  Status load_tile_var_offsets(unsigned int attribute_id, ConstBuffer* buff);
 
   /**
-   * Loads the variable tile sizes from the fragment metadata.
+   * Loads the variable tile sizes of an attribute from the fragment
+   * metadata.
    *
+   * @param attribute_id The attribute id.
    * @param buff Metadata buffer.
    * @return Status
    */
-  Status load_tile_var_sizes(ConstBuffer* buff);
+  Status load_tile_var_sizes(unsigned int attribute_id, ConstBuffer* buff);
+
+  /** Returns the id of the section holding the tile offsets of an attribute. */
+  uint64_t section_tile_offsets(unsigned int attribute_id) const;
+
+  /**
+   * Returns the id of the section holding the variable tile offsets of an
+   * attribute.
+   */
+  uint64_t section_tile_var_offsets(unsigned int attribute_id) const;
+
+  /**
+   * Returns the id of the section holding the variable tile sizes of an
+   * attribute.
+   */
+  uint64_t section_tile_var_sizes(unsigned int attribute_id) const;
 
   /**
    * Writes the bounding coordinates to the fragment metadata buffer.
@@ -341,28 +461,33 @@ class FragmentMetadata {
   Status write_non_empty_domain(Buffer* buff);
 
   /**
-   * Writes the tile offsets to the fragment metadata buffer.
+   * Writes the tile offsets of an attribute to the fragment metadata buffer.
    *
+   * @param attribute_id The attribute id.
    * @param buff Metadata buffer.
    * @return Status
    */
-  Status write_tile_offsets(Buffer* buff);
+  Status write_tile_offsets(unsigned int attribute_id, Buffer* buff);
 
   /**
-   * Writes the variable tile offsets to the fragment metadata buffer.
+   * Writes the variable tile offsets of an attribute to the fragment
+   * metadata buffer.
    *
+   * @param attribute_id The attribute id.
    * @param buff Metadata buffer.
    * @return Status
    */
-  Status write_tile_var_offsets(Buffer* buff);
+  Status write_tile_var_offsets(unsigned int attribute_id, Buffer* buff);
 
   /**
-   * Writes the variable tile sizes to the fragment metadata buffer.
+   * Writes the variable tile sizes of an attribute to the fragment metadata
+   * buffer.
    *
+   * @param attribute_id The attribute id.
    * @param buff Metadata buffer.
    * @return Status
    */
-  Status write_tile_var_sizes(Buffer* buff);
+  Status write_tile_var_sizes(unsigned int attribute_id, Buffer* buff);
 };
 
 }  // namespace tiledb
@@ -39,6 +39,7 @@
 #include "fragment.h"
 #include "fragment_metadata.h"
 #include "tile.h"
+#include "tile_cache.h"
 #include "tile_io.h"
 
 namespace tiledb {
@@ -142,9 +143,19 @@ class ReadState {
   /** Returns *true* if the read state corresponds to a dense fragment. */
   bool dense() const;
 
+  /** Drops the tiles fetched ahead with `prefetch_tile` and not read yet. */
+  void discard_prefetched();
+
   /** Returns *true* if the read operation is finished for this fragment. */
   bool done() const;
 
+  /**
+   * Finalizes the read state, closing the attribute files.
+   *
+   * @return Status
+   */
+  Status finalize();
+
   /**
    * Copies the bounding coordinates of the current search tile into the input
    * *bounding_coords*.
@@ -300,9 +311,29 @@ class ReadState {
   /** Returns *true* if the read buffers overflowed for the input attribute. */
   bool overflow(unsigned int attribute_id) const;
 
+  /**
+   * Queues the tile data of an attribute to be fetched ahead by the next
+   * `submit_prefetch`. A subsequent read of the same tile consumes the
+   * fetched data. Tiles that are already fetched are skipped.
+   *
+   * @param attribute_id The attribute id.
+   * @param tile_i The tile index.
+   * @return Status
+   */
+  Status prefetch_tile(unsigned int attribute_id, uint64_t tile_i);
+
   /** Resets the overflow flag of every attribute to *false*. */
   void reset_overflow();
 
+  /**
+   * Submits asynchronous reads of the tiles queued with `prefetch_tile`,
+   * coalescing nearby tiles of each file into larger reads.
+   *
+   * @param batch The batch the reads are added to.
+   * @return Status
+   */
+  Status submit_prefetch(IOBatch* batch);
+
   /**
    * True if the fragment non-empty domain fully covers the subarray area of
    * the current overlapping tile.
@@ -320,9 +351,27 @@ class ReadState {
   /** The number of array attributes. */
   unsigned int attribute_num_;
 
+  /**
+   * The pinned cached tiles the tiles are views of, one per tile (nullptr
+   * if the tile was not served by the tile cache).
+   */
+  std::vector<const CachedTile*> cached_tiles_;
+
+  /**
+   * The tile last read straight into a user buffer for each attribute, whose
+   * cells are all copied (INVALID_UINT64 if there is none).
+   */
+  std::vector<uint64_t> copied_tile_;
+
   /** The size of the array coordinates. */
   uint64_t coords_size_;
 
+  /**
+   * Holds the decoded values of the current variable-sized tile, one per
+   * dictionary-encoded attribute (*nullptr* for the rest).
+   */
+  std::vector<Buffer*> decoded_var_;
+
   /** Indicates if the read operation on this fragment finished. */
   bool done_;
 
@@ -619,9 +668,12 @@ class ReadState {
    *
    * @param attribute_id The attribute id.
    * @param tile_i The tile index.
+   * @param buffer If not null, the tile is read straight into this buffer
+   *     (which must fit it), and the tile becomes a view of it.
    * @return Status
    */
-  Status read_tile(unsigned int attribute_id, uint64_t tile_i);
+  Status read_tile(
+      unsigned int attribute_id, uint64_t tile_i, void* buffer = nullptr);
 
   /**
    * Prepares a variable-sized tile from the disk for reading for an attribute.
@@ -632,6 +684,25 @@ class ReadState {
    */
   Status read_tile_var(unsigned int attribute_id, uint64_t tile_i);
 
+  /**
+   * Serves a tile (and its variable-sized values) from the tile cache of the
+   * storage manager, making the tiles views of the pinned cached data.
+   *
+   * @param attribute_id The attribute id.
+   * @param tile_i The tile index.
+   * @param buffer If not null, the tile is copied into this buffer, and the
+   *     tile becomes a view of it.
+   * @return *true* on a cache hit.
+   */
+  bool read_tile_from_cache(
+      unsigned int attribute_id, uint64_t tile_i, void* buffer = nullptr);
+
+  /**
+   * Unpins the cached tile the input tile is a view of (if any). The tile
+   * must be fetched again before it is used.
+   */
+  void release_cached_tile(unsigned int attribute_id);
+
   /**
    * Shifts the offsets stored in the tile buffer of the input attribute, such
    * that the first starts from 0 and the rest are relative to the first one.
@@ -108,6 +108,9 @@ class WriteState {
    */
   std::vector<uint64_t> buffer_var_offsets_;
 
+  /** Holds a dictionary-encoded variable-sized tile before it is written. */
+  Buffer* encoded_var_;
+
   /** The fragment the write state belongs to. */
   const Fragment* fragment_;
 
@@ -137,6 +140,16 @@ class WriteState {
    */
   std::vector<TileIO*> tile_io_var_;
 
+  /**
+   * The tiles sampled for training a ZSTD dictionary, stored contiguously,
+   * one buffer per attribute (*nullptr* for the attributes that do not need
+   * training).
+   */
+  std::vector<Buffer*> zstd_samples_;
+
+  /** The sizes of the sampled tiles, one vector per attribute. */
+  std::vector<std::vector<size_t>> zstd_sample_sizes_;
+
   /* ********************************* */
   /*           PRIVATE METHODS         */
   /* ********************************* */
@@ -157,6 +170,23 @@ class WriteState {
   /** Initializes the internal Tile I/O structures. */
   void init_tile_io();
 
+  /**
+   * Sets the stored ZSTD dictionaries on the tiles of the attributes that
+   * use them, and prepares sampling for those without a dictionary yet.
+   */
+  void init_zstd_dictionaries();
+
+  /**
+   * Adds a tile (as it is passed to the compressor, i.e., after the filters)
+   * to the samples a ZSTD dictionary is trained on, up to the dictionary
+   * sample size of the storage manager config per attribute.
+   *
+   * @param attribute_id The id of the attribute the tile belongs to.
+   * @param tile The tile to sample.
+   * @return Status
+   */
+  Status sample_tile(unsigned int attribute_id, const Tile* tile);
+
   /**
    * Sorts the input cell coordinates according to the order specified in the
    * array schema. This is not done in place; the sorted positions are stored
@@ -211,6 +241,15 @@ class WriteState {
   template <class T>
   void update_bookkeeping(const void* buffer, uint64_t buffer_size);
 
+  /**
+   * Trains the ZSTD dictionaries of the attributes that were sampled, and
+   * stores them in the array directory. Too few samples are not an error;
+   * the dictionary is then trained by a later write.
+   *
+   * @return Status
+   */
+  Status train_zstd_dictionaries();
+
   /**
    * Performs the write operation for the case of a dense fragment, focusing
    * on a single fixed-sized attribute.
@@ -310,6 +349,17 @@ class WriteState {
       void* buffer_var,
       uint64_t buffer_var_size,
       const std::vector<uint64_t>& cell_pos);
+
+  /**
+   * Writes the current variable-sized tile of an attribute to the disk,
+   * dictionary-encoding it first if the attribute is set so, and records
+   * its offset and size in the fragment metadata. It must be called before
+   * the offsets tile is written.
+   *
+   * @param attribute_id The id of the attribute this operation focuses on.
+   * @return Status
+   */
+  Status write_tile_var(unsigned int attribute_id);
 };
 
 }  // namespace tiledb
@@ -117,6 +117,24 @@ extern const char* file_suffix;
 /** The fragment metadata file name. */
 extern const char* fragment_metadata_filename;
 
+/**
+ * The name prefix of the consolidated fragment metadata file of an array,
+ * which is followed by the generation number and the file suffix.
+ */
+extern const char* consolidated_fragment_metadata_prefix;
+
+/**
+ * The name of the small fragment file storing only the fragment non-empty
+ * domain, which is read to prune fragments without loading their metadata.
+ */
+extern const char* fragment_domain_filename;
+
+/**
+ * The value at the start of a fragment metadata file split into sections,
+ * which distinguishes it from the older single generic tile format.
+ */
+extern const uint64_t fragment_metadata_index_magic;
+
 /** Default datatype for a generic tile. */
 extern const Datatype generic_tile_datatype;
 
@@ -141,6 +159,96 @@ extern const uint64_t consolidation_buffer_size;
 /** The maximum number of bytes written in a single I/O. */
 extern const uint64_t max_write_bytes;
 
+/** The maximum number of files whose descriptors the VFS keeps open. */
+extern const uint64_t vfs_fd_cache_size;
+
+/**
+ * The size of the per-file write-behind buffer of the VFS. Appends are
+ * accumulated up to this size before reaching the backend (0 disables
+ * buffering).
+ */
+extern const uint64_t vfs_write_buffer_size;
+
+/**
+ * If *true*, uncompressed tiles are read as zero-copy views into
+ * memory-mapped files, where the filesystem backend supports it.
+ */
+extern const bool tile_io_mmap;
+
+/** The submission queue size of the io_uring asynchronous I/O engine. */
+extern const unsigned vfs_io_queue_depth;
+
+/**
+ * The number of threads of the asynchronous I/O engine used where io_uring
+ * is not available.
+ */
+extern const unsigned vfs_io_thread_num;
+
+/**
+ * If *true*, the tiles a read query needs in each round are fetched ahead
+ * with asynchronous I/O.
+ */
+extern const bool tile_prefetch;
+
+/**
+ * Tiles fetched ahead that lie at most this many bytes apart in a file are
+ * read with a single I/O request.
+ */
+extern const uint64_t tile_io_coalesce_gap;
+
+/** The maximum size of a single coalesced tile read. */
+extern const uint64_t tile_io_coalesce_max_size;
+
+/** The region of S3 requests. */
+extern const char* const s3_region;
+
+/**
+ * The endpoint ("host[:port]") of an S3-compatible object store, addressed
+ * path-style. If empty, requests go to AWS, addressed virtual-host-style.
+ */
+extern const char* const s3_endpoint_override;
+
+/** The scheme of S3 requests ("http" or "https"). */
+extern const char* const s3_scheme;
+
+/** The part size of S3 multipart uploads (at least 5 MB, per S3). */
+extern const uint64_t s3_multipart_part_size;
+
+/** The maximum number of concurrent requests of a single S3 operation. */
+extern const unsigned s3_max_parallel_ops;
+
+/**
+ * The local directory where blocks of remote (HDFS, S3) fragment files are
+ * cached. Remote reads are not cached if empty.
+ */
+extern const char* const vfs_disk_cache_dir;
+
+/** The maximum total size of the local disk cache. */
+extern const uint64_t vfs_disk_cache_size;
+
+/** The size of the blocks remote files are cached in. */
+extern const uint64_t vfs_disk_cache_block_size;
+
+/**
+ * For how long (in milliseconds) a remote directory found not to be a
+ * complete fragment is not checked again.
+ */
+extern const uint64_t vfs_disk_cache_mutable_ttl;
+
+/**
+ * The maximum number of threads checking concurrently which array
+ * subdirectories are fragments.
+ */
+extern const unsigned fragment_discovery_threads;
+
+/**
+ * The maximum (approximate) memory the metadata of arrays no query has open
+ * may occupy. Closed arrays are kept resident up to this budget, so that
+ * reopening them skips reloading their array and fragment metadata (0
+ * disables retention).
+ */
+extern const uint64_t open_array_cache_size;
+
 /** The maximum name length. */
 extern const unsigned name_max_len;
 
@@ -192,6 +300,24 @@ extern const char* bzip2_str;
 /** String describing DOUBLE_DELTA. */
 extern const char* double_delta_str;
 
+/** String describing GORILLA. */
+extern const char* gorilla_str;
+
+/** String describing BYTESHUFFLE. */
+extern const char* byteshuffle_str;
+
+/** String describing BITSHUFFLE. */
+extern const char* bitshuffle_str;
+
+/** String describing DELTA. */
+extern const char* delta_str;
+
+/** String describing BIT_WIDTH_REDUCTION. */
+extern const char* bit_width_reduction_str;
+
+/** The number of values that share a bit width in bit width reduction. */
+extern const uint64_t bit_width_reduction_window;
+
 /** The string representation for type int32. */
 extern const char* int32_str;
 
@@ -249,9 +375,54 @@ extern const char* null_str;
 /** The version in format { major, minor, revision }. */
 extern const int version[3];
 
-/** The size of a tile chunk. */
+/**
+ * The maximum size of the chunks tiles are split into for compression.
+ * Chunks are compressed in parallel.
+ */
 extern const uint64_t tile_chunk_size;
 
+/**
+ * The maximum number of threads compressing or decompressing the chunks of a
+ * tile.
+ */
+extern const unsigned tile_chunk_threads;
+
+/** Tiles smaller than this are (de)compressed on the calling thread. */
+extern const uint64_t tile_chunk_parallel_min_size;
+
+/** The maximum number of scratch buffers kept by the buffer pool. */
+extern const uint64_t buffer_pool_max_num;
+
+/** Scratch buffers larger than this are freed instead of pooled. */
+extern const uint64_t buffer_pool_max_size;
+
+/**
+ * The maximum total size of the decompressed tiles cached across queries
+ * (0 disables the cache).
+ */
+extern const uint64_t tile_cache_size;
+
+/** The number of independently locked shards of the tile cache. */
+extern const unsigned tile_cache_shard_num;
+
+/**
+ * If *true*, compressors use the SIMD instructions the CPU supports (checked
+ * at runtime).
+ */
+extern const bool compressor_simd;
+
+/**
+ * The prefix of the files in the array directory that store the trained ZSTD
+ * dictionaries, followed by the attribute name and the file suffix.
+ */
+extern const char* zstd_dictionary_prefix;
+
+/** The maximum size of a trained ZSTD dictionary. */
+extern const uint64_t zstd_dictionary_size;
+
+/** The maximum total size of the tile samples a ZSTD dictionary learns from. */
+extern const uint64_t zstd_dictionary_sample_size;
+
 }  // namespace constants
 
 }  // namespace tiledb
@@ -98,7 +98,9 @@ enum class StatusCode : char {
   ConstBuffer,
   Dimension,
   Domain,
-  Consolidation
+  Consolidation,
+  S3,
+  Filter
 };
 
 class Status {
@@ -250,6 +252,16 @@ class Status {
     return Status(StatusCode::Consolidation, msg, -1);
   }
 
+  /** Return a S3Error error class Status with a given message **/
+  static Status S3Error(const std::string& msg) {
+    return Status(StatusCode::S3, msg, -1);
+  }
+
+  /** Return a FilterError error class Status with a given message **/
+  static Status FilterError(const std::string& msg) {
+    return Status(StatusCode::Filter, msg, -1);
+  }
+
   /** Returns true iff the status indicates success **/
   bool ok() const {
     return (state_ == nullptr);
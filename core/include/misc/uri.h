@@ -100,6 +100,21 @@ class URI {
    */
   bool is_hdfs() const;
 
+  /**
+   * Checks if the input path is in the in-memory filesystem.
+   *
+   * @param path The path to be checked.
+   * @return The result of the check.
+   */
+  static bool is_mem(const std::string& path);
+
+  /**
+   * Checks if the URI is in the in-memory filesystem.
+   *
+   * @return The result of the check.
+   */
+  bool is_mem() const;
+
   /**
    * Checks if the input path is S3.
    *
@@ -41,6 +41,7 @@
 #include "status.h"
 #include "uri.h"
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -243,6 +244,19 @@ bool is_positive_integer(const char* s);
 template <class T>
 bool is_unary_subarray(const T* subarray, unsigned int dim_num);
 
+/**
+ * Runs operations concurrently.
+ *
+ * @param n The number of operations.
+ * @param max_threads The maximum number of threads to run them on.
+ * @param op The operation, invoked with the indexes 0 to *n* - 1.
+ * @return The status of a failed operation, or Ok.
+ */
+Status parallel_for(
+    uint64_t n,
+    uint64_t max_threads,
+    const std::function<Status(uint64_t)>& op);
+
 /**
  * Checks if a string starts with a certain prefix.
  *
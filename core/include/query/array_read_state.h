@@ -474,6 +474,18 @@ class ArrayReadState {
   template <class T>
   void init_subarray_tile_coords();
 
+  /**
+   * Fetches the tiles of the query attributes that a read round needs with
+   * asynchronous I/O, so that they are read concurrently rather than one at
+   * a time while copying cells.
+   *
+   * @param fragment_cell_pos_ranges The fragment cell position ranges of
+   *     the read round.
+   * @return Status
+   */
+  Status prefetch_tiles(
+      const FragmentCellPosRanges* fragment_cell_pos_ranges);
+
   /**
    * Performs a read operation in a **dense** array.
    *
@@ -0,0 +1,141 @@
+/**
+ * @file   config.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class Config.
+ */
+
+#ifndef TILEDB_CONFIG_H
+#define TILEDB_CONFIG_H
+
+#include <cinttypes>
+#include <string>
+
+namespace tiledb {
+
+/**
+ * The runtime parameters of a storage manager and of the objects it
+ * creates. The parameters are passed at construction and do not change
+ * afterwards. They default to the values in `constants`, whose documentation
+ * describes each of them.
+ */
+class Config {
+ public:
+  /* ********************************* */
+  /*          TYPE DEFINITIONS         */
+  /* ********************************* */
+
+  /** The parameters of the S3 backend. */
+  struct S3Params {
+    /** Constructor. */
+    S3Params();
+
+    /** See `constants::s3_endpoint_override`. */
+    std::string endpoint_override_;
+    /** See `constants::s3_max_parallel_ops`. */
+    unsigned max_parallel_ops_;
+    /** See `constants::s3_multipart_part_size`. */
+    uint64_t multipart_part_size_;
+    /** See `constants::s3_region`. */
+    std::string region_;
+    /** See `constants::s3_scheme`. */
+    std::string scheme_;
+  };
+
+  /** The parameters of the storage manager and its tile I/O. */
+  struct SMParams {
+    /** Constructor. */
+    SMParams();
+
+    /** See `constants::buffer_pool_max_num`. */
+    uint64_t buffer_pool_max_num_;
+    /** See `constants::buffer_pool_max_size`. */
+    uint64_t buffer_pool_max_size_;
+    /** See `constants::fragment_discovery_threads`. */
+    unsigned fragment_discovery_threads_;
+    /** See `constants::open_array_cache_size`. */
+    uint64_t open_array_cache_size_;
+    /** See `constants::tile_cache_shard_num`. */
+    unsigned tile_cache_shard_num_;
+    /** See `constants::tile_cache_size`. */
+    uint64_t tile_cache_size_;
+    /** See `constants::tile_chunk_parallel_min_size`. */
+    uint64_t tile_chunk_parallel_min_size_;
+    /** See `constants::tile_chunk_threads`. */
+    unsigned tile_chunk_threads_;
+    /** See `constants::tile_io_coalesce_gap`. */
+    uint64_t tile_io_coalesce_gap_;
+    /** See `constants::tile_io_coalesce_max_size`. */
+    uint64_t tile_io_coalesce_max_size_;
+    /** See `constants::tile_io_mmap`. */
+    bool tile_io_mmap_;
+    /** See `constants::tile_prefetch`. */
+    bool tile_prefetch_;
+    /** See `constants::zstd_dictionary_sample_size`. */
+    uint64_t zstd_dictionary_sample_size_;
+    /** See `constants::zstd_dictionary_size`. */
+    uint64_t zstd_dictionary_size_;
+  };
+
+  /** The parameters of the VFS. */
+  struct VFSParams {
+    /** Constructor. */
+    VFSParams();
+
+    /** See `constants::vfs_disk_cache_block_size`. */
+    uint64_t disk_cache_block_size_;
+    /** See `constants::vfs_disk_cache_dir`. */
+    std::string disk_cache_dir_;
+    /** See `constants::vfs_disk_cache_mutable_ttl`. */
+    uint64_t disk_cache_mutable_ttl_;
+    /** See `constants::vfs_disk_cache_size`. */
+    uint64_t disk_cache_size_;
+    /** See `constants::vfs_io_queue_depth`. */
+    unsigned io_queue_depth_;
+    /** See `constants::vfs_io_thread_num`. */
+    unsigned io_thread_num_;
+    /** The parameters of the S3 backend. */
+    S3Params s3_params_;
+    /** See `constants::vfs_write_buffer_size`. */
+    uint64_t write_buffer_size_;
+  };
+
+  /* ********************************* */
+  /*         PUBLIC ATTRIBUTES         */
+  /* ********************************* */
+
+  /** The storage manager parameters. */
+  SMParams sm_params_;
+
+  /** The VFS parameters. */
+  VFSParams vfs_params_;
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_CONFIG_H
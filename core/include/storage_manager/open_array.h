@@ -36,11 +36,13 @@
 
 #include <map>
 #include <mutex>
+#include <set>
 #include <vector>
 
 #include "array_metadata.h"
 #include "fragment_metadata.h"
 #include "uri.h"
+#include "zstd_dictionary.h"
 
 namespace tiledb {
 
@@ -73,8 +75,20 @@ class OpenArray {
   /** Returns the open array query counter. */
   uint64_t cnt() const;
 
-  /** Adds a new entry to the fragment metadata map. */
-  void fragment_metadata_add(FragmentMetadata* metadata);
+  /**
+   * Returns the generation of the consolidated fragment metadata loaded
+   * (0 if none).
+   */
+  uint64_t consolidated_generation() const;
+
+  /**
+   * Adds a new entry to the fragment metadata map.
+   *
+   * @param metadata The fragment metadata.
+   * @param in_use True if the metadata are used by the query that loaded
+   *     them, and false if they are only kept for future queries.
+   */
+  void fragment_metadata_add(FragmentMetadata* metadata, bool in_use = true);
 
   /**
    * Returns the stored metadata for a particular fragment uri (nullptr if not
@@ -83,24 +97,68 @@ class OpenArray {
    */
   FragmentMetadata* fragment_metadata_get(const URI& fragment_uri);
 
+  /** Checks if the metadata of the input fragment are loaded. */
+  bool fragment_metadata_loaded(const URI& fragment_uri) const;
+
+  /**
+   * Frees the metadata (and non-empty domains) of the fragments that were
+   * not listed when the array was last opened and are not used by any query,
+   * i.e., of fragments deleted since they were loaded.
+   */
+  void fragment_metadata_prune();
+
   /**
-   * Removes the metadata of the input fragment from the fragment metadata
-   * map.
+   * Releases the metadata of the input fragment, i.e., decrements the
+   * number of queries using it. The metadata stay loaded for future queries.
    */
   void fragment_metadata_rm(const URI& fragment_uri);
 
+  /** Returns the fragment URIs discovered when the array was last opened. */
+  const std::set<std::string>& fragment_uris() const;
+
   /** Increments the counter indicating the times this array has been opened. */
   void incr_cnt();
 
+  /** Returns the (approximate) main memory the loaded metadata occupy. */
+  uint64_t memory_size() const;
+
   /** Locks the array mutex. */
   void mtx_lock();
 
   /** Unlocks the array mutex. */
   void mtx_unlock();
 
+  /**
+   * Returns the known non-empty domain of the input fragment (nullptr if
+   * not known).
+   */
+  const void* non_empty_domain(const std::string& fragment_uri) const;
+
+  /** Stores the non-empty domain of the input fragment. */
+  void non_empty_domain_add(
+      const std::string& fragment_uri, const std::vector<uint8_t>& domain);
+
   /** Sets an array metadata. */
   void set_array_metadata(const ArrayMetadata* array_metadata);
 
+  /** Sets the generation of the consolidated fragment metadata loaded. */
+  void set_consolidated_generation(uint64_t generation);
+
+  /** Sets the fragment URIs discovered when opening the array. */
+  void set_fragment_uris(const std::vector<URI>& fragment_uris);
+
+  /**
+   * Returns the loaded ZSTD dictionary of the input attribute (nullptr if
+   * not loaded).
+   */
+  const ZStdDictionary* zstd_dictionary(const std::string& attribute) const;
+
+  /**
+   * Adds the ZSTD dictionary of the input attribute, which the open array
+   * takes ownership of.
+   */
+  void zstd_dictionary_add(const std::string& attribute, ZStdDictionary* dict);
+
  private:
   /* ********************************* */
   /*         PRIVATE ATTRIBUTES        */
@@ -112,6 +170,12 @@ class OpenArray {
   /** Counts the number of queries that opened the array. */
   uint64_t cnt_;
 
+  /**
+   * The generation of the consolidated fragment metadata loaded (0 if
+   * none).
+   */
+  uint64_t consolidated_generation_;
+
   /**
    * Enables searching for loaded fragment metadata by fragment name.
    * Format: <fragment_name> --> (fragment_metadata, # queries using it)
@@ -119,6 +183,25 @@ class OpenArray {
   std::map<std::string, std::pair<FragmentMetadata*, uint64_t>>
       fragment_metadata_;
 
+  /**
+   * The fragment URIs discovered when the array was last opened. Fragments
+   * are immutable, so these need not be checked again while they are listed
+   * in the array directory.
+   */
+  std::set<std::string> fragment_uris_;
+
+  /**
+   * The non-empty domains of the fragments, by fragment URI, used to prune
+   * fragments without loading their metadata.
+   */
+  std::map<std::string, std::vector<uint8_t>> non_empty_domains_;
+
+  /**
+   * The loaded ZSTD dictionaries, by attribute name. A dictionary is never
+   * replaced once stored, so it is kept as long as the entry.
+   */
+  std::map<std::string, ZStdDictionary*> zstd_dictionaries_;
+
   /**
    * A mutex used to lock the array when loading the array metadata and
    * any fragment metadata structures from the disk.
@@ -35,6 +35,7 @@
 #define TILEDB_STORAGE_MANAGER_H
 
 #include <condition_variable>
+#include <list>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -42,12 +43,15 @@
 #include <thread>
 
 #include "array_metadata.h"
+#include "buffer_pool.h"
+#include "config.h"
 #include "consolidator.h"
 #include "locked_array.h"
 #include "object_type.h"
 #include "open_array.h"
 #include "query.h"
 #include "status.h"
+#include "tile_cache.h"
 #include "uri.h"
 #include "vfs.h"
 
@@ -60,8 +64,13 @@ class StorageManager {
   /*     CONSTRUCTORS & DESTRUCTORS    */
   /* ********************************* */
 
-  /** Constructor. */
-  StorageManager();
+  /**
+   * Constructor.
+   *
+   * @param config The runtime parameters of the storage manager and of the
+   *     objects it creates.
+   */
+  explicit StorageManager(const Config& config = Config());
 
   /** Destructor. */
   ~StorageManager();
@@ -78,6 +87,16 @@ class StorageManager {
    */
   Status array_consolidate(const char* array_name);
 
+  /**
+   * Packs the metadata of all the fragments of an array into a single
+   * consolidated fragment metadata file, so that opening the array reads
+   * them with a single I/O.
+   *
+   * @param array_name The name of the array.
+   * @return Status
+   */
+  Status array_consolidate_metadata(const char* array_name);
+
   /**
    * Creates a TileDB array storing its metadata.
    *
@@ -115,6 +134,21 @@ class StorageManager {
    */
   Status async_push_query(Query* query, int i);
 
+  /** Returns the pool of scratch buffers used by tile (de)compression. */
+  BufferPool* buffer_pool() const;
+
+  /** Closes a file, releasing any descriptors kept open for it. */
+  Status close_file(const URI& uri) const;
+
+  /** Returns the number of closed arrays whose entries are retained. */
+  uint64_t closed_array_num();
+
+  /** Returns the total memory size of the retained closed array entries. */
+  uint64_t closed_array_size();
+
+  /** Returns the runtime parameters. */
+  const Config& config() const;
+
   /** Creates a directory with the input URI. */
   Status create_dir(const URI& uri);
 
@@ -125,10 +159,10 @@ class StorageManager {
   Status delete_fragment(const URI& uri) const;
 
   /** Safely removes a TileDB resource. */
-  Status remove_path(const URI& uri) const;
+  Status remove_path(const URI& uri);
 
   /** Safely moves a TileDB resource. */
-  Status move(const URI& old_uri, const URI& new_uri, bool force = false) const;
+  Status move(const URI& old_uri, const URI& new_uri, bool force = false);
 
   /** Retrieves the size of the input URI file. */
   Status file_size(const URI& uri, uint64_t* size) const;
@@ -178,6 +212,26 @@ class StorageManager {
    */
   Status load(FragmentMetadata* metadata);
 
+  /**
+   * Loads a single section of the fragment metadata of an array from
+   * persistent storage into memory.
+   *
+   * @param metadata The fragment metadata the section belongs to.
+   * @param section The section id.
+   * @return Status
+   */
+  Status load(FragmentMetadata* metadata, uint64_t section);
+
+  /**
+   * Maps an entire file into memory.
+   *
+   * @param uri The file to map.
+   * @param data The address of the mapping to be retrieved.
+   * @param size The size of the mapping to be retrieved.
+   * @return Status
+   */
+  Status map_file(const URI& uri, void** data, uint64_t* size) const;
+
   /**
    * TODO: DOC
    * @param old_uri
@@ -234,6 +288,25 @@ class StorageManager {
   Status query_submit_async(
       Query* query, void* (*callback)(void*), void* callback_data);
 
+  /**
+   * Submits an asynchronous read from a file into the input buffer. The
+   * buffer must remain valid until `wait_reads` returns for the batch.
+   *
+   * @param uri The URI file to read from.
+   * @param offset The offset in the file the read will start from.
+   * @param buffer The buffer to read into. The function reallocates memory
+   *     for the buffer, sets its size to *nbytes* and resets its offset.
+   * @param nbytes The number of bytes to read.
+   * @param batch The batch the read is added to.
+   * @return Status.
+   */
+  Status read_async(
+      const URI& uri,
+      uint64_t offset,
+      Buffer* buffer,
+      uint64_t nbytes,
+      IOBatch* batch) const;
+
   /**
    * Reads from a file into the input buffer.
    *
@@ -263,12 +336,48 @@ class StorageManager {
    */
   Status store(FragmentMetadata* metadata);
 
+  /**
+   * Stores the consolidated fragment metadata of an array, i.e., the index
+   * of the metadata of every fragment written in sections, in a new file
+   * whose name carries the next generation number. The files of older
+   * generations are then removed. The caller must hold an exclusive lock
+   * on the array.
+   *
+   * @param array_uri The array URI.
+   * @return Status
+   */
+  Status store_consolidated_fragment_metadata(const URI& array_uri);
+
+  /**
+   * Stores a trained ZSTD dictionary of an attribute in the array directory,
+   * unless one is stored already, possibly by another process meanwhile
+   * (dictionaries are never replaced, as tiles compressed with them may
+   * exist). The stored dictionary is then loaded into the open array. The
+   * array must be open.
+   *
+   * @param array_uri The array URI.
+   * @param attr The attribute the dictionary is trained for.
+   * @param dict The dictionary.
+   * @return Status
+   */
+  Status store_zstd_dictionary(
+      const URI& array_uri, const Attribute* attr, Buffer* dict);
+
   /**
    * Syncs a URI (file or directory), i.e., commits its contents
    * to persistent storage.
    */
   Status sync(const URI& uri);
 
+  /** Returns the cache of decompressed tiles shared by all queries. */
+  TileCache* tile_cache() const;
+
+  /** Unmaps a file mapped with `map_file`. */
+  Status unmap_file(const URI& uri, void* data, uint64_t size) const;
+
+  /** Waits for the reads of a batch submitted with `read_async`. */
+  Status wait_reads(IOBatch* batch) const;
+
   /**
    * Writes the contents of a buffer into a URI file.
    *
@@ -285,6 +394,17 @@ class StorageManager {
    */
   ObjectType object_type(const URI& uri) const;
 
+  /**
+   * Returns the ZSTD dictionary of an attribute of an open array (nullptr
+   * if no dictionary has been stored yet).
+   *
+   * @param array_uri The array URI.
+   * @param attribute The attribute name.
+   * @return The dictionary.
+   */
+  const ZStdDictionary* zstd_dictionary(
+      const URI& array_uri, const std::string& attribute);
+
  private:
   /* ********************************* */
   /*        PRIVATE ATTRIBUTES         */
@@ -317,6 +437,22 @@ class StorageManager {
    */
   std::thread* async_thread_[2];
 
+  /** Pool of scratch buffers shared by all tile (de)compressions. */
+  BufferPool* buffer_pool_;
+
+  /**
+   * The URIs of the arrays no query has open, whose entries are retained in
+   * *open_arrays_*, least recently closed first, along with the memory
+   * size of each entry at the time the array was closed.
+   */
+  std::list<std::pair<std::string, uint64_t>> closed_arrays_;
+
+  /** The total memory size of the entries in *closed_arrays_*. */
+  uint64_t closed_arrays_size_;
+
+  /** The runtime parameters. */
+  const Config config_;
+
   /** Object that handles array consolidation. */
   Consolidator* consolidator_;
 
@@ -341,6 +477,9 @@ class StorageManager {
    */
   std::map<std::string, OpenArray*> open_arrays_;
 
+  /** Cache of decompressed tiles, shared by all queries. */
+  TileCache* tile_cache_;
+
   /**
    * Virtual filesystem handler. It directs queries to the appropriate
    * filesystem backend. Note that this is stateful.
@@ -406,15 +545,86 @@ class StorageManager {
   void async_process_queries(int i);
 
   /**
-   * Retrieves the fragment URI's of an array that overlap with a give
-   * subarray.
+   * Retrieves the fragment URI's of an open array that overlap with a give
+   * subarray. The array directory is listed with the entry types, and the
+   * metadata of the fragments in the latest consolidated fragment metadata
+   * file are loaded from it. The subdirectories not already known to the
+   * open array as fragments are checked for fragment metadata concurrently.
+   * The discovered fragments are cached in the open array.
    */
   // TODO: Currently, no overlap check is performed with the subarray
   // TODO: and all fragments are retrieved. To be fixed soon.
   Status get_fragment_uris(
-      const URI& array_uri,
+      OpenArray* open_array,
       const void* subarray,
-      std::vector<URI>* fragment_uris) const;
+      std::vector<URI>* fragment_uris);
+
+  /**
+   * Checks if the input URI is a consolidated fragment metadata file.
+   *
+   * @param uri The URI to check.
+   * @param generation Set to the generation number of the file.
+   * @return True if the URI is a consolidated fragment metadata file.
+   */
+  bool is_consolidated_fragment_metadata(
+      const URI& uri, uint64_t* generation) const;
+
+  /**
+   * Loads the metadata of the fragments packed in a consolidated fragment
+   * metadata file into an open array, with a single read. The file is
+   * skipped if the open array has already loaded this generation. Only the
+   * listed fragments whose metadata are not loaded yet are added.
+   *
+   * @param open_array The open array.
+   * @param uri The consolidated fragment metadata file URI.
+   * @param generation The generation number of the file.
+   * @param fragment_uris The fragments currently in the array directory.
+   * @return Status
+   */
+  Status load_consolidated_fragment_metadata(
+      OpenArray* open_array,
+      const URI& uri,
+      uint64_t generation,
+      const std::vector<URI>& fragment_uris);
+
+  /**
+   * Reads the non-empty domain of a fragment from its domain file. The
+   * domain is left empty if the fragment has no (valid) domain file.
+   *
+   * @param open_array The open array the fragment belongs to.
+   * @param fragment_uri The fragment URI.
+   * @param domain The domain to read into.
+   * @return Status
+   */
+  Status load_non_empty_domain(
+      OpenArray* open_array,
+      const URI& fragment_uri,
+      std::vector<uint8_t>* domain) const;
+
+  /**
+   * Frees the least recently closed array entries, until the closed arrays
+   * fit in the open array cache size of the config. Must be called with
+   * *open_array_mtx_* locked.
+   */
+  void open_array_cache_evict();
+
+  /**
+   * Frees the retained entries of the closed arrays under the input URI,
+   * e.g., before the arrays are removed or moved.
+   */
+  void open_array_cache_rm(const URI& uri);
+
+  /**
+   * Reads the index at the start of the fragment metadata file of a
+   * fragment. The buffer is left empty if the fragment metadata are stored
+   * in the older single generic tile format.
+   *
+   * @param fragment_uri The fragment URI.
+   * @param buff The buffer to read into.
+   * @return Status
+   */
+  Status read_fragment_metadata_index(
+      const URI& fragment_uri, Buffer* buff) const;
 
   /** Retrieves an open array entry for the given array URI. */
   Status open_array_get_entry(const URI& array_uri, OpenArray** open_array);
@@ -428,11 +638,28 @@ class StorageManager {
       const void* subarray,
       std::vector<FragmentMetadata*>* fragment_metadata);
 
+  /**
+   * Loads the ZSTD dictionary of an attribute into an open array, if it is
+   * stored and not loaded already.
+   */
+  Status open_array_load_zstd_dictionary(
+      OpenArray* open_array, const Attribute* attr);
+
+  /**
+   * Loads the stored ZSTD dictionaries of the attributes that use them into
+   * an open array.
+   */
+  Status open_array_load_zstd_dictionaries(OpenArray* open_array);
+
   /**
    * Sorts the input fragment URIs in ascending timestamp order, breaking
    * ties using the process id.
    */
   void sort_fragment_uris(std::vector<URI>* fragment_uris) const;
+
+  /** Returns the URI of the file storing the ZSTD dictionary of an attribute. */
+  URI zstd_dictionary_uri(
+      const URI& array_uri, const std::string& attribute) const;
 };
 
 }  // namespace tiledb
@@ -0,0 +1,79 @@
+/**
+ * @file   dictionary_encoding.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class DictionaryEncoding.
+ */
+
+#ifndef TILEDB_DICTIONARY_ENCODING_H
+#define TILEDB_DICTIONARY_ENCODING_H
+
+#include "buffer.h"
+#include "status.h"
+#include "tile.h"
+
+namespace tiledb {
+
+/**
+ * Dictionary-encodes the values of a variable-sized tile: its distinct cell
+ * values are stored once, followed by a fixed-width code per cell (1, 2 or
+ * 4 bytes, depending on the dictionary size). Tiles that would not shrink
+ * are stored as they are, so decoding always restores the original values.
+ */
+class DictionaryEncoding {
+ public:
+  /* ****************************** */
+  /*               API              */
+  /* ****************************** */
+
+  /**
+   * Encodes a tile of variable-sized values.
+   *
+   * @param offsets The tile with the offsets of the cells. The offsets may
+   *     be shifted by a constant (only their differences are used).
+   * @param values The tile with the values of the cells.
+   * @param encoded The buffer the encoded tile is written to.
+   * @return Status
+   */
+  static Status encode(
+      const Tile* offsets, const Tile* values, Buffer* encoded);
+
+  /**
+   * Decodes a tile of variable-sized values.
+   *
+   * @param data The encoded tile.
+   * @param nbytes The size of the encoded tile.
+   * @param values The buffer the values are written to.
+   * @return Status
+   */
+  static Status decode(const void* data, uint64_t nbytes, Buffer* values);
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_DICTIONARY_ENCODING_H
@@ -36,12 +36,15 @@
 #include "attribute.h"
 #include "buffer.h"
 #include "const_buffer.h"
+#include "filter_pipeline.h"
 #include "status.h"
 
 #include <cinttypes>
 
 namespace tiledb {
 
+class ZStdDictionary;
+
 /**
  * Handles tile information. A tile can be in main memory if it has been
  * fetched from the disk or has been mmap-ed from a file. However, a tile
@@ -152,6 +155,15 @@ class Tile {
   /** Returns the number of dimensions (0 if this is an attribute tile). */
   unsigned int dim_num() const;
 
+  /**
+   * Returns *true* if the tile is compressed or filtered, i.e., it is not
+   * stored as is.
+   */
+  bool filtered() const;
+
+  /** Returns the filters applied to the tile before compression. */
+  const FilterPipeline& filters() const;
+
   /** Checks if the tile is empty. */
   bool empty() const;
 
@@ -161,7 +173,10 @@ class Tile {
   /** The current offset in the tile. */
   uint64_t offset() const;
 
-  /** Reallocates nbytes for the internal tile buffer. */
+  /**
+   * Reallocates nbytes for the internal tile buffer. If the tile is a view,
+   * it gets a fresh buffer of its own.
+   */
   Status realloc(uint64_t nbytes);
 
   /** Reads from the tile into the input buffer *nbytes*. */
@@ -173,12 +188,32 @@ class Tile {
   /** Resets the tile size. */
   void reset_size();
 
+  /** Sets the filters applied to the tile before compression. */
+  void set_filters(const FilterPipeline& filters);
+
   /** Sets the tile offset. */
   void set_offset(uint64_t offset);
 
+
   /** Sets the internal buffer size. */
   void set_size(uint64_t size);
 
+  /**
+   * Makes the tile a read-only view of external data (e.g., a region of a
+   * memory-mapped file), releasing its current buffer. The data must
+   * outlive the view.
+   *
+   * @param data The data to view.
+   * @param size The data size.
+   */
+  void set_view(void* data, uint64_t size);
+
+  /**
+   * Sets the dictionary ZSTD compresses the tile with (*nullptr* for none).
+   * The dictionary is not owned by the tile.
+   */
+  void set_zstd_dictionary(const ZStdDictionary* zstd_dictionary);
+
   /** Returns the tile size. */
   uint64_t size() const;
 
@@ -194,6 +229,9 @@ class Tile {
   /** Returns the tile data type. */
   Datatype type() const;
 
+  /** Returns the dictionary ZSTD compresses the tile with, if any. */
+  const ZStdDictionary* zstd_dictionary() const;
+
   /** Returns the value of type T in the tile at the input offset. */
   template <class T>
   inline T value(uint64_t offset) const {
@@ -252,6 +290,9 @@ class Tile {
    */
   unsigned int dim_num_;
 
+  /** The filters applied to the tile before compression. */
+  FilterPipeline filters_;
+
   /**
    * If *true* the tile object will delete *buff* upon
    * destruction, otherwise it will not delete it.
@@ -261,6 +302,9 @@ class Tile {
   /** The tile data type. */
   Datatype type_;
 
+  /** The dictionary ZSTD compresses the tile with (*nullptr* for none). */
+  const ZStdDictionary* zstd_dictionary_;
+
   /* ********************************* */
   /*          PRIVATE METHODS          */
   /* ********************************* */
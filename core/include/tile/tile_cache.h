@@ -0,0 +1,194 @@
+/**
+ * @file   tile_cache.h
+ * @file   buffer.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file defines class TileCache.
+ */
+
+#ifndef TILEDB_TILE_CACHE_H
+#define TILEDB_TILE_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tile.h"
+#include "uri.h"
+
+namespace tiledb {
+
+/**
+ * A decompressed tile held by the tile cache. For variable-sized attributes
+ * it holds both the (shifted) offsets and the values.
+ */
+struct CachedTile {
+  /** The tile data (the offsets for variable-sized attributes). */
+  void* data_;
+  /** The size of *data_*. */
+  uint64_t size_;
+  /** The values of a variable-sized attribute tile (nullptr otherwise). */
+  void* var_data_;
+  /** The size of *var_data_*. */
+  uint64_t var_size_;
+  /** The cache key. */
+  std::string key_;
+  /** The number of readers currently holding the tile. */
+  uint64_t pins_;
+  /** *true* if the tile was evicted while pinned. */
+  bool evicted_;
+};
+
+/**
+ * A sharded LRU cache of decompressed tiles, shared by all the queries of a
+ * storage manager. Tiles are keyed by (fragment URI, attribute id, tile
+ * index) and handed out pinned: a pinned tile stays valid (even if evicted)
+ * until it is released.
+ */
+class TileCache {
+ public:
+  /* ********************************* */
+  /*     CONSTRUCTORS & DESTRUCTORS    */
+  /* ********************************* */
+
+  /**
+   * Constructor.
+   *
+   * @param max_size The maximum total size of the cached tiles, split evenly
+   *     across the shards.
+   * @param shard_num The number of independently locked shards.
+   */
+  TileCache(uint64_t max_size, unsigned shard_num);
+
+  /** Destructor. */
+  ~TileCache();
+
+  /* ********************************* */
+  /*                API                */
+  /* ********************************* */
+
+  /** Returns *true* if the input tile is cached. */
+  bool contains(
+      const URI& fragment_uri, unsigned int attribute_id, uint64_t tile_i);
+
+  /**
+   * Evicts all the tiles of the fragments under the input URI, i.e., of the
+   * fragment itself or of the fragments in the directory it points to.
+   */
+  void evict(const URI& uri);
+
+  /**
+   * Returns the pinned cached tile (nullptr if it is not cached). The tile
+   * must be handed back with *release*.
+   *
+   * @param fragment_uri The fragment URI.
+   * @param attribute_id The attribute id (the attribute number for the
+   *     coordinates).
+   * @param tile_i The tile index.
+   * @return The pinned tile, or nullptr.
+   */
+  const CachedTile* get(
+      const URI& fragment_uri, unsigned int attribute_id, uint64_t tile_i);
+
+  /**
+   * Caches a copy of a decompressed tile, evicting the least recently used
+   * tiles as needed. Tiles that are already cached, or that do not fit in a
+   * shard, are ignored.
+   *
+   * @param fragment_uri The fragment URI.
+   * @param attribute_id The attribute id.
+   * @param tile_i The tile index.
+   * @param tile The tile (the offsets for variable-sized attributes).
+   * @param tile_var The values tile of a variable-sized attribute.
+   */
+  void insert(
+      const URI& fragment_uri,
+      unsigned int attribute_id,
+      uint64_t tile_i,
+      const Tile* tile,
+      const Tile* tile_var = nullptr);
+
+  /** Unpins a tile returned by *get*. */
+  void release(const CachedTile* tile);
+
+  /** Returns the total size of the (non-evicted) cached tiles. */
+  uint64_t size();
+
+ private:
+  /* ********************************* */
+  /*      PRIVATE TYPE DEFINITIONS     */
+  /* ********************************* */
+
+  /** An independently locked part of the cache. */
+  struct Shard {
+    /** Protects the shard. */
+    std::mutex mtx_;
+    /** The tiles, most recently used first. */
+    std::list<CachedTile*> lru_;
+    /** Maps a key to its tile in *lru_*. */
+    std::unordered_map<std::string, std::list<CachedTile*>::iterator> index_;
+    /** The total size of the tiles in the shard. */
+    uint64_t size_;
+  };
+
+  /* ********************************* */
+  /*         PRIVATE ATTRIBUTES        */
+  /* ********************************* */
+
+  /** The maximum total size of the tiles of a shard. */
+  uint64_t shard_max_size_;
+
+  /** The shards. */
+  std::vector<Shard*> shards_;
+
+  /* ********************************* */
+  /*          PRIVATE METHODS          */
+  /* ********************************* */
+
+  /** Deletes the tile, freeing its data. */
+  static void free_tile(CachedTile* tile);
+
+  /** Returns the cache key of a tile. */
+  static std::string key(
+      const URI& fragment_uri, unsigned int attribute_id, uint64_t tile_i);
+
+  /**
+   * Removes a tile from its shard, deleting it unless it is pinned. Must be
+   * called with the shard locked.
+   */
+  void remove(Shard* shard, std::list<CachedTile*>::iterator it);
+
+  /** Returns the shard of a key. */
+  Shard* shard(const std::string& key) const;
+};
+
+}  // namespace tiledb
+
+#endif  // TILEDB_TILE_CACHE_H
@@ -33,6 +33,10 @@
 #ifndef TILEDB_TILE_IO_H
 #define TILEDB_TILE_IO_H
 
+#include <map>
+#include <unordered_map>
+#include <vector>
+
 #include "storage_manager.h"
 #include "tile.h"
 #include "uri.h"
@@ -44,6 +48,20 @@ class StorageManager;
 /** Handles IO (reading/writing) for tiles. */
 class TileIO {
  public:
+  /* ********************************* */
+  /*          TYPE DEFINITIONS         */
+  /* ********************************* */
+
+  /** A single read covering one or more (sorted) file ranges. */
+  struct CoalescedRead {
+    /** The offset in the file where the read starts. */
+    uint64_t offset_;
+    /** The number of bytes to read. */
+    uint64_t nbytes_;
+    /** The number of ranges the read covers. */
+    uint64_t range_num_;
+  };
+
   /* ********************************* */
   /*     CONSTRUCTORS & DESTRUCTORS    */
   /* ********************************* */
@@ -66,11 +84,63 @@ class TileIO {
   /*                API                */
   /* ********************************* */
 
+  /**
+   * Closes the file, releasing any resources the storage layer keeps open
+   * for it. The TileIO object remains usable afterwards.
+   */
+  Status close();
+
+  /**
+   * Plans the reads of a set of file ranges, merging ranges that lie at
+   * most *max_gap* bytes apart, as long as a read does not exceed
+   * *max_size* bytes (a single larger range is read on its own). Each read
+   * covers the next `range_num_` ranges in order.
+   *
+   * @param ranges The ranges, as a map from file offset to size.
+   * @param max_gap The largest gap among ranges that is read through.
+   * @param max_size The maximum read size.
+   * @param reads The planned reads.
+   */
+  static void coalesce(
+      const std::map<uint64_t, uint64_t>& ranges,
+      uint64_t max_gap,
+      uint64_t max_size,
+      std::vector<CoalescedRead>* reads);
+
+  /** Drops the tiles fetched ahead with `prefetch` and not read yet. */
+  void discard_prefetched();
+
+  /**
+   * Drops the tile at the input offset if it was fetched ahead with
+   * `prefetch`, e.g., because it was served from elsewhere.
+   *
+   * @param file_offset The offset of the tile in the file.
+   */
+  void discard_prefetched(uint64_t file_offset);
+
   /** Retrieves the size of the file. */
   Status file_size(uint64_t* size) const;
 
   /**
-   * Reads into a tile from the file.
+   * Queues the (compressed) tile at the input offset to be fetched ahead by
+   * the next `submit_prefetch`. A subsequent `read` at the same offset
+   * consumes the fetched data once the batch has been waited on. Tiles read
+   * as views into the mapped file are skipped.
+   *
+   * @param tile The tile to be read.
+   * @param file_offset The offset in the file to read from.
+   * @param compressed_size The size of the compressed tile.
+   * @return Status.
+   */
+  Status prefetch(Tile* tile, uint64_t file_offset, uint64_t compressed_size);
+
+  /** Returns the number of tiles queued or fetched ahead and not read yet. */
+  uint64_t prefetched_num() const;
+
+  /**
+   * Reads into a tile from the file. If the tile is uncompressed and the
+   * file can be memory-mapped, the tile becomes a view into the mapping,
+   * which stays valid for the lifetime of the TileIO object.
    *
    * @param tile The tile to read into.
    * @param file_offset The offset in the file to read from.
@@ -84,6 +154,25 @@ class TileIO {
       uint64_t compressed_size,
       uint64_t tile_size);
 
+  /**
+   * Reads into a caller's buffer from the file, bypassing the tile's own
+   * buffer: the tile is decompressed (or read) in place into the
+   * destination, and becomes a view of it.
+   *
+   * @param tile The tile to read into.
+   * @param file_offset The offset in the file to read from.
+   * @param compressed_size The size of the compressed tile.
+   * @param tile_size The size of the decompressed tile.
+   * @param buffer The destination, with room for *tile_size* bytes.
+   * @return Status.
+   */
+  Status read_into(
+      Tile* tile,
+      uint64_t file_offset,
+      uint64_t compressed_size,
+      uint64_t tile_size,
+      void* buffer);
+
   /**
    * Reads a generic tile from the file. This means that there are not tile
    * metadata kept anywhere except for the file. Therefore, the function
@@ -116,6 +205,33 @@ class TileIO {
       uint64_t* compressed_size,
       uint64_t* header_size);
 
+  /**
+   * Serializes a tile generically into a buffer, i.e., (potentially)
+   * compresses it and prepends the generic tile header, exactly as
+   * `write_generic` would write it to the file. This allows placing several
+   * generic tiles in a file at offsets known before writing.
+   *
+   * @param tile The tile to be serialized.
+   * @param buff The buffer the header and tile contents are appended to.
+   * @return Status
+   */
+  Status serialize_generic(Tile* tile, Buffer* buff);
+
+  /**
+   * Sets the maximum size of the chunks tiles are split into for
+   * compression (`constants::tile_chunk_size` by default).
+   */
+  void set_chunk_size(uint64_t chunk_size);
+
+  /**
+   * Submits asynchronous reads of the tiles queued with `prefetch`, after
+   * coalescing nearby tiles into larger reads.
+   *
+   * @param batch The batch the reads are added to.
+   * @return Status
+   */
+  Status submit_prefetch(IOBatch* batch);
+
   /**
    * Writes (appends) a tile into the file.
    *
@@ -149,6 +265,40 @@ class TileIO {
   Status write_generic_tile_header(Tile* tile, uint64_t compressed_size);
 
  private:
+  /* ********************************* */
+  /*      PRIVATE TYPE DEFINITIONS     */
+  /* ********************************* */
+
+  /** The data of a (coalesced) read, shared by the tiles it covers. */
+  struct Chunk {
+    /** The data. */
+    Buffer* buffer_;
+    /** The offset in the file where the data start. */
+    uint64_t file_offset_;
+    /** The number of tiles not yet consumed. */
+    uint64_t refs_;
+  };
+
+  /** The location of a compressed chunk and of its decompressed data. */
+  struct CompressedChunk {
+    /** The offset of the compressed chunk in `buffer_`. */
+    uint64_t input_offset_;
+    /** The compressed chunk size. */
+    uint64_t compressed_size_;
+    /** The offset of the decompressed chunk in the tile. */
+    uint64_t output_offset_;
+    /** The decompressed chunk size. */
+    uint64_t size_;
+  };
+
+  /** A tile fetched ahead. */
+  struct PrefetchedTile {
+    /** The chunk holding the tile. */
+    Chunk* chunk_;
+    /** The (compressed) tile size. */
+    uint64_t size_;
+  };
+
   /* ********************************* */
   /*         PRIVATE ATTRIBUTES        */
   /* ********************************* */
@@ -162,6 +312,24 @@ class TileIO {
    */
   Buffer* buffer_;
 
+  /** The maximum size of the chunks tiles are split into for compression. */
+  uint64_t chunk_size_;
+
+  /** The memory-mapped file (nullptr if the file is not mapped). */
+  void* map_data_;
+
+  /** *True* if mapping the file was attempted and failed. */
+  bool map_failed_;
+
+  /** The size of the memory-mapped file. */
+  uint64_t map_size_;
+
+  /** The tiles queued for prefetching, as a map from offset to size. */
+  std::map<uint64_t, uint64_t> pending_;
+
+  /** The tiles fetched ahead, indexed by their file offset. */
+  std::unordered_map<uint64_t, PrefetchedTile> prefetched_;
+
   /** The storage manager object. */
   StorageManager* storage_manager_;
 
@@ -169,6 +337,12 @@ class TileIO {
   /*          PRIVATE METHODS          */
   /* ********************************* */
 
+  /**
+   * Allocates a tile for reading *tile_size* bytes into it. If *buffer* is
+   * not null, the tile becomes an (empty) view of it instead.
+   */
+  Status alloc_tile(Tile* tile, uint64_t tile_size, void* buffer);
+
   /**
    * Compresses a tile. The compressed data are written in buffer_.
    * Note that a coordinates tile must be split into one tile per
@@ -180,8 +354,23 @@ class TileIO {
    */
   Status compress_tile(Tile* tile);
 
+  /**
+   * Compresses a chunk of a tile with the tile's compressor, after running
+   * the tile's filters on it.
+   *
+   * @param tile The tile the chunk belongs to.
+   * @param data The chunk data.
+   * @param nbytes The chunk size.
+   * @param output The buffer the compressed data are appended to, with
+   *     enough free space for the compression overhead.
+   * @return Status
+   */
+  Status compress_chunk(
+      Tile* tile, const void* data, uint64_t nbytes, Buffer* output) const;
+
   /**
    * Compresses a single tile. The compressed data are written in buffer_.
+   * Tiles of multiple chunks have their chunks compressed in parallel.
    *
    * @param tile The tile to be compressed.
    * @return Status
@@ -204,26 +393,83 @@ class TileIO {
       uint64_t* overhead);
 
   /**
-   * Decompresses buffer_ into a tile.
-   * Note that a coordinates tile was split into one tile per
-   * dimension. In that case *decompress_one_tile* will be invoked
-   * for each dimension sub-tile.
+   * Decompresses a chunk of a tile with the tile's decompressor, and then
+   * reverses the tile's filters.
    *
-   * @param tile The tile where the decompressed data will be stored.
+   * @param tile The tile the chunk belongs to.
+   * @param chunk The location of the chunk.
    * @return Status
    */
-  Status decompress_tile(Tile* tile);
+  Status decompress_chunk(Tile* tile, const CompressedChunk& chunk) const;
 
   /**
-   * Decompresses buffer_ into a tile.
+   * Decompresses buffer_ into a tile (whose buffer must be allocated).
+   * Note that a coordinates tile was split into one tile per dimension.
+   * The chunk headers of all dimension tiles are read first, so that all
+   * chunks are decompressed in parallel, directly to their positions in the
+   * tile.
    *
    * @param tile The tile where the decompressed data will be stored.
    * @return Status
    */
-  Status decompress_one_tile(Tile* tile);
+  Status decompress_tile(Tile* tile);
+
+  /**
+   * Maps the file into memory, if not already mapped. It fails if a
+   * previous mapping attempt failed.
+   */
+  Status map_file();
 
-  /** Computes the compression overhead on *nbytes* of the input tile. */
+  /**
+   * Computes the filter and compression overhead on *nbytes* of the input
+   * tile.
+   */
   uint64_t overhead(Tile* tile, uint64_t nbytes) const;
+
+  /**
+   * Reads the chunk headers of a single (dimension) tile from buffer_,
+   * advancing past its chunks.
+   *
+   * @param output_offset The offset in the tile where the decompressed data
+   *     of the chunks start. It is advanced past them.
+   * @param chunks The located chunks are appended here.
+   * @return Status
+   */
+  Status read_chunk_headers(
+      uint64_t* output_offset, std::vector<CompressedChunk>* chunks);
+
+  /**
+   * Reads into a tile from the file, consuming data fetched ahead if any.
+   *
+   * @param tile The tile to read into.
+   * @param file_offset The offset in the file to read from.
+   * @param compressed_size The size of the compressed tile.
+   * @param tile_size The size of the decompressed tile.
+   * @param buffer The destination the tile becomes a view of, or nullptr
+   *     to read into the tile's own (or a memory-mapped) buffer.
+   * @return Status.
+   */
+  Status read_tile(
+      Tile* tile,
+      uint64_t file_offset,
+      uint64_t compressed_size,
+      uint64_t tile_size,
+      void* buffer);
+
+  /** Releases a tile's reference to a chunk, deleting the unused chunk. */
+  void release_chunk(Chunk* chunk);
+
+  /**
+   * Serializes the generic tile header into a buffer.
+   *
+   * @param tile The tile whose header will be serialized.
+   * @param compressed_size The size that the (potentially) compressed tile
+   *     will occupy in the file.
+   * @param buff The buffer the header is appended to.
+   * @return Status
+   */
+  Status serialize_generic_tile_header(
+      Tile* tile, uint64_t compressed_size, Buffer* buff) const;
 };
 
 }  // namespace tiledb
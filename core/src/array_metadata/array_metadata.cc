@@ -217,6 +217,26 @@ Status ArrayMetadata::check() const {
         "Array metadata check failed; Double delta compression can be used "
         "only with integer values"));
 
+  if (!check_gorilla_compressor())
+    return LOG_STATUS(Status::ArrayMetadataError(
+        "Array metadata check failed; Gorilla compression can be used only "
+        "with real values"));
+
+  if (!check_dictionary_encoding())
+    return LOG_STATUS(Status::ArrayMetadataError(
+        "Array metadata check failed; Dictionary encoding can be used only "
+        "with variable-sized char attributes"));
+
+  if (!check_zstd_dictionary())
+    return LOG_STATUS(Status::ArrayMetadataError(
+        "Array metadata check failed; ZSTD dictionaries can be used only "
+        "with attributes compressed with ZSTD"));
+
+  if (!check_filters())
+    return LOG_STATUS(Status::ArrayMetadataError(
+        "Array metadata check failed; Bit width reduction cannot be followed "
+        "by RLE or double delta compression"));
+
   if (!check_attribute_dimension_names())
     return LOG_STATUS(
         Status::ArrayMetadataError("Array metadata check failed; Attributes "
@@ -331,6 +351,15 @@ Status ArrayMetadata::get_attribute_ids(
 //   attribute #1
 //   attribute #2
 //   ...
+// filter pipeline of attribute #1
+// filter pipeline of attribute #2
+// ...
+// dictionary_encoding of attribute #1 (char)
+// dictionary_encoding of attribute #2 (char)
+// ...
+// zstd_dictionary of attribute #1 (char)
+// zstd_dictionary of attribute #2 (char)
+// ...
 Status ArrayMetadata::serialize(Buffer* buff) const {
   // Write version
   RETURN_NOT_OK(buff->write(constants::version, sizeof(constants::version)));
@@ -366,6 +395,22 @@ Status ArrayMetadata::serialize(Buffer* buff) const {
   for (auto& attr : attributes_)
     RETURN_NOT_OK(attr->serialize(buff));
 
+  // Write the attribute filter pipelines
+  for (auto& attr : attributes_)
+    RETURN_NOT_OK(attr->filters().serialize(buff));
+
+  // Write the attribute dictionary encoding flags
+  for (auto& attr : attributes_) {
+    auto dictionary_encoding = (char)attr->dictionary_encoding();
+    RETURN_NOT_OK(buff->write(&dictionary_encoding, sizeof(char)));
+  }
+
+  // Write the attribute ZSTD dictionary flags
+  for (auto& attr : attributes_) {
+    auto zstd_dictionary = (char)attr->zstd_dictionary();
+    RETURN_NOT_OK(buff->write(&zstd_dictionary, sizeof(char)));
+  }
+
   return Status::Ok();
 }
 
@@ -423,6 +468,15 @@ void ArrayMetadata::add_attribute(const Attribute* attr) {
 //   attribute #1
 //   attribute #2
 //   ...
+// filter pipeline of attribute #1
+// filter pipeline of attribute #2
+// ...
+// dictionary_encoding of attribute #1 (char)
+// dictionary_encoding of attribute #2 (char)
+// ...
+// zstd_dictionary of attribute #1 (char)
+// zstd_dictionary of attribute #2 (char)
+// ...
 Status ArrayMetadata::deserialize(ConstBuffer* buff) {
   // Load version
   RETURN_NOT_OK(buff->read(version_, sizeof(version_)));
@@ -469,6 +523,33 @@ Status ArrayMetadata::deserialize(ConstBuffer* buff) {
     attributes_.emplace_back(attr);
   }
 
+  // Load the attribute filter pipelines (absent in older arrays)
+  if (!buff->end()) {
+    for (auto& attr : attributes_) {
+      FilterPipeline filters;
+      RETURN_NOT_OK(filters.deserialize(buff));
+      attr->set_filters(filters);
+    }
+  }
+
+  // Load the attribute dictionary encoding flags (absent in older arrays)
+  if (!buff->end()) {
+    for (auto& attr : attributes_) {
+      char dictionary_encoding;
+      RETURN_NOT_OK(buff->read(&dictionary_encoding, sizeof(char)));
+      attr->set_dictionary_encoding(dictionary_encoding != 0);
+    }
+  }
+
+  // Load the attribute ZSTD dictionary flags (absent in older arrays)
+  if (!buff->end()) {
+    for (auto& attr : attributes_) {
+      char zstd_dictionary;
+      RETURN_NOT_OK(buff->read(&zstd_dictionary, sizeof(char)));
+      attr->set_zstd_dictionary(zstd_dictionary != 0);
+    }
+  }
+
   // Initialize the rest of the object members
   RETURN_NOT_OK(init());
 
@@ -559,6 +640,59 @@ bool ArrayMetadata::check_double_delta_compressor() const {
   return true;
 }
 
+bool ArrayMetadata::check_dictionary_encoding() const {
+  for (auto attr : attributes_) {
+    if (attr->dictionary_encoding() &&
+        (attr->type() != Datatype::CHAR || !attr->var_size()))
+      return false;
+  }
+
+  return true;
+}
+
+bool ArrayMetadata::check_zstd_dictionary() const {
+  for (auto attr : attributes_) {
+    if (attr->zstd_dictionary() && attr->compressor() != Compressor::ZSTD)
+      return false;
+  }
+
+  return true;
+}
+
+bool ArrayMetadata::check_filters() const {
+  for (auto attr : attributes_) {
+    auto compressor = attr->compressor();
+    if (compressor != Compressor::RLE &&
+        compressor != Compressor::DOUBLE_DELTA)
+      continue;
+    const FilterPipeline& filters = attr->filters();
+    for (unsigned int i = 0; i < filters.filter_num(); ++i) {
+      if (filters.filter(i) == FilterType::BIT_WIDTH_REDUCTION)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool ArrayMetadata::check_gorilla_compressor() const {
+  // Check coordinates
+  if (domain_->type() != Datatype::FLOAT32 &&
+      domain_->type() != Datatype::FLOAT64 &&
+      coords_compression_ == Compressor::GORILLA)
+    return false;
+
+  // Check attributes
+  for (auto attr : attributes_) {
+    if (attr->type() != Datatype::FLOAT32 &&
+        attr->type() != Datatype::FLOAT64 &&
+        attr->compressor() == Compressor::GORILLA)
+      return false;
+  }
+
+  return true;
+}
+
 void ArrayMetadata::clear() {
   array_uri_ = URI();
   array_type_ = ArrayType::DENSE;
@@ -42,7 +42,10 @@ namespace tiledb {
 /*     CONSTRUCTORS & DESTRUCTORS    */
 /* ********************************* */
 
-Attribute::Attribute() = default;
+Attribute::Attribute() {
+  dictionary_encoding_ = false;
+  zstd_dictionary_ = false;
+}
 
 Attribute::Attribute(const char* name, Datatype type) {
   // Set name
@@ -56,6 +59,8 @@ Attribute::Attribute(const char* name, Datatype type) {
   cell_val_num_ = 1;
   compressor_ = Compressor::NO_COMPRESSION;
   compression_level_ = -1;
+  dictionary_encoding_ = false;
+  zstd_dictionary_ = false;
 }
 
 Attribute::Attribute(const Attribute* attr) {
@@ -66,6 +71,9 @@ Attribute::Attribute(const Attribute* attr) {
   cell_val_num_ = attr->cell_val_num();
   compressor_ = attr->compressor();
   compression_level_ = attr->compression_level();
+  dictionary_encoding_ = attr->dictionary_encoding();
+  filters_ = attr->filters();
+  zstd_dictionary_ = attr->zstd_dictionary();
 }
 
 Attribute::~Attribute() = default;
@@ -74,6 +82,10 @@ Attribute::~Attribute() = default;
 /*                API                */
 /* ********************************* */
 
+void Attribute::add_filter(FilterType filter) {
+  filters_.add_filter(filter);
+}
+
 uint64_t Attribute::cell_size() const {
   if (var_size())
     return constants::var_size;
@@ -93,6 +105,10 @@ int Attribute::compression_level() const {
   return compression_level_;
 }
 
+bool Attribute::dictionary_encoding() const {
+  return dictionary_encoding_;
+}
+
 // ===== FORMAT =====
 // attribute_name_size (unsigned int)
 // attribute_name (string)
@@ -135,6 +151,11 @@ void Attribute::dump(FILE* out) const {
   fprintf(out, "- Type: %s\n", type_s);
   fprintf(out, "- Compressor: %s\n", compressor_s);
   fprintf(out, "- Compression level: %d\n", compression_level_);
+  filters_.dump(out);
+  if (dictionary_encoding_)
+    fprintf(out, "- Dictionary encoding: true\n");
+  if (zstd_dictionary_)
+    fprintf(out, "- ZSTD dictionary: true\n");
 
   if (!var_size())
     fprintf(out, "- Cell val num: %u\n", cell_val_num_);
@@ -142,6 +163,10 @@ void Attribute::dump(FILE* out) const {
     fprintf(out, "- Cell val num: var\n");
 }
 
+const FilterPipeline& Attribute::filters() const {
+  return filters_;
+}
+
 const std::string& Attribute::name() const {
   return name_;
 }
@@ -186,6 +211,18 @@ void Attribute::set_compression_level(int compression_level) {
   compression_level_ = compression_level;
 }
 
+void Attribute::set_dictionary_encoding(bool dictionary_encoding) {
+  dictionary_encoding_ = dictionary_encoding;
+}
+
+void Attribute::set_filters(const FilterPipeline& filters) {
+  filters_ = filters;
+}
+
+void Attribute::set_zstd_dictionary(bool zstd_dictionary) {
+  zstd_dictionary_ = zstd_dictionary;
+}
+
 Datatype Attribute::type() const {
   return type_;
 }
@@ -194,4 +231,8 @@ bool Attribute::var_size() const {
   return cell_val_num_ == constants::var_num;
 }
 
+bool Attribute::zstd_dictionary() const {
+  return zstd_dictionary_;
+}
+
 }  // namespace tiledb
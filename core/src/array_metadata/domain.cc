@@ -538,6 +538,64 @@ bool Domain::is_contained_in_tile_slab_row(const T* range) const {
   return true;
 }
 
+bool Domain::overlap(const void* subarray_a, const void* subarray_b) const {
+  switch (type_) {
+    case Datatype::INT32:
+      return overlap(
+          static_cast<const int*>(subarray_a),
+          static_cast<const int*>(subarray_b));
+    case Datatype::INT64:
+      return overlap(
+          static_cast<const int64_t*>(subarray_a),
+          static_cast<const int64_t*>(subarray_b));
+    case Datatype::FLOAT32:
+      return overlap(
+          static_cast<const float*>(subarray_a),
+          static_cast<const float*>(subarray_b));
+    case Datatype::FLOAT64:
+      return overlap(
+          static_cast<const double*>(subarray_a),
+          static_cast<const double*>(subarray_b));
+    case Datatype::INT8:
+      return overlap(
+          static_cast<const int8_t*>(subarray_a),
+          static_cast<const int8_t*>(subarray_b));
+    case Datatype::UINT8:
+      return overlap(
+          static_cast<const uint8_t*>(subarray_a),
+          static_cast<const uint8_t*>(subarray_b));
+    case Datatype::INT16:
+      return overlap(
+          static_cast<const int16_t*>(subarray_a),
+          static_cast<const int16_t*>(subarray_b));
+    case Datatype::UINT16:
+      return overlap(
+          static_cast<const uint16_t*>(subarray_a),
+          static_cast<const uint16_t*>(subarray_b));
+    case Datatype::UINT32:
+      return overlap(
+          static_cast<const uint32_t*>(subarray_a),
+          static_cast<const uint32_t*>(subarray_b));
+    case Datatype::UINT64:
+      return overlap(
+          static_cast<const uint64_t*>(subarray_a),
+          static_cast<const uint64_t*>(subarray_b));
+    default:
+      return true;
+  }
+}
+
+template <class T>
+bool Domain::overlap(const T* subarray_a, const T* subarray_b) const {
+  for (unsigned int i = 0; i < dim_num_; ++i) {
+    if (subarray_a[2 * i] > subarray_b[2 * i + 1] ||
+        subarray_b[2 * i] > subarray_a[2 * i + 1])
+      return false;
+  }
+
+  return true;
+}
+
 // ===== FORMAT =====
 // type (char)
 // dim_num (unsigned int)
@@ -1483,6 +1541,27 @@ template bool Domain::is_contained_in_tile_slab_row<uint32_t>(
 template bool Domain::is_contained_in_tile_slab_row<uint64_t>(
     const uint64_t* range) const;
 
+template bool Domain::overlap<int>(
+    const int* subarray_a, const int* subarray_b) const;
+template bool Domain::overlap<int64_t>(
+    const int64_t* subarray_a, const int64_t* subarray_b) const;
+template bool Domain::overlap<float>(
+    const float* subarray_a, const float* subarray_b) const;
+template bool Domain::overlap<double>(
+    const double* subarray_a, const double* subarray_b) const;
+template bool Domain::overlap<int8_t>(
+    const int8_t* subarray_a, const int8_t* subarray_b) const;
+template bool Domain::overlap<uint8_t>(
+    const uint8_t* subarray_a, const uint8_t* subarray_b) const;
+template bool Domain::overlap<int16_t>(
+    const int16_t* subarray_a, const int16_t* subarray_b) const;
+template bool Domain::overlap<uint16_t>(
+    const uint16_t* subarray_a, const uint16_t* subarray_b) const;
+template bool Domain::overlap<uint32_t>(
+    const uint32_t* subarray_a, const uint32_t* subarray_b) const;
+template bool Domain::overlap<uint64_t>(
+    const uint64_t* subarray_a, const uint64_t* subarray_b) const;
+
 template unsigned int Domain::subarray_overlap<int>(
     const int* subarray_a, const int* subarray_b, int* overlap_subarray) const;
 template unsigned int Domain::subarray_overlap<int64_t>(
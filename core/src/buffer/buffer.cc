@@ -61,7 +61,7 @@ Buffer::Buffer(void* data, uint64_t size, bool owns_data)
     , owns_data_(owns_data)
     , size_(size) {
   offset_ = 0;
-  alloced_size_ = 0;
+  alloced_size_ = size;
   owns_data_ = false;
 }
 
@@ -95,6 +95,11 @@ void Buffer::clear() {
   alloced_size_ = 0;
 }
 
+void Buffer::commit(uint64_t nbytes) {
+  offset_ += nbytes;
+  size_ = offset_;
+}
+
 void* Buffer::cur_data() const {
   return (char*)data_ + offset_;
 }
@@ -116,6 +121,10 @@ uint64_t Buffer::offset() const {
   return offset_;
 }
 
+bool Buffer::owns_data() const {
+  return owns_data_;
+}
+
 Status Buffer::read(void* buffer, uint64_t nbytes) {
   if (nbytes + offset_ > size_) {
     return LOG_STATUS(
@@ -127,6 +136,10 @@ Status Buffer::read(void* buffer, uint64_t nbytes) {
 }
 
 Status Buffer::realloc(uint64_t nbytes) {
+  // A view can be reused up to its size
+  if (!owns_data_ && nbytes <= alloced_size_)
+    return Status::Ok();
+
   if (!owns_data_) {
     return LOG_STATUS(Status::BufferError(
         "Cannot reallocate buffer; Buffer does not own data"));
@@ -150,6 +163,12 @@ Status Buffer::realloc(uint64_t nbytes) {
   return Status::Ok();
 }
 
+Status Buffer::reserve(uint64_t nbytes) {
+  if (offset_ + nbytes > alloced_size_)
+    RETURN_NOT_OK(realloc(offset_ + nbytes));
+  return Status::Ok();
+}
+
 void Buffer::reset_offset() {
   offset_ = 0;
 }
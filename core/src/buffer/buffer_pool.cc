@@ -0,0 +1,91 @@
+/**
+ * @file   buffer_pool.cc
+ * @file   buffer.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class BufferPool.
+ */
+
+#include "buffer_pool.h"
+
+namespace tiledb {
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+BufferPool::BufferPool(uint64_t max_num, uint64_t max_size)
+    : max_num_(max_num)
+    , max_size_(max_size) {
+}
+
+BufferPool::~BufferPool() {
+  for (auto buffer : buffers_)
+    delete buffer;
+}
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+Buffer* BufferPool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!buffers_.empty()) {
+      Buffer* buffer = buffers_.back();
+      buffers_.pop_back();
+      return buffer;
+    }
+  }
+
+  return new Buffer();
+}
+
+uint64_t BufferPool::pooled_num() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return buffers_.size();
+}
+
+void BufferPool::release(Buffer* buffer) {
+  if (buffer == nullptr)
+    return;
+
+  if (buffer->owns_data() &&
+      buffer->alloced_size() <= max_size_) {
+    buffer->reset_size();
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (buffers_.size() < max_num_) {
+      buffers_.push_back(buffer);
+      return;
+    }
+  }
+
+  delete buffer;
+}
+
+}  // namespace tiledb
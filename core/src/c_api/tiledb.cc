@@ -409,6 +409,30 @@ int tiledb_attribute_set_compressor(
   return TILEDB_OK;
 }
 
+int tiledb_attribute_add_filter(
+    tiledb_ctx_t* ctx, tiledb_attribute_t* attr, tiledb_filter_type_t filter) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  attr->attr_->add_filter(static_cast<tiledb::FilterType>(filter));
+  return TILEDB_OK;
+}
+
+int tiledb_attribute_set_dictionary_encoding(
+    tiledb_ctx_t* ctx, tiledb_attribute_t* attr, int dictionary_encoding) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  attr->attr_->set_dictionary_encoding(dictionary_encoding != 0);
+  return TILEDB_OK;
+}
+
+int tiledb_attribute_set_zstd_dictionary(
+    tiledb_ctx_t* ctx, tiledb_attribute_t* attr, int zstd_dictionary) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  attr->attr_->set_zstd_dictionary(zstd_dictionary != 0);
+  return TILEDB_OK;
+}
+
 int tiledb_attribute_set_cell_val_num(
     tiledb_ctx_t* ctx, tiledb_attribute_t* attr, unsigned int cell_val_num) {
   if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
@@ -447,6 +471,50 @@ int tiledb_attribute_get_compressor(
   return TILEDB_OK;
 }
 
+int tiledb_attribute_get_filter_num(
+    tiledb_ctx_t* ctx,
+    const tiledb_attribute_t* attr,
+    unsigned int* filter_num) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  *filter_num = attr->attr_->filters().filter_num();
+  return TILEDB_OK;
+}
+
+int tiledb_attribute_get_filter(
+    tiledb_ctx_t* ctx,
+    const tiledb_attribute_t* attr,
+    unsigned int index,
+    tiledb_filter_type_t* filter) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  if (index >= attr->attr_->filters().filter_num()) {
+    save_error(ctx, tiledb::Status::Error("Invalid filter index"));
+    return TILEDB_ERR;
+  }
+  *filter = static_cast<tiledb_filter_type_t>(
+      attr->attr_->filters().filter(index));
+  return TILEDB_OK;
+}
+
+int tiledb_attribute_get_dictionary_encoding(
+    tiledb_ctx_t* ctx,
+    const tiledb_attribute_t* attr,
+    int* dictionary_encoding) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  *dictionary_encoding = (attr->attr_->dictionary_encoding()) ? 1 : 0;
+  return TILEDB_OK;
+}
+
+int tiledb_attribute_get_zstd_dictionary(
+    tiledb_ctx_t* ctx, const tiledb_attribute_t* attr, int* zstd_dictionary) {
+  if (sanity_check(ctx) == TILEDB_ERR || sanity_check(ctx, attr) == TILEDB_ERR)
+    return TILEDB_ERR;
+  *zstd_dictionary = (attr->attr_->zstd_dictionary()) ? 1 : 0;
+  return TILEDB_OK;
+}
+
 int tiledb_attribute_get_cell_val_num(
     tiledb_ctx_t* ctx,
     const tiledb_attribute_t* attr,
@@ -1369,6 +1437,19 @@ int tiledb_array_consolidate(tiledb_ctx_t* ctx, const char* array_name) {
   return TILEDB_OK;
 }
 
+int tiledb_array_consolidate_metadata(
+    tiledb_ctx_t* ctx, const char* array_name) {
+  // Sanity checks
+  if (sanity_check(ctx) == TILEDB_ERR)
+    return TILEDB_ERR;
+
+  if (save_error(
+          ctx, ctx->storage_manager_->array_consolidate_metadata(array_name)))
+    return TILEDB_ERR;
+
+  return TILEDB_OK;
+}
+
 /* ****************************** */
 /*       RESOURCE  MANAGEMENT     */
 /* ****************************** */
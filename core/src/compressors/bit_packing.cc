@@ -0,0 +1,222 @@
+/**
+ * @file   bit_packing.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class BitPacking.
+ */
+
+#include "bit_packing.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define TILEDB_BIT_PACKING_X86
+#endif
+
+namespace tiledb {
+
+namespace {
+
+/* ****************************** */
+/*             KERNELS            */
+/* ****************************** */
+
+/** The number of interleaved lanes. */
+const uint64_t lane_num = BitPacking::LANE_NUM;
+
+/**
+ * Packs *rows* x *lane_num* values of at most *width* bits, with value i
+ * going to lane i % *lane_num*.
+ */
+void pack_scalar(
+    const uint64_t* values, uint64_t rows, int width, uint64_t* out) {
+  uint64_t acc[lane_num] = {0};
+  int filled = 0;
+  for (uint64_t r = 0; r < rows; ++r, values += lane_num) {
+    for (uint64_t j = 0; j < lane_num; ++j)
+      acc[j] |= values[j] << filled;
+    filled += width;
+    if (filled >= 64) {
+      filled -= 64;
+      for (uint64_t j = 0; j < lane_num; ++j) {
+        out[j] = acc[j];
+        acc[j] = (filled == 0) ? 0 : values[j] >> (width - filled);
+      }
+      out += lane_num;
+    }
+  }
+  if (filled > 0)
+    std::memcpy(out, acc, sizeof(acc));
+}
+
+/** Inverse of `pack_scalar`. */
+void unpack_scalar(
+    const uint64_t* in, uint64_t rows, int width, uint64_t* values) {
+  if (width == 0) {
+    std::memset(values, 0, rows * lane_num * sizeof(uint64_t));
+    return;
+  }
+  uint64_t mask = (width == 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+  int filled = 0;
+  for (uint64_t r = 0; r < rows; ++r, values += lane_num) {
+    uint64_t v[lane_num];
+    for (uint64_t j = 0; j < lane_num; ++j)
+      v[j] = in[j] >> filled;
+    filled += width;
+    if (filled >= 64) {
+      filled -= 64;
+      in += lane_num;
+      if (filled > 0) {
+        for (uint64_t j = 0; j < lane_num; ++j)
+          v[j] |= in[j] << (width - filled);
+      }
+    }
+    for (uint64_t j = 0; j < lane_num; ++j)
+      values[j] = v[j] & mask;
+  }
+}
+
+#ifdef TILEDB_BIT_PACKING_X86
+
+/** AVX2 version of `pack_scalar`, one row at a time. */
+__attribute__((target("avx2"))) void pack_avx2(
+    const uint64_t* values, uint64_t rows, int width, uint64_t* out) {
+  __m256i acc = _mm256_setzero_si256();
+  int filled = 0;
+  for (uint64_t r = 0; r < rows; ++r, values += lane_num) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)values);
+    acc = _mm256_or_si256(acc, _mm256_sll_epi64(v, _mm_cvtsi32_si128(filled)));
+    filled += width;
+    if (filled >= 64) {
+      filled -= 64;
+      _mm256_storeu_si256((__m256i*)out, acc);
+      out += lane_num;
+      // Shifts by 64 or more give zero
+      acc = _mm256_srl_epi64(v, _mm_cvtsi32_si128(width - filled));
+    }
+  }
+  if (filled > 0)
+    _mm256_storeu_si256((__m256i*)out, acc);
+}
+
+/** AVX2 version of `unpack_scalar`, one row at a time. */
+__attribute__((target("avx2"))) void unpack_avx2(
+    const uint64_t* in, uint64_t rows, int width, uint64_t* values) {
+  if (width == 0) {
+    std::memset(values, 0, rows * lane_num * sizeof(uint64_t));
+    return;
+  }
+  __m256i mask = _mm256_set1_epi64x(
+      (width == 64) ? -1LL : (long long)((uint64_t(1) << width) - 1));
+  __m256i word = _mm256_loadu_si256((const __m256i*)in);
+  int filled = 0;
+  for (uint64_t r = 0; r < rows; ++r, values += lane_num) {
+    __m256i v = _mm256_srl_epi64(word, _mm_cvtsi32_si128(filled));
+    filled += width;
+    if (filled >= 64) {
+      filled -= 64;
+      in += lane_num;
+      if (filled > 0 || r + 1 < rows)
+        word = _mm256_loadu_si256((const __m256i*)in);
+      if (filled > 0) {
+        v = _mm256_or_si256(
+            v, _mm256_sll_epi64(word, _mm_cvtsi32_si128(width - filled)));
+      }
+    }
+    _mm256_storeu_si256((__m256i*)values, _mm256_and_si256(v, mask));
+  }
+}
+
+#endif
+
+/** The packing kernels. */
+struct Kernels {
+  void (*pack_)(const uint64_t*, uint64_t, int, uint64_t*);
+  void (*unpack_)(const uint64_t*, uint64_t, int, uint64_t*);
+};
+
+/**
+ * Picks the packing kernels, based on the instructions the CPU supports
+ * (scalar ones if *simd* is *false*).
+ */
+Kernels kernels(bool simd) {
+#ifdef TILEDB_BIT_PACKING_X86
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  if (simd && has_avx2)
+    return {pack_avx2, unpack_avx2};
+#else
+  (void)simd;
+#endif
+  return {pack_scalar, unpack_scalar};
+}
+
+}  // namespace
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+const uint64_t BitPacking::LANE_NUM;
+
+void BitPacking::pack(
+    const uint64_t* values,
+    uint64_t rows,
+    int width,
+    uint64_t* out,
+    bool simd) {
+  kernels(simd).pack_(values, rows, width, out);
+}
+
+uint64_t BitPacking::packed_size(uint64_t rows, int width) {
+  return LANE_NUM * sizeof(uint64_t) * ((rows * width + 63) / 64);
+}
+
+uint64_t BitPacking::row_num(uint64_t value_num) {
+  return (value_num + LANE_NUM - 1) / LANE_NUM;
+}
+
+void BitPacking::unpack(
+    const uint64_t* in,
+    uint64_t rows,
+    int width,
+    uint64_t* values,
+    bool simd) {
+  kernels(simd).unpack_(in, rows, width, values);
+}
+
+int BitPacking::width(uint64_t value) {
+  int width = 0;
+  while (value != 0) {
+    ++width;
+    value >>= 1;
+  }
+  return width;
+}
+
+}  // namespace tiledb
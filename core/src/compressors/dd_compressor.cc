@@ -31,21 +31,37 @@
  */
 
 #include "dd_compressor.h"
+#include "bit_packing.h"
 #include "logger.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <iostream>
 
 /* ****************************** */
 /*             MACROS             */
 /* ****************************** */
 
-#define ABS(x) ((x) < 0) ? uint64_t(-(x)) : uint64_t(x)
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
-#define MAX(a, b) ((a) > (b) ? (a) : (b))
 
 namespace tiledb {
 
-const uint64_t DoubleDelta::OVERHEAD = 17;
+const uint64_t DoubleDelta::OVERHEAD = 25;
+
+namespace {
+
+/* ****************************** */
+/*          BLOCK FORMAT          */
+/* ****************************** */
+
+/** Marks buffers in the block-wise format. */
+const char blockwise_format = 0;
+
+/** The number of double deltas in a block. */
+const uint64_t block_value_num = 128;
+
+}  // namespace
 
 /* ****************************** */
 /*               API              */
@@ -106,7 +122,10 @@ Status DoubleDelta::decompress(
 }
 
 uint64_t DoubleDelta::overhead(uint64_t nbytes) {
-  return DoubleDelta::OVERHEAD;
+  // A block of 128 values grows by at most 41 bytes (for 1-byte values, with
+  // double deltas of up to 10 bits and 9 bytes of block header), plus the
+  // padding of the last block
+  return DoubleDelta::OVERHEAD + (nbytes / block_value_num) * 41 + 256;
 }
 
 /* ****************************** */
@@ -115,92 +134,142 @@ uint64_t DoubleDelta::overhead(uint64_t nbytes) {
 
 template <class T>
 Status DoubleDelta::compress(ConstBuffer* input_buffer, Buffer* output_buffer) {
-  // Calculate number of values and handle trivial case
+  // Calculate number of values
   uint64_t value_size = sizeof(T);
   uint64_t num = input_buffer->size() / value_size;
-  assert(num > 0 && (input_buffer->size() % value_size == 0));
-
-  // Calculate bitsize (ignoring the sign bit)
-  auto in = (T*)input_buffer->data();
-  int bitsize;
-  RETURN_NOT_OK(compute_bitsize(in, num, &bitsize));
-  auto bitsize_c = (char)bitsize;
-
-  // Write bitsize and number of values
-  RETURN_NOT_OK(output_buffer->write(&bitsize_c, sizeof(char)));
-  RETURN_NOT_OK(output_buffer->write(&num, sizeof(uint64_t)));
-
-  // Trivial case - no compression
-  if (bitsize >= sizeof(T) * 8 - 1) {
-    RETURN_NOT_OK(output_buffer->write(in, input_buffer->size()));
-    return Status::Ok();
+  assert(input_buffer->size() % value_size == 0);
+  auto in = (const T*)input_buffer->data();
+
+  // Reserve space for the worst case
+  RETURN_NOT_OK(output_buffer->reserve(
+      input_buffer->size() + overhead(input_buffer->size())));
+  auto out_start = (char*)output_buffer->cur_data();
+  char* out = out_start;
+
+  // Write format and number of values
+  *(out++) = blockwise_format;
+  std::memcpy(out, &num, sizeof(uint64_t));
+  out += sizeof(uint64_t);
+
+  // Write first value and delta
+  if (num > 0) {
+    auto value = (uint64_t)in[0];
+    std::memcpy(out, &value, sizeof(uint64_t));
+    out += sizeof(uint64_t);
+  }
+  if (num > 1) {
+    uint64_t delta = (uint64_t)in[1] - (uint64_t)in[0];
+    std::memcpy(out, &delta, sizeof(uint64_t));
+    out += sizeof(uint64_t);
   }
 
-  // Write first value
-  RETURN_NOT_OK(output_buffer->write(&in[0], value_size));
-  if (num == 1)
-    return Status::Ok();
-
-  // Write second value
-  RETURN_NOT_OK(output_buffer->write(&in[1], value_size));
-  if (num == 2)
-    return Status::Ok();
-
-  // Write double deltas
-  int64_t prev_delta = int64_t(in[1]) - int64_t(in[0]);
-  int bit_in_chunk = 63;  // Leftmost bit (MSB)
-  uint64_t chunk = 0;
-  int64_t cur_delta, dd;
-  for (uint64_t i = 2; i < num; ++i) {
-    cur_delta = int64_t(in[i]) - int64_t(in[i - 1]);
-    dd = cur_delta - prev_delta;
-    RETURN_NOT_OK(
-        write_double_delta(output_buffer, dd, bitsize, &chunk, &bit_in_chunk));
-    prev_delta = cur_delta;
+  // Write blocks of double deltas
+  uint64_t values[block_value_num];
+  uint64_t packed[block_value_num];
+  for (uint64_t start = 2; start < num; start += block_value_num) {
+    uint64_t n = MIN(block_value_num, num - start);
+    const T* cur = in + start - 2;
+
+    // Double deltas, wrapping around in 64 bits
+    for (uint64_t i = 0; i < n; ++i)
+      values[i] =
+          (uint64_t)cur[i + 2] - 2 * (uint64_t)cur[i + 1] + (uint64_t)cur[i];
+
+    // Frame of reference
+    auto min = (int64_t)values[0];
+    auto max = min;
+    for (uint64_t i = 1; i < n; ++i) {
+      auto v = (int64_t)values[i];
+      min = (v < min) ? v : min;
+      max = (v > max) ? v : max;
+    }
+    int width = BitPacking::width((uint64_t)max - (uint64_t)min);
+    uint64_t rows = BitPacking::row_num(n);
+    for (uint64_t i = 0; i < n; ++i)
+      values[i] -= (uint64_t)min;
+    for (uint64_t i = n; i < rows * BitPacking::LANE_NUM; ++i)
+      values[i] = 0;
+
+    // Write block
+    std::memcpy(out, &min, sizeof(int64_t));
+    out += sizeof(int64_t);
+    *(out++) = (char)width;
+    BitPacking::pack(values, rows, width, packed);
+    uint64_t size = BitPacking::packed_size(rows, width);
+    std::memcpy(out, packed, size);
+    out += size;
   }
 
-  // Write whatever is left in the chunk
-  if (bit_in_chunk < 63)
-    RETURN_NOT_OK(output_buffer->write(&chunk, sizeof(uint64_t)));
+  output_buffer->commit(out - out_start);
 
   return Status::Ok();
 }
 
 template <class T>
-Status DoubleDelta::compute_bitsize(T* in, uint64_t num, int* bitsize) {
-  // Find maximum absolute double delta
-  int64_t max = 0;
-  int64_t prev_delta = in[1] - in[0];
-  int64_t cur_delta, dd;
-  char delta_out_of_bounds = 0;
-  for (uint64_t i = 2; i < num; ++i) {
-    cur_delta = in[i] - in[i - 1];
-    dd = cur_delta - prev_delta;
-    delta_out_of_bounds |= (char)(cur_delta < 0 && prev_delta > 0 && dd > 0);
-    delta_out_of_bounds |= (char)(cur_delta > 0 && prev_delta < 0 && dd < 0);
-    max = MAX(ABS(dd), max);
-    prev_delta = cur_delta;
+Status DoubleDelta::decompress(
+    ConstBuffer* input_buffer, Buffer* output_buffer) {
+  // Buffers of earlier versions start with a non-zero bitsize
+  if (input_buffer->nbytes_left_to_read() > 0 &&
+      input_buffer->value<char>() != blockwise_format)
+    return decompress_v1<T>(input_buffer, output_buffer);
+
+  // Read format and number of values
+  char format;
+  uint64_t num;
+  RETURN_NOT_OK(input_buffer->read(&format, sizeof(char)));
+  RETURN_NOT_OK(input_buffer->read(&num, sizeof(uint64_t)));
+  RETURN_NOT_OK(output_buffer->reserve(num * sizeof(T)));
+  auto out = (char*)output_buffer->cur_data();
+
+  // Read first value and delta
+  uint64_t value = 0, delta = 0;
+  T v;
+  if (num > 0) {
+    RETURN_NOT_OK(input_buffer->read(&value, sizeof(uint64_t)));
+    v = (T)value;
+    std::memcpy(out, &v, sizeof(T));
+  }
+  if (num > 1) {
+    RETURN_NOT_OK(input_buffer->read(&delta, sizeof(uint64_t)));
+    value += delta;
+    v = (T)value;
+    std::memcpy(out + sizeof(T), &v, sizeof(T));
   }
 
-  // Handle error
-  if (delta_out_of_bounds) {
-    return LOG_STATUS(
-        Status::CompressionError("Cannot compress with DoubleDelta; Some "
-                                 "negative double delta is out of bounds"));
+  // Read blocks of double deltas
+  uint64_t values[block_value_num];
+  uint64_t packed[block_value_num];
+  for (uint64_t start = 2; start < num; start += block_value_num) {
+    uint64_t n = MIN(block_value_num, num - start);
+    uint64_t rows = BitPacking::row_num(n);
+    uint64_t min;
+    unsigned char width;
+    RETURN_NOT_OK(input_buffer->read(&min, sizeof(uint64_t)));
+    RETURN_NOT_OK(input_buffer->read(&width, sizeof(char)));
+    if (width > 64)
+      return LOG_STATUS(Status::CompressionError(
+          "Failed decompressing with DoubleDelta; invalid bit width"));
+    RETURN_NOT_OK(
+        input_buffer->read(packed, BitPacking::packed_size(rows, width)));
+    BitPacking::unpack(packed, rows, width, values);
+
+    // Undo the double deltas
+    char* cur = out + start * sizeof(T);
+    for (uint64_t i = 0; i < n; ++i, cur += sizeof(T)) {
+      delta += values[i] + min;
+      value += delta;
+      v = (T)value;
+      std::memcpy(cur, &v, sizeof(T));
+    }
   }
 
-  // Calculate bitsize of the maximum absolute double delta
-  *bitsize = 0;
-  do {
-    ++(*bitsize);
-    max >>= 1;
-  } while (max);
+  output_buffer->commit(num * sizeof(T));
 
   return Status::Ok();
 }
 
 template <class T>
-Status DoubleDelta::decompress(
+Status DoubleDelta::decompress_v1(
     ConstBuffer* input_buffer, Buffer* output_buffer) {
   // Read bitsize and number of values
   char bitsize_c;
@@ -296,54 +365,6 @@ Status DoubleDelta::read_double_delta(
   return Status::Ok();
 }
 
-Status DoubleDelta::write_double_delta(
-    Buffer* buff,
-    int64_t double_delta,
-    int bitsize,
-    uint64_t* chunk,
-    int* bit_in_chunk) {
-  // Write sign
-  uint64_t to_or = (double_delta < 0) ? 1 : 0;
-  to_or <<= (*bit_in_chunk);
-  (*chunk) |= to_or;
-  --(*bit_in_chunk);
-
-  // Write chunk and reset
-  if (*bit_in_chunk < 0) {
-    RETURN_NOT_OK(buff->write(chunk, sizeof(uint64_t)));
-    *bit_in_chunk = 63;
-    *chunk = 0;
-  }
-
-  // Write rest of bits
-  int bits_left_to_write = bitsize;
-  int bit_in_dd = bitsize - 1;
-  int bits_to_fill_in_chunk = MIN((*bit_in_chunk) + 1, bits_left_to_write);
-  uint64_t abs_dd = ABS(double_delta);
-  uint64_t tmp_abs_dd;
-
-  while (bits_left_to_write > 0) {
-    if (bits_to_fill_in_chunk > 0) {
-      tmp_abs_dd = (abs_dd << (63 - bit_in_dd));
-      tmp_abs_dd >>= (63 - (*bit_in_chunk));
-      (*chunk) |= tmp_abs_dd;
-      (*bit_in_chunk) -= bits_to_fill_in_chunk;
-      bit_in_dd -= bits_to_fill_in_chunk;
-      bits_left_to_write -= bits_to_fill_in_chunk;
-    }
-
-    // Write chunk and reset
-    if (*bit_in_chunk < 0) {
-      RETURN_NOT_OK(buff->write(chunk, sizeof(uint64_t)));
-      *bit_in_chunk = 63;
-      *chunk = 0;
-      bits_to_fill_in_chunk = MIN((*bit_in_chunk) + 1, bits_left_to_write);
-    }
-  }
-
-  return Status::Ok();
-}
-
 // Explicit template instantiations
 
 template Status DoubleDelta::compress<char>(
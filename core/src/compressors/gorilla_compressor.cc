@@ -0,0 +1,205 @@
+/**
+ * @file   gorilla_compressor.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements the Gorilla compressor class.
+ */
+
+#include "gorilla_compressor.h"
+#include "bit_packing.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tiledb {
+
+namespace {
+
+/** The number of XORs in a block. */
+const uint64_t block_value_num = 128;
+
+}  // namespace
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+Status Gorilla::compress(
+    Datatype type, ConstBuffer* input_buffer, Buffer* output_buffer) {
+  switch (type) {
+    case Datatype::FLOAT32:
+      return Gorilla::compress<uint32_t>(input_buffer, output_buffer);
+    case Datatype::FLOAT64:
+      return Gorilla::compress<uint64_t>(input_buffer, output_buffer);
+    default:
+      return LOG_STATUS(Status::CompressionError(
+          "Cannot compress tile with Gorilla; Not supported datatype"));
+  }
+}
+
+Status Gorilla::decompress(
+    Datatype type, ConstBuffer* input_buffer, Buffer* output_buffer) {
+  switch (type) {
+    case Datatype::FLOAT32:
+      return Gorilla::decompress<uint32_t>(input_buffer, output_buffer);
+    case Datatype::FLOAT64:
+      return Gorilla::decompress<uint64_t>(input_buffer, output_buffer);
+    default:
+      return LOG_STATUS(Status::CompressionError(
+          "Cannot decompress tile with Gorilla; Not supported datatype"));
+  }
+}
+
+uint64_t Gorilla::overhead(uint64_t nbytes) {
+  // The number of values and a padded first value, 2 bytes per block of 128
+  // values (at least 512 bytes), and the padding of the last block
+  return 16 + (nbytes / 512 + 1) * 2 + 32;
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+template <class T>
+Status Gorilla::compress(ConstBuffer* input_buffer, Buffer* output_buffer) {
+  // Sanity check on input buffer
+  if (input_buffer->size() % sizeof(T) != 0)
+    return LOG_STATUS(Status::CompressionError(
+        "Failed compressing with Gorilla; invalid input buffer format"));
+  uint64_t num = input_buffer->size() / sizeof(T);
+  auto in = (const T*)input_buffer->data();
+
+  // Reserve space for the worst case
+  RETURN_NOT_OK(output_buffer->reserve(
+      input_buffer->size() + overhead(input_buffer->size())));
+  auto out_start = (char*)output_buffer->cur_data();
+  char* out = out_start;
+
+  // Write number of values and first value
+  std::memcpy(out, &num, sizeof(uint64_t));
+  out += sizeof(uint64_t);
+  if (num > 0) {
+    std::memcpy(out, &in[0], sizeof(T));
+    out += sizeof(T);
+  }
+
+  // Write blocks of XORs
+  uint64_t values[block_value_num];
+  uint64_t packed[block_value_num];
+  for (uint64_t start = 1; start < num; start += block_value_num) {
+    uint64_t n = std::min(block_value_num, num - start);
+    const T* cur = in + start - 1;
+    uint64_t all = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+      values[i] = (uint64_t)(cur[i + 1] ^ cur[i]);
+      all |= values[i];
+    }
+
+    // Strip the zeros all XORs share
+    int shift = 0;
+    while (all != 0 && (all & 1) == 0) {
+      all >>= 1;
+      ++shift;
+    }
+    int width = BitPacking::width(all);
+    uint64_t rows = BitPacking::row_num(n);
+    for (uint64_t i = 0; i < n; ++i)
+      values[i] >>= shift;
+    for (uint64_t i = n; i < rows * BitPacking::LANE_NUM; ++i)
+      values[i] = 0;
+
+    // Write block
+    *(out++) = (char)shift;
+    *(out++) = (char)width;
+    BitPacking::pack(values, rows, width, packed);
+    uint64_t size = BitPacking::packed_size(rows, width);
+    std::memcpy(out, packed, size);
+    out += size;
+  }
+
+  output_buffer->commit(out - out_start);
+
+  return Status::Ok();
+}
+
+template <class T>
+Status Gorilla::decompress(ConstBuffer* input_buffer, Buffer* output_buffer) {
+  // Read number of values and first value
+  uint64_t num;
+  RETURN_NOT_OK(input_buffer->read(&num, sizeof(uint64_t)));
+  RETURN_NOT_OK(output_buffer->reserve(num * sizeof(T)));
+  auto out = (char*)output_buffer->cur_data();
+  T value = 0;
+  if (num > 0) {
+    RETURN_NOT_OK(input_buffer->read(&value, sizeof(T)));
+    std::memcpy(out, &value, sizeof(T));
+  }
+
+  // Read blocks of XORs
+  uint64_t values[block_value_num];
+  uint64_t packed[block_value_num];
+  for (uint64_t start = 1; start < num; start += block_value_num) {
+    uint64_t n = std::min(block_value_num, num - start);
+    uint64_t rows = BitPacking::row_num(n);
+    unsigned char shift, width;
+    RETURN_NOT_OK(input_buffer->read(&shift, sizeof(char)));
+    RETURN_NOT_OK(input_buffer->read(&width, sizeof(char)));
+    if (shift + width > 8 * sizeof(T))
+      return LOG_STATUS(Status::CompressionError(
+          "Failed decompressing with Gorilla; invalid bit width"));
+    RETURN_NOT_OK(
+        input_buffer->read(packed, BitPacking::packed_size(rows, width)));
+    BitPacking::unpack(packed, rows, width, values);
+
+    // Undo the XORs
+    char* cur = out + start * sizeof(T);
+    for (uint64_t i = 0; i < n; ++i, cur += sizeof(T)) {
+      value ^= (T)(values[i] << shift);
+      std::memcpy(cur, &value, sizeof(T));
+    }
+  }
+
+  output_buffer->commit(num * sizeof(T));
+
+  return Status::Ok();
+}
+
+// Explicit template instantiations
+
+template Status Gorilla::compress<uint32_t>(
+    ConstBuffer* input_buffer, Buffer* output_buffer);
+template Status Gorilla::compress<uint64_t>(
+    ConstBuffer* input_buffer, Buffer* output_buffer);
+
+template Status Gorilla::decompress<uint32_t>(
+    ConstBuffer* input_buffer, Buffer* output_buffer);
+template Status Gorilla::decompress<uint64_t>(
+    ConstBuffer* input_buffer, Buffer* output_buffer);
+
+}  // namespace tiledb
@@ -38,6 +38,66 @@
 
 namespace tiledb {
 
+namespace {
+
+/**
+ * A deflate stream kept per thread and reset between calls, which saves
+ * allocating and initializing the zlib state for every chunk.
+ */
+struct DeflateStream {
+  z_stream strm_;
+  bool init_ = false;
+  int level_ = 0;
+
+  ~DeflateStream() {
+    if (init_)
+      (void)deflateEnd(&strm_);
+  }
+
+  /** Prepares the stream for a new input, compressed at *level*. */
+  bool reset(int level) {
+    if (init_ && level == level_)
+      return deflateReset(&strm_) == Z_OK;
+    if (init_)
+      (void)deflateEnd(&strm_);
+    strm_.zalloc = Z_NULL;
+    strm_.zfree = Z_NULL;
+    strm_.opaque = Z_NULL;
+    init_ = (deflateInit(&strm_, level) == Z_OK);
+    level_ = level;
+    return init_;
+  }
+};
+
+/** An inflate stream kept per thread and reset between calls. */
+struct InflateStream {
+  z_stream strm_;
+  bool init_ = false;
+
+  ~InflateStream() {
+    if (init_)
+      (void)inflateEnd(&strm_);
+  }
+
+  /** Prepares the stream for a new input. */
+  bool reset() {
+    if (init_)
+      return inflateReset(&strm_) == Z_OK;
+    strm_.zalloc = Z_NULL;
+    strm_.zfree = Z_NULL;
+    strm_.opaque = Z_NULL;
+    strm_.avail_in = 0;
+    strm_.next_in = Z_NULL;
+    init_ = (inflateInit(&strm_) == Z_OK);
+    return init_;
+  }
+};
+
+thread_local DeflateStream deflate_stream;
+thread_local InflateStream inflate_stream;
+
+}  // namespace
+
 Status GZip::compress(
     int level, ConstBuffer* input_buffer, Buffer* output_buffer) {
   // Sanity check
@@ -45,29 +105,17 @@ Status GZip::compress(
     return LOG_STATUS(Status::CompressionError(
         "Failed compressing with GZip; invalid buffer format"));
 
-  ssize_t ret;
-  z_stream strm;
-
-  // Allocate deflate state
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  ret = deflateInit(&strm, level < 0 ? GZip::default_level() : level);
-
-  if (ret != Z_OK) {
-    (void)deflateEnd(&strm);
+  // Reset the deflate state of this thread
+  if (!deflate_stream.reset(level < 0 ? GZip::default_level() : level))
     return LOG_STATUS(Status::GZipError("Cannot compress with GZIP"));
-  }
+  z_stream& strm = deflate_stream.strm_;
 
   // Compress
   strm.next_in = (unsigned char*)input_buffer->data();
   strm.next_out = (unsigned char*)output_buffer->cur_data();
   strm.avail_in = (uInt)input_buffer->size();
   strm.avail_out = (uInt)output_buffer->free_space();
-  ret = deflate(&strm, Z_FINISH);
-
-  // Clean up
-  (void)deflateEnd(&strm);
+  int ret = deflate(&strm, Z_FINISH);
 
   // Return
   if (ret == Z_STREAM_ERROR || strm.avail_in != 0)
@@ -87,27 +135,17 @@ Status GZip::decompress(ConstBuffer* input_buffer, Buffer* output_buffer) {
     return LOG_STATUS(Status::CompressionError(
         "Failed decompressing with GZip; invalid buffer format"));
 
-  int ret;
-  z_stream strm;
-
-  // Allocate deflate state
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  strm.avail_in = 0;
-  strm.next_in = Z_NULL;
-  ret = inflateInit(&strm);
-
-  if (ret != Z_OK) {
+  // Reset the inflate state of this thread
+  if (!inflate_stream.reset())
     return LOG_STATUS(Status::GZipError("Cannot decompress with GZIP"));
-  }
+  z_stream& strm = inflate_stream.strm_;
 
   // Decompress
   strm.next_in = (unsigned char*)input_buffer->data();
   strm.next_out = (unsigned char*)output_buffer->cur_data();
   strm.avail_in = (uInt)input_buffer->size();
   strm.avail_out = (uInt)output_buffer->free_space();
-  ret = inflate(&strm, Z_FINISH);
+  int ret = inflate(&strm, Z_FINISH);
 
   if (ret != Z_STREAM_END) {
     return LOG_STATUS(
@@ -119,9 +157,6 @@ Status GZip::decompress(ConstBuffer* input_buffer, Buffer* output_buffer) {
   output_buffer->advance_size(compressed_size);
   output_buffer->advance_offset(compressed_size);
 
-  // Clean up
-  (void)inflateEnd(&strm);
-
   // Success
   return Status::Ok();
 }
@@ -31,6 +31,7 @@
  */
 
 #include <lz4.h>
+#include <cstdlib>
 #include <limits>
 
 #include "logger.h"
@@ -38,6 +39,33 @@
 
 namespace tiledb {
 
+#if LZ4_VERSION_NUMBER >= 10705
+namespace {
+
+/**
+ * The compression state of a thread, allocated on first use and reused by
+ * every subsequent call on the same thread.
+ */
+struct LZ4State {
+  void* state_ = nullptr;
+
+  ~LZ4State() {
+    std::free(state_);
+  }
+
+  /** Returns the state, allocating it if needed. */
+  void* get() {
+    if (state_ == nullptr)
+      state_ = std::malloc(LZ4_sizeofState());
+    return state_;
+  }
+};
+
+thread_local LZ4State lz4_state;
+
+}  // namespace
+#endif
+
 Status LZ4::compress(
     int level, ConstBuffer* input_buffer, Buffer* output_buffer) {
   // Sanity check
@@ -49,11 +77,17 @@ Status LZ4::compress(
 
     // Compress
 #if LZ4_VERSION_NUMBER >= 10705
-  int ret = LZ4_compress_default(
+  void* state = lz4_state.get();
+  if (state == nullptr)
+    return LOG_STATUS(Status::CompressionError(
+        "LZ4 compression failed; Cannot allocate state"));
+  int ret = LZ4_compress_fast_extState(
+      state,
       (char*)input_buffer->data(),
       (char*)output_buffer->cur_data(),
       (int)input_buffer->size(),
-      (int)output_buffer->free_space());
+      (int)output_buffer->free_space(),
+      1);
 #else
   // deprecated lz4 api
   int ret = LZ4_compress(
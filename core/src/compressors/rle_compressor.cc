@@ -30,26 +30,223 @@
  * This file implements the rle compressor class.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
 #include "logger.h"
 #include "rle_compressor.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define TILEDB_RLE_X86
+#endif
+
 namespace tiledb {
 
+namespace {
+
+/* ****************************** */
+/*         SCALAR KERNELS         */
+/* ****************************** */
+
+/** The maximum length of a run. */
+const uint64_t max_run_len = 65535;
+
+/**
+ * Given that the first *len* values are equal, returns how many of the first
+ * *value_num* values are equal to the first.
+ */
+uint64_t extend_run(
+    const unsigned char* input,
+    uint64_t value_size,
+    uint64_t len,
+    uint64_t value_num) {
+  const unsigned char* cur = input + len * value_size;
+  while (len < value_num && std::memcmp(cur, input, value_size) == 0) {
+    ++len;
+    cur += value_size;
+  }
+  return len;
+}
+
+/** Returns how many of the first *value_num* values are equal to the first. */
+uint64_t run_len_scalar(
+    const unsigned char* input, uint64_t value_size, uint64_t value_num) {
+  return extend_run(input, value_size, 1, value_num);
+}
+
+/** Writes *run_len* copies of a value to *output*. */
+void fill_scalar(
+    unsigned char* output,
+    const unsigned char* value,
+    uint64_t value_size,
+    uint64_t run_len) {
+  for (uint64_t i = 0; i < run_len; ++i, output += value_size)
+    std::memcpy(output, value, value_size);
+}
+
+#ifdef TILEDB_RLE_X86
+
+/* ****************************** */
+/*          SIMD KERNELS          */
+/* ****************************** */
+
+/** Loads a 1, 2, 4 or 8-byte value zero-extended to 64 bits. */
+uint64_t load_value(const unsigned char* value, uint64_t value_size) {
+  uint64_t v = 0;
+  std::memcpy(&v, value, value_size);
+  return v;
+}
+
+/** Returns a 128-bit vector repeating a 1, 2, 4 or 8-byte value. */
+__m128i broadcast_sse2(const unsigned char* value, uint64_t value_size) {
+  uint64_t v = load_value(value, value_size);
+  switch (value_size) {
+    case 1:
+      return _mm_set1_epi8((char)v);
+    case 2:
+      return _mm_set1_epi16((short)v);
+    case 4:
+      return _mm_set1_epi32((int)v);
+    default:
+      return _mm_set1_epi64x((long long)v);
+  }
+}
+
+/** Returns a 256-bit vector repeating a 1, 2, 4 or 8-byte value. */
+__attribute__((target("avx2"))) __m256i broadcast_avx2(
+    const unsigned char* value, uint64_t value_size) {
+  uint64_t v = load_value(value, value_size);
+  switch (value_size) {
+    case 1:
+      return _mm256_set1_epi8((char)v);
+    case 2:
+      return _mm256_set1_epi16((short)v);
+    case 4:
+      return _mm256_set1_epi32((int)v);
+    default:
+      return _mm256_set1_epi64x((long long)v);
+  }
+}
+
+/** SSE2 version of `run_len_scalar` for 1, 2, 4 or 8-byte values. */
+uint64_t run_len_sse2(
+    const unsigned char* input, uint64_t value_size, uint64_t value_num) {
+  __m128i pattern = broadcast_sse2(input, value_size);
+  uint64_t nbytes = value_num * value_size;
+  uint64_t i = 0;
+  for (; i + 16 <= nbytes; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(input + i));
+    unsigned eq = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, pattern));
+    if (eq != 0xFFFF)
+      return (i + __builtin_ctz(~eq)) / value_size;
+  }
+  return extend_run(input, value_size, i / value_size, value_num);
+}
+
+/** AVX2 version of `run_len_scalar` for 1, 2, 4 or 8-byte values. */
+__attribute__((target("avx2"))) uint64_t run_len_avx2(
+    const unsigned char* input, uint64_t value_size, uint64_t value_num) {
+  __m256i pattern = broadcast_avx2(input, value_size);
+  uint64_t nbytes = value_num * value_size;
+  uint64_t i = 0;
+  for (; i + 32 <= nbytes; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(input + i));
+    unsigned eq =
+        (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern));
+    if (eq != 0xFFFFFFFF)
+      return (i + __builtin_ctz(~eq)) / value_size;
+  }
+  return extend_run(input, value_size, i / value_size, value_num);
+}
+
+/** SSE2 version of `fill_scalar` for 1, 2, 4 or 8-byte values. */
+void fill_sse2(
+    unsigned char* output,
+    const unsigned char* value,
+    uint64_t value_size,
+    uint64_t run_len) {
+  __m128i pattern = broadcast_sse2(value, value_size);
+  uint64_t nbytes = run_len * value_size;
+  uint64_t i = 0;
+  for (; i + 16 <= nbytes; i += 16)
+    _mm_storeu_si128((__m128i*)(output + i), pattern);
+  fill_scalar(output + i, value, value_size, (nbytes - i) / value_size);
+}
+
+/** AVX2 version of `fill_scalar` for 1, 2, 4 or 8-byte values. */
+__attribute__((target("avx2"))) void fill_avx2(
+    unsigned char* output,
+    const unsigned char* value,
+    uint64_t value_size,
+    uint64_t run_len) {
+  __m256i pattern = broadcast_avx2(value, value_size);
+  uint64_t nbytes = run_len * value_size;
+  uint64_t i = 0;
+  for (; i + 32 <= nbytes; i += 32)
+    _mm256_storeu_si256((__m256i*)(output + i), pattern);
+  fill_scalar(output + i, value, value_size, (nbytes - i) / value_size);
+}
+
+#endif
+
+/* ****************************** */
+/*            DISPATCH            */
+/* ****************************** */
+
+typedef uint64_t (*RunLenFunc)(const unsigned char*, uint64_t, uint64_t);
+
+typedef void (*FillFunc)(
+    unsigned char*, const unsigned char*, uint64_t, uint64_t);
+
+/** The kernels used for a value size. */
+struct Kernels {
+  RunLenFunc run_len_;
+  FillFunc fill_;
+};
+
+/**
+ * Picks the kernels for a value size, based on the instructions the CPU
+ * supports. Values of other than 1, 2, 4 or 8 bytes take the scalar path, as
+ * do all values if *simd* is *false*.
+ */
+Kernels kernels(uint64_t value_size, bool simd) {
+  Kernels scalar = {run_len_scalar, fill_scalar};
+#ifdef TILEDB_RLE_X86
+  if (!simd ||
+      (value_size != 1 && value_size != 2 && value_size != 4 &&
+       value_size != 8))
+    return scalar;
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  if (has_avx2)
+    return {run_len_avx2, fill_avx2};
+  return {run_len_sse2, fill_sse2};
+#else
+  (void)value_size;
+  (void)simd;
+  return scalar;
+#endif
+}
+
+}  // namespace
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
 Status RLE::compress(
-    uint64_t value_size, ConstBuffer* input_buffer, Buffer* output_buffer) {
+    uint64_t value_size,
+    ConstBuffer* input_buffer,
+    Buffer* output_buffer,
+    bool simd) {
   // Sanity check
   if (input_buffer->data() == nullptr)
     return LOG_STATUS(Status::CompressionError(
         "Failed compressing with RLE; null input buffer"));
-  unsigned int cur_run_len = 1;
-  unsigned int max_run_len = 65535;
-  auto input_cur = (const unsigned char*)input_buffer->data() + value_size;
-  auto input_prev = (const unsigned char*)input_buffer->data();
+  auto input_cur = (const unsigned char*)input_buffer->data();
   uint64_t value_num = input_buffer->size() / value_size;
-  unsigned char byte;
 
   // Trivial case
   if (value_num == 0)
@@ -61,50 +258,46 @@ Status RLE::compress(
         "Failed compressing with RLE; invalid input buffer format"));
   }
 
+  // Reserve space for the worst case, where all runs have length 1
+  uint64_t run_size = value_size + 2 * sizeof(char);
+  RETURN_NOT_OK(output_buffer->reserve(value_num * run_size));
+  auto output_start = (unsigned char*)output_buffer->cur_data();
+  unsigned char* output_cur = output_start;
+
   // Make runs
-  for (uint64_t i = 1; i < value_num; ++i) {
-    if (std::memcmp(input_cur, input_prev, value_size) == 0 &&
-        cur_run_len < max_run_len) {  // Expand the run
-      ++cur_run_len;
-    } else {  // Save the run
-      // Copy to output buffer
-      RETURN_NOT_OK(output_buffer->write(input_prev, value_size));
-      byte = (unsigned char)(cur_run_len >> 8);
-      RETURN_NOT_OK(output_buffer->write(&byte, sizeof(char)));
-      byte = (unsigned char)(cur_run_len % 256);
-      RETURN_NOT_OK(output_buffer->write(&byte, sizeof(char)));
-
-      // Reset current run length
-      cur_run_len = 1;
-    }
-
-    // Update run info
-    input_prev = input_cur;
-    input_cur = input_prev + value_size;
+  Kernels k = kernels(value_size, simd);
+  while (value_num > 0) {
+    uint64_t run_len =
+        k.run_len_(input_cur, value_size, std::min(value_num, max_run_len));
+
+    // Save the run
+    std::memcpy(output_cur, input_cur, value_size);
+    output_cur[value_size] = (unsigned char)(run_len >> 8);
+    output_cur[value_size + 1] = (unsigned char)(run_len % 256);
+    output_cur += run_size;
+
+    input_cur += run_len * value_size;
+    value_num -= run_len;
   }
 
-  // Save final run
-  RETURN_NOT_OK(output_buffer->write(input_prev, value_size));
-  byte = (unsigned char)(cur_run_len >> 8);
-  RETURN_NOT_OK(output_buffer->write(&byte, sizeof(char)));
-  byte = (unsigned char)(cur_run_len % 256);
-  RETURN_NOT_OK(output_buffer->write(&byte, sizeof(char)));
+  output_buffer->commit(output_cur - output_start);
 
   return Status::Ok();
 }
 
 Status RLE::decompress(
-    uint64_t value_size, ConstBuffer* input_buffer, Buffer* output_buffer) {
+    uint64_t value_size,
+    ConstBuffer* input_buffer,
+    Buffer* output_buffer,
+    bool simd) {
   // Sanity check
   if (input_buffer->data() == nullptr)
     return LOG_STATUS(Status::CompressionError(
         "Failed decompressing with RLE; null input buffer"));
 
-  auto input_cur = static_cast<const unsigned char*>(input_buffer->data());
-  uint64_t run_len;
+  auto input_start = static_cast<const unsigned char*>(input_buffer->data());
   uint64_t run_size = value_size + 2 * sizeof(char);
   uint64_t run_num = input_buffer->size() / run_size;
-  unsigned char byte;
 
   // Trivial case
   if (run_num == 0)
@@ -116,22 +309,27 @@ Status RLE::decompress(
         "Failed decompressing with RLE; invalid input buffer format"));
   }
 
+  // Compute the decompressed size
+  uint64_t value_num = 0;
+  const unsigned char* input_cur = input_start + value_size;
+  for (uint64_t i = 0; i < run_num; ++i, input_cur += run_size)
+    value_num += ((uint64_t)input_cur[0] << 8) + input_cur[1];
+  RETURN_NOT_OK(output_buffer->reserve(value_num * value_size));
+  auto output_start = (unsigned char*)output_buffer->cur_data();
+
   // Decompress runs
-  for (uint64_t i = 0; i < run_num; ++i) {
-    // Retrieve the current run length
-    std::memcpy(&byte, input_cur + value_size, sizeof(char));
-    run_len = (((uint64_t)byte) << 8);
-    std::memcpy(&byte, input_cur + value_size + sizeof(char), sizeof(char));
-    run_len += (uint64_t)byte;
-
-    // Copy to output buffer
-    for (uint64_t j = 0; j < run_len; ++j)
-      RETURN_NOT_OK(output_buffer->write(input_cur, value_size))
-
-    // Update input/output tracking info
-    input_cur += run_size;
+  Kernels k = kernels(value_size, simd);
+  unsigned char* output_cur = output_start;
+  input_cur = input_start;
+  for (uint64_t i = 0; i < run_num; ++i, input_cur += run_size) {
+    uint64_t run_len =
+        ((uint64_t)input_cur[value_size] << 8) + input_cur[value_size + 1];
+    k.fill_(output_cur, input_cur, value_size, run_len);
+    output_cur += run_len * value_size;
   }
 
+  output_buffer->commit(output_cur - output_start);
+
   return Status::Ok();
 }
 
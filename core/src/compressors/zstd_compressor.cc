@@ -32,26 +32,81 @@
 
 #include "zstd_compressor.h"
 #include "logger.h"
+#include "zstd_dictionary.h"
 
 #include <zstd.h>
 #include <iostream>
 
 namespace tiledb {
 
+namespace {
+
+/**
+ * The compression and decompression contexts of a thread. They are created
+ * on first use and reused by every subsequent call on the same thread.
+ */
+struct ZStdContexts {
+  ZSTD_CCtx* cctx_ = nullptr;
+  ZSTD_DCtx* dctx_ = nullptr;
+
+  ~ZStdContexts() {
+    ZSTD_freeCCtx(cctx_);
+    ZSTD_freeDCtx(dctx_);
+  }
+
+  /** Returns the compression context, creating it if needed. */
+  ZSTD_CCtx* cctx() {
+    if (cctx_ == nullptr)
+      cctx_ = ZSTD_createCCtx();
+    return cctx_;
+  }
+
+  /** Returns the decompression context, creating it if needed. */
+  ZSTD_DCtx* dctx() {
+    if (dctx_ == nullptr)
+      dctx_ = ZSTD_createDCtx();
+    return dctx_;
+  }
+};
+
+thread_local ZStdContexts zstd_contexts;
+
+}  // namespace
+
 Status ZStd::compress(
-    int level, ConstBuffer* input_buffer, Buffer* output_buffer) {
+    int level,
+    ConstBuffer* input_buffer,
+    Buffer* output_buffer,
+    const ZStdDictionary* dict) {
   // Sanity check
   if (input_buffer->data() == nullptr || output_buffer->data() == nullptr)
     return LOG_STATUS(Status::CompressionError(
         "Failed compressing with ZStd; invalid buffer format"));
 
+  ZSTD_CCtx* cctx = zstd_contexts.cctx();
+  if (cctx == nullptr)
+    return LOG_STATUS(Status::CompressionError(
+        "ZStd compression failed; Cannot create context"));
+
   // Compress
-  uint64_t zstd_ret = ZSTD_compress(
-      output_buffer->cur_data(),
-      output_buffer->free_space(),
-      input_buffer->data(),
-      input_buffer->size(),
-      level < 0 ? ZStd::default_level() : level);
+  uint64_t zstd_ret;
+  if (dict == nullptr) {
+    zstd_ret = ZSTD_compressCCtx(
+        cctx,
+        output_buffer->cur_data(),
+        output_buffer->free_space(),
+        input_buffer->data(),
+        input_buffer->size(),
+        level < 0 ? ZStd::default_level() : level);
+  } else {
+    zstd_ret = ZSTD_compress_usingCDict(
+        cctx,
+        output_buffer->cur_data(),
+        output_buffer->free_space(),
+        input_buffer->data(),
+        input_buffer->size(),
+        dict->cdict());
+  }
 
   // Handle error
   if (ZSTD_isError(zstd_ret) != 0) {
@@ -67,18 +122,45 @@ Status ZStd::compress(
   return Status::Ok();
 }
 
-Status ZStd::decompress(ConstBuffer* input_buffer, Buffer* output_buffer) {
+Status ZStd::decompress(
+    ConstBuffer* input_buffer,
+    Buffer* output_buffer,
+    const ZStdDictionary* dict) {
   // Sanity check
   if (input_buffer->data() == nullptr || output_buffer->data() == nullptr)
     return LOG_STATUS(Status::CompressionError(
         "Failed decompressing with ZStd; invalid buffer format"));
 
+  // Data compressed with a dictionary record its id
+  unsigned dict_id =
+      ZSTD_getDictID_fromFrame(input_buffer->data(), input_buffer->size());
+  if (dict_id != 0 && (dict == nullptr || dict->id() != dict_id))
+    return LOG_STATUS(Status::CompressionError(
+        "ZStd decompression failed; Dictionary not found"));
+
+  ZSTD_DCtx* dctx = zstd_contexts.dctx();
+  if (dctx == nullptr)
+    return LOG_STATUS(Status::CompressionError(
+        "ZStd decompression failed; Cannot create context"));
+
   // Decompress
-  uint64_t zstd_ret = ZSTD_decompress(
-      output_buffer->cur_data(),
-      output_buffer->free_space(),
-      input_buffer->data(),
-      input_buffer->size());
+  uint64_t zstd_ret;
+  if (dict_id == 0) {
+    zstd_ret = ZSTD_decompressDCtx(
+        dctx,
+        output_buffer->cur_data(),
+        output_buffer->free_space(),
+        input_buffer->data(),
+        input_buffer->size());
+  } else {
+    zstd_ret = ZSTD_decompress_usingDDict(
+        dctx,
+        output_buffer->cur_data(),
+        output_buffer->free_space(),
+        input_buffer->data(),
+        input_buffer->size(),
+        dict->ddict());
+  }
 
   // Check error
   if (ZSTD_isError(zstd_ret) != 0) {
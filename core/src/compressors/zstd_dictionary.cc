@@ -0,0 +1,121 @@
+/**
+ * @file   zstd_dictionary.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class ZStdDictionary.
+ */
+
+#include "zstd_dictionary.h"
+#include "logger.h"
+#include "zstd_compressor.h"
+
+#include <zdict.h>
+#include <zstd.h>
+
+namespace tiledb {
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+ZStdDictionary::ZStdDictionary() {
+  cdict_ = nullptr;
+  ddict_ = nullptr;
+  id_ = 0;
+}
+
+ZStdDictionary::~ZStdDictionary() {
+  ZSTD_freeCDict(cdict_);
+  ZSTD_freeDDict(ddict_);
+}
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+const ZSTD_CDict_s* ZStdDictionary::cdict() const {
+  return cdict_;
+}
+
+const ZSTD_DDict_s* ZStdDictionary::ddict() const {
+  return ddict_;
+}
+
+unsigned ZStdDictionary::id() const {
+  return id_;
+}
+
+Status ZStdDictionary::init(const void* data, uint64_t size, int level) {
+  // A dictionary without an id could not be told apart from no dictionary
+  // when decompressing
+  id_ = ZDICT_getDictID(data, size);
+  if (id_ == 0)
+    return LOG_STATUS(Status::CompressionError(
+        "Cannot load ZStd dictionary; Invalid dictionary"));
+
+  cdict_ = ZSTD_createCDict(
+      data, size, level < 0 ? ZStd::default_level() : level);
+  ddict_ = ZSTD_createDDict(data, size);
+  if (cdict_ == nullptr || ddict_ == nullptr)
+    return LOG_STATUS(Status::CompressionError(
+        "Cannot load ZStd dictionary; Dictionary digestion failed"));
+
+  return Status::Ok();
+}
+
+Status ZStdDictionary::train(
+    const Buffer* samples,
+    const std::vector<size_t>& sample_sizes,
+    uint64_t dict_size,
+    Buffer* dict) {
+  dict->reset_offset();
+  dict->reset_size();
+  if (sample_sizes.empty())
+    return LOG_STATUS(Status::CompressionError(
+        "Cannot train ZStd dictionary; No samples"));
+
+  RETURN_NOT_OK(dict->realloc(dict_size));
+  size_t zdict_ret = ZDICT_trainFromBuffer(
+      dict->data(),
+      dict_size,
+      samples->data(),
+      &sample_sizes[0],
+      (unsigned)sample_sizes.size());
+  if (ZDICT_isError(zdict_ret) != 0) {
+    const char* msg = ZDICT_getErrorName(zdict_ret);
+    return LOG_STATUS(Status::CompressionError(
+        std::string("Cannot train ZStd dictionary: ") + msg));
+  }
+
+  dict->set_size(zdict_ret);
+  dict->set_offset(zdict_ret);
+
+  return Status::Ok();
+}
+
+}  // namespace tiledb
@@ -0,0 +1,467 @@
+/**
+ * @file   disk_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class DiskCache.
+ */
+
+#include "disk_cache.h"
+#include "logger.h"
+#include "posix_filesystem.h"
+#include "utils.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+/*
+ * A block is stored in file "<hash of the file URI>_<block offset>.blk", which
+ * starts with the URI length (uint64_t) and the URI, followed by the data.
+ * The URI disambiguates hash collisions and lets the cache be rebuilt from
+ * the directory. Blocks are written to temporary files and then renamed, so
+ * that a block file is always complete.
+ */
+
+namespace tiledb {
+
+namespace {
+
+/** The suffix of the block files. */
+const char* block_suffix = ".blk";
+
+/** Reads exactly *nbytes* at *offset* from a descriptor. */
+bool pread_all(int fd, uint64_t offset, char* buffer, uint64_t nbytes) {
+  while (nbytes > 0) {
+    ssize_t n = ::pread(fd, buffer, nbytes, offset);
+    if (n <= 0)
+      return false;
+    buffer += n;
+    offset += n;
+    nbytes -= n;
+  }
+  return true;
+}
+
+/** Writes exactly *nbytes* to a descriptor. */
+bool write_all(int fd, const char* buffer, uint64_t nbytes) {
+  while (nbytes > 0) {
+    ssize_t n = ::write(fd, buffer, nbytes);
+    if (n <= 0)
+      return false;
+    buffer += n;
+    nbytes -= n;
+  }
+  return true;
+}
+
+}  // namespace
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+DiskCache::DiskCache(
+    const std::string& dir, uint64_t max_size, uint64_t block_size)
+    : block_size_(block_size)
+    , dir_(dir)
+    , hits_(0)
+    , max_size_(max_size)
+    , misses_(0)
+    , size_(0)
+    , tmp_counter_(0) {
+}
+
+DiskCache::~DiskCache() = default;
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+bool DiskCache::file_size(const URI& uri, uint64_t* size) const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  auto it = file_sizes_.find(uri.to_string());
+  if (it == file_sizes_.end())
+    return false;
+  *size = it->second;
+  return true;
+}
+
+uint64_t DiskCache::hits() const {
+  return hits_;
+}
+
+Status DiskCache::init() {
+  if (block_size_ == 0)
+    return LOG_STATUS(
+        Status::VFSError("Cannot initialize disk cache; Block size is zero"));
+  if (!posix::is_dir(dir_))
+    RETURN_NOT_OK(posix::create_dir(dir_));
+
+  DIR* dir = opendir(dir_.c_str());
+  if (dir == nullptr)
+    return LOG_STATUS(Status::VFSError(
+        std::string("Cannot initialize disk cache; Cannot open directory '") +
+        dir_ + "'"));
+
+  // Pick up the complete blocks, oldest last, and drop the temporary files
+  // left behind by interrupted writes
+  std::vector<std::pair<time_t, Block>> blocks;
+  struct dirent* ent;
+  while ((ent = readdir(dir)) != nullptr) {
+    std::string name = ent->d_name;
+    std::string path = dir_ + "/" + name;
+    if (name.find(".tmp") != std::string::npos) {
+      ::unlink(path.c_str());
+      continue;
+    }
+    uint64_t suffix_size = std::strlen(block_suffix);
+    if (name.size() < suffix_size ||
+        name.compare(name.size() - suffix_size, suffix_size, block_suffix) != 0)
+      continue;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+      continue;
+    struct stat st;
+    uint64_t uri_size = 0;
+    bool valid = fstat(fd, &st) == 0 &&
+                 pread_all(fd, 0, (char*)&uri_size, sizeof(uint64_t)) &&
+                 (uint64_t)st.st_size >= sizeof(uint64_t) + uri_size;
+    Block block;
+    if (valid) {
+      block.uri_.resize(uri_size);
+      valid = pread_all(fd, sizeof(uint64_t), &block.uri_[0], uri_size);
+    }
+    ::close(fd);
+    // The name must start with the hash of the URI
+    if (!valid ||
+        name.compare(0, 17, block_name(block.uri_, 0), 0, 17) != 0) {
+      ::unlink(path.c_str());
+      continue;
+    }
+    block.name_ = name;
+    block.size_ = st.st_size - sizeof(uint64_t) - uri_size;
+    blocks.emplace_back(st.st_mtime, block);
+  }
+  closedir(dir);
+
+  std::sort(
+      blocks.begin(),
+      blocks.end(),
+      [](const std::pair<time_t, Block>& a, const std::pair<time_t, Block>& b) {
+        return a.first > b.first;
+      });
+
+  std::vector<std::string> evicted;
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    for (auto& b : blocks) {
+      lru_.push_back(b.second);
+      index_[b.second.name_] = std::prev(lru_.end());
+      size_ += b.second.size_;
+    }
+    evicted = evict();
+  }
+  for (const auto& path : evicted)
+    ::unlink(path.c_str());
+
+  return Status::Ok();
+}
+
+bool DiskCache::is_immutable(const URI& dir) const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  return immutable_dirs_.count(dir.to_string()) > 0;
+}
+
+bool DiskCache::is_mutable(const URI& dir) const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  auto it = mutable_dirs_.find(dir.to_string());
+  return it != mutable_dirs_.end() &&
+         it->second > std::chrono::steady_clock::now();
+}
+
+uint64_t DiskCache::misses() const {
+  return misses_;
+}
+
+Status DiskCache::read(
+    const URI& uri,
+    uint64_t file_size,
+    uint64_t offset,
+    void* buffer,
+    uint64_t nbytes,
+    const Fetch& fetch) {
+  if (offset + nbytes > file_size)
+    return LOG_STATUS(Status::VFSError(
+        std::string("Cannot read from file '") + uri.to_string() +
+        "'; Read past the end of the file"));
+  if (nbytes == 0)
+    return Status::Ok();
+
+  auto buffer_c = (char*)buffer;
+  uint64_t end = offset + nbytes;
+  uint64_t first = offset / block_size_;
+  uint64_t last = (end - 1) / block_size_;
+  auto block_end = [&](uint64_t b) {
+    return std::min((b + 1) * block_size_, file_size);
+  };
+
+  uint64_t b = first;
+  while (b <= last) {
+    // Serve a cached block
+    uint64_t b_offset = b * block_size_;
+    uint64_t begin = std::max(offset, b_offset);
+    uint64_t len = std::min(end, block_end(b)) - begin;
+    if (read_block(
+            uri,
+            b_offset,
+            block_end(b) - b_offset,
+            begin - b_offset,
+            len,
+            buffer_c + (begin - offset))) {
+      ++hits_;
+      ++b;
+      continue;
+    }
+
+    // Fetch the run of missing blocks with a single request
+    uint64_t run_end = b + 1;
+    while (run_end <= last &&
+           !contains(
+               uri,
+               run_end * block_size_,
+               block_end(run_end) - run_end * block_size_))
+      ++run_end;
+    uint64_t run_offset = b_offset;
+    uint64_t run_size = block_end(run_end - 1) - run_offset;
+    std::vector<char> data(run_size);
+    RETURN_NOT_OK(fetch(run_offset, &data[0], run_size));
+    misses_ += run_end - b;
+
+    // Copy the requested part and cache the blocks
+    begin = std::max(offset, run_offset);
+    len = std::min(end, run_offset + run_size) - begin;
+    std::memcpy(buffer_c + (begin - offset), &data[begin - run_offset], len);
+    for (uint64_t i = b; i < run_end; ++i) {
+      uint64_t i_offset = i * block_size_;
+      store_block(
+          uri,
+          i_offset,
+          &data[i_offset - run_offset],
+          block_end(i) - i_offset);
+    }
+    b = run_end;
+  }
+
+  return Status::Ok();
+}
+
+void DiskCache::remove(const URI& uri) {
+  std::string path = uri.to_string();
+  std::string dir = path + "/";
+  auto matches = [&](const std::string& s) {
+    return s == path || utils::starts_with(s, dir);
+  };
+
+  std::vector<std::string> removed;
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+      if (matches(it->uri_)) {
+        removed.push_back(dir_ + "/" + it->name_);
+        size_ -= it->size_;
+        index_.erase(it->name_);
+        it = lru_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    for (auto it = file_sizes_.begin(); it != file_sizes_.end();)
+      it = matches(it->first) ? file_sizes_.erase(it) : std::next(it);
+    for (auto it = immutable_dirs_.begin(); it != immutable_dirs_.end();)
+      it = matches(*it) ? immutable_dirs_.erase(it) : std::next(it);
+    for (auto it = mutable_dirs_.begin(); it != mutable_dirs_.end();)
+      it = matches(it->first) ? mutable_dirs_.erase(it) : std::next(it);
+  }
+  for (const auto& p : removed)
+    ::unlink(p.c_str());
+}
+
+void DiskCache::set_file_size(const URI& uri, uint64_t size) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  file_sizes_[uri.to_string()] = size;
+}
+
+void DiskCache::set_immutable(const URI& dir) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  immutable_dirs_.insert(dir.to_string());
+  mutable_dirs_.erase(dir.to_string());
+}
+
+void DiskCache::set_mutable(const URI& dir, uint64_t ttl) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  // Expired marks are purged here, so that they do not accumulate
+  auto now = std::chrono::steady_clock::now();
+  for (auto it = mutable_dirs_.begin(); it != mutable_dirs_.end();)
+    it = (it->second <= now) ? mutable_dirs_.erase(it) : std::next(it);
+  mutable_dirs_[dir.to_string()] = now + std::chrono::milliseconds(ttl);
+}
+
+uint64_t DiskCache::size() const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  return size_;
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+std::string DiskCache::block_name(const std::string& uri, uint64_t offset) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : uri) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ULL;
+  }
+  char name[64];
+  std::snprintf(
+      name,
+      sizeof(name),
+      "%016" PRIx64 "_%" PRIu64 "%s",
+      hash,
+      offset,
+      block_suffix);
+  return name;
+}
+
+bool DiskCache::contains(const URI& uri, uint64_t offset, uint64_t size) const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  auto it = index_.find(block_name(uri.to_string(), offset));
+  return it != index_.end() && it->second->uri_ == uri.to_string() &&
+         it->second->size_ == size;
+}
+
+std::vector<std::string> DiskCache::evict() {
+  std::vector<std::string> evicted;
+  while (size_ > max_size_ && !lru_.empty()) {
+    const Block& block = lru_.back();
+    evicted.push_back(dir_ + "/" + block.name_);
+    size_ -= block.size_;
+    index_.erase(block.name_);
+    lru_.pop_back();
+  }
+  return evicted;
+}
+
+bool DiskCache::read_block(
+    const URI& uri,
+    uint64_t offset,
+    uint64_t size,
+    uint64_t begin,
+    uint64_t nbytes,
+    char* buffer) {
+  std::string uri_str = uri.to_string();
+  std::string name = block_name(uri_str, offset);
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    auto it = index_.find(name);
+    if (it == index_.end() || it->second->uri_ != uri_str ||
+        it->second->size_ != size)
+      return false;
+    lru_.splice(lru_.begin(), lru_, it->second);
+  }
+
+  // The block may be evicted concurrently, in which case this is a miss
+  std::string path = dir_ + "/" + name;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+  bool ok = pread_all(
+      fd, sizeof(uint64_t) + uri_str.size() + begin, buffer, nbytes);
+  ::close(fd);
+  return ok;
+}
+
+void DiskCache::store_block(
+    const URI& uri, uint64_t offset, const char* data, uint64_t size) {
+  // A block larger than the whole budget would be evicted right away
+  if (size > max_size_)
+    return;
+
+  std::string uri_str = uri.to_string();
+  std::string name = block_name(uri_str, offset);
+  std::string path = dir_ + "/" + name;
+  std::string tmp_path = path + ".tmp" + std::to_string(getpid()) + "_" +
+                         std::to_string(tmp_counter_++);
+
+  // Write the block to a temporary file
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU);
+  if (fd == -1)
+    return;
+  uint64_t uri_size = uri_str.size();
+  bool ok = write_all(fd, (const char*)&uri_size, sizeof(uint64_t)) &&
+            write_all(fd, uri_str.data(), uri_size) &&
+            write_all(fd, data, size);
+  ok = (::close(fd) == 0) && ok;
+  if (!ok) {
+    ::unlink(tmp_path.c_str());
+    return;
+  }
+
+  // Publish it, replacing a stale block with the same name
+  std::vector<std::string> evicted;
+  {
+    std::unique_lock<std::mutex> lck(mtx_);
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      ::unlink(tmp_path.c_str());
+      return;
+    }
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+      size_ -= it->second->size_;
+      lru_.erase(it->second);
+    }
+    Block block;
+    block.name_ = name;
+    block.size_ = size;
+    block.uri_ = uri_str;
+    lru_.push_front(block);
+    index_[name] = lru_.begin();
+    size_ += size;
+    evicted = evict();
+  }
+  for (const auto& p : evicted)
+    ::unlink(p.c_str());
+}
+
+}  // namespace tiledb
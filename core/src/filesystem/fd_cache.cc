@@ -0,0 +1,237 @@
+/**
+ * @file   fd_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class FDCache.
+ */
+
+#include "fd_cache.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace tiledb {
+
+/* ****************************** */
+/*          CACHE ENTRY           */
+/* ****************************** */
+
+struct FDCache::Entry {
+  /** Constructor. */
+  explicit Entry(const std::string& path)
+      : path_(path)
+      , read_fd_(-1)
+      , append_fd_(-1)
+      , pins_(0)
+      , detached_(false) {
+  }
+
+  /** The file path. */
+  std::string path_;
+
+  /** The read-only descriptor (-1 if not open). */
+  int read_fd_;
+
+  /** The append descriptor (-1 if not open). */
+  int append_fd_;
+
+  /** Number of `acquire` calls not yet released. */
+  uint64_t pins_;
+
+  /** *True* if the entry was removed from the cache while pinned. */
+  bool detached_;
+
+  /** Serializes opening the entry's descriptors. */
+  std::mutex mtx_;
+
+  /** The position of the entry in the LRU list. */
+  std::list<Entry*>::iterator lru_it_;
+};
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+FDCache::FDCache(uint64_t capacity)
+    : capacity_(capacity)
+    , hits_(0)
+    , misses_(0) {
+}
+
+FDCache::~FDCache() {
+  for (auto entry : lru_)
+    destroy(entry);
+}
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+Status FDCache::acquire(
+    const std::string& path, Mode mode, Entry** entry, int* fd) {
+  // Find or create the entry, and pin it
+  mtx_.lock();
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    *entry = it->second;
+    lru_.splice(lru_.begin(), lru_, (*entry)->lru_it_);
+  } else {
+    *entry = new Entry(path);
+    lru_.push_front(*entry);
+    (*entry)->lru_it_ = lru_.begin();
+    entries_[path] = *entry;
+  }
+  ++(*entry)->pins_;
+  evict();
+  mtx_.unlock();
+
+  // Open the descriptor if needed
+  std::unique_lock<std::mutex> entry_lck((*entry)->mtx_);
+  int* entry_fd =
+      (mode == Mode::READ) ? &(*entry)->read_fd_ : &(*entry)->append_fd_;
+  if (*entry_fd != -1) {
+    ++hits_;
+  } else {
+    ++misses_;
+    if (mode == Mode::READ)
+      *entry_fd = ::open(path.c_str(), O_RDONLY);
+    else
+      *entry_fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, S_IRWXU);
+    if (*entry_fd == -1) {
+      std::string errmsg = strerror(errno);
+      entry_lck.unlock();
+      release(*entry);
+      *entry = nullptr;
+      return LOG_STATUS(Status::IOError(
+          std::string("Cannot open file '") + path + "'; " + errmsg));
+    }
+  }
+
+  *fd = *entry_fd;
+  return Status::Ok();
+}
+
+Status FDCache::close(const std::string& path) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  auto it = entries_.find(path);
+  if (it == entries_.end())
+    return Status::Ok();
+  return detach(it->second);
+}
+
+Status FDCache::close_path(const std::string& path) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  std::string dir = path + "/";
+  std::vector<Entry*> to_close;
+  for (auto& e : entries_) {
+    if (e.first == path || utils::starts_with(e.first, dir))
+      to_close.push_back(e.second);
+  }
+
+  Status st;
+  for (auto entry : to_close) {
+    Status st_close = detach(entry);
+    if (st.ok())
+      st = st_close;
+  }
+
+  return st;
+}
+
+uint64_t FDCache::hits() const {
+  return hits_;
+}
+
+uint64_t FDCache::misses() const {
+  return misses_;
+}
+
+void FDCache::release(Entry* entry) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  if (--entry->pins_ > 0)
+    return;
+  if (entry->detached_)
+    destroy(entry);
+  else
+    evict();
+}
+
+uint64_t FDCache::size() const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  return entries_.size();
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+Status FDCache::detach(Entry* entry) {
+  entries_.erase(entry->path_);
+  lru_.erase(entry->lru_it_);
+  entry->detached_ = true;
+
+  if (entry->pins_ == 0)
+    return destroy(entry);
+  return Status::Ok();
+}
+
+Status FDCache::destroy(Entry* entry) {
+  bool ok = true;
+  if (entry->read_fd_ != -1 && ::close(entry->read_fd_) != 0)
+    ok = false;
+  if (entry->append_fd_ != -1 && ::close(entry->append_fd_) != 0)
+    ok = false;
+  std::string path = entry->path_;
+  delete entry;
+
+  if (!ok)
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot close file '") + path + "'; " + strerror(errno)));
+  return Status::Ok();
+}
+
+void FDCache::evict() {
+  auto it = lru_.end();
+  while (entries_.size() > capacity_ && it != lru_.begin()) {
+    --it;
+    auto entry = *it;
+    if (entry->pins_ > 0)
+      continue;
+    it = lru_.erase(it);
+    entries_.erase(entry->path_);
+    destroy(entry);
+  }
+}
+
+}  // namespace tiledb
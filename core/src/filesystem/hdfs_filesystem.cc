@@ -123,6 +123,23 @@ Status move_path(hdfsFS fs, const URI& old_uri, const URI& new_uri) {
   return Status::Ok();
 }
 
+Status move_file_no_replace(
+    hdfsFS fs, const URI& old_uri, const URI& new_uri, bool* moved) {
+  int ret =
+      hdfsRename(fs, old_uri.to_path().c_str(), new_uri.to_path().c_str());
+  if (ret < 0) {
+    if (hdfsExists(fs, new_uri.to_path().c_str()) == 0) {
+      *moved = false;
+      return Status::Ok();
+    }
+    return LOG_STATUS(Status::IOError(
+        "Error moving file " + old_uri.to_string() + " to " +
+        new_uri.to_string()));
+  }
+  *moved = true;
+  return Status::Ok();
+}
+
 bool is_dir(hdfsFS fs, const URI& uri) {
   int exists = hdfsExists(fs, uri.to_path().c_str());
   if (exists == 0) {  // success
@@ -285,6 +302,15 @@ Status write_to_file(
 
 // List all subdirectories and files for a given path, appending them to paths.
 Status ls(hdfsFS fs, const URI& uri, std::vector<std::string>* paths) {
+  std::vector<bool> is_dirs;
+  return ls_with_types(fs, uri, paths, &is_dirs);
+}
+
+Status ls_with_types(
+    hdfsFS fs,
+    const URI& uri,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs) {
   int numEntries = 0;
   hdfsFileInfo* fileList =
       hdfsListDirectory(fs, uri.to_path().c_str(), &numEntries);
@@ -300,6 +326,7 @@ Status ls(hdfsFS fs, const URI& uri, std::vector<std::string>* paths) {
       path = std::string("hdfs://") + path;
     }
     paths->push_back(path);
+    is_dirs->push_back((char)(fileList[i].mKind) == 'D');
   }
   hdfsFreeFileInfo(fileList, numEntries);
   return Status::Ok();
@@ -0,0 +1,91 @@
+/**
+ * @file   io_engine.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements classes IOBatch and IOEngine.
+ */
+
+#include "io_engine.h"
+#include "constants.h"
+#include "thread_pool_io_engine.h"
+#include "uring_io_engine.h"
+
+namespace tiledb {
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+IOBatch::IOBatch()
+    : pending_(0) {
+}
+
+IOBatch::~IOBatch() = default;
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+void IOBatch::complete(const Status& st) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  if (!st.ok() && status_.ok())
+    status_ = st;
+  if (--pending_ == 0)
+    cv_.notify_all();
+}
+
+void IOBatch::expect(uint64_t n) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  pending_ += n;
+}
+
+uint64_t IOBatch::pending() const {
+  std::unique_lock<std::mutex> lck(mtx_);
+  return pending_;
+}
+
+Status IOBatch::wait() {
+  std::unique_lock<std::mutex> lck(mtx_);
+  cv_.wait(lck, [this]() { return pending_ == 0; });
+  Status st = status_;
+  status_ = Status::Ok();
+  return st;
+}
+
+IOEngine* IOEngine::create(unsigned queue_depth, unsigned thread_num) {
+#ifdef HAVE_IO_URING
+  auto uring = new UringIOEngine();
+  if (uring->init(queue_depth).ok())
+    return uring;
+  delete uring;
+#endif
+
+  return new ThreadPoolIOEngine(thread_num);
+}
+
+}  // namespace tiledb
@@ -0,0 +1,502 @@
+/**
+ * @file   mem_filesystem.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file includes definitions of in-memory filesystem functions.
+ */
+
+#include "mem_filesystem.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace tiledb {
+
+namespace mem {
+
+/* ****************************** */
+/*        TYPE DEFINITIONS        */
+/* ****************************** */
+
+namespace {
+
+/** A stripe of the file contents table. */
+struct Stripe {
+  /** Protects the stripe. */
+  std::mutex mtx_;
+
+  /** The contents of the files of the stripe, indexed by path. */
+  std::unordered_map<std::string, std::vector<char>> files_;
+};
+
+/** The state of an in-process file lock. */
+struct Filelock {
+  /** Number of shared holders. */
+  uint64_t shared_;
+
+  /** *True* if held exclusively. */
+  bool exclusive_;
+};
+
+/** The process-wide state of the in-memory filesystem. */
+struct Filesystem {
+  /** Number of stripes of the file contents table. */
+  static const unsigned STRIPE_NUM = 64;
+
+  /**
+   * The namespace, mapping every path to *true* for directories and *false*
+   * for files. The root (empty path) is implicit. Lock order: the namespace
+   * before any stripe.
+   */
+  std::map<std::string, bool> entries_;
+
+  /** Protects the namespace. */
+  std::mutex entries_mtx_;
+
+  /** The file contents table. */
+  Stripe stripes_[STRIPE_NUM];
+
+  /** Signals released file locks. */
+  std::condition_variable lock_cv_;
+
+  /** The handles of the held file locks, mapped to (path, shared). */
+  std::unordered_map<int, std::pair<std::string, bool>> lock_handles_;
+
+  /** Protects the file locks. */
+  std::mutex lock_mtx_;
+
+  /** The held file locks, indexed by path. */
+  std::unordered_map<std::string, Filelock> locks_;
+
+  /** The next file lock handle. */
+  int next_lock_handle_ = 0;
+
+  /** Returns the stripe holding a path. */
+  Stripe& stripe(const std::string& path) {
+    return stripes_[std::hash<std::string>()(path) % STRIPE_NUM];
+  }
+};
+
+/** Returns the filesystem. */
+Filesystem& fs() {
+  static Filesystem fs;
+  return fs;
+}
+
+/** Returns the path of a URI without the scheme and trailing slashes. */
+std::string mem_path(const URI& uri) {
+  std::string path = uri.to_path();
+  while (!path.empty() && path.back() == '/')
+    path.pop_back();
+  return path;
+}
+
+/** Returns the parent of a path. */
+std::string parent(const std::string& path) {
+  auto pos = path.find_last_of('/');
+  return (pos == std::string::npos) ? "" : path.substr(0, pos);
+}
+
+/** Returns the URI of a path. */
+std::string mem_uri(const std::string& path) {
+  return "mem://" + path;
+}
+
+/** Checks if a path is a directory. The caller holds the namespace lock. */
+bool is_dir_locked(const std::string& path) {
+  if (path.empty())
+    return true;
+  auto it = fs().entries_.find(path);
+  return it != fs().entries_.end() && it->second;
+}
+
+/** Creates a file. The caller holds the namespace lock. */
+Status create_file_locked(const std::string& path) {
+  auto& entries = fs().entries_;
+  auto it = entries.find(path);
+  if (it != entries.end()) {
+    if (it->second)
+      return LOG_STATUS(Status::IOError(
+          std::string("Cannot create file '") + mem_uri(path) +
+          "'; A directory with the same name exists"));
+    return Status::Ok();
+  }
+  if (path.empty() || !is_dir_locked(parent(path)))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot create file '") + mem_uri(path) +
+        "'; Parent directory does not exist"));
+
+  entries[path] = false;
+  auto& stripe = fs().stripe(path);
+  std::unique_lock<std::mutex> lck(stripe.mtx_);
+  stripe.files_[path];
+
+  return Status::Ok();
+}
+
+/**
+ * Moves the contents of a file across stripes, one stripe at a time. The
+ * caller holds the namespace lock.
+ */
+void move_contents(const std::string& old_path, const std::string& new_path) {
+  std::vector<char> contents;
+  auto& old_stripe = fs().stripe(old_path);
+  old_stripe.mtx_.lock();
+  contents.swap(old_stripe.files_[old_path]);
+  old_stripe.files_.erase(old_path);
+  old_stripe.mtx_.unlock();
+  auto& new_stripe = fs().stripe(new_path);
+  new_stripe.mtx_.lock();
+  new_stripe.files_[new_path].swap(contents);
+  new_stripe.mtx_.unlock();
+}
+
+/**
+ * Removes a path and everything under it. The caller holds the namespace
+ * lock.
+ */
+void remove_locked(const std::string& path) {
+  auto& entries = fs().entries_;
+  auto remove = [&](std::map<std::string, bool>::iterator it) {
+    if (!it->second) {
+      auto& stripe = fs().stripe(it->first);
+      std::unique_lock<std::mutex> lck(stripe.mtx_);
+      stripe.files_.erase(it->first);
+    }
+    return entries.erase(it);
+  };
+
+  // Siblings such as "a-1" or "a.b" sort between "a" and "a/...", so the
+  // path and the entries under it are looked up separately
+  auto it = entries.find(path);
+  if (it != entries.end())
+    remove(it);
+  std::string prefix = path + "/";
+  it = entries.lower_bound(prefix);
+  while (it != entries.end() && utils::starts_with(it->first, prefix))
+    it = remove(it);
+}
+
+}  // namespace
+
+/* ****************************** */
+/*            FUNCTIONS           */
+/* ****************************** */
+
+Status create_dir(const URI& uri) {
+  std::string p = mem_path(uri);
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  if (p.empty() || fs().entries_.count(p))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot create directory '") + uri.to_string() +
+        "'; Directory already exists"));
+  if (!is_dir_locked(parent(p)))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot create directory '") + uri.to_string() +
+        "'; Parent directory does not exist"));
+
+  fs().entries_[p] = true;
+  return Status::Ok();
+}
+
+Status create_file(const URI& uri) {
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  return create_file_locked(mem_path(uri));
+}
+
+Status file_size(const URI& uri, uint64_t* nbytes) {
+  std::string p = mem_path(uri);
+  auto& stripe = fs().stripe(p);
+  std::unique_lock<std::mutex> lck(stripe.mtx_);
+  auto it = stripe.files_.find(p);
+  if (it == stripe.files_.end())
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot get size of file '") + uri.to_string() +
+        "'; File does not exist"));
+
+  *nbytes = it->second.size();
+  return Status::Ok();
+}
+
+Status filelock_lock(const URI& uri, int* fd, bool shared) {
+  if (!is_file(uri))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot lock file '") + uri.to_string() +
+        "'; File does not exist"));
+
+  std::string p = mem_path(uri);
+  auto& f = fs();
+  std::unique_lock<std::mutex> lck(f.lock_mtx_);
+  f.lock_cv_.wait(lck, [&]() {
+    auto it = f.locks_.find(p);
+    if (it == f.locks_.end())
+      return true;
+    return !it->second.exclusive_ && (shared || it->second.shared_ == 0);
+  });
+
+  auto& filelock = f.locks_[p];
+  if (shared)
+    ++filelock.shared_;
+  else
+    filelock.exclusive_ = true;
+  *fd = f.next_lock_handle_++;
+  f.lock_handles_[*fd] = std::make_pair(p, shared);
+
+  return Status::Ok();
+}
+
+Status filelock_unlock(int fd) {
+  auto& f = fs();
+  std::unique_lock<std::mutex> lck(f.lock_mtx_);
+  auto it = f.lock_handles_.find(fd);
+  if (it == f.lock_handles_.end())
+    return LOG_STATUS(
+        Status::IOError("Cannot unlock file; Invalid lock handle"));
+
+  auto& filelock = f.locks_[it->second.first];
+  if (it->second.second)
+    --filelock.shared_;
+  else
+    filelock.exclusive_ = false;
+  if (filelock.shared_ == 0 && !filelock.exclusive_)
+    f.locks_.erase(it->second.first);
+  f.lock_handles_.erase(it);
+  f.lock_cv_.notify_all();
+
+  return Status::Ok();
+}
+
+bool is_dir(const URI& uri) {
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  return is_dir_locked(mem_path(uri));
+}
+
+bool is_file(const URI& uri) {
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  auto it = fs().entries_.find(mem_path(uri));
+  return it != fs().entries_.end() && !it->second;
+}
+
+Status ls(const URI& uri, std::vector<std::string>* paths) {
+  std::vector<bool> is_dirs;
+  return ls_with_types(uri, paths, &is_dirs);
+}
+
+Status ls_with_types(
+    const URI& uri,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs) {
+  std::string p = mem_path(uri);
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  if (!is_dir_locked(p))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot list directory '") + uri.to_string() +
+        "'; Directory does not exist"));
+
+  // Entries under the directory are contiguous in the ordered namespace
+  auto& entries = fs().entries_;
+  std::string prefix = p.empty() ? "" : p + "/";
+  for (auto it = entries.lower_bound(prefix);
+       it != entries.end() && utils::starts_with(it->first, prefix);
+       ++it) {
+    if (it->first.find('/', prefix.size()) == std::string::npos) {
+      paths->push_back(mem_uri(it->first));
+      is_dirs->push_back(it->second);
+    }
+  }
+
+  return Status::Ok();
+}
+
+Status move_path(const URI& old_uri, const URI& new_uri) {
+  std::string old_path = mem_path(old_uri);
+  std::string new_path = mem_path(new_uri);
+  std::string old_prefix = old_path + "/";
+  auto& entries = fs().entries_;
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+
+  // Check the source and target
+  auto old_it = entries.find(old_path);
+  if (old_it == entries.end())
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot move path '") + old_uri.to_string() +
+        "'; Path does not exist"));
+  if (new_path == old_path)
+    return Status::Ok();
+  if (utils::starts_with(new_path, old_prefix) ||
+      !is_dir_locked(parent(new_path)))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot move path '") + old_uri.to_string() + "' to '" +
+        new_uri.to_string() + "'; Invalid target"));
+  auto new_it = entries.find(new_path);
+  if (new_it != entries.end()) {
+    std::string new_prefix = new_path + "/";
+    auto next = entries.lower_bound(new_prefix);
+    if (new_it->second && next != entries.end() &&
+        utils::starts_with(next->first, new_prefix))
+      return LOG_STATUS(Status::IOError(
+          std::string("Cannot move path '") + old_uri.to_string() + "' to '" +
+          new_uri.to_string() + "'; Directory not empty"));
+    remove_locked(new_path);
+  }
+
+  // Re-key the path and everything under it
+  std::vector<std::pair<std::string, bool>> moved;
+  moved.emplace_back(old_it->first, old_it->second);
+  entries.erase(old_it);
+  for (auto it = entries.lower_bound(old_prefix);
+       it != entries.end() && utils::starts_with(it->first, old_prefix);) {
+    moved.emplace_back(it->first, it->second);
+    it = entries.erase(it);
+  }
+  for (auto& m : moved) {
+    std::string moved_path = new_path + m.first.substr(old_path.size());
+    entries[moved_path] = m.second;
+    if (!m.second)
+      move_contents(m.first, moved_path);
+  }
+
+  return Status::Ok();
+}
+
+Status move_file_no_replace(
+    const URI& old_uri, const URI& new_uri, bool* moved) {
+  std::string old_path = mem_path(old_uri);
+  std::string new_path = mem_path(new_uri);
+  auto& entries = fs().entries_;
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+
+  auto old_it = entries.find(old_path);
+  if (old_it == entries.end() || old_it->second)
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot move file '") + old_uri.to_string() +
+        "'; File does not exist"));
+  if (entries.count(new_path) > 0) {
+    *moved = false;
+    return Status::Ok();
+  }
+  if (!is_dir_locked(parent(new_path)))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot move file '") + old_uri.to_string() + "' to '" +
+        new_uri.to_string() + "'; Invalid target"));
+
+  entries.erase(old_it);
+  entries[new_path] = false;
+  move_contents(old_path, new_path);
+  *moved = true;
+
+  return Status::Ok();
+}
+
+Status read_from_file(
+    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) {
+  std::string p = mem_path(uri);
+  auto& stripe = fs().stripe(p);
+  std::unique_lock<std::mutex> lck(stripe.mtx_);
+  auto it = stripe.files_.find(p);
+  if (it == stripe.files_.end())
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot read from file '") + uri.to_string() +
+        "'; File does not exist"));
+  auto& contents = it->second;
+  if (offset > contents.size() || nbytes > contents.size() - offset)
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot read from file '") + uri.to_string() +
+        "'; Read exceeds file size"));
+
+  if (nbytes > 0)
+    std::memcpy(buffer, &contents[offset], nbytes);
+  return Status::Ok();
+}
+
+Status remove_file(const URI& uri) {
+  std::string p = mem_path(uri);
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  auto it = fs().entries_.find(p);
+  if (it == fs().entries_.end() || it->second)
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot remove file '") + uri.to_string() +
+        "'; File does not exist"));
+
+  remove_locked(p);
+  return Status::Ok();
+}
+
+Status remove_path(const URI& uri) {
+  std::string p = mem_path(uri);
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  if (p.empty() || !fs().entries_.count(p))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot remove path '") + uri.to_string() +
+        "'; Path does not exist"));
+
+  remove_locked(p);
+  return Status::Ok();
+}
+
+Status sync(const URI& uri) {
+  std::string p = mem_path(uri);
+  std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+  if (!p.empty() && !fs().entries_.count(p))
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot sync path '") + uri.to_string() +
+        "'; Path does not exist"));
+
+  return Status::Ok();
+}
+
+Status write_to_file(
+    const URI& uri, const void* buffer, uint64_t buffer_size) {
+  std::string p = mem_path(uri);
+  auto& stripe = fs().stripe(p);
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lck(stripe.mtx_);
+      auto it = stripe.files_.find(p);
+      if (it != stripe.files_.end()) {
+        auto data = static_cast<const char*>(buffer);
+        it->second.insert(it->second.end(), data, data + buffer_size);
+        return Status::Ok();
+      }
+    }
+
+    // Appending to a missing file creates it
+    std::unique_lock<std::mutex> lck(fs().entries_mtx_);
+    RETURN_NOT_OK(create_file_locked(p));
+  }
+}
+
+}  // namespace mem
+
+}  // namespace tiledb
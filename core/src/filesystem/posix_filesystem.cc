@@ -36,6 +36,8 @@
 #include "utils.h"
 
 #include <dirent.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <ftw.h>
 
@@ -178,11 +180,20 @@ Status file_size(const std::string& path, uint64_t* size) {
         Status::IOError("Cannot get file size; File opening error"));
   }
 
+  Status st = file_size(fd, size);
+
+  close(fd);
+  return st;
+}
+
+Status file_size(int fd, uint64_t* size) {
   struct stat st = {};
-  fstat(fd, &st);
+  if (fstat(fd, &st) != 0) {
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot get file size; ") + strerror(errno)));
+  }
   *size = (uint64_t)st.st_size;
 
-  close(fd);
   return Status::Ok();
 }
 
@@ -247,6 +258,50 @@ Status ls(const std::string& path, std::vector<std::string>* paths) {
   return Status::Ok();
 }
 
+Status ls_with_types(
+    const std::string& path,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs) {
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot list directory '") + path + "'; " +
+        strerror(errno)));
+  }
+  struct dirent* next_path;
+  while ((next_path = readdir(dir)) != nullptr) {
+    const char* name = next_path->d_name;
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+      continue;
+    bool is_dir = next_path->d_type == DT_DIR;
+    // Not all filesystems fill in the type
+    if (next_path->d_type == DT_UNKNOWN || next_path->d_type == DT_LNK) {
+      struct stat st;
+      is_dir = fstatat(dirfd(dir), name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+    }
+    paths->push_back(path + "/" + name);
+    is_dirs->push_back(is_dir);
+  }
+  if (closedir(dir) != 0) {
+    return LOG_STATUS(Status::IOError(
+        std::string("Cannot close parent directory; ") + strerror(errno)));
+  }
+  return Status::Ok();
+}
+
+Status map_file(int fd, uint64_t size, void** data) {
+  if (size == 0)
+    return LOG_STATUS(Status::IOError("Cannot map file; File is empty"));
+
+  *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (*data == MAP_FAILED) {
+    *data = nullptr;
+    return LOG_STATUS(
+        Status::IOError(std::string("Cannot map file; ") + strerror(errno)));
+  }
+  return Status::Ok();
+}
+
 Status move_path(const std::string& old_path, const std::string& new_path) {
   if (rename(old_path.c_str(), new_path.c_str()) != 0) {
     return LOG_STATUS(
@@ -255,6 +310,21 @@ Status move_path(const std::string& old_path, const std::string& new_path) {
   return Status::Ok();
 }
 
+Status move_file_no_replace(
+    const std::string& old_path, const std::string& new_path, bool* moved) {
+  // Unlike renaming, linking fails if the new path exists
+  if (link(old_path.c_str(), new_path.c_str()) != 0) {
+    if (errno == EEXIST) {
+      *moved = false;
+      return Status::Ok();
+    }
+    return LOG_STATUS(
+        Status::IOError(std::string("Cannot move file: ") + strerror(errno)));
+  }
+  *moved = true;
+  return remove_file(old_path);
+}
+
 void purge_dots_from_path(std::string* path) {
   // Trivial case
   if (path == nullptr)
@@ -318,12 +388,10 @@ Status read_from_file(
         Status::IOError("Cannot read from file; File opening error"));
   }
   // Read
-  lseek(fd, offset, SEEK_SET);
-  int64_t bytes_read = ::read(fd, buffer, nbytes);
-  if (bytes_read != int64_t(nbytes)) {
-    return LOG_STATUS(Status::IOError(
-        std::string("Cannot read from file '") + path.c_str() +
-        "'; File reading error"));
+  Status st = read_from_file(fd, offset, buffer, nbytes);
+  if (!st.ok()) {
+    close(fd);
+    return st;
   }
   // Close file
   if (close(fd)) {
@@ -333,6 +401,48 @@ Status read_from_file(
   return Status::Ok();
 }
 
+Status read_from_file(int fd, uint64_t offset, void* buffer, uint64_t nbytes) {
+  // Positional reads may return fewer bytes than requested
+  auto buffer_c = (char*)buffer;
+  while (nbytes > 0) {
+    ssize_t bytes_read = ::pread(fd, buffer_c, nbytes, offset);
+    if (bytes_read == -1 && errno == EINTR)
+      continue;
+    if (bytes_read <= 0)
+      return LOG_STATUS(
+          Status::IOError("Cannot read from file; File reading error"));
+    buffer_c += bytes_read;
+    offset += bytes_read;
+    nbytes -= bytes_read;
+  }
+  return Status::Ok();
+}
+
+Status read_from_file(int fd, uint64_t offset, struct iovec* iov, int iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t bytes_read = ::preadv(fd, iov, iovcnt, offset);
+    if (bytes_read == -1 && errno == EINTR)
+      continue;
+    if (bytes_read <= 0)
+      return LOG_STATUS(
+          Status::IOError("Cannot read from file; File reading error"));
+    offset += bytes_read;
+
+    // Skip the filled buffers and resume a partially filled one
+    auto remaining = (uint64_t)bytes_read;
+    while (iovcnt > 0 && remaining >= iov->iov_len) {
+      remaining -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (char*)iov->iov_base + remaining;
+      iov->iov_len -= remaining;
+    }
+  }
+  return Status::Ok();
+}
+
 Status sync(const std::string& path) {
   // Open file
   int fd = -1;
@@ -351,6 +461,7 @@ Status sync(const std::string& path) {
 
   // Sync
   if (fsync(fd) != 0) {
+    close(fd);
     return LOG_STATUS(Status::IOError(
         std::string("Cannot sync file '") + path + "'; File syncing error"));
   }
@@ -365,6 +476,22 @@ Status sync(const std::string& path) {
   return Status::Ok();
 }
 
+Status sync(int fd) {
+  if (fsync(fd) != 0) {
+    return LOG_STATUS(
+        Status::IOError("Cannot sync file; File syncing error"));
+  }
+  return Status::Ok();
+}
+
+Status unmap_file(void* data, uint64_t size) {
+  if (munmap(data, size) != 0) {
+    return LOG_STATUS(
+        Status::IOError(std::string("Cannot unmap file; ") + strerror(errno)));
+  }
+  return Status::Ok();
+}
+
 Status write_to_file(
     const std::string& path, const void* buffer, uint64_t buffer_size) {
   // Open file
@@ -375,23 +502,11 @@ Status write_to_file(
         "'; File opening error"));
   }
 
-  // Append data to the file in batches of constants::max_write_bytes
-  // bytes at a time
-  int64_t bytes_written;
-  while (buffer_size > constants::max_write_bytes) {
-    bytes_written = ::write(fd, buffer, constants::max_write_bytes);
-    if (bytes_written != constants::max_write_bytes) {
-      return LOG_STATUS(Status::IOError(
-          std::string("Cannot write to file '") + path +
-          "'; File writing error"));
-    }
-    buffer_size -= constants::max_write_bytes;
-  }
-  bytes_written = ::write(fd, buffer, buffer_size);
-  if (bytes_written != int64_t(buffer_size)) {
-    return LOG_STATUS(Status::IOError(
-        std::string("Cannot write to file '") + path +
-        "'; File writing error"));
+  // Write
+  Status st = write_to_file(fd, buffer, buffer_size);
+  if (!st.ok()) {
+    close(fd);
+    return st;
   }
 
   // Close file
@@ -405,6 +520,28 @@ Status write_to_file(
   return Status::Ok();
 }
 
+Status write_to_file(int fd, const void* buffer, uint64_t buffer_size) {
+  // Append data to the file in batches of constants::max_write_bytes
+  // bytes at a time
+  auto buffer_c = (const char*)buffer;
+  int64_t bytes_written;
+  while (buffer_size > constants::max_write_bytes) {
+    bytes_written = ::write(fd, buffer_c, constants::max_write_bytes);
+    if (bytes_written != constants::max_write_bytes)
+      return LOG_STATUS(
+          Status::IOError("Cannot write to file; File writing error"));
+    buffer_c += constants::max_write_bytes;
+    buffer_size -= constants::max_write_bytes;
+  }
+  bytes_written = ::write(fd, buffer_c, buffer_size);
+  if (bytes_written != int64_t(buffer_size))
+    return LOG_STATUS(
+        Status::IOError("Cannot write to file; File writing error"));
+
+  // Success
+  return Status::Ok();
+}
+
 }  // namespace posix
 
 }  // namespace tiledb
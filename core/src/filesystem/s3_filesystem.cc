@@ -0,0 +1,1052 @@
+/**
+ * @file   s3_filesystem.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class S3.
+ */
+
+#ifdef HAVE_S3
+
+#include "s3_filesystem.h"
+#include "constants.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <curl/curl.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+namespace tiledb {
+
+/* ********************************* */
+/*          TYPE DEFINITIONS         */
+/* ********************************* */
+
+struct S3::Response {
+  /** Constructor. */
+  Response()
+      : buffer_(nullptr)
+      , buffer_size_(0)
+      , code_(0)
+      , handle_(nullptr)
+      , nbytes_(0) {
+  }
+
+  /** The response body (unless read into `buffer_`) or the error message. */
+  std::string body_;
+
+  /** The buffer to read the body into (optional). */
+  char* buffer_;
+
+  /** The size of `buffer_`. */
+  uint64_t buffer_size_;
+
+  /** The HTTP status code. */
+  long code_;
+
+  /** The libcurl handle of the request. */
+  CURL* handle_;
+
+  /** The response headers, with lower case names. */
+  std::map<std::string, std::string> headers_;
+
+  /** The number of bytes read into `buffer_`. */
+  uint64_t nbytes_;
+};
+
+struct S3::Upload {
+  /** Constructor. */
+  explicit Upload(const URI& uri)
+      : dropped_(false)
+      , refs_(0)
+      , uri_(uri) {
+  }
+
+  /** The bucket of the object. */
+  std::string bucket_;
+
+  /** The data not uploaded yet. */
+  Buffer buffer_;
+
+  /**
+   * Set once the upload is removed from the index, after which it is
+   * deleted as soon as it is unpinned.
+   */
+  bool dropped_;
+
+  /** The entity tags of the uploaded parts, in part order. */
+  std::vector<std::string> etags_;
+
+  /** The object key. */
+  std::string key_;
+
+  /** Serializes appends and flushes. */
+  std::mutex mtx_;
+
+  /** Number of callers pinning the upload, protected by `uploads_mtx_`. */
+  uint64_t refs_;
+
+  /** The multipart upload id (empty until the first part is uploaded). */
+  std::string upload_id_;
+
+  /** The object URI. */
+  URI uri_;
+};
+
+namespace {
+
+/** The number of attempts of requests failing with transient errors. */
+const int request_attempts = 3;
+
+/** Returns the lower case hexadecimal representation of bytes. */
+std::string hex(const unsigned char* data, uint64_t nbytes) {
+  static const char* digits = "0123456789abcdef";
+  std::string ret;
+  ret.reserve(2 * nbytes);
+  for (uint64_t i = 0; i < nbytes; ++i) {
+    ret += digits[data[i] >> 4];
+    ret += digits[data[i] & 0xf];
+  }
+  return ret;
+}
+
+/** Returns the (raw) HMAC-SHA256 of a message. */
+std::string hmac_sha256(const std::string& key, const std::string& msg) {
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_len = 0;
+  HMAC(
+      EVP_sha256(),
+      key.data(),
+      (int)key.size(),
+      (const unsigned char*)msg.data(),
+      msg.size(),
+      digest,
+      &digest_len);
+  return std::string((const char*)digest, digest_len);
+}
+
+/** Returns the hexadecimal SHA256 digest of data. */
+std::string sha256_hex(const void* data, uint64_t nbytes) {
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256((const unsigned char*)(data == nullptr ? "" : data), nbytes, digest);
+  return hex(digest, SHA256_DIGEST_LENGTH);
+}
+
+/** Splits an S3 URI into its bucket and key, dropping trailing slashes. */
+void split(const URI& uri, std::string* bucket, std::string* key) {
+  std::string path = uri.to_path();
+  while (!path.empty() && path.back() == '/')
+    path.pop_back();
+  uint64_t pos = path.find('/');
+  if (pos == std::string::npos) {
+    *bucket = path;
+    key->clear();
+  } else {
+    *bucket = path.substr(0, pos);
+    *key = path.substr(pos + 1);
+  }
+}
+
+/**
+ * Percent-encodes a string as S3 expects, keeping the unreserved characters
+ * (and the slashes, if *keep_slash*).
+ */
+std::string uri_encode(const std::string& str, bool keep_slash) {
+  static const char* digits = "0123456789ABCDEF";
+  std::string ret;
+  for (unsigned char c : str) {
+    if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' ||
+        (keep_slash && c == '/')) {
+      ret += (char)c;
+    } else {
+      ret += '%';
+      ret += digits[c >> 4];
+      ret += digits[c & 0xf];
+    }
+  }
+  return ret;
+}
+
+/** Replaces the predefined XML entities of a string. */
+std::string xml_unescape(const std::string& str) {
+  static const char* entities[][2] = {{"&amp;", "&"},
+                                      {"&lt;", "<"},
+                                      {"&gt;", ">"},
+                                      {"&quot;", "\""},
+                                      {"&apos;", "'"}};
+  std::string ret;
+  for (uint64_t i = 0; i < str.size(); ++i) {
+    bool replaced = false;
+    if (str[i] == '&') {
+      for (auto& entity : entities) {
+        if (str.compare(i, strlen(entity[0]), entity[0]) == 0) {
+          ret += entity[1];
+          i += strlen(entity[0]) - 1;
+          replaced = true;
+          break;
+        }
+      }
+    }
+    if (!replaced)
+      ret += str[i];
+  }
+  return ret;
+}
+
+/** Retrieves the (unescaped) contents of all elements with a given tag. */
+void xml_values(
+    const std::string& xml,
+    const std::string& tag,
+    std::vector<std::string>* values) {
+  std::string open = "<" + tag + ">";
+  std::string close = "</" + tag + ">";
+  uint64_t pos = 0;
+  while ((pos = xml.find(open, pos)) != std::string::npos) {
+    pos += open.size();
+    uint64_t end = xml.find(close, pos);
+    if (end == std::string::npos)
+      break;
+    values->push_back(xml_unescape(xml.substr(pos, end - pos)));
+    pos = end + close.size();
+  }
+}
+
+/** Returns the contents of the first element with a given tag, or "". */
+std::string xml_value(const std::string& xml, const std::string& tag) {
+  std::vector<std::string> values;
+  xml_values(xml, tag, &values);
+  return values.empty() ? std::string() : values[0];
+}
+
+/** The libcurl callback receiving response headers. */
+size_t header_callback(char* data, size_t size, size_t nitems, void* userdata) {
+  auto headers = (std::map<std::string, std::string>*)userdata;
+  std::string line(data, size * nitems);
+  uint64_t colon = line.find(':');
+  if (colon != std::string::npos) {
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    uint64_t begin = line.find_first_not_of(" \t", colon + 1);
+    uint64_t end = line.find_last_not_of(" \t\r\n");
+    (*headers)[name] = (begin == std::string::npos || end < begin) ?
+                           std::string() :
+                           line.substr(begin, end - begin + 1);
+  }
+  return size * nitems;
+}
+
+/** Returns the S3 URI of a key. */
+std::string s3_uri(const std::string& bucket, const std::string& key) {
+  return "s3://" + bucket + "/" + key;
+}
+
+}  // namespace
+
+/* ********************************* */
+/*     CONSTRUCTORS & DESTRUCTORS    */
+/* ********************************* */
+
+S3::S3(const Config::S3Params& params)
+    : params_(params) {
+  virtual_addressing_ = false;
+}
+
+S3::~S3() {
+  disconnect();
+  for (auto handle : handles_)
+    curl_easy_cleanup((CURL*)handle);
+}
+
+/* ********************************* */
+/*                API                */
+/* ********************************* */
+
+Status S3::connect() {
+  static std::once_flag curl_init;
+  std::call_once(curl_init, []() { curl_global_init(CURL_GLOBAL_ALL); });
+
+  region_ = params_.region_;
+  scheme_ = params_.scheme_;
+  endpoint_ = params_.endpoint_override_;
+
+  // The standard AWS environment variables take precedence
+  const char* region = getenv("AWS_REGION");
+  if (region != nullptr && *region != '\0')
+    region_ = region;
+  const char* endpoint_url = getenv("AWS_ENDPOINT_URL");
+  if (endpoint_url != nullptr && *endpoint_url != '\0') {
+    endpoint_ = endpoint_url;
+    uint64_t pos = endpoint_.find("://");
+    if (pos != std::string::npos) {
+      scheme_ = endpoint_.substr(0, pos);
+      endpoint_ = endpoint_.substr(pos + 3);
+    }
+    while (!endpoint_.empty() && endpoint_.back() == '/')
+      endpoint_.pop_back();
+  }
+  virtual_addressing_ = endpoint_.empty();
+  if (virtual_addressing_)
+    endpoint_ = "s3." + region_ + ".amazonaws.com";
+
+  const char* access_key_id = getenv("AWS_ACCESS_KEY_ID");
+  const char* secret_access_key = getenv("AWS_SECRET_ACCESS_KEY");
+  const char* session_token = getenv("AWS_SESSION_TOKEN");
+  access_key_id_ = (access_key_id == nullptr) ? "" : access_key_id;
+  secret_access_key_ = (secret_access_key == nullptr) ? "" : secret_access_key;
+  session_token_ = (session_token == nullptr) ? "" : session_token;
+
+  return Status::Ok();
+}
+
+Status S3::create_bucket(const URI& uri) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  if (bucket.empty() || !key.empty())
+    return LOG_STATUS(Status::S3Error(
+        "Cannot create bucket '" + uri.to_string() + "'; Invalid bucket URI"));
+
+  // Buckets outside the default region must state their region
+  std::string body;
+  if (region_ != "us-east-1")
+    body =
+        "<CreateBucketConfiguration><LocationConstraint>" + region_ +
+        "</LocationConstraint></CreateBucketConfiguration>";
+  Response response;
+  return request(
+      "PUT", bucket, "", {}, {}, body.data(), body.size(), &response);
+}
+
+Status S3::create_dir(const URI& uri) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  if (key.empty())
+    return create_bucket(uri);
+  if (is_dir(uri))
+    return LOG_STATUS(Status::S3Error(
+        "Cannot create directory '" + uri.to_string() +
+        "'; Directory already exists"));
+  return Status::Ok();
+}
+
+Status S3::create_file(const URI& uri) const {
+  if (is_file(uri))
+    return Status::Ok();
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  Response response;
+  return request("PUT", bucket, key, {}, {}, nullptr, 0, &response);
+}
+
+Status S3::disconnect() {
+  return complete_uploads("");
+}
+
+Status S3::file_size(const URI& uri, uint64_t* nbytes) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  Response response;
+  RETURN_NOT_OK(
+      request("HEAD", bucket, key, {}, {}, nullptr, 0, &response));
+  auto it = response.headers_.find("content-length");
+  if (it == response.headers_.end())
+    return LOG_STATUS(Status::S3Error(
+        "Cannot get size of '" + uri.to_string() +
+        "'; Missing content length"));
+  *nbytes = std::strtoull(it->second.c_str(), nullptr, 10);
+  return Status::Ok();
+}
+
+Status S3::flush(const URI& uri) {
+  std::string path = uri.to_string();
+  while (!path.empty() && path.back() == '/')
+    path.pop_back();
+  return complete_uploads(path);
+}
+
+bool S3::is_bucket(const URI& uri) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  if (bucket.empty() || !key.empty())
+    return false;
+  Response response;
+  return request("HEAD", bucket, "", {}, {}, nullptr, 0, &response).ok();
+}
+
+bool S3::is_dir(const URI& uri) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  if (key.empty())
+    return is_bucket(uri);
+  std::vector<std::string> keys;
+  return list(bucket, key + "/", false, 1, &keys).ok() && !keys.empty();
+}
+
+bool S3::is_file(const URI& uri) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  if (key.empty())
+    return false;
+  Response response;
+  return request("HEAD", bucket, key, {}, {}, nullptr, 0, &response).ok();
+}
+
+Status S3::ls(const URI& uri, std::vector<std::string>* paths) const {
+  std::vector<bool> is_dirs;
+  return ls_with_types(uri, paths, &is_dirs);
+}
+
+Status S3::ls_with_types(
+    const URI& uri,
+    std::vector<std::string>* paths,
+    std::vector<bool>* is_dirs) const {
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  std::string prefix = key.empty() ? key : key + "/";
+  std::vector<std::string> keys;
+  RETURN_NOT_OK(list(bucket, prefix, true, 0, &keys));
+
+  // Common prefixes (directories) end with '/'; a name that is both an
+  // object and a prefix is reported as a directory
+  std::map<std::string, bool> entries;
+  for (auto& k : keys) {
+    std::string entry = k;
+    bool is_dir = false;
+    while (!entry.empty() && entry.back() == '/') {
+      entry.pop_back();
+      is_dir = true;
+    }
+    if (entry.size() > key.size())
+      entries[s3_uri(bucket, entry)] |= is_dir;
+  }
+  for (auto& e : entries) {
+    paths->push_back(e.first);
+    is_dirs->push_back(e.second);
+  }
+  return Status::Ok();
+}
+
+Status S3::move_path(const URI& old_uri, const URI& new_uri) {
+  RETURN_NOT_OK(flush(old_uri));
+  std::string old_bucket, old_key, new_bucket, new_key;
+  split(old_uri, &old_bucket, &old_key);
+  split(new_uri, &new_bucket, &new_key);
+  if (old_key.empty() || new_key.empty())
+    return LOG_STATUS(Status::S3Error(
+        "Cannot move '" + old_uri.to_string() + "'; Buckets cannot be moved"));
+
+  // Collect the objects to move
+  std::vector<std::string> keys;
+  if (is_file(old_uri))
+    keys.push_back(old_key);
+  else
+    RETURN_NOT_OK(list(old_bucket, old_key + "/", false, 0, &keys));
+  if (keys.empty())
+    return LOG_STATUS(Status::S3Error(
+        "Cannot move '" + old_uri.to_string() + "'; Path does not exist"));
+
+  // Copy everything before removing anything
+  RETURN_NOT_OK(parallel(keys.size(), [&](uint64_t i) {
+    std::string suffix = keys[i].substr(old_key.size());
+    return copy_object(
+        URI(s3_uri(old_bucket, keys[i])),
+        URI(s3_uri(new_bucket, new_key + suffix)));
+  }));
+  return parallel(keys.size(), [&](uint64_t i) {
+    Response response;
+    return request(
+        "DELETE", old_bucket, keys[i], {}, {}, nullptr, 0, &response);
+  });
+}
+
+Status S3::move_file_no_replace(
+    const URI& old_uri, const URI& new_uri, bool* moved) {
+  RETURN_NOT_OK(flush(old_uri));
+  std::string old_bucket, old_key, new_bucket, new_key;
+  split(old_uri, &old_bucket, &old_key);
+  split(new_uri, &new_bucket, &new_key);
+
+  // Server-side copy, which the store rejects if the new URI exists
+  std::map<std::string, std::string> headers;
+  headers["if-none-match"] = "*";
+  headers["x-amz-copy-source"] =
+      "/" + old_bucket + "/" + uri_encode(old_key, true);
+  Response response;
+  Status st = request(
+      "PUT", new_bucket, new_key, {}, headers, nullptr, 0, &response);
+  if (response.code_ == 412) {
+    *moved = false;
+    return Status::Ok();
+  }
+  RETURN_NOT_OK(st);
+  if (response.body_.find("<Error>") != std::string::npos)
+    return LOG_STATUS(Status::S3Error(
+        "Cannot move '" + old_uri.to_string() + "'; " +
+        xml_value(response.body_, "Message")));
+  *moved = true;
+
+  return request(
+      "DELETE", old_bucket, old_key, {}, {}, nullptr, 0, &response);
+}
+
+Status S3::parallel(
+    uint64_t n, const std::function<Status(uint64_t)>& op) const {
+  return utils::parallel_for(n, params_.max_parallel_ops_, op);
+}
+
+Status S3::read_from_file(
+    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const {
+  if (nbytes == 0)
+    return Status::Ok();
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  std::map<std::string, std::string> headers;
+  headers["range"] = "bytes=" + std::to_string(offset) + "-" +
+                     std::to_string(offset + nbytes - 1);
+  Response response;
+  response.buffer_ = (char*)buffer;
+  response.buffer_size_ = nbytes;
+  RETURN_NOT_OK(
+      request("GET", bucket, key, {}, headers, nullptr, 0, &response));
+  if (response.nbytes_ != nbytes)
+    return LOG_STATUS(Status::S3Error(
+        "Cannot read from '" + uri.to_string() +
+        "'; Read past the end of the object"));
+  return Status::Ok();
+}
+
+Status S3::remove_file(const URI& uri) {
+  // Discard a pending upload
+  Upload* upload = nullptr;
+  uploads_mtx_.lock();
+  auto it = uploads_.find(uri.to_string());
+  if (it != uploads_.end()) {
+    upload = it->second;
+    ++upload->refs_;
+  }
+  uploads_mtx_.unlock();
+  if (upload != nullptr) {
+    upload->mtx_.lock();
+    if (!upload->dropped_) {
+      drop_upload(upload);
+      if (!upload->upload_id_.empty())
+        abort_upload(upload->bucket_, upload->key_, upload->upload_id_);
+    }
+    upload->mtx_.unlock();
+    release_upload(upload);
+  }
+
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  if (!is_file(uri))
+    return LOG_STATUS(Status::S3Error(
+        "Cannot remove file '" + uri.to_string() + "'; File does not exist"));
+  Response response;
+  return request("DELETE", bucket, key, {}, {}, nullptr, 0, &response);
+}
+
+Status S3::remove_path(const URI& uri) {
+  RETURN_NOT_OK(flush(uri));
+  std::string bucket, key;
+  split(uri, &bucket, &key);
+  std::vector<std::string> keys;
+  RETURN_NOT_OK(list(bucket, key.empty() ? key : key + "/", false, 0, &keys));
+  if (keys.empty() && !key.empty())
+    return LOG_STATUS(Status::S3Error(
+        "Cannot remove path '" + uri.to_string() + "'; Path does not exist"));
+
+  RETURN_NOT_OK(parallel(keys.size(), [&](uint64_t i) {
+    Response response;
+    return request("DELETE", bucket, keys[i], {}, {}, nullptr, 0, &response);
+  }));
+  if (!key.empty())
+    return Status::Ok();
+  Response response;
+  return request("DELETE", bucket, "", {}, {}, nullptr, 0, &response);
+}
+
+Status S3::write_to_file(
+    const URI& uri, const void* buffer, uint64_t nbytes) {
+  // Find or start the upload of the object, and pin it
+  Upload* upload;
+  for (;;) {
+    uploads_mtx_.lock();
+    auto it = uploads_.find(uri.to_string());
+    if (it != uploads_.end()) {
+      upload = it->second;
+    } else {
+      uploads_mtx_.unlock();
+      uint64_t size = 0;
+      if (is_file(uri) && file_size(uri, &size).ok() && size > 0)
+        return LOG_STATUS(Status::S3Error(
+            "Cannot write to '" + uri.to_string() +
+            "'; S3 objects cannot be appended to"));
+      auto new_upload = new Upload(uri);
+      split(uri, &new_upload->bucket_, &new_upload->key_);
+      uploads_mtx_.lock();
+      auto ret = uploads_.emplace(uri.to_string(), new_upload);
+      if (!ret.second)
+        delete new_upload;
+      upload = ret.first->second;
+    }
+    ++upload->refs_;
+    uploads_mtx_.unlock();
+
+    // Start over if the upload was completed or discarded meanwhile
+    upload->mtx_.lock();
+    if (!upload->dropped_)
+      break;
+    upload->mtx_.unlock();
+    release_upload(upload);
+  }
+
+  Status st = append_upload(upload, buffer, nbytes);
+  upload->mtx_.unlock();
+  release_upload(upload);
+  return st;
+}
+
+/* ********************************* */
+/*          PRIVATE METHODS          */
+/* ********************************* */
+
+Status S3::abort_upload(
+    const std::string& bucket,
+    const std::string& key,
+    const std::string& upload_id) const {
+  Response response;
+  return request(
+      "DELETE",
+      bucket,
+      key,
+      {{"uploadId", upload_id}},
+      {},
+      nullptr,
+      0,
+      &response);
+}
+
+Status S3::append_upload(
+    Upload* upload, const void* buffer, uint64_t nbytes) {
+  RETURN_NOT_OK(upload->buffer_.write(buffer, nbytes));
+
+  // Upload full parts once there are enough to keep all connections busy
+  uint64_t part_size = params_.multipart_part_size_;
+  uint64_t size = upload->buffer_.size();
+  if (size < part_size * std::max<unsigned>(params_.max_parallel_ops_, 1))
+    return Status::Ok();
+  uint64_t upload_size = (size / part_size) * part_size;
+  char* data = (char*)upload->buffer_.data();
+  Status st = upload_parts(upload, data, upload_size);
+  if (!st.ok()) {
+    drop_upload(upload);
+    if (!upload->upload_id_.empty())
+      abort_upload(upload->bucket_, upload->key_, upload->upload_id_);
+    return st;
+  }
+
+  // Keep the remainder
+  std::memmove(data, data + upload_size, size - upload_size);
+  upload->buffer_.set_offset(size - upload_size);
+  upload->buffer_.set_size(size - upload_size);
+  return Status::Ok();
+}
+
+Status S3::complete_upload(Upload* upload) const {
+  const char* data = (const char*)upload->buffer_.data();
+  uint64_t size = upload->buffer_.size();
+
+  // Small objects are uploaded in one go
+  Response response;
+  if (upload->upload_id_.empty())
+    return request(
+        "PUT",
+        upload->bucket_,
+        upload->key_,
+        {},
+        {},
+        data,
+        size,
+        &response);
+
+  Status st;
+  if (size > 0)
+    st = upload_parts(upload, data, size);
+  if (st.ok()) {
+    std::string body = "<CompleteMultipartUpload>";
+    for (uint64_t i = 0; i < upload->etags_.size(); ++i)
+      body += "<Part><PartNumber>" + std::to_string(i + 1) +
+              "</PartNumber><ETag>" + upload->etags_[i] + "</ETag></Part>";
+    body += "</CompleteMultipartUpload>";
+    st = request(
+        "POST",
+        upload->bucket_,
+        upload->key_,
+        {{"uploadId", upload->upload_id_}},
+        {},
+        body.data(),
+        body.size(),
+        &response);
+
+    // The store may report failures after responding with success
+    if (st.ok() && response.body_.find("<Error>") != std::string::npos)
+      st = LOG_STATUS(Status::S3Error(
+          "Cannot complete upload of '" + upload->uri_.to_string() + "'; " +
+          xml_value(response.body_, "Message")));
+  }
+  if (!st.ok())
+    abort_upload(upload->bucket_, upload->key_, upload->upload_id_);
+  return st;
+}
+
+Status S3::complete_uploads(const std::string& path) {
+  std::vector<Upload*> uploads;
+  pin_uploads(path, &uploads);
+
+  Status ret;
+  for (auto upload : uploads) {
+    upload->mtx_.lock();
+    if (!upload->dropped_) {
+      drop_upload(upload);
+      Status st = complete_upload(upload);
+      if (ret.ok())
+        ret = st;
+    }
+    upload->mtx_.unlock();
+    release_upload(upload);
+  }
+  return ret;
+}
+
+Status S3::copy_object(const URI& old_uri, const URI& new_uri) const {
+  std::string old_bucket, old_key, new_bucket, new_key;
+  split(old_uri, &old_bucket, &old_key);
+  split(new_uri, &new_bucket, &new_key);
+  std::map<std::string, std::string> headers;
+  headers["x-amz-copy-source"] =
+      "/" + old_bucket + "/" + uri_encode(old_key, true);
+  Response response;
+  RETURN_NOT_OK(request(
+      "PUT", new_bucket, new_key, {}, headers, nullptr, 0, &response));
+  if (response.body_.find("<Error>") != std::string::npos)
+    return LOG_STATUS(Status::S3Error(
+        "Cannot copy '" + old_uri.to_string() + "'; " +
+        xml_value(response.body_, "Message")));
+  return Status::Ok();
+}
+
+void S3::drop_upload(Upload* upload) {
+  std::unique_lock<std::mutex> lck(uploads_mtx_);
+  if (upload->dropped_)
+    return;
+  upload->dropped_ = true;
+
+  // A newer upload of the object may be indexed instead
+  auto it = uploads_.find(upload->uri_.to_string());
+  if (it != uploads_.end() && it->second == upload)
+    uploads_.erase(it);
+}
+
+Status S3::list(
+    const std::string& bucket,
+    const std::string& prefix,
+    bool delimited,
+    uint64_t max_keys,
+    std::vector<std::string>* keys) const {
+  std::map<std::string, std::string> query;
+  query["list-type"] = "2";
+  query["prefix"] = prefix;
+  if (delimited)
+    query["delimiter"] = "/";
+  if (max_keys > 0)
+    query["max-keys"] = std::to_string(max_keys);
+
+  for (;;) {
+    Response response;
+    RETURN_NOT_OK(
+        request("GET", bucket, "", query, {}, nullptr, 0, &response));
+    xml_values(response.body_, "Key", keys);
+    std::vector<std::string> common_prefixes;
+    xml_values(response.body_, "CommonPrefixes", &common_prefixes);
+    for (auto& common_prefix : common_prefixes)
+      xml_values(common_prefix, "Prefix", keys);
+
+    if ((max_keys > 0 && keys->size() >= max_keys) ||
+        xml_value(response.body_, "IsTruncated") != "true")
+      return Status::Ok();
+    query["continuation-token"] =
+        xml_value(response.body_, "NextContinuationToken");
+  }
+}
+
+void S3::pin_uploads(
+    const std::string& path, std::vector<Upload*>* uploads) {
+  std::unique_lock<std::mutex> lck(uploads_mtx_);
+  std::string prefix = path + "/";
+  for (auto& upload : uploads_) {
+    if (path.empty() || upload.first == path ||
+        utils::starts_with(upload.first, prefix)) {
+      ++upload.second->refs_;
+      uploads->push_back(upload.second);
+    }
+  }
+}
+
+void S3::release_upload(Upload* upload) {
+  std::unique_lock<std::mutex> lck(uploads_mtx_);
+  if (--upload->refs_ == 0 && upload->dropped_)
+    delete upload;
+}
+
+Status S3::request(
+    const std::string& method,
+    const std::string& bucket,
+    const std::string& key,
+    const std::map<std::string, std::string>& query,
+    const std::map<std::string, std::string>& headers,
+    const void* body,
+    uint64_t body_size,
+    Response* response) const {
+  // Address the bucket as a host or as the first path segment
+  std::string host = endpoint_;
+  std::string path;
+  if (!bucket.empty()) {
+    if (virtual_addressing_)
+      host = bucket + "." + endpoint_;
+    else
+      path = "/" + bucket;
+  }
+  if (!key.empty() || path.empty())
+    path += "/" + uri_encode(key, true);
+  std::string query_str;
+  for (auto& param : query) {
+    if (!query_str.empty())
+      query_str += "&";
+    query_str +=
+        uri_encode(param.first, false) + "=" + uri_encode(param.second, false);
+  }
+  std::string url = scheme_ + "://" + host + path;
+  if (!query_str.empty())
+    url += "?" + query_str;
+
+  // Sign the request (AWS Signature Version 4)
+  char date_time[17];
+  time_t now = time(nullptr);
+  struct tm tm;
+  gmtime_r(&now, &tm);
+  strftime(date_time, sizeof(date_time), "%Y%m%dT%H%M%SZ", &tm);
+  std::string date(date_time, 8);
+  std::string payload_hash = sha256_hex(body, body_size);
+  std::map<std::string, std::string> all_headers = headers;
+  all_headers["host"] = host;
+  all_headers["x-amz-content-sha256"] = payload_hash;
+  all_headers["x-amz-date"] = date_time;
+  if (!session_token_.empty())
+    all_headers["x-amz-security-token"] = session_token_;
+  std::string canonical_headers, signed_headers;
+  for (auto& header : all_headers) {
+    canonical_headers += header.first + ":" + header.second + "\n";
+    if (!signed_headers.empty())
+      signed_headers += ";";
+    signed_headers += header.first;
+  }
+  std::string canonical_request = method + "\n" + path + "\n" + query_str +
+                                  "\n" + canonical_headers + "\n" +
+                                  signed_headers + "\n" + payload_hash;
+  std::string scope = date + "/" + region_ + "/s3/aws4_request";
+  std::string string_to_sign =
+      "AWS4-HMAC-SHA256\n" + std::string(date_time) + "\n" + scope + "\n" +
+      sha256_hex(canonical_request.data(), canonical_request.size());
+  std::string signing_key = hmac_sha256(
+      hmac_sha256(
+          hmac_sha256(
+              hmac_sha256("AWS4" + secret_access_key_, date), region_),
+          "s3"),
+      "aws4_request");
+  std::string signature = hmac_sha256(signing_key, string_to_sign);
+
+  struct curl_slist* header_list = nullptr;
+  for (auto& header : all_headers) {
+    if (header.first != "host")
+      header_list = curl_slist_append(
+          header_list, (header.first + ": " + header.second).c_str());
+  }
+  if (!access_key_id_.empty()) {
+    std::string authorization =
+        "Authorization: AWS4-HMAC-SHA256 Credential=" + access_key_id_ + "/" +
+        scope + ", SignedHeaders=" + signed_headers + ", Signature=" +
+        hex((const unsigned char*)signature.data(), signature.size());
+    header_list = curl_slist_append(header_list, authorization.c_str());
+  }
+  header_list = curl_slist_append(header_list, "Expect:");
+  if (method == "PUT" || method == "POST")
+    header_list =
+        curl_slist_append(header_list, "Content-Type: application/octet-stream");
+
+  // Reuse an idle handle, keeping its connection alive
+  handles_mtx_.lock();
+  CURL* curl;
+  if (handles_.empty()) {
+    curl = curl_easy_init();
+  } else {
+    curl = (CURL*)handles_.back();
+    handles_.pop_back();
+  }
+  handles_mtx_.unlock();
+  response->handle_ = curl;
+
+  // Retry transient failures
+  CURLcode rc = CURLE_OK;
+  for (int attempt = 0; attempt < request_attempts; ++attempt) {
+    if (attempt > 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(100 << attempt));
+    response->body_.clear();
+    response->headers_.clear();
+    response->nbytes_ = 0;
+    response->code_ = 0;
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response->headers_);
+    if (method == "HEAD") {
+      curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (method != "GET") {
+      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+      if (method == "PUT" || method == "POST") {
+        curl_easy_setopt(
+            curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)body_size);
+        curl_easy_setopt(
+            curl, CURLOPT_POSTFIELDS, body == nullptr ? "" : (const char*)body);
+      }
+    }
+    rc = curl_easy_perform(curl);
+    if (rc == CURLE_OK)
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->code_);
+    if ((rc == CURLE_OK && response->code_ < 500) || rc == CURLE_WRITE_ERROR)
+      break;
+  }
+
+  curl_slist_free_all(header_list);
+  curl_easy_reset(curl);
+  handles_mtx_.lock();
+  handles_.push_back(curl);
+  handles_mtx_.unlock();
+
+  if (rc != CURLE_OK)
+    return LOG_STATUS(Status::S3Error(
+        method + " request to '" + url + "' failed; " +
+        curl_easy_strerror(rc)));
+  if (response->code_ >= 300) {
+    std::string message = xml_value(response->body_, "Message");
+    Status st = Status::S3Error(
+        method + " request to '" + url + "' failed with HTTP status " +
+        std::to_string(response->code_) +
+        (message.empty() ? std::string() : "; " + message));
+    // Missing objects are a normal answer to existence checks, and failed
+    // preconditions to conditional writes
+    bool expected = (method == "HEAD" && response->code_ == 404) ||
+                    response->code_ == 412;
+    return expected ? st : LOG_STATUS(st);
+  }
+  return Status::Ok();
+}
+
+Status S3::upload_parts(
+    Upload* upload, const char* data, uint64_t nbytes) const {
+  if (upload->upload_id_.empty()) {
+    Response response;
+    RETURN_NOT_OK(request(
+        "POST",
+        upload->bucket_,
+        upload->key_,
+        {{"uploads", ""}},
+        {},
+        nullptr,
+        0,
+        &response));
+    upload->upload_id_ = xml_value(response.body_, "UploadId");
+    if (upload->upload_id_.empty())
+      return LOG_STATUS(Status::S3Error(
+          "Cannot upload '" + upload->uri_.to_string() +
+          "'; Missing upload id"));
+  }
+
+  uint64_t part_size = params_.multipart_part_size_;
+  uint64_t nparts = (nbytes + part_size - 1) / part_size;
+  uint64_t first_part = upload->etags_.size();
+  upload->etags_.resize(first_part + nparts);
+  return parallel(nparts, [&](uint64_t i) {
+    uint64_t offset = i * part_size;
+    Response response;
+    RETURN_NOT_OK(request(
+        "PUT",
+        upload->bucket_,
+        upload->key_,
+        {{"partNumber", std::to_string(first_part + i + 1)},
+         {"uploadId", upload->upload_id_}},
+        {},
+        data + offset,
+        std::min(part_size, nbytes - offset),
+        &response));
+    upload->etags_[first_part + i] = response.headers_["etag"];
+    return Status::Ok();
+  });
+}
+
+size_t S3::write_callback(
+    char* data, size_t size, size_t nmemb, void* userdata) {
+  auto response = (Response*)userdata;
+  uint64_t nbytes = size * nmemb;
+  long code = 0;
+  curl_easy_getinfo(response->handle_, CURLINFO_RESPONSE_CODE, &code);
+
+  // Error messages never go to the user buffer
+  if (response->buffer_ == nullptr || code >= 300) {
+    response->body_.append(data, nbytes);
+    return nbytes;
+  }
+  if (response->nbytes_ + nbytes > response->buffer_size_)
+    return 0;
+  std::memcpy(response->buffer_ + response->nbytes_, data, nbytes);
+  response->nbytes_ += nbytes;
+  return nbytes;
+}
+
+}  // namespace tiledb
+
+#endif  // HAVE_S3
@@ -0,0 +1,102 @@
+/**
+ * @file   thread_pool_io_engine.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class ThreadPoolIOEngine.
+ */
+
+#include "thread_pool_io_engine.h"
+#include "posix_filesystem.h"
+
+namespace tiledb {
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+ThreadPoolIOEngine::ThreadPoolIOEngine(unsigned int thread_num)
+    : stop_(false) {
+  if (thread_num == 0)
+    thread_num = 1;
+  for (unsigned int i = 0; i < thread_num; ++i)
+    threads_.push_back(new std::thread(&ThreadPoolIOEngine::worker, this));
+}
+
+ThreadPoolIOEngine::~ThreadPoolIOEngine() {
+  mtx_.lock();
+  stop_ = true;
+  mtx_.unlock();
+  cv_.notify_all();
+
+  for (auto thread : threads_) {
+    thread->join();
+    delete thread;
+  }
+}
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+const char* ThreadPoolIOEngine::name() const {
+  return "thread_pool";
+}
+
+Status ThreadPoolIOEngine::submit(const std::vector<IORequest>& requests) {
+  mtx_.lock();
+  for (const auto& request : requests)
+    requests_.push(request);
+  mtx_.unlock();
+  cv_.notify_all();
+
+  return Status::Ok();
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+void ThreadPoolIOEngine::worker() {
+  std::unique_lock<std::mutex> lck(mtx_);
+  for (;;) {
+    // Queued requests are drained before terminating
+    cv_.wait(lck, [this]() { return stop_ || !requests_.empty(); });
+    if (requests_.empty())
+      return;
+    IORequest request = requests_.front();
+    requests_.pop();
+
+    lck.unlock();
+    Status st = posix::read_from_file(
+        request.fd, request.offset, request.buffer, request.nbytes);
+    request.batch->complete(st);
+    lck.lock();
+  }
+}
+
+}  // namespace tiledb
@@ -0,0 +1,345 @@
+/**
+ * @file   uring_io_engine.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class UringIOEngine.
+ */
+
+#ifdef HAVE_IO_URING
+
+#include "uring_io_engine.h"
+#include "logger.h"
+#include "posix_filesystem.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace tiledb {
+
+/* ****************************** */
+/*        TYPE DEFINITIONS        */
+/* ****************************** */
+
+struct UringIOEngine::Op {
+  /** The request. */
+  IORequest request_;
+
+  /** The target of the read. */
+  struct iovec iov_;
+};
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+UringIOEngine::UringIOEngine()
+    : cqes_(nullptr)
+    , cq_head_(nullptr)
+    , cq_mask_(nullptr)
+    , cq_entries_(0)
+    , cq_tail_(nullptr)
+    , cq_ring_size_(0)
+    , cq_ring_(nullptr)
+    , inflight_(0)
+    , reaper_(nullptr)
+    , ring_fd_(-1)
+    , sq_array_(nullptr)
+    , sq_entries_(0)
+    , sq_head_(nullptr)
+    , sq_mask_(nullptr)
+    , sq_ring_size_(0)
+    , sq_ring_(nullptr)
+    , sq_tail_(nullptr)
+    , sqes_(nullptr) {
+}
+
+UringIOEngine::~UringIOEngine() {
+  // Stop the reaper with a NOP, once all reads have completed
+  if (reaper_ != nullptr) {
+    std::unique_lock<std::mutex> lck(submit_mtx_);
+    inflight_cv_.wait(lck, [this]() { return inflight_ == 0; });
+    reserve(&lck);
+    queue(nullptr);
+    Status st = enter(1);
+    lck.unlock();
+
+    // The reaper cannot be stopped; leave it the ring it blocks on
+    if (!st.ok()) {
+      reaper_->detach();
+      delete reaper_;
+      return;
+    }
+    reaper_->join();
+    delete reaper_;
+  }
+
+  if (sqes_ != nullptr)
+    munmap(sqes_, sq_entries_ * sizeof(struct io_uring_sqe));
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr)
+    munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ != -1)
+    ::close(ring_fd_);
+}
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+Status UringIOEngine::init(unsigned int entries) {
+  // Failures are not logged, as the caller falls back to another engine
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd_ = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (ring_fd_ < 0) {
+    ring_fd_ = -1;
+    return Status::IOError(
+        std::string("Cannot set up io_uring; ") + strerror(errno));
+  }
+
+  // Map the rings
+  sq_entries_ = params.sq_entries;
+  cq_entries_ = params.cq_entries;
+  sq_ring_size_ = params.sq_off.array + sq_entries_ * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + cq_entries_ * sizeof(struct io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap)
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  void* addr = mmap(
+      nullptr,
+      sq_ring_size_,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      ring_fd_,
+      IORING_OFF_SQ_RING);
+  if (addr == MAP_FAILED)
+    return Status::IOError(
+        std::string("Cannot map io_uring submission ring; ") +
+        strerror(errno));
+  sq_ring_ = addr;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    addr = mmap(
+        nullptr,
+        cq_ring_size_,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ring_fd_,
+        IORING_OFF_CQ_RING);
+    if (addr == MAP_FAILED)
+      return Status::IOError(
+          std::string("Cannot map io_uring completion ring; ") +
+          strerror(errno));
+    cq_ring_ = addr;
+  }
+  addr = mmap(
+      nullptr,
+      sq_entries_ * sizeof(struct io_uring_sqe),
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      ring_fd_,
+      IORING_OFF_SQES);
+  if (addr == MAP_FAILED)
+    return Status::IOError(
+        std::string("Cannot map io_uring submission entries; ") +
+        strerror(errno));
+  sqes_ = (struct io_uring_sqe*)addr;
+
+  auto sq = (char*)sq_ring_;
+  sq_head_ = (unsigned*)(sq + params.sq_off.head);
+  sq_tail_ = (unsigned*)(sq + params.sq_off.tail);
+  sq_mask_ = (unsigned*)(sq + params.sq_off.ring_mask);
+  sq_array_ = (unsigned*)(sq + params.sq_off.array);
+  auto cq = (char*)cq_ring_;
+  cq_head_ = (unsigned*)(cq + params.cq_off.head);
+  cq_tail_ = (unsigned*)(cq + params.cq_off.tail);
+  cq_mask_ = (unsigned*)(cq + params.cq_off.ring_mask);
+  cqes_ = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+  reaper_ = new std::thread(&UringIOEngine::reap, this);
+
+  return Status::Ok();
+}
+
+const char* UringIOEngine::name() const {
+  return "io_uring";
+}
+
+Status UringIOEngine::submit(const std::vector<IORequest>& requests) {
+  std::unique_lock<std::mutex> lck(submit_mtx_);
+  Status st;
+  unsigned queued = 0;
+  uint64_t i = 0;
+  for (; i < requests.size(); ++i) {
+    // Hand the queued entries to the kernel before waiting for a free slot
+    if (queued == sq_entries_ || inflight_ == cq_entries_) {
+      st = enter(queued);
+      queued = 0;
+      if (!st.ok())
+        break;
+    }
+    reserve(&lck);
+
+    auto op = new Op();
+    op->request_ = requests[i];
+    op->iov_.iov_base = requests[i].buffer;
+    op->iov_.iov_len = requests[i].nbytes;
+    queue(op);
+    ++queued;
+  }
+  if (st.ok())
+    st = enter(queued);
+  if (st.ok())
+    return st;
+
+  // The batches are waited on regardless, so every request the kernel did
+  // not take must still be completed
+  unqueue(st);
+  for (; i < requests.size(); ++i)
+    requests[i].batch->complete(st);
+
+  return st;
+}
+
+/* ****************************** */
+/*        PROTECTED METHODS       */
+/* ****************************** */
+
+Status UringIOEngine::enter(unsigned n) {
+  while (n > 0) {
+    int ret = (int)syscall(
+        __NR_io_uring_enter, ring_fd_, n, 0, 0, nullptr, (size_t)0);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+        continue;
+      return LOG_STATUS(Status::IOError(
+          std::string("Cannot submit to io_uring; ") + strerror(errno)));
+    }
+    n -= (unsigned)ret;
+  }
+
+  return Status::Ok();
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+void UringIOEngine::queue(Op* op) {
+  unsigned tail = *sq_tail_;
+  unsigned idx = tail & *sq_mask_;
+  struct io_uring_sqe* sqe = &sqes_[idx];
+  std::memset(sqe, 0, sizeof(*sqe));
+  if (op == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = op->request_.fd;
+    sqe->off = op->request_.offset;
+    sqe->addr = (uint64_t)&op->iov_;
+    sqe->len = 1;
+  }
+  sqe->user_data = (uint64_t)op;
+  sq_array_[idx] = idx;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+}
+
+void UringIOEngine::reap() {
+  for (;;) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      syscall(
+          __NR_io_uring_enter,
+          ring_fd_,
+          0,
+          1,
+          IORING_ENTER_GETEVENTS,
+          nullptr,
+          (size_t)0);
+      continue;
+    }
+    struct io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+    auto op = (Op*)cqe->user_data;
+    int res = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+    if (op != nullptr) {
+      // Failed and short reads are completed synchronously, which also
+      // produces the proper error for reads past the end of the file
+      const IORequest& request = op->request_;
+      uint64_t done = (res > 0) ? (uint64_t)res : 0;
+      Status st;
+      if (done < request.nbytes)
+        st = posix::read_from_file(
+            request.fd,
+            request.offset + done,
+            (char*)request.buffer + done,
+            request.nbytes - done);
+      request.batch->complete(st);
+      delete op;
+    }
+
+    std::unique_lock<std::mutex> lck(submit_mtx_);
+    --inflight_;
+    inflight_cv_.notify_all();
+    if (op == nullptr)
+      return;
+  }
+}
+
+void UringIOEngine::reserve(std::unique_lock<std::mutex>* lck) {
+  inflight_cv_.wait(*lck, [this]() { return inflight_ < cq_entries_; });
+  ++inflight_;
+}
+
+void UringIOEngine::unqueue(const Status& st) {
+  // The kernel consumes entries only when entered by a submitter, so the
+  // tail can be rewound to its head
+  unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  unsigned tail = *sq_tail_;
+  for (unsigned i = head; i != tail; ++i) {
+    auto op = (Op*)sqes_[sq_array_[i & *sq_mask_]].user_data;
+    op->request_.batch->complete(st);
+    delete op;
+    --inflight_;
+  }
+  __atomic_store_n(sq_tail_, head, __ATOMIC_RELEASE);
+  inflight_cv_.notify_all();
+}
+
+}  // namespace tiledb
+
+#endif  // HAVE_IO_URING
@@ -31,22 +31,76 @@
  */
 
 #include "vfs.h"
+#include "constants.h"
 #include "hdfs_filesystem.h"
 #include "logger.h"
+#include "mem_filesystem.h"
 #include "posix_filesystem.h"
+#include "utils.h"
 
+#include <climits>
 #include <iostream>
 
 namespace tiledb {
 
+/* ********************************* */
+/*          TYPE DEFINITIONS         */
+/* ********************************* */
+
+struct VFS::WriteBuffer {
+  /** Constructor. */
+  explicit WriteBuffer(const URI& uri)
+      : dropped_(false)
+      , refs_(0)
+      , uri_(uri) {
+  }
+
+  /** The buffered data. */
+  Buffer buffer_;
+
+  /**
+   * Set once the buffer is removed from the index, after which it is
+   * deleted as soon as it is unpinned.
+   */
+  bool dropped_;
+
+  /** Serializes appends and flushes. */
+  std::mutex mtx_;
+
+  /** Number of callers pinning the buffer, protected by the index lock. */
+  uint64_t refs_;
+
+  /** The file URI. */
+  URI uri_;
+};
+
 /* ********************************* */
 /*     CONSTRUCTORS & DESTRUCTORS    */
 /* ********************************* */
 
-VFS::VFS() {
+VFS::VFS(const Config::VFSParams& params)
+    : params_(params) {
+  io_engine_ = nullptr;
+  fd_cache_ = new FDCache(constants::vfs_fd_cache_size);
+  disk_cache_ = nullptr;
+  if (!params_.disk_cache_dir_.empty()) {
+    disk_cache_ = new DiskCache(
+        params_.disk_cache_dir_,
+        params_.disk_cache_size_,
+        params_.disk_cache_block_size_);
+    // Remote reads are not cached if the cache cannot be set up
+    if (!disk_cache_->init().ok()) {
+      delete disk_cache_;
+      disk_cache_ = nullptr;
+    }
+  }
 #ifdef HAVE_HDFS
   Status st = hdfs::connect(hdfs_);
 #endif
+#ifdef HAVE_S3
+  s3_ = new S3(params_.s3_params_);
+  Status st_s3 = s3_->connect();
+#endif
 }
 
 VFS::~VFS() {
@@ -55,6 +109,18 @@ VFS::~VFS() {
     // Status st = hdfs::disconnect(hdfs_);
   }
 #endif
+  for (auto& write_buffer : write_buffers_) {
+    flush_write_buffer(write_buffer.second);
+    delete write_buffer.second;
+  }
+#ifdef HAVE_S3
+  delete s3_;
+#endif
+
+  // The engine waits for in-flight reads, which use cached descriptors
+  delete io_engine_;
+  delete fd_cache_;
+  delete disk_cache_;
 }
 
 /* ********************************* */
@@ -64,12 +130,26 @@ VFS::~VFS() {
 std::string VFS::abs_path(const std::string& path) {
   if (URI::is_posix(path))
     return posix::abs_path(path);
-  if (URI::is_hdfs(path))
+  if (URI::is_hdfs(path) || URI::is_mem(path))
     return path;
   // Certainly starts with "<resource>://" other than "file://"
   return path;
 }
 
+Status VFS::close_file(const URI& uri) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, true));
+  if (uri.is_posix())
+    return fd_cache_->close(uri.to_path());
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->flush(uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
+#endif
+  }
+  return Status::Ok();
+}
+
 Status VFS::create_dir(const URI& uri) const {
   if (uri.is_posix()) {
     return posix::create_dir(uri.to_path());
@@ -79,6 +159,15 @@ Status VFS::create_dir(const URI& uri) const {
     return hdfs::create_dir(hdfs_, uri);
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_mem())
+    return mem::create_dir(uri);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->create_dir(uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::Error(
@@ -94,20 +183,45 @@ Status VFS::create_file(const URI& uri) const {
     return hdfs::create_file(hdfs_, uri);
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_mem())
+    return mem::create_file(uri);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->create_file(uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError(
       std::string("Unsupported URI scheme: ") + uri.to_string());
 }
 
+const FDCache* VFS::fd_cache() const {
+  return fd_cache_;
+}
+
 Status VFS::remove_path(const URI& uri) const {
+  discard_write_buffers(uri);
+  if (disk_cache_ != nullptr)
+    disk_cache_->remove(uri);
   if (uri.is_posix()) {
+    RETURN_NOT_OK(fd_cache_->close_path(uri.to_path()));
     return posix::remove_path(uri.to_path());
   } else if (uri.is_hdfs()) {
 #ifdef HAVE_HDFS
     return hdfs::remove_path(hdfs_, uri);
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  } else if (uri.is_mem()) {
+    return mem::remove_path(uri);
+  } else if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->remove_path(uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   } else {
     return Status::VFSError("Unsupported URI scheme: " + uri.to_string());
@@ -115,7 +229,11 @@ Status VFS::remove_path(const URI& uri) const {
 }
 
 Status VFS::remove_file(const URI& uri) const {
+  discard_write_buffers(uri);
+  if (disk_cache_ != nullptr)
+    disk_cache_->remove(uri);
   if (uri.is_posix()) {
+    RETURN_NOT_OK(fd_cache_->close(uri.to_path()));
     return posix::remove_file(uri.to_path());
   }
   if (uri.is_hdfs()) {
@@ -123,6 +241,15 @@ Status VFS::remove_file(const URI& uri) const {
     return hdfs::remove_file(hdfs_, uri);
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_mem())
+    return mem::remove_file(uri);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->remove_file(uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI scheme: " + uri.to_string());
@@ -131,11 +258,20 @@ Status VFS::remove_file(const URI& uri) const {
 Status VFS::filelock_lock(const URI& uri, int* fd, bool shared) const {
   if (uri.is_posix())
     return posix::filelock_lock(uri.to_path(), fd, shared);
+  if (uri.is_mem())
+    return mem::filelock_lock(uri, fd, shared);
   if (uri.is_hdfs()) {
 #ifdef HAVE_HDFS
     return Status::Ok();
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return Status::Ok();
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI scheme: " + uri.to_string());
@@ -145,30 +281,63 @@ Status VFS::filelock_unlock(const URI& uri, int fd) const {
   if (uri.is_posix()) {
     return posix::filelock_unlock(fd);
   }
+  if (uri.is_mem())
+    return mem::filelock_unlock(fd);
   if (uri.is_hdfs()) {
 #ifdef HAVE_HDFS
     return Status::Ok();
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return Status::Ok();
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI scheme: " + uri.to_string());
 }
 
 Status VFS::file_size(const URI& uri, uint64_t* size) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, false));
   if (uri.is_posix()) {
-    return posix::file_size(uri.to_path(), size);
+    FDCache::Entry* entry;
+    int fd;
+    RETURN_NOT_OK(fd_cache_->acquire(
+        uri.to_path(), FDCache::Mode::READ, &entry, &fd));
+    Status st = posix::file_size(fd, size);
+    fd_cache_->release(entry);
+    return st;
   }
   if (uri.is_hdfs()) {
 #ifdef HAVE_HDFS
     return hdfs::file_size(hdfs_, uri, size);
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_mem())
+    return mem::file_size(uri, size);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->file_size(uri, size);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI scheme: " + uri.to_string());
 }
 
+IOEngine* VFS::io_engine() const {
+  std::unique_lock<std::mutex> lck(io_engine_mtx_);
+  if (io_engine_ == nullptr)
+    io_engine_ = IOEngine::create(
+        params_.io_queue_depth_, params_.io_thread_num_);
+  return io_engine_;
+}
+
 bool VFS::is_dir(const URI& uri) const {
   if (uri.is_posix()) {
     return posix::is_dir(uri.to_path());
@@ -178,6 +347,15 @@ bool VFS::is_dir(const URI& uri) const {
     return hdfs::is_dir(hdfs_, uri);
 #else
     return false;
+#endif
+  }
+  if (uri.is_mem())
+    return mem::is_dir(uri);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->is_dir(uri);
+#else
+    return false;
 #endif
   }
   return false;
@@ -192,6 +370,15 @@ bool VFS::is_file(const URI& uri) const {
     return hdfs::is_file(hdfs_, uri);
 #else
     return false;
+#endif
+  }
+  if (uri.is_mem())
+    return mem::is_file(uri);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->is_file(uri);
+#else
+    return false;
 #endif
   }
   return false;
@@ -206,6 +393,44 @@ Status VFS::ls(const URI& parent, std::vector<URI>* uris) const {
     RETURN_NOT_OK(hdfs::ls(hdfs_, parent, &files));
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  } else if (parent.is_mem()) {
+    RETURN_NOT_OK(mem::ls(parent, &files));
+  } else if (parent.is_s3()) {
+#ifdef HAVE_S3
+    RETURN_NOT_OK(s3_->ls(parent, &files));
+#else
+    return Status::VFSError("TileDB was built without S3 support");
+#endif
+  } else {
+    return Status::VFSError("Unsupported URI scheme: " + parent.to_string());
+  }
+  for (auto& file : files) {
+    uris->push_back(URI(file));
+  }
+  return Status::Ok();
+}
+
+Status VFS::ls_with_types(
+    const URI& parent,
+    std::vector<URI>* uris,
+    std::vector<bool>* is_dirs) const {
+  std::vector<std::string> files;
+  if (parent.is_posix()) {
+    RETURN_NOT_OK(posix::ls_with_types(parent.to_path(), &files, is_dirs));
+  } else if (parent.is_hdfs()) {
+#ifdef HAVE_HDFS
+    RETURN_NOT_OK(hdfs::ls_with_types(hdfs_, parent, &files, is_dirs));
+#else
+    return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  } else if (parent.is_mem()) {
+    RETURN_NOT_OK(mem::ls_with_types(parent, &files, is_dirs));
+  } else if (parent.is_s3()) {
+#ifdef HAVE_S3
+    RETURN_NOT_OK(s3_->ls_with_types(parent, &files, is_dirs));
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   } else {
     return Status::VFSError("Unsupported URI scheme: " + parent.to_string());
@@ -216,8 +441,32 @@ Status VFS::ls(const URI& parent, std::vector<URI>* uris) const {
   return Status::Ok();
 }
 
+Status VFS::map_file(const URI& uri, void** data, uint64_t* size) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, false));
+  if (uri.is_posix()) {
+    FDCache::Entry* entry;
+    int fd;
+    RETURN_NOT_OK(fd_cache_->acquire(
+        uri.to_path(), FDCache::Mode::READ, &entry, &fd));
+    Status st = posix::file_size(fd, size);
+    if (st.ok())
+      st = posix::map_file(fd, *size, data);
+    fd_cache_->release(entry);
+    return st;
+  }
+  return Status::VFSError(
+      "Cannot map file '" + uri.to_string() +
+      "'; Memory mapping is supported only for POSIX files");
+}
+
 Status VFS::move_path(const URI& old_uri, const URI& new_uri) {
+  RETURN_NOT_OK(flush_write_buffers(old_uri, true));
+  if (disk_cache_ != nullptr) {
+    disk_cache_->remove(old_uri);
+    disk_cache_->remove(new_uri);
+  }
   if (old_uri.is_posix()) {
+    RETURN_NOT_OK(fd_cache_->close_path(old_uri.to_path()));
     if (new_uri.is_posix()) {
       return posix::move_path(old_uri.to_path(), new_uri.to_path());
     }
@@ -237,50 +486,432 @@ Status VFS::move_path(const URI& old_uri, const URI& new_uri) {
       return hdfs::get_path(old_uri, new_uri);
     }
   }
+  if (old_uri.is_mem() && new_uri.is_mem())
+    return mem::move_path(old_uri, new_uri);
+  if (old_uri.is_s3() && new_uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->move_path(old_uri, new_uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
+#endif
+  }
   return Status::VFSError(
       "Unsupported URI schemes: " + old_uri.to_string() + ", " +
       new_uri.to_string());
 }
 
-Status VFS::read_from_file(
-    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const {
+Status VFS::move_file_no_replace(
+    const URI& old_uri, const URI& new_uri, bool* moved) {
+  RETURN_NOT_OK(flush_write_buffers(old_uri, true));
+  if (disk_cache_ != nullptr)
+    disk_cache_->remove(old_uri);
+  Status st;
+  if (old_uri.is_posix() && new_uri.is_posix()) {
+    RETURN_NOT_OK(fd_cache_->close(old_uri.to_path()));
+    st = posix::move_file_no_replace(
+        old_uri.to_path(), new_uri.to_path(), moved);
+  } else if (old_uri.is_hdfs() && new_uri.is_hdfs()) {
+#ifdef HAVE_HDFS
+    st = hdfs::move_file_no_replace(hdfs_, old_uri, new_uri, moved);
+#else
+    return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  } else if (old_uri.is_mem() && new_uri.is_mem()) {
+    st = mem::move_file_no_replace(old_uri, new_uri, moved);
+  } else if (old_uri.is_s3() && new_uri.is_s3()) {
+#ifdef HAVE_S3
+    st = s3_->move_file_no_replace(old_uri, new_uri, moved);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
+#endif
+  } else {
+    return Status::VFSError(
+        "Unsupported URI schemes: " + old_uri.to_string() + ", " +
+        new_uri.to_string());
+  }
+
+  // Blocks of a previous file at the new URI must not be served
+  if (st.ok() && *moved && disk_cache_ != nullptr)
+    disk_cache_->remove(new_uri);
+
+  return st;
+}
+
+Status VFS::read_batch(
+    const URI& uri, const std::vector<ReadRange>& ranges) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, false));
   if (uri.is_posix()) {
-    return posix::read_from_file(uri.to_path(), offset, buffer, nbytes);
+    FDCache::Entry* entry;
+    int fd;
+    RETURN_NOT_OK(fd_cache_->acquire(
+        uri.to_path(), FDCache::Mode::READ, &entry, &fd));
+
+    // Group adjacent ranges into vectored reads
+    Status st;
+    std::vector<struct iovec> iov;
+    uint64_t offset = 0, end = 0;
+    for (auto& range : ranges) {
+      if (range.nbytes == 0)
+        continue;
+      if (!iov.empty() && (range.offset != end || iov.size() == IOV_MAX)) {
+        st = posix::read_from_file(fd, offset, &iov[0], (int)iov.size());
+        if (!st.ok())
+          break;
+        iov.clear();
+      }
+      if (iov.empty())
+        offset = range.offset;
+      struct iovec v = {range.buffer, range.nbytes};
+      iov.push_back(v);
+      end = range.offset + range.nbytes;
+    }
+    if (st.ok() && !iov.empty())
+      st = posix::read_from_file(fd, offset, &iov[0], (int)iov.size());
+
+    fd_cache_->release(entry);
+    return st;
   }
   if (uri.is_hdfs()) {
-#ifdef HAVE_HDFS
-    return hdfs::read_from_file(hdfs_, uri, offset, buffer, nbytes);
+    for (auto& range : ranges)
+      RETURN_NOT_OK(
+          read_remote(uri, range.offset, range.buffer, range.nbytes));
+    return Status::Ok();
+  }
+  if (uri.is_mem()) {
+    for (auto& range : ranges)
+      RETURN_NOT_OK(mem::read_from_file(
+          uri, range.offset, range.buffer, range.nbytes));
+    return Status::Ok();
+  }
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    // Issue the ranged GETs in parallel
+    return s3_->parallel(ranges.size(), [&](uint64_t i) {
+      return read_remote(
+          uri, ranges[i].offset, ranges[i].buffer, ranges[i].nbytes);
+    });
 #else
-    return Status::VFSError("TileDB was built without HDFS support");
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI schemes: " + uri.to_string());
 }
 
+Status VFS::read_async(
+    const URI& uri,
+    const std::vector<ReadRange>& ranges,
+    IOBatch* batch) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, false));
+  if (!uri.is_posix()) {
+    batch->expect(1);
+    batch->complete(read_batch(uri, ranges));
+    return Status::Ok();
+  }
+
+  // The descriptor stays pinned until the batch is waited on
+  FDCache::Entry* entry;
+  int fd;
+  RETURN_NOT_OK(
+      fd_cache_->acquire(uri.to_path(), FDCache::Mode::READ, &entry, &fd));
+  batch->mtx_.lock();
+  batch->fd_entries_.push_back(entry);
+  batch->mtx_.unlock();
+
+  std::vector<IORequest> requests;
+  requests.reserve(ranges.size());
+  for (auto& range : ranges) {
+    if (range.nbytes == 0)
+      continue;
+    IORequest request = {fd, range.offset, range.nbytes, range.buffer, batch};
+    requests.push_back(request);
+  }
+  batch->expect(requests.size());
+
+  return io_engine()->submit(requests);
+}
+
+Status VFS::read_from_file(
+    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, false));
+  if (uri.is_posix()) {
+    FDCache::Entry* entry;
+    int fd;
+    RETURN_NOT_OK(fd_cache_->acquire(
+        uri.to_path(), FDCache::Mode::READ, &entry, &fd));
+    Status st = posix::read_from_file(fd, offset, buffer, nbytes);
+    fd_cache_->release(entry);
+    return st;
+  }
+  if (uri.is_hdfs() || uri.is_s3())
+    return read_remote(uri, offset, buffer, nbytes);
+  if (uri.is_mem())
+    return mem::read_from_file(uri, offset, buffer, nbytes);
+  return Status::VFSError("Unsupported URI schemes: " + uri.to_string());
+}
+
 Status VFS::sync(const URI& uri) const {
+  RETURN_NOT_OK(flush_write_buffers(uri, false));
   if (uri.is_posix()) {
-    return posix::sync(uri.to_path());
+    // Directories and missing files are not cached
+    if (!posix::is_file(uri.to_path()))
+      return posix::sync(uri.to_path());
+    FDCache::Entry* entry;
+    int fd;
+    RETURN_NOT_OK(fd_cache_->acquire(
+        uri.to_path(), FDCache::Mode::APPEND, &entry, &fd));
+    Status st = posix::sync(fd);
+    fd_cache_->release(entry);
+    return st;
   }
   if (uri.is_hdfs()) {
 #ifdef HAVE_HDFS
     return Status::Ok();
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_mem())
+    return mem::sync(uri);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->flush(uri);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI schemes: " + uri.to_string());
 }
 
+Status VFS::unmap_file(const URI& uri, void* data, uint64_t size) const {
+  if (uri.is_posix())
+    return posix::unmap_file(data, size);
+  return Status::VFSError(
+      "Cannot unmap file '" + uri.to_string() +
+      "'; Memory mapping is supported only for POSIX files");
+}
+
+Status VFS::wait_reads(IOBatch* batch) const {
+  Status st = batch->wait();
+
+  batch->mtx_.lock();
+  for (auto entry : batch->fd_entries_)
+    fd_cache_->release(entry);
+  batch->fd_entries_.clear();
+  batch->mtx_.unlock();
+
+  return st;
+}
+
 Status VFS::write_to_file(
     const URI& uri, const void* buffer, uint64_t buffer_size) const {
+  // In-memory files gain nothing from buffering, and S3 objects are
+  // buffered by their multipart uploads
+  uint64_t capacity = params_.write_buffer_size_;
+  if (capacity == 0 || uri.is_mem() || uri.is_s3())
+    return write_direct(uri, buffer, buffer_size);
+
+  // Find or create the buffer of the file, and pin it
+  WriteBuffer* write_buffer;
+  for (;;) {
+    write_buffers_mtx_.lock();
+    auto it = write_buffers_.find(uri.to_string());
+    if (it != write_buffers_.end()) {
+      write_buffer = it->second;
+    } else {
+      // The file is visible from the first write on
+      if (!is_file(uri)) {
+        Status st = create_file(uri);
+        if (!st.ok()) {
+          write_buffers_mtx_.unlock();
+          return st;
+        }
+      }
+      write_buffer = new WriteBuffer(uri);
+      write_buffers_[uri.to_string()] = write_buffer;
+    }
+    ++write_buffer->refs_;
+    write_buffers_mtx_.unlock();
+
+    // Start over if the file was closed or removed meanwhile
+    write_buffer->mtx_.lock();
+    if (!write_buffer->dropped_)
+      break;
+    write_buffer->mtx_.unlock();
+    release_write_buffer(write_buffer);
+  }
+
+  // Flush if full, and write large buffers directly
+  Status st;
+  if (write_buffer->buffer_.size() + buffer_size > capacity)
+    st = flush_write_buffer(write_buffer);
+  if (st.ok()) {
+    if (buffer_size >= capacity)
+      st = write_direct(uri, buffer, buffer_size);
+    else
+      st = write_buffer->buffer_.write(buffer, buffer_size);
+  }
+  write_buffer->mtx_.unlock();
+  release_write_buffer(write_buffer);
+
+  return st;
+}
+
+/* ********************************* */
+/*          PRIVATE METHODS          */
+/* ********************************* */
+
+void VFS::discard_write_buffers(const URI& uri) const {
+  std::vector<WriteBuffer*> write_buffers;
+  pin_write_buffers(uri, &write_buffers);
+  for (auto write_buffer : write_buffers) {
+    write_buffer->mtx_.lock();
+    drop_write_buffer(write_buffer);
+    write_buffer->mtx_.unlock();
+    release_write_buffer(write_buffer);
+  }
+}
+
+void VFS::drop_write_buffer(WriteBuffer* write_buffer) const {
+  std::unique_lock<std::mutex> lck(write_buffers_mtx_);
+  if (write_buffer->dropped_)
+    return;
+  write_buffer->dropped_ = true;
+  write_buffers_.erase(write_buffer->uri_.to_string());
+}
+
+Status VFS::fetch_remote(
+    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const {
+  if (uri.is_hdfs()) {
+#ifdef HAVE_HDFS
+    return hdfs::read_from_file(hdfs_, uri, offset, buffer, nbytes);
+#else
+    return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->read_from_file(uri, offset, buffer, nbytes);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
+#endif
+  }
+  return Status::VFSError("Unsupported URI schemes: " + uri.to_string());
+}
+
+Status VFS::flush_write_buffer(WriteBuffer* write_buffer) const {
+  auto& buffer = write_buffer->buffer_;
+  if (buffer.size() == 0)
+    return Status::Ok();
+
+  // The data is kept upon error, so that flushing can be retried
+  RETURN_NOT_OK(
+      write_direct(write_buffer->uri_, buffer.data(), buffer.size()));
+  buffer.reset_size();
+  buffer.reset_offset();
+
+  return Status::Ok();
+}
+
+Status VFS::flush_write_buffers(const URI& uri, bool drop) const {
+  std::vector<WriteBuffer*> write_buffers;
+  pin_write_buffers(uri, &write_buffers);
+
+  // Buffers that fail to flush are kept, so that no data is lost
+  Status st;
+  for (auto write_buffer : write_buffers) {
+    write_buffer->mtx_.lock();
+    Status st_flush = flush_write_buffer(write_buffer);
+    if (drop && st_flush.ok())
+      drop_write_buffer(write_buffer);
+    write_buffer->mtx_.unlock();
+    release_write_buffer(write_buffer);
+    if (st.ok())
+      st = st_flush;
+  }
+
+  return st;
+}
+
+bool VFS::is_immutable(const URI& uri) const {
+  // Fragment files do not change once the fragment metadata is written
+  URI dir = uri.parent();
+  if (disk_cache_->is_immutable(dir))
+    return true;
+
+  // Negative answers expire, as the fragment may be completed soon
+  if (disk_cache_->is_mutable(dir))
+    return false;
+  if (!is_file(dir.join_path(constants::fragment_metadata_filename))) {
+    disk_cache_->set_mutable(dir, params_.disk_cache_mutable_ttl_);
+    return false;
+  }
+  disk_cache_->set_immutable(dir);
+  return true;
+}
+
+void VFS::pin_write_buffers(
+    const URI& uri, std::vector<WriteBuffer*>* write_buffers) const {
+  std::unique_lock<std::mutex> lck(write_buffers_mtx_);
+  if (write_buffers_.empty())
+    return;
+  std::string path = uri.to_string();
+  std::string dir = path + "/";
+  for (auto& write_buffer : write_buffers_) {
+    if (write_buffer.first == path ||
+        utils::starts_with(write_buffer.first, dir)) {
+      ++write_buffer.second->refs_;
+      write_buffers->push_back(write_buffer.second);
+    }
+  }
+}
+
+Status VFS::read_remote(
+    const URI& uri, uint64_t offset, void* buffer, uint64_t nbytes) const {
+  if (disk_cache_ == nullptr || !is_immutable(uri))
+    return fetch_remote(uri, offset, buffer, nbytes);
+
+  uint64_t size;
+  if (!disk_cache_->file_size(uri, &size)) {
+    RETURN_NOT_OK(file_size(uri, &size));
+    disk_cache_->set_file_size(uri, size);
+  }
+  return disk_cache_->read(
+      uri, size, offset, buffer, nbytes, [&](uint64_t o, void* b, uint64_t n) {
+        return fetch_remote(uri, o, b, n);
+      });
+}
+
+void VFS::release_write_buffer(WriteBuffer* write_buffer) const {
+  std::unique_lock<std::mutex> lck(write_buffers_mtx_);
+  if (--write_buffer->refs_ == 0 && write_buffer->dropped_)
+    delete write_buffer;
+}
+
+Status VFS::write_direct(
+    const URI& uri, const void* buffer, uint64_t buffer_size) const {
   if (uri.is_posix()) {
-    return posix::write_to_file(uri.to_path(), buffer, buffer_size);
+    FDCache::Entry* entry;
+    int fd;
+    RETURN_NOT_OK(fd_cache_->acquire(
+        uri.to_path(), FDCache::Mode::APPEND, &entry, &fd));
+    Status st = posix::write_to_file(fd, buffer, buffer_size);
+    fd_cache_->release(entry);
+    return st;
   }
   if (uri.is_hdfs()) {
 #ifdef HAVE_HDFS
     return hdfs::write_to_file(hdfs_, uri, buffer, buffer_size);
 #else
     return Status::VFSError("TileDB was built without HDFS support");
+#endif
+  }
+  if (uri.is_mem())
+    return mem::write_to_file(uri, buffer, buffer_size);
+  if (uri.is_s3()) {
+#ifdef HAVE_S3
+    return s3_->write_to_file(uri, buffer, buffer_size);
+#else
+    return Status::VFSError("TileDB was built without S3 support");
 #endif
   }
   return Status::VFSError("Unsupported URI schemes: " + uri.to_string());
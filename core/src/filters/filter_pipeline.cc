@@ -0,0 +1,641 @@
+/**
+ * @file   filter_pipeline.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class FilterPipeline.
+ */
+
+#include "filter_pipeline.h"
+#include "constants.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace tiledb {
+
+namespace {
+
+/** Loads a value of *width* bytes (zero-extended). */
+inline uint64_t load(const char* data, uint64_t width) {
+  uint64_t value = 0;
+  std::memcpy(&value, data, width);
+  return value;
+}
+
+/** Stores the lowest *width* bytes of a value. */
+inline void store(char* data, uint64_t value, uint64_t width) {
+  std::memcpy(data, &value, width);
+}
+
+/** Returns the mask of the lowest *width* bytes. */
+inline uint64_t mask(uint64_t width) {
+  return (width == sizeof(uint64_t)) ? ~uint64_t(0) :
+                                       (uint64_t(1) << (8 * width)) - 1;
+}
+
+/** Sign-extends a value of *width* bytes. */
+inline int64_t sign_extend(uint64_t value, uint64_t width) {
+  unsigned shift = 64 - 8 * (unsigned)width;
+  return (int64_t)(value << shift) >> shift;
+}
+
+/** Checks if a type is a signed integer type. */
+inline bool is_signed_int(Datatype type) {
+  return type == Datatype::INT8 || type == Datatype::INT16 ||
+         type == Datatype::INT32 || type == Datatype::INT64 ||
+         type == Datatype::CHAR;
+}
+
+/** Checks if a type is an unsigned integer type. */
+inline bool is_unsigned_int(Datatype type) {
+  return type == Datatype::UINT8 || type == Datatype::UINT16 ||
+         type == Datatype::UINT32 || type == Datatype::UINT64;
+}
+
+/** Appends values of up to 64 bits to a bit stream. */
+class BitWriter {
+ public:
+  explicit BitWriter(char* data)
+      : acc_(0)
+      , bits_(0)
+      , data_((unsigned char*)data) {
+  }
+
+  /** Appends the lowest *width* bits of a value. */
+  void put(uint64_t value, unsigned width) {
+    if (width > 32) {
+      put(value & 0xffffffff, 32);
+      put(value >> 32, width - 32);
+      return;
+    }
+    acc_ |= value << bits_;
+    bits_ += width;
+    while (bits_ >= 8) {
+      *data_++ = (unsigned char)acc_;
+      acc_ >>= 8;
+      bits_ -= 8;
+    }
+  }
+
+  /** Writes the pending bits, padding the last byte. */
+  void flush() {
+    if (bits_ > 0)
+      *data_++ = (unsigned char)acc_;
+    acc_ = 0;
+    bits_ = 0;
+  }
+
+ private:
+  uint64_t acc_;
+  unsigned bits_;
+  unsigned char* data_;
+};
+
+/** Reads values of up to 64 bits from a bit stream. */
+class BitReader {
+ public:
+  explicit BitReader(const char* data)
+      : acc_(0)
+      , bits_(0)
+      , data_((const unsigned char*)data) {
+  }
+
+  /** Reads a value of *width* bits. */
+  uint64_t get(unsigned width) {
+    if (width > 32) {
+      uint64_t low = get(32);
+      return low | (get(width - 32) << 32);
+    }
+    while (bits_ < width) {
+      acc_ |= uint64_t(*data_++) << bits_;
+      bits_ += 8;
+    }
+    uint64_t value = acc_ & ((uint64_t(1) << width) - 1);
+    acc_ >>= width;
+    bits_ -= width;
+    return value;
+  }
+
+  /** Skips the padding of the last byte. */
+  void align() {
+    acc_ = 0;
+    bits_ = 0;
+  }
+
+ private:
+  uint64_t acc_;
+  unsigned bits_;
+  const unsigned char* data_;
+};
+
+/** Returns the number of bytes of *value_num* values of *width* bits. */
+inline uint64_t packed_size(uint64_t value_num, unsigned width) {
+  return (value_num * width + 7) / 8;
+}
+
+}  // namespace
+
+/* ********************************* */
+/*     CONSTRUCTORS & DESTRUCTORS    */
+/* ********************************* */
+
+FilterPipeline::FilterPipeline() = default;
+
+FilterPipeline::~FilterPipeline() = default;
+
+/* ********************************* */
+/*                API                */
+/* ********************************* */
+
+void FilterPipeline::add_filter(FilterType filter) {
+  filters_.push_back(filter);
+}
+
+// ===== FORMAT =====
+// filter_num (unsigned int)
+// filter #1 (char)
+// filter #2 (char)
+// ...
+Status FilterPipeline::deserialize(ConstBuffer* buff) {
+  unsigned int filter_num;
+  RETURN_NOT_OK(buff->read(&filter_num, sizeof(unsigned int)));
+  filters_.clear();
+  for (unsigned int i = 0; i < filter_num; ++i) {
+    char filter;
+    RETURN_NOT_OK(buff->read(&filter, sizeof(char)));
+    if (filter < (char)FilterType::BYTESHUFFLE ||
+        filter > (char)FilterType::BIT_WIDTH_REDUCTION)
+      return LOG_STATUS(Status::FilterError(
+          "Cannot deserialize filter pipeline; Unknown filter type"));
+    filters_.push_back((FilterType)filter);
+  }
+
+  return Status::Ok();
+}
+
+void FilterPipeline::dump(FILE* out) const {
+  if (filters_.empty())
+    return;
+
+  fprintf(out, "- Filters:");
+  for (auto filter : filters_)
+    fprintf(out, " %s", filter_type_str(filter));
+  fprintf(out, "\n");
+}
+
+bool FilterPipeline::empty() const {
+  return filters_.empty();
+}
+
+FilterType FilterPipeline::filter(unsigned int i) const {
+  assert(i < filters_.size());
+  return filters_[i];
+}
+
+unsigned int FilterPipeline::filter_num() const {
+  return (unsigned int)filters_.size();
+}
+
+uint64_t FilterPipeline::overhead(uint64_t nbytes) const {
+  // Only bit width reduction adds data: the value number, plus the minimum
+  // and bit width of each window
+  uint64_t total = 0;
+  for (auto filter : filters_) {
+    if (filter != FilterType::BIT_WIDTH_REDUCTION)
+      continue;
+    uint64_t filter_overhead =
+        sizeof(uint64_t) +
+        (nbytes / constants::bit_width_reduction_window + 1) *
+            2 * sizeof(uint64_t);
+    total += filter_overhead;
+    nbytes += filter_overhead;
+  }
+
+  return total;
+}
+
+Status FilterPipeline::run_forward(
+    Datatype type, ConstBuffer* input, Buffer* output) const {
+  return run(type, false, input, output);
+}
+
+Status FilterPipeline::run_reverse(
+    Datatype type, ConstBuffer* input, Buffer* output) const {
+  return run(type, true, input, output);
+}
+
+// ===== FORMAT =====
+// filter_num (unsigned int)
+// filter #1 (char)
+// filter #2 (char)
+// ...
+Status FilterPipeline::serialize(Buffer* buff) const {
+  auto filter_num = (unsigned int)filters_.size();
+  RETURN_NOT_OK(buff->write(&filter_num, sizeof(unsigned int)));
+  for (auto filter : filters_) {
+    auto filter_c = (char)filter;
+    RETURN_NOT_OK(buff->write(&filter_c, sizeof(char)));
+  }
+
+  return Status::Ok();
+}
+
+/* ********************************* */
+/*          PRIVATE METHODS          */
+/* ********************************* */
+
+Status FilterPipeline::apply(
+    FilterType filter,
+    Datatype type,
+    bool reverse,
+    ConstBuffer* input,
+    Buffer* output) {
+  auto value_size = datatype_size(type);
+  switch (filter) {
+    case FilterType::BYTESHUFFLE:
+      return reverse ? byteunshuffle(value_size, input, output) :
+                       byteshuffle(value_size, input, output);
+    case FilterType::BITSHUFFLE:
+      return reverse ? bitunshuffle(value_size, input, output) :
+                       bitshuffle(value_size, input, output);
+    case FilterType::DELTA:
+      return reverse ? delta_decode(value_size, input, output) :
+                       delta_encode(value_size, input, output);
+    case FilterType::BIT_WIDTH_REDUCTION:
+      return reverse ? bit_width_expand(type, input, output) :
+                       bit_width_reduce(type, input, output);
+  }
+
+  return LOG_STATUS(
+      Status::FilterError("Cannot apply filter; Unknown filter type"));
+}
+
+// ===== FORMAT =====
+// value_num (uint64_t)
+// window #1: minimum (value), bit_width (uint8_t), packed differences
+// window #2: ...
+// trailing bytes that do not make a whole value
+Status FilterPipeline::bit_width_reduce(
+    Datatype type, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  // Non-integer values pass through
+  bool is_signed = is_signed_int(type);
+  if (!is_signed && !is_unsigned_int(type)) {
+    input->advance_offset(nbytes);
+    return output->write(in, nbytes);
+  }
+
+  auto value_size = datatype_size(type);
+  uint64_t value_num = nbytes / value_size;
+  uint64_t window = constants::bit_width_reduction_window;
+  uint64_t window_num = (value_num + window - 1) / window;
+  uint64_t max_size = sizeof(uint64_t) +
+                      window_num * (value_size + sizeof(uint8_t)) + nbytes;
+  RETURN_NOT_OK(output->reserve(max_size));
+  auto out = (char*)output->cur_data();
+  char* out_start = out;
+  std::memcpy(out, &value_num, sizeof(uint64_t));
+  out += sizeof(uint64_t);
+
+  uint64_t value_mask = mask(value_size);
+  for (uint64_t start = 0; start < value_num; start += window) {
+    uint64_t end = std::min(start + window, value_num);
+
+    // Find the window minimum and maximum
+    uint64_t min = load(in + start * value_size, value_size);
+    uint64_t max = min;
+    for (uint64_t i = start + 1; i < end; ++i) {
+      uint64_t v = load(in + i * value_size, value_size);
+      if (is_signed) {
+        if (sign_extend(v, value_size) < sign_extend(min, value_size))
+          min = v;
+        if (sign_extend(v, value_size) > sign_extend(max, value_size))
+          max = v;
+      } else {
+        if (v < min)
+          min = v;
+        if (v > max)
+          max = v;
+      }
+    }
+
+    // Pack the differences from the minimum
+    uint64_t range = (max - min) & value_mask;
+    unsigned width = 0;
+    while (width < 64 && (range >> width) != 0)
+      ++width;
+    store(out, min, value_size);
+    out += value_size;
+    *out++ = (char)width;
+    BitWriter writer(out);
+    if (width > 0) {
+      for (uint64_t i = start; i < end; ++i) {
+        uint64_t v = load(in + i * value_size, value_size);
+        writer.put((v - min) & value_mask, width);
+      }
+      writer.flush();
+    }
+    out += packed_size(end - start, width);
+  }
+
+  // Trailing bytes
+  uint64_t tail = nbytes - value_num * value_size;
+  std::memcpy(out, in + value_num * value_size, tail);
+  out += tail;
+
+  input->advance_offset(nbytes);
+  output->commit(out - out_start);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::bit_width_expand(
+    Datatype type, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  // Non-integer values passed through
+  bool is_signed = is_signed_int(type);
+  if (!is_signed && !is_unsigned_int(type)) {
+    input->advance_offset(nbytes);
+    return output->write(in, nbytes);
+  }
+
+  auto value_size = datatype_size(type);
+  const char* in_end = in + nbytes;
+  uint64_t value_num;
+  if (nbytes < sizeof(uint64_t))
+    return LOG_STATUS(Status::FilterError(
+        "Cannot reverse bit width reduction; Invalid input"));
+  std::memcpy(&value_num, in, sizeof(uint64_t));
+  in += sizeof(uint64_t);
+  uint64_t window = constants::bit_width_reduction_window;
+  if (value_num > (nbytes / (value_size + 1) + 1) * window)
+    return LOG_STATUS(Status::FilterError(
+        "Cannot reverse bit width reduction; Invalid input"));
+
+  RETURN_NOT_OK(output->reserve(value_num * value_size));
+  auto out = (char*)output->cur_data();
+  char* out_start = out;
+
+  uint64_t value_mask = mask(value_size);
+  for (uint64_t start = 0; start < value_num; start += window) {
+    uint64_t end = std::min(start + window, value_num);
+    if (in + value_size + sizeof(uint8_t) > in_end)
+      return LOG_STATUS(Status::FilterError(
+          "Cannot reverse bit width reduction; Invalid input"));
+    uint64_t min = load(in, value_size);
+    in += value_size;
+    auto width = (unsigned)(unsigned char)*in++;
+    uint64_t size = packed_size(end - start, width);
+    if (width > 8 * value_size || in + size > in_end)
+      return LOG_STATUS(Status::FilterError(
+          "Cannot reverse bit width reduction; Invalid input"));
+
+    BitReader reader(in);
+    for (uint64_t i = start; i < end; ++i) {
+      uint64_t diff = (width > 0) ? reader.get(width) : 0;
+      store(out, (min + diff) & value_mask, value_size);
+      out += value_size;
+    }
+    in += size;
+  }
+  output->commit(out - out_start);
+
+  // Trailing bytes
+  input->advance_offset(nbytes);
+  return output->write(in, in_end - in);
+}
+
+Status FilterPipeline::bitshuffle(
+    uint64_t value_size, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  // Whole groups of 8 values are shuffled, so that bit planes are whole
+  // bytes; the rest is copied as is
+  uint64_t value_num = nbytes / value_size / 8 * 8;
+  uint64_t plane_size = value_num / 8;
+  RETURN_NOT_OK(output->reserve(nbytes));
+  auto out = (char*)output->cur_data();
+  std::memset(out, 0, value_num * value_size);
+  auto planes = (unsigned char*)out;
+  for (uint64_t i = 0; i < value_num; ++i) {
+    auto value = (const unsigned char*)in + i * value_size;
+    auto bit = (unsigned char)(1 << (i % 8));
+    for (uint64_t b = 0; b < value_size; ++b) {
+      unsigned char byte = value[b];
+      for (unsigned t = 0; byte != 0; ++t, byte >>= 1) {
+        if (byte & 1)
+          planes[(8 * b + t) * plane_size + i / 8] |= bit;
+      }
+    }
+  }
+  std::memcpy(
+      out + value_num * value_size,
+      in + value_num * value_size,
+      nbytes - value_num * value_size);
+
+  input->advance_offset(nbytes);
+  output->commit(nbytes);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::bitunshuffle(
+    uint64_t value_size, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  uint64_t value_num = nbytes / value_size / 8 * 8;
+  uint64_t plane_size = value_num / 8;
+  RETURN_NOT_OK(output->reserve(nbytes));
+  auto out = (char*)output->cur_data();
+  std::memset(out, 0, value_num * value_size);
+  auto planes = (const unsigned char*)in;
+  auto values = (unsigned char*)out;
+  for (uint64_t k = 0; k < 8 * value_size; ++k) {
+    auto bit = (unsigned char)(1 << (k % 8));
+    for (uint64_t j = 0; j < plane_size; ++j) {
+      unsigned char byte = planes[k * plane_size + j];
+      for (unsigned t = 0; byte != 0; ++t, byte >>= 1) {
+        if (byte & 1)
+          values[(8 * j + t) * value_size + k / 8] |= bit;
+      }
+    }
+  }
+  std::memcpy(
+      out + value_num * value_size,
+      in + value_num * value_size,
+      nbytes - value_num * value_size);
+
+  input->advance_offset(nbytes);
+  output->commit(nbytes);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::byteshuffle(
+    uint64_t value_size, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  uint64_t value_num = nbytes / value_size;
+  RETURN_NOT_OK(output->reserve(nbytes));
+  auto out = (char*)output->cur_data();
+  for (uint64_t b = 0; b < value_size; ++b) {
+    char* plane = out + b * value_num;
+    for (uint64_t i = 0; i < value_num; ++i)
+      plane[i] = in[i * value_size + b];
+  }
+  std::memcpy(
+      out + value_num * value_size,
+      in + value_num * value_size,
+      nbytes - value_num * value_size);
+
+  input->advance_offset(nbytes);
+  output->commit(nbytes);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::byteunshuffle(
+    uint64_t value_size, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  uint64_t value_num = nbytes / value_size;
+  RETURN_NOT_OK(output->reserve(nbytes));
+  auto out = (char*)output->cur_data();
+  for (uint64_t b = 0; b < value_size; ++b) {
+    const char* plane = in + b * value_num;
+    for (uint64_t i = 0; i < value_num; ++i)
+      out[i * value_size + b] = plane[i];
+  }
+  std::memcpy(
+      out + value_num * value_size,
+      in + value_num * value_size,
+      nbytes - value_num * value_size);
+
+  input->advance_offset(nbytes);
+  output->commit(nbytes);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::delta_decode(
+    uint64_t value_size, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  uint64_t value_num = nbytes / value_size;
+  uint64_t value_mask = mask(value_size);
+  RETURN_NOT_OK(output->reserve(nbytes));
+  auto out = (char*)output->cur_data();
+  uint64_t prev = 0;
+  for (uint64_t i = 0; i < value_num; ++i) {
+    prev = (prev + load(in + i * value_size, value_size)) & value_mask;
+    store(out + i * value_size, prev, value_size);
+  }
+  std::memcpy(
+      out + value_num * value_size,
+      in + value_num * value_size,
+      nbytes - value_num * value_size);
+
+  input->advance_offset(nbytes);
+  output->commit(nbytes);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::delta_encode(
+    uint64_t value_size, ConstBuffer* input, Buffer* output) {
+  auto in = (const char*)input->data() + input->offset();
+  uint64_t nbytes = input->nbytes_left_to_read();
+
+  uint64_t value_num = nbytes / value_size;
+  uint64_t value_mask = mask(value_size);
+  RETURN_NOT_OK(output->reserve(nbytes));
+  auto out = (char*)output->cur_data();
+  uint64_t prev = 0;
+  for (uint64_t i = 0; i < value_num; ++i) {
+    uint64_t value = load(in + i * value_size, value_size);
+    store(out + i * value_size, (value - prev) & value_mask, value_size);
+    prev = value;
+  }
+  std::memcpy(
+      out + value_num * value_size,
+      in + value_num * value_size,
+      nbytes - value_num * value_size);
+
+  input->advance_offset(nbytes);
+  output->commit(nbytes);
+
+  return Status::Ok();
+}
+
+Status FilterPipeline::run(
+    Datatype type, bool reverse, ConstBuffer* input, Buffer* output) const {
+  auto filter_num = filters_.size();
+  if (filter_num == 0)
+    return output->write(input, input->nbytes_left_to_read());
+
+  // The intermediate results alternate between two scratch buffers
+  Buffer* scratch[2] = {nullptr, nullptr};
+  ConstBuffer* stage_input = input;
+  Status st;
+  for (size_t i = 0; i < filter_num && st.ok(); ++i) {
+    auto filter = reverse ? filters_[filter_num - 1 - i] : filters_[i];
+    Buffer* stage_output = output;
+    if (i + 1 < filter_num) {
+      if (scratch[i % 2] == nullptr)
+        scratch[i % 2] = new Buffer();
+      stage_output = scratch[i % 2];
+      stage_output->reset_size();
+      stage_output->reset_offset();
+    }
+    st = apply(filter, type, reverse, stage_input, stage_output);
+    if (stage_input != input)
+      delete stage_input;
+    stage_input =
+        (stage_output != output) ? new ConstBuffer(stage_output) : nullptr;
+  }
+
+  if (stage_input != input)
+    delete stage_input;
+  delete scratch[0];
+  delete scratch[1];
+
+  return st;
+}
+
+}  // namespace tiledb
@@ -116,7 +116,10 @@ Status Fragment::finalize() {
       return st_rn;
   }
 
-  // READ - nothing to be done
+  // READ
+  if (read_state_ != nullptr)
+    return read_state_->finalize();
+
   return Status::Ok();
 }
 
@@ -164,6 +167,13 @@ Status Fragment::init(const URI& uri, FragmentMetadata* metadata) {
   metadata_ = metadata;
   dense_ = metadata_->dense();
 
+  // The read state searches the tiles of sparse fragments by their MBRs and
+  // bounding coordinates
+  if (!dense_) {
+    RETURN_NOT_OK(metadata_->load_mbrs());
+    RETURN_NOT_OK(metadata_->load_bounding_coords());
+  }
+
   read_state_ = new ReadState(this, query_, metadata_);
 
   // Success
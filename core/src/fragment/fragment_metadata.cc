@@ -33,7 +33,9 @@
 
 #include "fragment_metadata.h"
 #include "const_buffer.h"
+#include "constants.h"
 #include "logger.h"
+#include "storage_manager.h"
 
 #include <cassert>
 #include <iostream>
@@ -51,6 +53,8 @@ FragmentMetadata::FragmentMetadata(
     , fragment_uri_(fragment_uri) {
   domain_ = nullptr;
   non_empty_domain_ = nullptr;
+  storage_manager_ = nullptr;
+  tile_num_ = 0;
 }
 
 FragmentMetadata::~FragmentMetadata() {
@@ -115,6 +119,10 @@ void FragmentMetadata::append_tile_var_size(
   tile_var_sizes_[attribute_id].push_back(size);
 }
 
+const ArrayMetadata* FragmentMetadata::array_metadata() const {
+  return array_metadata_;
+}
+
 const std::vector<void*>& FragmentMetadata::bounding_coords() const {
   return bounding_coords_;
 }
@@ -135,17 +143,95 @@ bool FragmentMetadata::dense() const {
 }
 
 Status FragmentMetadata::deserialize(ConstBuffer* buf) {
+  unsigned int attribute_num = array_metadata_->attribute_num();
+  tile_offsets_.resize(attribute_num + 1);
+  tile_var_offsets_.resize(attribute_num);
+  tile_var_sizes_.resize(attribute_num);
+
   RETURN_NOT_OK(load_non_empty_domain(buf));
   RETURN_NOT_OK(load_mbrs(buf));
   RETURN_NOT_OK(load_bounding_coords(buf));
-  RETURN_NOT_OK(load_tile_offsets(buf));
-  RETURN_NOT_OK(load_tile_var_offsets(buf));
-  RETURN_NOT_OK(load_tile_var_sizes(buf));
+  for (unsigned int i = 0; i < attribute_num + 1; ++i)
+    RETURN_NOT_OK(load_tile_offsets(i, buf));
+  for (unsigned int i = 0; i < attribute_num; ++i)
+    RETURN_NOT_OK(load_tile_var_offsets(i, buf));
+  for (unsigned int i = 0; i < attribute_num; ++i)
+    RETURN_NOT_OK(load_tile_var_sizes(i, buf));
   RETURN_NOT_OK(load_last_tile_cell_num(buf));
 
   return Status::Ok();
 }
 
+// ===== FORMAT =====
+// magic (uint64_t)
+// index_size (uint64_t)
+// section_num (uint64_t)
+// section_offset_#1 (uint64_t) section_offset_#2 (uint64_t) ...
+// tile_num (uint64_t)
+// last_tile_cell_num (uint64_t)
+// non_empty_domain_size (uint64_t) non_empty_domain (void*)
+Status FragmentMetadata::deserialize_index(
+    StorageManager* storage_manager, ConstBuffer* buff) {
+  // Get magic value and index size
+  uint64_t magic = 0;
+  uint64_t index_size = 0;
+  RETURN_NOT_OK(buff->read(&magic, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->read(&index_size, sizeof(uint64_t)));
+  if (magic != constants::fragment_metadata_index_magic)
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Invalid section index"));
+
+  // Get section offsets
+  uint64_t section_num = 0;
+  Status st = buff->read(&section_num, sizeof(uint64_t));
+  if (!st.ok() || section_num != this->section_num())
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Invalid number of sections"));
+  section_offsets_.resize(section_num);
+  st = buff->read(&section_offsets_[0], section_num * sizeof(uint64_t));
+  if (!st.ok())
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading section offsets failed"));
+
+  // Get number of tiles
+  st = buff->read(&tile_num_, sizeof(uint64_t));
+  if (!st.ok())
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading number of tiles failed"));
+
+  RETURN_NOT_OK(load_last_tile_cell_num(buff));
+  RETURN_NOT_OK(load_non_empty_domain(buff));
+
+  // The remaining sections are loaded on demand
+  unsigned int attribute_num = array_metadata_->attribute_num();
+  tile_offsets_.resize(attribute_num + 1);
+  tile_var_offsets_.resize(attribute_num);
+  tile_var_sizes_.resize(attribute_num);
+  section_loaded_.assign(section_num, false);
+  storage_manager_ = storage_manager;
+
+  return Status::Ok();
+}
+
+Status FragmentMetadata::deserialize_section(
+    uint64_t section, ConstBuffer* buff) {
+  unsigned int attribute_num = array_metadata_->attribute_num();
+
+  if (section == 0)
+    return load_mbrs(buff);
+  if (section == 1)
+    return load_bounding_coords(buff);
+  if (section < section_tile_var_offsets(0))
+    return load_tile_offsets(section - section_tile_offsets(0), buff);
+  if (section < section_tile_var_sizes(0))
+    return load_tile_var_offsets(section - section_tile_var_offsets(0), buff);
+  if (section < section_tile_var_sizes(attribute_num))
+    return load_tile_var_sizes(section - section_tile_var_sizes(0), buff);
+
+  return LOG_STATUS(Status::FragmentMetadataError(
+      "Cannot load fragment metadata; Invalid section"));
+}
+
 const void* FragmentMetadata::domain() const {
   return domain_;
 }
@@ -201,26 +287,116 @@ uint64_t FragmentMetadata::last_tile_cell_num() const {
   return last_tile_cell_num_;
 }
 
+Status FragmentMetadata::load_bounding_coords() {
+  return load_section(1);
+}
+
+Status FragmentMetadata::load_mbrs() {
+  return load_section(0);
+}
+
+Status FragmentMetadata::load_tile_offsets(unsigned int attribute_id) {
+  return load_section(section_tile_offsets(attribute_id));
+}
+
+Status FragmentMetadata::load_tile_var_offsets(unsigned int attribute_id) {
+  return load_section(section_tile_var_offsets(attribute_id));
+}
+
+Status FragmentMetadata::load_tile_var_sizes(unsigned int attribute_id) {
+  return load_section(section_tile_var_sizes(attribute_id));
+}
+
 const std::vector<void*>& FragmentMetadata::mbrs() const {
   return mbrs_;
 }
 
+uint64_t FragmentMetadata::memory_size() const {
+  std::lock_guard<std::mutex> lock(mtx_);
+
+  // MBRs and bounding coordinates hold two coordinates each
+  uint64_t size = (mbrs_.size() + bounding_coords_.size()) * 2 *
+                  array_metadata_->coords_size();
+  for (auto& tile_offsets : tile_offsets_)
+    size += tile_offsets.size() * sizeof(uint64_t);
+  for (auto& tile_var_offsets : tile_var_offsets_)
+    size += tile_var_offsets.size() * sizeof(uint64_t);
+  for (auto& tile_var_sizes : tile_var_sizes_)
+    size += tile_var_sizes.size() * sizeof(uint64_t);
+
+  return size;
+}
+
 const void* FragmentMetadata::non_empty_domain() const {
   return non_empty_domain_;
 }
 
-Status FragmentMetadata::serialize(Buffer* buf) {
-  RETURN_NOT_OK(write_non_empty_domain(buf));
-  RETURN_NOT_OK(write_mbrs(buf));
-  RETURN_NOT_OK(write_bounding_coords(buf));
-  RETURN_NOT_OK(write_tile_offsets(buf));
-  RETURN_NOT_OK(write_tile_var_offsets(buf));
-  RETURN_NOT_OK(write_tile_var_sizes(buf));
-  RETURN_NOT_OK(write_last_tile_cell_num(buf));
+// ===== FORMAT =====
+// mbrs
+// bounding_coords
+// tile_offsets_attr#0 ... tile_offsets_attr#<attribute_num>
+// tile_var_offsets_attr#0 ... tile_var_offsets_attr#<attribute_num-1>
+// tile_var_sizes_attr#0 ... tile_var_sizes_attr#<attribute_num-1>
+uint64_t FragmentMetadata::section_num() const {
+  return section_tile_var_sizes(array_metadata_->attribute_num());
+}
+
+uint64_t FragmentMetadata::section_offset(uint64_t section) const {
+  return section_offsets_[section];
+}
+
+Status FragmentMetadata::serialize_index(
+    const std::vector<uint64_t>& section_sizes, Buffer* buff) {
+  uint64_t magic = constants::fragment_metadata_index_magic;
+  auto section_num = (uint64_t)section_sizes.size();
+  uint64_t domain_size =
+      (non_empty_domain_ == nullptr) ? 0 : array_metadata_->coords_size() * 2;
+  uint64_t index_size = (6 + section_num) * sizeof(uint64_t) + domain_size;
+  uint64_t tile_num = this->tile_num();
+
+  // Write magic value, index size and number of sections
+  RETURN_NOT_OK(buff->write(&magic, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->write(&index_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->write(&section_num, sizeof(uint64_t)));
+
+  // Write section offsets, the first section following the index
+  uint64_t section_offset = index_size;
+  for (auto section_size : section_sizes) {
+    RETURN_NOT_OK(buff->write(&section_offset, sizeof(uint64_t)));
+    section_offset += section_size;
+  }
+
+  // Write number of tiles
+  Status st = buff->write(&tile_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot serialize fragment metadata; Writing number of tiles failed"));
+  }
+
+  RETURN_NOT_OK(write_last_tile_cell_num(buff));
+  RETURN_NOT_OK(write_non_empty_domain(buff));
 
   return Status::Ok();
 }
 
+Status FragmentMetadata::serialize_section(uint64_t section, Buffer* buff) {
+  unsigned int attribute_num = array_metadata_->attribute_num();
+
+  if (section == 0)
+    return write_mbrs(buff);
+  if (section == 1)
+    return write_bounding_coords(buff);
+  if (section < section_tile_var_offsets(0))
+    return write_tile_offsets(section - section_tile_offsets(0), buff);
+  if (section < section_tile_var_sizes(0))
+    return write_tile_var_offsets(section - section_tile_var_offsets(0), buff);
+  if (section < section_tile_var_sizes(attribute_num))
+    return write_tile_var_sizes(section - section_tile_var_sizes(0), buff);
+
+  return LOG_STATUS(Status::FragmentMetadataError(
+      "Cannot serialize fragment metadata; Invalid section"));
+}
+
 void FragmentMetadata::set_last_tile_cell_num(uint64_t cell_num) {
   last_tile_cell_num_ = cell_num;
 }
@@ -229,6 +405,10 @@ uint64_t FragmentMetadata::tile_num() const {
   if (dense_)
     return array_metadata_->domain()->tile_num(domain_);
 
+  // The MBRs may not be loaded yet
+  if (!section_loaded_.empty())
+    return tile_num_;
+
   return (uint64_t)mbrs_.size();
 }
 
@@ -362,127 +542,125 @@ Status FragmentMetadata::load_non_empty_domain(ConstBuffer* buff) {
   return Status::Ok();
 }
 
-// ===== FORMAT =====
-// tile_offsets_attr#0_num (uint64_t)
-// tile_offsets_attr#0_#1 (uint64_t) tile_offsets_attr#0_#2 (uint64_t) ...
-// ...
-// tile_offsets_attr#<attribute_num>_num (uint64_t)
-// tile_offsets_attr#<attribute_num>_#1 (uint64_t)
-// tile_offsets_attr#<attribute_num>_#2 (uint64_t) ...
-Status FragmentMetadata::load_tile_offsets(ConstBuffer* buff) {
-  Status st;
-  uint64_t tile_offsets_num = 0;
-  unsigned int attribute_num = array_metadata_->attribute_num();
+Status FragmentMetadata::load_section(uint64_t section) {
+  std::lock_guard<std::mutex> lock(mtx_);
 
-  // Allocate tile offsets
-  tile_offsets_.resize(attribute_num + 1);
+  if (section_loaded_.empty() || section_loaded_[section])
+    return Status::Ok();
 
-  // For all attributes, get the tile offsets
-  for (unsigned int i = 0; i < attribute_num + 1; ++i) {
-    // Get number of tile offsets
-    st = buff->read(&tile_offsets_num, sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot load fragment metadata; Reading number of tile offsets "
-          "failed"));
-    }
+  RETURN_NOT_OK(storage_manager_->load(this, section));
+  section_loaded_[section] = true;
 
-    if (tile_offsets_num == 0)
-      continue;
+  return Status::Ok();
+}
 
-    // Get tile offsets
-    tile_offsets_[i].resize(tile_offsets_num);
-    st = buff->read(&tile_offsets_[i][0], tile_offsets_num * sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot load fragment metadata; Reading tile offsets failed"));
-    }
+// ===== FORMAT =====
+// tile_offsets_num (uint64_t)
+// tile_offsets_#1 (uint64_t) tile_offsets_#2 (uint64_t) ...
+Status FragmentMetadata::load_tile_offsets(
+    unsigned int attribute_id, ConstBuffer* buff) {
+  // Get number of tile offsets
+  uint64_t tile_offsets_num = 0;
+  Status st = buff->read(&tile_offsets_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading number of tile offsets "
+        "failed"));
   }
+
+  if (tile_offsets_num == 0)
+    return Status::Ok();
+
+  // Get tile offsets
+  auto& tile_offsets = tile_offsets_[attribute_id];
+  tile_offsets.resize(tile_offsets_num);
+  st = buff->read(&tile_offsets[0], tile_offsets_num * sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading tile offsets failed"));
+  }
+
   return Status::Ok();
 }
 
 // ===== FORMAT =====
-// tile_var_offsets_attr#0_num (uint64_t)
-// tile_var_offsets_attr#0_#1 (uint64_t) tile_var_offsets_attr#0_#2 (uint64_t)
-// ...
-// ...
-// tile_var_offsets_attr#<attribute_num-1>_num(uint64_t)
-// tile_var_offsets_attr#<attribute_num-1>_#1 (uint64_t)
-//     tile_ver_offsets_attr#<attribute_num-1>_#2 (uint64_t) ...
-Status FragmentMetadata::load_tile_var_offsets(ConstBuffer* buff) {
-  Status st;
-  unsigned int attribute_num = array_metadata_->attribute_num();
+// tile_var_offsets_num (uint64_t)
+// tile_var_offsets_#1 (uint64_t) tile_var_offsets_#2 (uint64_t) ...
+Status FragmentMetadata::load_tile_var_offsets(
+    unsigned int attribute_id, ConstBuffer* buff) {
+  // Get number of tile offsets
   uint64_t tile_var_offsets_num = 0;
+  Status st = buff->read(&tile_var_offsets_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading number of variable tile "
+        "offsets failed"));
+  }
 
-  // Allocate tile offsets
-  tile_var_offsets_.resize(attribute_num);
-
-  // For all attributes, get the variable tile offsets
-  for (unsigned int i = 0; i < attribute_num; ++i) {
-    // Get number of tile offsets
-    st = buff->read(&tile_var_offsets_num, sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot load fragment metadata; Reading number of variable tile "
-          "offsets failed"));
-    }
-
-    if (tile_var_offsets_num == 0)
-      continue;
+  if (tile_var_offsets_num == 0)
+    return Status::Ok();
 
-    // Get variable tile offsets
-    tile_var_offsets_[i].resize(tile_var_offsets_num);
-    st = buff->read(
-        &tile_var_offsets_[i][0], tile_var_offsets_num * sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot load fragment metadata; Reading variable tile offsets "
-          "failed"));
-    }
+  // Get variable tile offsets
+  auto& tile_var_offsets = tile_var_offsets_[attribute_id];
+  tile_var_offsets.resize(tile_var_offsets_num);
+  st = buff->read(
+      &tile_var_offsets[0], tile_var_offsets_num * sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading variable tile offsets "
+        "failed"));
   }
+
   return Status::Ok();
 }
 
 // ===== FORMAT =====
-// tile_var_sizes_attr#0_num (uint64_t)
-// tile_var_sizes_attr#0_#1 (uint64_t) tile_sizes_attr#0_#2 (uint64_t) ...
-// ...
-// tile_var_sizes_attr#<attribute_num-1>_num(uint64_t)
-// tile_var_sizes__attr#<attribute_num-1>_#1 (uint64_t)
-//     tile_var_sizes_attr#<attribute_num-1>_#2 (uint64_t) ...
-Status FragmentMetadata::load_tile_var_sizes(ConstBuffer* buff) {
-  Status st;
-  unsigned int attribute_num = array_metadata_->attribute_num();
+// tile_var_sizes_num (uint64_t)
+// tile_var_sizes_#1 (uint64_t) tile_var_sizes_#2 (uint64_t) ...
+Status FragmentMetadata::load_tile_var_sizes(
+    unsigned int attribute_id, ConstBuffer* buff) {
+  // Get number of tile sizes
   uint64_t tile_var_sizes_num = 0;
+  Status st = buff->read(&tile_var_sizes_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading number of variable tile "
+        "sizes failed"));
+  }
 
-  // Allocate tile sizes
-  tile_var_sizes_.resize(attribute_num);
-
-  // For all attributes, get the variable tile sizes
-  for (unsigned int i = 0; i < attribute_num; ++i) {
-    // Get number of tile sizes
-    st = buff->read(&tile_var_sizes_num, sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot load fragment metadata; Reading number of variable tile "
-          "sizes failed"));
-    }
-
-    if (tile_var_sizes_num == 0)
-      continue;
+  if (tile_var_sizes_num == 0)
+    return Status::Ok();
 
-    // Get variable tile sizes
-    tile_var_sizes_[i].resize(tile_var_sizes_num);
-    st = buff->read(
-        &tile_var_sizes_[i][0], tile_var_sizes_num * sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot load fragment metadata; Reading variable tile sizes failed"));
-    }
+  // Get variable tile sizes
+  auto& tile_var_sizes = tile_var_sizes_[attribute_id];
+  tile_var_sizes.resize(tile_var_sizes_num);
+  st = buff->read(&tile_var_sizes[0], tile_var_sizes_num * sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot load fragment metadata; Reading variable tile sizes failed"));
   }
+
   return Status::Ok();
 }
 
+uint64_t FragmentMetadata::section_tile_offsets(
+    unsigned int attribute_id) const {
+  // The tile offsets follow the MBRs and bounding coordinates
+  return 2 + attribute_id;
+}
+
+uint64_t FragmentMetadata::section_tile_var_offsets(
+    unsigned int attribute_id) const {
+  return section_tile_offsets(array_metadata_->attribute_num() + 1) +
+         attribute_id;
+}
+
+uint64_t FragmentMetadata::section_tile_var_sizes(
+    unsigned int attribute_id) const {
+  return section_tile_var_offsets(array_metadata_->attribute_num()) +
+         attribute_id;
+}
+
 // ===== FORMAT =====
 // bounding_coords_num(uint64_t)
 // bounding_coords_#1(void*) bounding_coords_#2(void*) ...
@@ -581,114 +759,92 @@ Status FragmentMetadata::write_non_empty_domain(Buffer* buff) {
 }
 
 // ===== FORMAT =====
-// tile_offsets_attr#0_num(uint64_t)
-// tile_offsets_attr#0_#1 (uint64_t) tile_offsets_attr#0_#2 (uint64_t) ...
-// ...
-// tile_offsets_attr#<attribute_num>_num(uint64_t)
-// tile_offsets_attr#<attribute_num>_#1 (uint64_t)
-// tile_offsets_attr#<attribute_num>_#2 (uint64_t) ...
-Status FragmentMetadata::write_tile_offsets(Buffer* buff) {
-  Status st;
-  unsigned int attribute_num = array_metadata_->attribute_num();
-
-  // Write tile offsets for each attribute
-  for (unsigned int i = 0; i < attribute_num + 1; ++i) {
-    // Write number of tile offsets
-    uint64_t tile_offsets_num = tile_offsets_[i].size();
-    st = buff->write(&tile_offsets_num, sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot serialize fragment metadata; Writing number of tile offsets "
-          "failed"));
-    }
+// tile_offsets_num(uint64_t)
+// tile_offsets_#1 (uint64_t) tile_offsets_#2 (uint64_t) ...
+Status FragmentMetadata::write_tile_offsets(
+    unsigned int attribute_id, Buffer* buff) {
+  auto& tile_offsets = tile_offsets_[attribute_id];
+
+  // Write number of tile offsets
+  uint64_t tile_offsets_num = tile_offsets.size();
+  Status st = buff->write(&tile_offsets_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot serialize fragment metadata; Writing number of tile offsets "
+        "failed"));
+  }
 
-    if (tile_offsets_num == 0)
-      continue;
+  if (tile_offsets_num == 0)
+    return Status::Ok();
 
-    // Write tile offsets
-    st = buff->write(&tile_offsets_[i][0], tile_offsets_num * sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot serialize fragment metadata; Writing tile offsets failed"));
-    }
+  // Write tile offsets
+  st = buff->write(&tile_offsets[0], tile_offsets_num * sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot serialize fragment metadata; Writing tile offsets failed"));
   }
 
   return Status::Ok();
 }
 
 // ===== FORMAT =====
-// tile_var_offsets_attr#0_num(uint64_t)
-// tile_var_offsets_attr#0_#1 (uint64_t) tile_var_offsets_attr#0_#2 (uint64_t)
-// ...
-// ...
-// tile_var_offsets_attr#<attribute_num-1>_num(uint64_t)
-// tile_var_offsets_attr#<attribute_num-1>_#1 (uint64_t)
-//     tile_var_offsets_attr#<attribute_num-1>_#2 (uint64_t) ...
-Status FragmentMetadata::write_tile_var_offsets(Buffer* buff) {
-  Status st;
-  unsigned int attribute_num = array_metadata_->attribute_num();
-
-  // Write tile offsets for each attribute
-  for (unsigned int i = 0; i < attribute_num; ++i) {
-    // Write number of offsets
-    uint64_t tile_var_offsets_num = tile_var_offsets_[i].size();
-    st = buff->write(&tile_var_offsets_num, sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot serialize fragment metadata; Writing number of "
-          "variable tile offsets failed"));
-    }
+// tile_var_offsets_num(uint64_t)
+// tile_var_offsets_#1 (uint64_t) tile_var_offsets_#2 (uint64_t) ...
+Status FragmentMetadata::write_tile_var_offsets(
+    unsigned int attribute_id, Buffer* buff) {
+  auto& tile_var_offsets = tile_var_offsets_[attribute_id];
+
+  // Write number of offsets
+  uint64_t tile_var_offsets_num = tile_var_offsets.size();
+  Status st = buff->write(&tile_var_offsets_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot serialize fragment metadata; Writing number of "
+        "variable tile offsets failed"));
+  }
 
-    if (tile_var_offsets_num == 0)
-      continue;
+  if (tile_var_offsets_num == 0)
+    return Status::Ok();
 
-    // Write tile offsets
-    st = buff->write(
-        &tile_var_offsets_[i][0], tile_var_offsets_num * sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot serialize fragment metadata; Writing "
-          "variable tile offsets failed"));
-    }
+  // Write tile offsets
+  st = buff->write(
+      &tile_var_offsets[0], tile_var_offsets_num * sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot serialize fragment metadata; Writing "
+        "variable tile offsets failed"));
   }
 
   return Status::Ok();
 }
 
 // ===== FORMAT =====
-// tile_var_sizes_attr#0_num(uint64_t)
-// tile_var_sizes_attr#0_#1 (uint64_t) tile_sizes_attr#0_#2 (uint64_t) ...
-// ...
-// tile_var_sizes_attr#<attribute_num-1>_num(uint64_t)
-// tile_var_sizes__attr#<attribute_num-1>_#1(uint64_t)
-//     tile_var_sizes_attr#<attribute_num-1>_#2 (uint64_t) ...
-Status FragmentMetadata::write_tile_var_sizes(Buffer* buff) {
-  Status st;
-  unsigned int attribute_num = array_metadata_->attribute_num();
-
-  // Write tile sizes for each attribute
-  for (unsigned int i = 0; i < attribute_num; ++i) {
-    // Write number of sizes
-    uint64_t tile_var_sizes_num = tile_var_sizes_[i].size();
-    st = buff->write(&tile_var_sizes_num, sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(Status::FragmentMetadataError(
-          "Cannot serialize fragment metadata; Writing number of "
-          "variable tile sizes failed"));
-    }
+// tile_var_sizes_num(uint64_t)
+// tile_var_sizes_#1 (uint64_t) tile_var_sizes_#2 (uint64_t) ...
+Status FragmentMetadata::write_tile_var_sizes(
+    unsigned int attribute_id, Buffer* buff) {
+  auto& tile_var_sizes = tile_var_sizes_[attribute_id];
+
+  // Write number of sizes
+  uint64_t tile_var_sizes_num = tile_var_sizes.size();
+  Status st = buff->write(&tile_var_sizes_num, sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(Status::FragmentMetadataError(
+        "Cannot serialize fragment metadata; Writing number of "
+        "variable tile sizes failed"));
+  }
 
-    if (tile_var_sizes_num == 0)
-      continue;
+  if (tile_var_sizes_num == 0)
+    return Status::Ok();
 
-    // Write tile sizes
-    st = buff->write(
-        &tile_var_sizes_[i][0], tile_var_sizes_num * sizeof(uint64_t));
-    if (!st.ok()) {
-      return LOG_STATUS(
-          Status::FragmentMetadataError("Cannot serialize fragment metadata; "
-                                        "Writing variable tile sizes failed"));
-    }
+  // Write tile sizes
+  st = buff->write(&tile_var_sizes[0], tile_var_sizes_num * sizeof(uint64_t));
+  if (!st.ok()) {
+    return LOG_STATUS(
+        Status::FragmentMetadataError("Cannot serialize fragment metadata; "
+                                      "Writing variable tile sizes failed"));
   }
+
   return Status::Ok();
 }
 
@@ -31,6 +31,7 @@
  * This file implements the ReadState class.
  */
 
+#include "dictionary_encoding.h"
 #include "logger.h"
 #include "posix_filesystem.h"
 #include "query.h"
@@ -91,6 +92,12 @@ ReadState::~ReadState() {
   for (auto& tile_var : tiles_var_)
     delete tile_var;
 
+  for (unsigned int i = 0; i < cached_tiles_.size(); ++i)
+    release_cached_tile(i);
+
+  for (auto& decoded_var : decoded_var_)
+    delete decoded_var;
+
   for (auto& tile_io : tile_io_)
     delete tile_io;
 
@@ -121,9 +128,29 @@ Status ReadState::copy_cells(
 
   // For easy reference
   uint64_t cell_size = array_metadata_->cell_size(attribute_id);
+  char* buffer_c = static_cast<char*>(buffer) + *buffer_offset;
+
+  // A tile read straight into a buffer has all its cells copied already
+  if (tile_i == copied_tile_[attribute_id])
+    return Status::Ok();
+
+  // A whole tile that fits in the buffer is read straight into it. The tile
+  // must not keep viewing the buffer, which the user may reuse or free.
+  uint64_t tile_size = metadata_->cell_num(tile_i) * cell_size;
+  if (tile_i != fetched_tile_[attribute_id] && cell_pos_range.first == 0 &&
+      (cell_pos_range.second + 1) * cell_size == tile_size &&
+      buffer_size - *buffer_offset >= tile_size) {
+    RETURN_NOT_OK(read_tile(attribute_id, tile_i, buffer_c));
+    tiles_[attribute_id]->set_view(nullptr, 0);
+    fetched_tile_[attribute_id] = INVALID_UINT64;
+    copied_tile_[attribute_id] = tile_i;
+    *buffer_offset += tile_size;
+    return Status::Ok();
+  }
 
   // Prepare attribute tile
   RETURN_NOT_OK(read_tile(attribute_id, tile_i));
+  copied_tile_[attribute_id] = INVALID_UINT64;
 
   auto tile = tiles_[attribute_id];
 
@@ -144,7 +171,6 @@ Status ReadState::copy_cells(
   uint64_t bytes_to_copy = MIN(bytes_left_to_copy, buffer_free_space);
 
   // Copy and update current buffer and tile offsets
-  char* buffer_c = static_cast<char*>(buffer) + *buffer_offset;
   if (bytes_to_copy != 0) {
     RETURN_NOT_OK(tile->read(buffer_c, bytes_to_copy));
     *buffer_offset += bytes_to_copy;
@@ -201,7 +227,7 @@ Status ReadState::copy_cells_var(
   // Compute actual cells to copy
   uint64_t start_cell_pos = tile->offset() / cell_size;
   uint64_t end_cell_pos = start_cell_pos + bytes_to_copy / cell_size - 1;
-  uint64_t tile_var_size = metadata_->tile_var_sizes()[attribute_id][tile_i];
+  uint64_t tile_var_size = tile_var->size();
 
   RETURN_NOT_OK(compute_bytes_to_copy(
       attribute_id,
@@ -252,10 +278,31 @@ bool ReadState::dense() const {
   return fragment_->dense();
 }
 
+void ReadState::discard_prefetched() {
+  for (auto& tile_io : tile_io_)
+    tile_io->discard_prefetched();
+  for (auto& tile_io_var : tile_io_var_) {
+    if (tile_io_var != nullptr)
+      tile_io_var->discard_prefetched();
+  }
+}
+
 bool ReadState::done() const {
   return done_;
 }
 
+Status ReadState::finalize() {
+  // Close all attribute files
+  for (auto& tile_io : tile_io_)
+    RETURN_NOT_OK(tile_io->close());
+  for (auto& tile_io_var : tile_io_var_) {
+    if (tile_io_var != nullptr)
+      RETURN_NOT_OK(tile_io_var->close());
+  }
+
+  return Status::Ok();
+}
+
 void ReadState::get_bounding_coords(void* bounding_coords) const {
   // For easy reference
   uint64_t pos = search_tile_pos_;
@@ -855,11 +902,57 @@ bool ReadState::overflow(unsigned int attribute_id) const {
   return overflow_[attribute_id];
 }
 
+Status ReadState::prefetch_tile(unsigned int attribute_id, uint64_t tile_i) {
+  if (tile_i == fetched_tile_[attribute_id] ||
+      tile_i == copied_tile_[attribute_id] || is_empty_attribute(attribute_id))
+    return Status::Ok();
+
+  // Cached tiles are not read from the file
+  if (query_->storage_manager()->tile_cache()->contains(
+          fragment_->fragment_uri(), attribute_id, tile_i))
+    return Status::Ok();
+
+  // Fixed-sized tile, or offsets of a variable-sized tile
+  RETURN_NOT_OK(metadata_->load_tile_offsets(attribute_id));
+  auto tile_io = tile_io_[attribute_id];
+  uint64_t tile_compressed_size;
+  RETURN_NOT_OK(compute_tile_compressed_size(
+      tile_i, attribute_id, tile_io, &tile_compressed_size));
+  uint64_t file_offset = metadata_->tile_offsets()[attribute_id][tile_i];
+  RETURN_NOT_OK(
+      tile_io->prefetch(tiles_[attribute_id], file_offset, tile_compressed_size));
+  if (attribute_id == attribute_num_ ||
+      !array_metadata_->var_size(attribute_id))
+    return Status::Ok();
+
+  // Variable-sized values
+  RETURN_NOT_OK(metadata_->load_tile_var_offsets(attribute_id));
+  auto tile_io_var = tile_io_var_[attribute_id];
+  uint64_t tile_compressed_var_size;
+  RETURN_NOT_OK(compute_tile_compressed_var_size(
+      tile_i, attribute_id, tile_io_var, &tile_compressed_var_size));
+  uint64_t file_var_offset =
+      metadata_->tile_var_offsets()[attribute_id][tile_i];
+  return tile_io_var->prefetch(
+      tiles_var_[attribute_id], file_var_offset, tile_compressed_var_size);
+}
+
 void ReadState::reset_overflow() {
   for (unsigned int i = 0; i < overflow_.size(); ++i)
     overflow_[i] = false;
 }
 
+Status ReadState::submit_prefetch(IOBatch* batch) {
+  for (auto& tile_io : tile_io_)
+    RETURN_NOT_OK(tile_io->submit_prefetch(batch));
+  for (auto& tile_io_var : tile_io_var_) {
+    if (tile_io_var != nullptr)
+      RETURN_NOT_OK(tile_io_var->submit_prefetch(batch));
+  }
+
+  return Status::Ok();
+}
+
 bool ReadState::subarray_area_covered() const {
   return subarray_area_covered_;
 }
@@ -1315,8 +1408,13 @@ void ReadState::init_empty_attributes() {
 
 void ReadState::init_fetched_tiles() {
   fetched_tile_.resize(attribute_num_ + 2);
-  for (unsigned int i = 0; i < attribute_num_ + 2; ++i)
+  cached_tiles_.resize(attribute_num_ + 2);
+  copied_tile_.resize(attribute_num_ + 2);
+  for (unsigned int i = 0; i < attribute_num_ + 2; ++i) {
     fetched_tile_[i] = INVALID_UINT64;
+    cached_tiles_[i] = nullptr;
+    copied_tile_[i] = INVALID_UINT64;
+  }
 }
 
 void ReadState::init_overflow() {
@@ -1327,6 +1425,7 @@ void ReadState::init_overflow() {
 
 void ReadState::init_tiles() {
   auto dim_num = array_metadata_->domain()->dim_num();
+  auto storage_manager = query_->storage_manager();
 
   for (unsigned int i = 0; i < attribute_num_; ++i) {
     const Attribute* attr = array_metadata_->attribute(i);
@@ -1339,11 +1438,25 @@ void ReadState::init_tiles() {
         (var_size) ? constants::cell_var_offset_size : attr->cell_size(),
         0));
 
-    if (var_size)
+    if (var_size) {
       tiles_var_.emplace_back(new Tile(
           attr->type(), attr->compressor(), datatype_size(attr->type()), 0));
-    else
+      tiles_var_.back()->set_filters(attr->filters());
+    } else {
+      tiles_.back()->set_filters(attr->filters());
       tiles_var_.emplace_back(nullptr);
+    }
+
+    decoded_var_.emplace_back(
+        (attr->dictionary_encoding()) ? new Buffer() : nullptr);
+
+    // Tiles written before the dictionary was trained decompress without it
+    if (attr->zstd_dictionary()) {
+      auto dict = storage_manager->zstd_dictionary(
+          array_metadata_->array_uri(), attr->name());
+      auto tile = (var_size) ? tiles_var_.back() : tiles_[i];
+      tile->set_zstd_dictionary(dict);
+    }
   }
   tiles_.emplace_back(new Tile(
       array_metadata_->coords_type(),
@@ -1395,7 +1508,8 @@ Status ReadState::read_from_tile(
   return Status::Ok();
 }
 
-Status ReadState::read_tile(unsigned int attribute_id, uint64_t tile_i) {
+Status ReadState::read_tile(
+    unsigned int attribute_id, uint64_t tile_i, void* buffer) {
   // Return if the tile has already been fetched
   if (tile_i == fetched_tile_[attribute_id])
     return Status::Ok();
@@ -1403,11 +1517,20 @@ Status ReadState::read_tile(unsigned int attribute_id, uint64_t tile_i) {
   auto tile = tiles_[attribute_id];
   auto tile_io = tile_io_[attribute_id];
 
+  // Decompressed tiles are shared across queries through the tile cache
+  release_cached_tile(attribute_id);
+  bool cacheable = tile->filtered();
+  if (cacheable && read_tile_from_cache(attribute_id, tile_i, buffer))
+    return Status::Ok();
+
   // To handle the special case of the search tile
   // The real attribute id corresponds to an actual attribute or coordinates
   unsigned int attribute_id_real =
       (attribute_id == attribute_num_ + 1) ? attribute_num_ : attribute_id;
 
+  // The tile offsets are loaded the first time a tile is read
+  RETURN_NOT_OK(metadata_->load_tile_offsets(attribute_id_real));
+
   uint64_t tile_compressed_size;
   RETURN_NOT_OK(compute_tile_compressed_size(
       tile_i, attribute_id_real, tile_io, &tile_compressed_size));
@@ -1416,11 +1539,19 @@ Status ReadState::read_tile(unsigned int attribute_id, uint64_t tile_i) {
   uint64_t tile_size = metadata_->cell_num(tile_i) *
                        array_metadata_->cell_size(attribute_id_real);
 
-  Status st = tile_io->read(tile, file_offset, tile_compressed_size, tile_size);
+  Status st =
+      (buffer == nullptr) ?
+          tile_io->read(tile, file_offset, tile_compressed_size, tile_size) :
+          tile_io->read_into(
+              tile, file_offset, tile_compressed_size, tile_size, buffer);
 
   // Mark as fetched
-  if (st.ok())
+  if (st.ok()) {
     fetched_tile_[attribute_id] = tile_i;
+    if (cacheable)
+      query_->storage_manager()->tile_cache()->insert(
+          fragment_->fragment_uri(), attribute_id_real, tile_i, tile);
+  }
 
   return st;
 }
@@ -1436,6 +1567,21 @@ Status ReadState::read_tile_var(unsigned int attribute_id, uint64_t tile_i) {
 
   auto tile = tiles_[attribute_id];
   auto tile_io = tile_io_[attribute_id];
+  auto tile_var = tiles_var_[attribute_id];
+  auto tile_io_var = tile_io_var_[attribute_id];
+  auto decoded_var = decoded_var_[attribute_id];
+
+  // Decompressed tiles are shared across queries through the tile cache
+  release_cached_tile(attribute_id);
+  bool cacheable =
+      tile->filtered() || tile_var->filtered() || decoded_var != nullptr;
+  if (cacheable && read_tile_from_cache(attribute_id, tile_i))
+    return Status::Ok();
+
+  // The tile offsets and sizes are loaded the first time a tile is read
+  RETURN_NOT_OK(metadata_->load_tile_offsets(attribute_id));
+  RETURN_NOT_OK(metadata_->load_tile_var_offsets(attribute_id));
+  RETURN_NOT_OK(metadata_->load_tile_var_sizes(attribute_id));
 
   uint64_t tile_compressed_size;
   RETURN_NOT_OK(compute_tile_compressed_size(
@@ -1447,9 +1593,6 @@ Status ReadState::read_tile_var(unsigned int attribute_id, uint64_t tile_i) {
   RETURN_NOT_OK(
       tile_io->read(tile, file_offset, tile_compressed_size, tile_size));
 
-  auto tile_var = tiles_var_[attribute_id];
-  auto tile_io_var = tile_io_var_[attribute_id];
-
   // Get size of decompressed tile
   uint64_t tile_compressed_var_size;
   RETURN_NOT_OK(compute_tile_compressed_var_size(
@@ -1461,16 +1604,80 @@ Status ReadState::read_tile_var(unsigned int attribute_id, uint64_t tile_i) {
   RETURN_NOT_OK(tile_io_var->read(
       tile_var, file_var_offset, tile_compressed_var_size, tile_var_size));
 
+  // Decode dictionary-encoded values
+  if (decoded_var != nullptr) {
+    RETURN_NOT_OK(DictionaryEncoding::decode(
+        tile_var->data(), tile_var->size(), decoded_var));
+    tile_var->set_view(decoded_var->data(), decoded_var->size());
+  }
+
   // Shift variable cell offsets
   shift_var_offsets(attribute_id);
 
   // Mark as fetched
   fetched_tile_[attribute_id] = tile_i;
+  if (cacheable)
+    query_->storage_manager()->tile_cache()->insert(
+        fragment_->fragment_uri(), attribute_id, tile_i, tile, tile_var);
 
   // Success
   return Status::Ok();
 }
 
+bool ReadState::read_tile_from_cache(
+    unsigned int attribute_id, uint64_t tile_i, void* buffer) {
+  // The search tile shares the cached coordinate tiles
+  unsigned int attribute_id_real =
+      (attribute_id == attribute_num_ + 1) ? attribute_num_ : attribute_id;
+
+  auto tile_cache = query_->storage_manager()->tile_cache();
+  auto cached =
+      tile_cache->get(fragment_->fragment_uri(), attribute_id_real, tile_i);
+  if (cached == nullptr)
+    return false;
+
+  // The tile may have been prefetched before another query cached it. The
+  // offsets of prefetched tiles are loaded already.
+  auto tile_io = tile_io_[attribute_id];
+  if (tile_io->prefetched_num() != 0)
+    tile_io->discard_prefetched(
+        metadata_->tile_offsets()[attribute_id_real][tile_i]);
+  auto tile_io_var =
+      (attribute_id < attribute_num_) ? tile_io_var_[attribute_id] : nullptr;
+  if (tile_io_var != nullptr && tile_io_var->prefetched_num() != 0)
+    tile_io_var->discard_prefetched(
+        metadata_->tile_var_offsets()[attribute_id][tile_i]);
+
+  auto tile = tiles_[attribute_id];
+  if (buffer == nullptr) {
+    tile->set_view(cached->data_, cached->size_);
+  } else {
+    std::memcpy(buffer, cached->data_, cached->size_);
+    tile->set_view(buffer, cached->size_);
+  }
+  if (attribute_id < attribute_num_ && tiles_var_[attribute_id] != nullptr)
+    tiles_var_[attribute_id]->set_view(cached->var_data_, cached->var_size_);
+
+  // The tile stays pinned while the tiles are views of it
+  if (buffer == nullptr)
+    cached_tiles_[attribute_id] = cached;
+  else
+    tile_cache->release(cached);
+  fetched_tile_[attribute_id] = tile_i;
+
+  return true;
+}
+
+void ReadState::release_cached_tile(unsigned int attribute_id) {
+  if (cached_tiles_[attribute_id] == nullptr)
+    return;
+
+  query_->storage_manager()->tile_cache()->release(
+      cached_tiles_[attribute_id]);
+  cached_tiles_[attribute_id] = nullptr;
+  fetched_tile_[attribute_id] = INVALID_UINT64;
+}
+
 void ReadState::shift_var_offsets(unsigned int attribute_id) {
   // For easy reference
   uint64_t cell_num =
@@ -39,12 +39,14 @@
 
 #include "comparators.h"
 #include "const_buffer.h"
+#include "dictionary_encoding.h"
 #include "logger.h"
 #include "posix_filesystem.h"
 #include "query.h"
 #include "tile.h"
 #include "utils.h"
 #include "write_state.h"
+#include "zstd_dictionary.h"
 
 namespace tiledb {
 
@@ -55,9 +57,11 @@ namespace tiledb {
 WriteState::WriteState(const Fragment* fragment)
     : fragment_(fragment) {
   metadata_ = fragment_->metadata();
+  encoded_var_ = new Buffer();
 
   init_tiles();
   init_tile_io();
+  init_zstd_dictionaries();
 
   // For easy reference
   auto array_metadata = fragment_->query()->array_metadata();
@@ -92,6 +96,11 @@ WriteState::~WriteState() {
   for (auto& tile_io_var : tile_io_var_)
     delete tile_io_var;
 
+  delete encoded_var_;
+
+  for (auto& samples : zstd_samples_)
+    delete samples;
+
   if (mbr_ != nullptr)
     std::free(mbr_);
 
@@ -118,6 +127,17 @@ Status WriteState::finalize() {
   // Sync all attributes
   RETURN_NOT_OK(sync());
 
+  // Train the missing ZSTD dictionaries on the tiles just written
+  RETURN_NOT_OK(train_zstd_dictionaries());
+
+  // Close all attribute files
+  for (auto& tile_io : tile_io_)
+    RETURN_NOT_OK(tile_io->close());
+  for (auto& tile_io_var : tile_io_var_) {
+    if (tile_io_var != nullptr)
+      RETURN_NOT_OK(tile_io_var->close());
+  }
+
   // Success
   return Status::Ok();
 }
@@ -245,7 +265,9 @@ void WriteState::init_tiles() {
           fragment_->tile_size(i),
           datatype_size(attr->type()),
           0));
+      tiles_var_.back()->set_filters(attr->filters());
     } else {
+      tiles_.back()->set_filters(attr->filters());
       tiles_var_.emplace_back(nullptr);
     }
   }
@@ -278,6 +300,56 @@ void WriteState::init_tile_io() {
       new TileIO(query->storage_manager(), fragment_->coords_uri()));
 }
 
+void WriteState::init_zstd_dictionaries() {
+  auto array_metadata = fragment_->query()->array_metadata();
+  auto attribute_num = array_metadata->attribute_num();
+  auto storage_manager = fragment_->query()->storage_manager();
+  zstd_samples_.resize(attribute_num, nullptr);
+  zstd_sample_sizes_.resize(attribute_num);
+  for (unsigned int i = 0; i < attribute_num; ++i) {
+    auto attr = array_metadata->attribute(i);
+    if (!attr->zstd_dictionary())
+      continue;
+
+    auto dict = storage_manager->zstd_dictionary(
+        array_metadata->array_uri(), attr->name());
+    if (dict == nullptr)
+      zstd_samples_[i] = new Buffer();
+    else if (attr->var_size())
+      tiles_var_[i]->set_zstd_dictionary(dict);
+    else
+      tiles_[i]->set_zstd_dictionary(dict);
+  }
+}
+
+Status WriteState::sample_tile(unsigned int attribute_id, const Tile* tile) {
+  // Nothing to do if the attribute is not sampled, or has enough samples
+  if (attribute_id >= zstd_samples_.size())
+    return Status::Ok();
+  auto samples = zstd_samples_[attribute_id];
+  auto storage_manager = fragment_->query()->storage_manager();
+  if (samples == nullptr ||
+      samples->size() >=
+          storage_manager->config().sm_params_.zstd_dictionary_sample_size_ ||
+      tile->size() == 0)
+    return Status::Ok();
+
+  // Sample the tile after the filters, as the compressor would see it
+  uint64_t size_before = samples->size();
+  const FilterPipeline& filters = tile->filters();
+  if (filters.empty()) {
+    RETURN_NOT_OK(samples->write(tile->data(), tile->size()));
+  } else {
+    Buffer filtered;
+    ConstBuffer unfiltered(tile->data(), tile->size());
+    RETURN_NOT_OK(filters.run_forward(tile->type(), &unfiltered, &filtered));
+    RETURN_NOT_OK(samples->write(filtered.data(), filtered.size()));
+  }
+  zstd_sample_sizes_[attribute_id].push_back(samples->size() - size_before);
+
+  return Status::Ok();
+}
+
 void WriteState::sort_cell_pos(
     const void* buffer,
     uint64_t buffer_size,
@@ -447,6 +519,33 @@ void WriteState::update_bookkeeping(const void* buffer, uint64_t buffer_size) {
   }
 }
 
+Status WriteState::train_zstd_dictionaries() {
+  // For easy reference
+  auto array_metadata = fragment_->query()->array_metadata();
+  auto storage_manager = fragment_->query()->storage_manager();
+
+  for (unsigned int i = 0; i < zstd_samples_.size(); ++i) {
+    auto samples = zstd_samples_[i];
+    if (samples == nullptr || zstd_sample_sizes_[i].empty())
+      continue;
+
+    // Training fails on too few or too uniform samples
+    Buffer dict;
+    if (!ZStdDictionary::train(
+             samples,
+             zstd_sample_sizes_[i],
+             storage_manager->config().sm_params_.zstd_dictionary_size_,
+             &dict)
+             .ok())
+      continue;
+
+    RETURN_NOT_OK(storage_manager->store_zstd_dictionary(
+        array_metadata->array_uri(), array_metadata->attribute(i), &dict));
+  }
+
+  return Status::Ok();
+}
+
 Status WriteState::write_attr(
     unsigned int attribute_id, void* buffer, uint64_t buffer_size) {
   // Trivial case
@@ -467,6 +566,7 @@ Status WriteState::write_attr(
   do {
     RETURN_NOT_OK(tile->write(buf));
     if (tile->full()) {
+      RETURN_NOT_OK(sample_tile(attribute_id, tile));
       RETURN_NOT_OK(tile_io->write(tile, &bytes_written));
       metadata_->append_tile_offset(attribute_id, bytes_written);
       tile->reset_offset();
@@ -487,6 +587,7 @@ Status WriteState::write_attr_last(unsigned int attribute_id) {
 
   // Fill tiles and dispatch them for writing
   uint64_t bytes_written;
+  RETURN_NOT_OK(sample_tile(attribute_id, tile));
   RETURN_NOT_OK(tile_io->write(tile, &bytes_written));
   metadata_->append_tile_offset(attribute_id, bytes_written);
   tile->reset_offset();
@@ -513,10 +614,9 @@ Status WriteState::write_attr_var(
   auto tile = tiles_[attribute_id];
   auto tile_var = tiles_var_[attribute_id];
   auto tile_io = tile_io_[attribute_id];
-  auto tile_io_var = tile_io_var_[attribute_id];
 
   // Fill tiles and dispatch them for writing
-  uint64_t bytes_written, bytes_written_var, bytes_to_write_var;
+  uint64_t bytes_written, bytes_to_write_var;
   do {
     RETURN_NOT_OK(tile->write_with_shift(buf, buffer_var_offset));
 
@@ -529,11 +629,9 @@ Status WriteState::write_attr_var(
     RETURN_NOT_OK(tile_var->write(buf_var, bytes_to_write_var));
 
     if (tile->full()) {
+      RETURN_NOT_OK(write_tile_var(attribute_id));
       RETURN_NOT_OK(tile_io->write(tile, &bytes_written));
-      RETURN_NOT_OK(tile_io_var->write(tile_var, &bytes_written_var));
       metadata_->append_tile_offset(attribute_id, bytes_written);
-      metadata_->append_tile_var_offset(attribute_id, bytes_written_var);
-      metadata_->append_tile_var_size(attribute_id, tile_var->size());
       tile->reset_offset();
       tile->set_size(0);
       tile_var->reset_offset();
@@ -554,15 +652,12 @@ Status WriteState::write_attr_var_last(unsigned int attribute_id) {
   auto tile = tiles_[attribute_id];
   auto tile_var = tiles_var_[attribute_id];
   auto tile_io = tile_io_[attribute_id];
-  auto tile_io_var = tile_io_var_[attribute_id];
 
   // Fill tiles and dispatch them for writing
-  uint64_t bytes_written, bytes_written_var;
+  uint64_t bytes_written;
+  RETURN_NOT_OK(write_tile_var(attribute_id));
   RETURN_NOT_OK(tile_io->write(tile, &bytes_written));
-  RETURN_NOT_OK(tile_io_var->write(tile_var, &bytes_written_var));
   metadata_->append_tile_offset(attribute_id, bytes_written);
-  metadata_->append_tile_var_offset(attribute_id, bytes_written_var);
-  metadata_->append_tile_var_size(attribute_id, tile_var->size());
   tile->reset_offset();
   tile_var->reset_offset();
 
@@ -768,4 +863,42 @@ Status WriteState::write_sparse_unsorted_attr_var(
   return st;
 }
 
+Status WriteState::write_tile_var(unsigned int attribute_id) {
+  // For easy reference
+  auto attr = fragment_->query()->array_metadata()->attribute(attribute_id);
+  auto tile_var = tiles_var_[attribute_id];
+  auto tile_io_var = tile_io_var_[attribute_id];
+  uint64_t bytes_written;
+
+  // Values as they are
+  if (!attr->dictionary_encoding()) {
+    RETURN_NOT_OK(sample_tile(attribute_id, tile_var));
+    RETURN_NOT_OK(tile_io_var->write(tile_var, &bytes_written));
+    metadata_->append_tile_var_offset(attribute_id, bytes_written);
+    metadata_->append_tile_var_size(attribute_id, tile_var->size());
+    return Status::Ok();
+  }
+
+  // Dictionary-encoded values, compressed like the values would be
+  RETURN_NOT_OK(DictionaryEncoding::encode(
+      tiles_[attribute_id], tile_var, encoded_var_));
+  encoded_var_->reset_offset();
+  Tile tile_encoded(
+      tile_var->type(),
+      tile_var->compressor(),
+      tile_var->compression_level(),
+      tile_var->cell_size(),
+      0,
+      encoded_var_,
+      false);
+  tile_encoded.set_filters(tile_var->filters());
+  tile_encoded.set_zstd_dictionary(tile_var->zstd_dictionary());
+  RETURN_NOT_OK(sample_tile(attribute_id, &tile_encoded));
+  RETURN_NOT_OK(tile_io_var->write(&tile_encoded, &bytes_written));
+  metadata_->append_tile_var_offset(attribute_id, bytes_written);
+  metadata_->append_tile_var_size(attribute_id, encoded_var_->size());
+
+  return Status::Ok();
+}
+
 }  // namespace tiledb
@@ -49,6 +49,25 @@ const char* array_metadata_filename = "__array_metadata.tdb";
 /** The fragment metadata file name. */
 const char* fragment_metadata_filename = "__fragment_metadata.tdb";
 
+/**
+ * The name prefix of the consolidated fragment metadata file of an array,
+ * which is followed by the generation number and the file suffix.
+ */
+const char* consolidated_fragment_metadata_prefix =
+    "__consolidated_fragment_metadata_";
+
+/**
+ * The name of the small fragment file storing only the fragment non-empty
+ * domain, which is read to prune fragments without loading their metadata.
+ */
+const char* fragment_domain_filename = "__non_empty_domain.tdb";
+
+/**
+ * The value at the start of a fragment metadata file split into sections,
+ * which distinguishes it from the older single generic tile format.
+ */
+const uint64_t fragment_metadata_index_magic = UINT64_MAX;
+
 /** The default tile capacity. */
 const uint64_t capacity = 10000;
 
@@ -142,6 +161,96 @@ const uint64_t consolidation_buffer_size = 10000000;
 /** The maximum number of bytes written in a single I/O. */
 const uint64_t max_write_bytes = INT_MAX;
 
+/** The maximum number of files whose descriptors the VFS keeps open. */
+const uint64_t vfs_fd_cache_size = 256;
+
+/**
+ * The size of the per-file write-behind buffer of the VFS. Appends are
+ * accumulated up to this size before reaching the backend (0 disables
+ * buffering).
+ */
+const uint64_t vfs_write_buffer_size = 1024 * 1024;
+
+/**
+ * If *true*, uncompressed tiles are read as zero-copy views into
+ * memory-mapped files, where the filesystem backend supports it.
+ */
+const bool tile_io_mmap = true;
+
+/** The submission queue size of the io_uring asynchronous I/O engine. */
+const unsigned vfs_io_queue_depth = 64;
+
+/**
+ * The number of threads of the asynchronous I/O engine used where io_uring
+ * is not available.
+ */
+const unsigned vfs_io_thread_num = 16;
+
+/**
+ * If *true*, the tiles a read query needs in each round are fetched ahead
+ * with asynchronous I/O.
+ */
+const bool tile_prefetch = true;
+
+/**
+ * Tiles fetched ahead that lie at most this many bytes apart in a file are
+ * read with a single I/O request.
+ */
+const uint64_t tile_io_coalesce_gap = 64 * 1024;
+
+/** The maximum size of a single coalesced tile read. */
+const uint64_t tile_io_coalesce_max_size = 16 * 1024 * 1024;
+
+/** The region of S3 requests. */
+const char* const s3_region = "us-east-1";
+
+/**
+ * The endpoint ("host[:port]") of an S3-compatible object store, addressed
+ * path-style. If empty, requests go to AWS, addressed virtual-host-style.
+ */
+const char* const s3_endpoint_override = "";
+
+/** The scheme of S3 requests ("http" or "https"). */
+const char* const s3_scheme = "https";
+
+/** The part size of S3 multipart uploads (at least 5 MB, per S3). */
+const uint64_t s3_multipart_part_size = 5 * 1024 * 1024;
+
+/** The maximum number of concurrent requests of a single S3 operation. */
+const unsigned s3_max_parallel_ops = 8;
+
+/**
+ * The local directory where blocks of remote (HDFS, S3) fragment files are
+ * cached. Remote reads are not cached if empty.
+ */
+const char* const vfs_disk_cache_dir = "";
+
+/** The maximum total size of the local disk cache. */
+const uint64_t vfs_disk_cache_size = 10ULL * 1024 * 1024 * 1024;
+
+/** The size of the blocks remote files are cached in. */
+const uint64_t vfs_disk_cache_block_size = 1024 * 1024;
+
+/**
+ * For how long (in milliseconds) a remote directory found not to be a
+ * complete fragment is not checked again.
+ */
+const uint64_t vfs_disk_cache_mutable_ttl = 1000;
+
+/**
+ * The maximum number of threads checking concurrently which array
+ * subdirectories are fragments.
+ */
+const unsigned fragment_discovery_threads = 8;
+
+/**
+ * The maximum (approximate) memory the metadata of arrays no query has open
+ * may occupy. Closed arrays are kept resident up to this budget, so that
+ * reopening them skips reloading their array and fragment metadata (0
+ * disables retention).
+ */
+const uint64_t open_array_cache_size = 64 * 1024 * 1024;
+
 /** The maximum name length. */
 const unsigned name_max_len = 256;
 
@@ -193,6 +302,24 @@ const char* bzip2_str = "BZIP2";
 /** String describing DOUBLE_DELTA. */
 const char* double_delta_str = "DOUBLE_DELTA";
 
+/** String describing GORILLA. */
+const char* gorilla_str = "GORILLA";
+
+/** String describing BYTESHUFFLE. */
+const char* byteshuffle_str = "BYTESHUFFLE";
+
+/** String describing BITSHUFFLE. */
+const char* bitshuffle_str = "BITSHUFFLE";
+
+/** String describing DELTA. */
+const char* delta_str = "DELTA";
+
+/** String describing BIT_WIDTH_REDUCTION. */
+const char* bit_width_reduction_str = "BIT_WIDTH_REDUCTION";
+
+/** The number of values that share a bit width in bit width reduction. */
+const uint64_t bit_width_reduction_window = 256;
+
 /** The string representation for type int32. */
 const char* int32_str = "INT32";
 
@@ -250,8 +377,53 @@ const char* null_str = "null";
 /** The version in format { major, minor, revision }. */
 const int version[3] = {1, 0, 0};
 
-/** The size of a tile chunk. */
-const uint64_t tile_chunk_size = INT_MAX;
+/**
+ * The maximum size of the chunks tiles are split into for compression.
+ * Chunks are compressed in parallel.
+ */
+const uint64_t tile_chunk_size = 1024 * 1024;
+
+/**
+ * The maximum number of threads compressing or decompressing the chunks of a
+ * tile.
+ */
+const unsigned tile_chunk_threads = 8;
+
+/** Tiles smaller than this are (de)compressed on the calling thread. */
+const uint64_t tile_chunk_parallel_min_size = 64 * 1024;
+
+/** The maximum number of scratch buffers kept by the buffer pool. */
+const uint64_t buffer_pool_max_num = 64;
+
+/** Scratch buffers larger than this are freed instead of pooled. */
+const uint64_t buffer_pool_max_size = 8 * 1024 * 1024;
+
+/**
+ * The maximum total size of the decompressed tiles cached across queries
+ * (0 disables the cache).
+ */
+const uint64_t tile_cache_size = 100 * 1024 * 1024;
+
+/** The number of independently locked shards of the tile cache. */
+const unsigned tile_cache_shard_num = 16;
+
+/**
+ * If *true*, compressors use the SIMD instructions the CPU supports (checked
+ * at runtime).
+ */
+const bool compressor_simd = true;
+
+/**
+ * The prefix of the files in the array directory that store the trained ZSTD
+ * dictionaries, followed by the attribute name and the file suffix.
+ */
+const char* zstd_dictionary_prefix = "__zstd_dictionary_";
+
+/** The maximum size of a trained ZSTD dictionary. */
+const uint64_t zstd_dictionary_size = 64 * 1024;
+
+/** The maximum total size of the tile samples a ZSTD dictionary learns from. */
+const uint64_t zstd_dictionary_sample_size = 100 * 64 * 1024;
 
 }  // namespace constants
 
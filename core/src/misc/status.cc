@@ -158,6 +158,12 @@ std::string Status::code_to_string() const {
     case StatusCode::Consolidation:
       type = "[TileDB::Consolidation] Error";
       break;
+    case StatusCode::S3:
+      type = "[TileDB::S3] Error";
+      break;
+    case StatusCode::Filter:
+      type = "[TileDB::Filter] Error";
+      break;
     default:
       type = "[TileDB::?] Error:";
   }
@@ -38,10 +38,14 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <thread>
 
 namespace tiledb {
 
@@ -359,6 +363,44 @@ bool is_unary_subarray(const T* subarray, unsigned int dim_num) {
   return true;
 }
 
+Status parallel_for(
+    uint64_t n,
+    uint64_t max_threads,
+    const std::function<Status(uint64_t)>& op) {
+  if (n == 0)
+    return Status::Ok();
+  if (n == 1 || max_threads <= 1) {
+    for (uint64_t i = 0; i < n; ++i)
+      RETURN_NOT_OK(op(i));
+    return Status::Ok();
+  }
+
+  std::atomic<uint64_t> next(0);
+  std::mutex mtx;
+  Status ret;
+  auto worker = [&]() {
+    uint64_t i;
+    while ((i = next++) < n) {
+      Status st = op(i);
+      if (!st.ok()) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (ret.ok())
+          ret = st;
+      }
+    }
+  };
+
+  uint64_t thread_num = std::min(n, max_threads);
+  std::vector<std::thread*> threads;
+  for (uint64_t i = 0; i < thread_num; ++i)
+    threads.push_back(new std::thread(worker));
+  for (auto thread : threads) {
+    thread->join();
+    delete thread;
+  }
+  return ret;
+}
+
 bool starts_with(const std::string& value, const std::string& prefix) {
   if (prefix.size() > value.size())
     return false;
@@ -38,6 +38,7 @@
 #include "utils.h"
 
 #include <cassert>
+#include <set>
 
 /* ****************************** */
 /*             MACROS             */
@@ -1080,6 +1081,9 @@ Status ArrayReadState::get_next_fragment_cell_ranges_dense() {
   // Insert cell pos ranges in the state
   fragment_cell_pos_ranges_vec_.push_back(fragment_cell_pos_ranges);
 
+  // Fetch the tiles of the read round
+  RETURN_NOT_OK(prefetch_tiles(fragment_cell_pos_ranges));
+
   // Clean up processed overlapping tiles
   clean_up_processed_fragment_cell_pos_ranges();
 
@@ -1121,6 +1125,9 @@ Status ArrayReadState::get_next_fragment_cell_ranges_sparse() {
   // Insert cell pos ranges in the state
   fragment_cell_pos_ranges_vec_.push_back(fragment_cell_pos_ranges);
 
+  // Fetch the tiles of the read round
+  RETURN_NOT_OK(prefetch_tiles(fragment_cell_pos_ranges));
+
   // Clean up processed overlapping tiles
   clean_up_processed_fragment_cell_pos_ranges();
 
@@ -1319,6 +1326,52 @@ void ArrayReadState::get_next_subarray_tile_coords() {
   }
 }
 
+Status ArrayReadState::prefetch_tiles(
+    const FragmentCellPosRanges* fragment_cell_pos_ranges) {
+  if (!query_->storage_manager()->config().sm_params_.tile_prefetch_)
+    return Status::Ok();
+
+  // Find the distinct fragment tiles of the read round
+  std::set<FragmentInfo> fragment_tiles;
+  for (auto& fragment_cell_pos_range : *fragment_cell_pos_ranges) {
+    if (fragment_cell_pos_range.first.first != INVALID_UINT)
+      fragment_tiles.insert(fragment_cell_pos_range.first);
+  }
+  if (fragment_tiles.empty())
+    return Status::Ok();
+
+  // Queue the attribute tiles and submit their (coalesced) reads
+  auto& attribute_ids = query_->attribute_ids();
+  IOBatch batch;
+  Status st;
+  for (auto& fragment_tile : fragment_tiles) {
+    auto read_state = fragment_read_states_[fragment_tile.first];
+    for (auto attribute_id : attribute_ids) {
+      st = read_state->prefetch_tile(attribute_id, fragment_tile.second);
+      if (!st.ok())
+        break;
+    }
+    if (!st.ok())
+      break;
+  }
+  for (auto read_state : fragment_read_states_) {
+    if (!st.ok())
+      break;
+    st = read_state->submit_prefetch(&batch);
+  }
+
+  // Wait even upon error, as submitted reads target the tile I/O buffers
+  Status st_wait = query_->storage_manager()->wait_reads(&batch);
+  if (st.ok())
+    st = st_wait;
+  if (!st.ok()) {
+    for (auto read_state : fragment_read_states_)
+      read_state->discard_prefetched();
+  }
+
+  return st;
+}
+
 Status ArrayReadState::read_dense(void** buffers, uint64_t* buffer_sizes) {
   // For easy reference
   auto& attribute_ids = query_->attribute_ids();
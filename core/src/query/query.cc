@@ -35,6 +35,7 @@
 #include "utils.h"
 
 #include <sys/time.h>
+#include <atomic>
 #include <sstream>
 
 /* ****************************** */
@@ -530,6 +531,16 @@ std::string Query::new_fragment_name() const {
   struct timeval tp = {};
   gettimeofday(&tp, nullptr);
   uint64_t ms = (uint64_t)tp.tv_sec * 1000L + tp.tv_usec / 1000;
+
+  // Make the timestamps strictly increasing within the process, so that
+  // fragments created in the same millisecond get distinct, ordered names
+  static std::atomic<uint64_t> last_ms(0);
+  uint64_t prev_ms = last_ms.load();
+  do {
+    if (ms <= prev_ms)
+      ms = prev_ms + 1;
+  } while (!last_ms.compare_exchange_weak(prev_ms, ms));
+
   char fragment_name[constants::name_max_len];
 
   std::stringstream ss;
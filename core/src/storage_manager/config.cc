@@ -0,0 +1,77 @@
+/**
+ * @file   config.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class Config.
+ */
+
+#include "config.h"
+#include "constants.h"
+
+namespace tiledb {
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+Config::S3Params::S3Params()
+    : endpoint_override_(constants::s3_endpoint_override)
+    , max_parallel_ops_(constants::s3_max_parallel_ops)
+    , multipart_part_size_(constants::s3_multipart_part_size)
+    , region_(constants::s3_region)
+    , scheme_(constants::s3_scheme) {
+}
+
+Config::SMParams::SMParams()
+    : buffer_pool_max_num_(constants::buffer_pool_max_num)
+    , buffer_pool_max_size_(constants::buffer_pool_max_size)
+    , fragment_discovery_threads_(constants::fragment_discovery_threads)
+    , open_array_cache_size_(constants::open_array_cache_size)
+    , tile_cache_shard_num_(constants::tile_cache_shard_num)
+    , tile_cache_size_(constants::tile_cache_size)
+    , tile_chunk_parallel_min_size_(constants::tile_chunk_parallel_min_size)
+    , tile_chunk_threads_(constants::tile_chunk_threads)
+    , tile_io_coalesce_gap_(constants::tile_io_coalesce_gap)
+    , tile_io_coalesce_max_size_(constants::tile_io_coalesce_max_size)
+    , tile_io_mmap_(constants::tile_io_mmap)
+    , tile_prefetch_(constants::tile_prefetch)
+    , zstd_dictionary_sample_size_(constants::zstd_dictionary_sample_size)
+    , zstd_dictionary_size_(constants::zstd_dictionary_size) {
+}
+
+Config::VFSParams::VFSParams()
+    : disk_cache_block_size_(constants::vfs_disk_cache_block_size)
+    , disk_cache_dir_(constants::vfs_disk_cache_dir)
+    , disk_cache_mutable_ttl_(constants::vfs_disk_cache_mutable_ttl)
+    , disk_cache_size_(constants::vfs_disk_cache_size)
+    , io_queue_depth_(constants::vfs_io_queue_depth)
+    , io_thread_num_(constants::vfs_io_thread_num)
+    , write_buffer_size_(constants::vfs_write_buffer_size) {
+}
+
+}  // namespace tiledb
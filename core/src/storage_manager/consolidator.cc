@@ -120,6 +120,13 @@ Status Consolidator::consolidate(const char* array_name) {
     goto clean_up;
   }
 
+  // Pack the metadata of the remaining fragments
+  st = storage_manager_->store_consolidated_fragment_metadata(array_uri);
+  if (!st.ok()) {
+    storage_manager_->array_unlock(array_uri, false);
+    goto clean_up;
+  }
+
   // Unlock the array
   st = storage_manager_->array_unlock(array_uri, false);
 
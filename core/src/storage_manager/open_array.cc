@@ -42,10 +42,15 @@ namespace tiledb {
 OpenArray::OpenArray() {
   array_metadata_ = nullptr;
   cnt_ = 0;
+  consolidated_generation_ = 0;
 }
 
 OpenArray::~OpenArray() {
+  for (auto& metadata : fragment_metadata_)
+    delete metadata.second.first;
   delete array_metadata_;
+  for (auto& dict : zstd_dictionaries_)
+    delete dict.second;
 }
 
 /* ****************************** */
@@ -64,13 +69,18 @@ uint64_t OpenArray::cnt() const {
   return cnt_;
 }
 
+uint64_t OpenArray::consolidated_generation() const {
+  return consolidated_generation_;
+}
+
 void OpenArray::decr_cnt() {
   --cnt_;
 }
 
-void OpenArray::fragment_metadata_add(FragmentMetadata* metadata) {
+void OpenArray::fragment_metadata_add(
+    FragmentMetadata* metadata, bool in_use) {
   fragment_metadata_[metadata->fragment_uri().to_string()] =
-      std::pair<FragmentMetadata*, uint64_t>(metadata, 1);
+      std::pair<FragmentMetadata*, uint64_t>(metadata, in_use ? 1 : 0);
 }
 
 FragmentMetadata* OpenArray::fragment_metadata_get(const URI& fragment_uri) {
@@ -82,6 +92,28 @@ FragmentMetadata* OpenArray::fragment_metadata_get(const URI& fragment_uri) {
   return it->second.first;
 }
 
+bool OpenArray::fragment_metadata_loaded(const URI& fragment_uri) const {
+  return fragment_metadata_.count(fragment_uri.to_string()) > 0;
+}
+
+void OpenArray::fragment_metadata_prune() {
+  for (auto it = fragment_metadata_.begin(); it != fragment_metadata_.end();) {
+    if (it->second.second == 0 && fragment_uris_.count(it->first) == 0) {
+      delete it->second.first;
+      it = fragment_metadata_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto it = non_empty_domains_.begin(); it != non_empty_domains_.end();) {
+    if (fragment_uris_.count(it->first) == 0)
+      it = non_empty_domains_.erase(it);
+    else
+      ++it;
+  }
+}
+
 void OpenArray::fragment_metadata_rm(const URI& fragment_uri) {
   // Find metadata
   auto it = fragment_metadata_.find(fragment_uri.to_string());
@@ -89,20 +121,26 @@ void OpenArray::fragment_metadata_rm(const URI& fragment_uri) {
     return;
 
   // Decrement counter
-  --(it->second.second);
+  if (it->second.second > 0)
+    --(it->second.second);
+}
 
-  // Potentially remove metadata from main memory
-  // TODO: The following may be left to a cache manager
-  if (it->second.second == 0) {
-    delete it->second.first;
-    fragment_metadata_.erase(it);
-  }
+const std::set<std::string>& OpenArray::fragment_uris() const {
+  return fragment_uris_;
 }
 
 void OpenArray::incr_cnt() {
   ++cnt_;
 }
 
+uint64_t OpenArray::memory_size() const {
+  uint64_t size = 0;
+  for (auto& metadata : fragment_metadata_)
+    size += metadata.second.first->memory_size();
+
+  return size;
+}
+
 void OpenArray::mtx_lock() {
   mtx_.lock();
 }
@@ -111,10 +149,49 @@ void OpenArray::mtx_unlock() {
   mtx_.unlock();
 }
 
+const void* OpenArray::non_empty_domain(
+    const std::string& fragment_uri) const {
+  // Loaded metadata carry the non-empty domain
+  auto metadata = fragment_metadata_.find(fragment_uri);
+  if (metadata != fragment_metadata_.end())
+    return metadata->second.first->non_empty_domain();
+
+  auto it = non_empty_domains_.find(fragment_uri);
+  return (it == non_empty_domains_.end()) ? nullptr : it->second.data();
+}
+
+void OpenArray::non_empty_domain_add(
+    const std::string& fragment_uri, const std::vector<uint8_t>& domain) {
+  non_empty_domains_[fragment_uri] = domain;
+}
+
 void OpenArray::set_array_metadata(const ArrayMetadata* array_metadata) {
   array_metadata_ = array_metadata;
 }
 
+void OpenArray::set_consolidated_generation(uint64_t generation) {
+  consolidated_generation_ = generation;
+}
+
+void OpenArray::set_fragment_uris(const std::vector<URI>& fragment_uris) {
+  fragment_uris_.clear();
+  for (auto& uri : fragment_uris)
+    fragment_uris_.insert(uri.to_string());
+}
+
+const ZStdDictionary* OpenArray::zstd_dictionary(
+    const std::string& attribute) const {
+  auto it = zstd_dictionaries_.find(attribute);
+  return (it == zstd_dictionaries_.end()) ? nullptr : it->second;
+}
+
+void OpenArray::zstd_dictionary_add(
+    const std::string& attribute, ZStdDictionary* dict) {
+  auto& entry = zstd_dictionaries_[attribute];
+  delete entry;
+  entry = dict;
+}
+
 /* ****************************** */
 /*        PRIVATE METHODS         */
 /* ****************************** */
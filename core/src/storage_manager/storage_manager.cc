@@ -32,7 +32,10 @@
  */
 
 #include <blosc.h>
+#include <unistd.h>
 #include <algorithm>
+#include <map>
+#include <sstream>
 
 #include "logger.h"
 #include "storage_manager.h"
@@ -44,11 +47,19 @@ namespace tiledb {
 /*   CONSTRUCTORS & DESTRUCTORS   */
 /* ****************************** */
 
-StorageManager::StorageManager() {
+StorageManager::StorageManager(const Config& config)
+    : config_(config) {
   async_done_ = false;
   async_thread_[0] = nullptr;
   async_thread_[1] = nullptr;
+  buffer_pool_ = new BufferPool(
+      config_.sm_params_.buffer_pool_max_num_,
+      config_.sm_params_.buffer_pool_max_size_);
+  closed_arrays_size_ = 0;
   consolidator_ = new Consolidator(this);
+  tile_cache_ = new TileCache(
+      config_.sm_params_.tile_cache_size_,
+      config_.sm_params_.tile_cache_shard_num_);
   vfs_ = nullptr;
   blosc_init();
 }
@@ -58,6 +69,10 @@ StorageManager::~StorageManager() {
   delete async_thread_[0];
   delete async_thread_[1];
   delete vfs_;
+  for (auto& closed_array : closed_arrays_)
+    delete open_arrays_[closed_array.first];
+  delete buffer_pool_;
+  delete tile_cache_;
   blosc_destroy();
 }
 
@@ -82,6 +97,29 @@ Status StorageManager::array_consolidate(const char* array_name) {
   return consolidator_->consolidate(array_name);
 }
 
+Status StorageManager::array_consolidate_metadata(const char* array_name) {
+  // Check array URI
+  URI array_uri(array_name);
+  if (array_uri.is_invalid()) {
+    return LOG_STATUS(Status::StorageManagerError(
+        "Cannot consolidate array metadata; Invalid URI"));
+  }
+
+  // Check if array exists
+  if (object_type(array_uri) != ObjectType::ARRAY) {
+    return LOG_STATUS(Status::StorageManagerError(
+        "Cannot consolidate array metadata; Array does not exist"));
+  }
+
+  // Lock the array exclusively, so that concurrent consolidations do not
+  // write the same generation
+  RETURN_NOT_OK(array_lock(array_uri, false));
+  Status st = store_consolidated_fragment_metadata(array_uri);
+  Status st_unlock = array_unlock(array_uri, false);
+
+  return st.ok() ? st_unlock : st;
+}
+
 Status StorageManager::array_create(ArrayMetadata* array_metadata) {
   // Check array metadata
   if (array_metadata == nullptr) {
@@ -90,8 +128,12 @@ Status StorageManager::array_create(ArrayMetadata* array_metadata) {
   }
   RETURN_NOT_OK(array_metadata->check());
 
-  // Create array directory
+  // Drop any retained entry of an array previously at this URI
   const URI& array_uri = array_metadata->array_uri();
+  open_array_cache_rm(array_uri);
+  tile_cache_->evict(array_uri);
+
+  // Create array directory
   RETURN_NOT_OK(vfs_->create_dir(array_uri));
 
   // Store array metadata
@@ -182,6 +224,28 @@ Status StorageManager::async_push_query(Query* query, int i) {
   return Status::Ok();
 }
 
+BufferPool* StorageManager::buffer_pool() const {
+  return buffer_pool_;
+}
+
+Status StorageManager::close_file(const URI& uri) const {
+  return vfs_->close_file(uri);
+}
+
+uint64_t StorageManager::closed_array_num() {
+  std::lock_guard<std::mutex> lock(open_array_mtx_);
+  return closed_arrays_.size();
+}
+
+uint64_t StorageManager::closed_array_size() {
+  std::lock_guard<std::mutex> lock(open_array_mtx_);
+  return closed_arrays_size_;
+}
+
+const Config& StorageManager::config() const {
+  return config_;
+}
+
 Status StorageManager::create_dir(const URI& uri) {
   return vfs_->create_dir(uri);
 }
@@ -196,23 +260,30 @@ Status StorageManager::delete_fragment(const URI& uri) const {
         "Cannot delete fragment directory; '" + uri.to_string() +
         "' is not a TileDB fragment"));
   }
+  tile_cache_->evict(uri);
   return vfs_->remove_path(uri);
 }
 
-Status StorageManager::remove_path(const URI& uri) const {
+Status StorageManager::remove_path(const URI& uri) {
   if (object_type(uri) == ObjectType::INVALID) {
     return LOG_STATUS(Status::StorageManagerError(
         "Not a valid TileDB object: " + uri.to_string()));
   }
+  open_array_cache_rm(uri);
+  tile_cache_->evict(uri);
   return vfs_->remove_path(uri);
 }
 
 Status StorageManager::move(
-    const URI& old_uri, const URI& new_uri, bool force) const {
+    const URI& old_uri, const URI& new_uri, bool force) {
   if (object_type(old_uri) == ObjectType::INVALID) {
     return LOG_STATUS(Status::StorageManagerError(
         "Not a valid TileDB object: " + old_uri.to_string()));
   }
+  open_array_cache_rm(old_uri);
+  open_array_cache_rm(new_uri);
+  tile_cache_->evict(old_uri);
+  tile_cache_->evict(new_uri);
   return vfs_->move_path(old_uri, new_uri);
 }
 
@@ -240,7 +311,7 @@ Status StorageManager::group_create(const std::string& group) const {
 Status StorageManager::init() {
   async_thread_[0] = new std::thread(async_start, this, 0);
   async_thread_[1] = new std::thread(async_start, this, 1);
-  vfs_ = new VFS();
+  vfs_ = new VFS(config_.vfs_params_);
 
   return Status::Ok();
 }
@@ -271,6 +342,7 @@ Status StorageManager::load(
   auto tile_io = new TileIO(this, array_metadata_uri);
   auto tile = (Tile*)nullptr;
   RETURN_NOT_OK_ELSE(tile_io->read_generic(&tile, 0), delete tile_io);
+  RETURN_NOT_OK_ELSE(tile_io->close(), delete tile; delete tile_io);
 
   // Deserialize
   tile->reset_offset();
@@ -291,6 +363,16 @@ Status StorageManager::load(FragmentMetadata* fragment_metadata) {
     return Status::StorageManagerError(
         "Cannot load fragment metadata; Fragment directory does not exist");
 
+  // Fragment metadata split into sections start with an index and the
+  // sections are loaded on demand. Older fragments store the metadata as a
+  // single generic tile.
+  Buffer index_buff;
+  RETURN_NOT_OK(read_fragment_metadata_index(fragment_uri, &index_buff));
+  if (index_buff.size() > 0) {
+    ConstBuffer index_cbuff(&index_buff);
+    return fragment_metadata->deserialize_index(this, &index_cbuff);
+  }
+
   URI fragment_metadata_uri = fragment_uri.join_path(
       std::string(constants::fragment_metadata_filename));
 
@@ -298,6 +380,7 @@ Status StorageManager::load(FragmentMetadata* fragment_metadata) {
   auto tile = (Tile*)nullptr;
   auto tile_io = new TileIO(this, fragment_metadata_uri);
   RETURN_NOT_OK_ELSE(tile_io->read_generic(&tile, 0), delete tile_io);
+  RETURN_NOT_OK_ELSE(tile_io->close(), delete tile; delete tile_io);
 
   // Deserialize
   tile->reset_offset();
@@ -311,6 +394,35 @@ Status StorageManager::load(FragmentMetadata* fragment_metadata) {
   return st;
 }
 
+Status StorageManager::load(
+    FragmentMetadata* fragment_metadata, uint64_t section) {
+  URI fragment_metadata_uri = fragment_metadata->fragment_uri().join_path(
+      std::string(constants::fragment_metadata_filename));
+
+  // Read from file
+  auto tile = (Tile*)nullptr;
+  auto tile_io = new TileIO(this, fragment_metadata_uri);
+  RETURN_NOT_OK_ELSE(
+      tile_io->read_generic(&tile, fragment_metadata->section_offset(section)),
+      delete tile_io);
+
+  // Deserialize
+  tile->reset_offset();
+  auto cbuff = new ConstBuffer(tile->buffer());
+  Status st = fragment_metadata->deserialize_section(section, cbuff);
+
+  delete cbuff;
+  delete tile;
+  delete tile_io;
+
+  return st;
+}
+
+Status StorageManager::map_file(
+    const URI& uri, void** data, uint64_t* size) const {
+  return vfs_->map_file(uri, data, size);
+}
+
 Status StorageManager::move_path(
     const URI& old_uri, const URI& new_uri, bool force) {
   return vfs_->move_path(old_uri, new_uri);
@@ -371,6 +483,20 @@ Status StorageManager::query_submit_async(
   return async_push_query(query, 0);
 }
 
+Status StorageManager::read_async(
+    const URI& uri,
+    uint64_t offset,
+    Buffer* buffer,
+    uint64_t nbytes,
+    IOBatch* batch) const {
+  RETURN_NOT_OK(buffer->realloc(nbytes));
+  buffer->set_size(nbytes);
+  buffer->reset_offset();
+  std::vector<VFS::ReadRange> ranges = {{offset, nbytes, buffer->data()}};
+
+  return vfs_->read_async(uri, ranges, batch);
+}
+
 Status StorageManager::read_from_file(
     const URI& uri, uint64_t offset, Buffer* buffer, uint64_t nbytes) const {
   RETURN_NOT_OK(buffer->realloc(nbytes));
@@ -405,6 +531,8 @@ Status StorageManager::store(ArrayMetadata* array_metadata) {
       false);
   auto tile_io = new TileIO(this, array_metadata_uri);
   Status st = tile_io->write_generic(tile);
+  if (st.ok())
+    st = tile_io->close();
 
   delete tile;
   delete tile_io;
@@ -419,29 +547,207 @@ Status StorageManager::store(FragmentMetadata* metadata) {
   if (!vfs_->is_dir(fragment_uri))
     return Status::Ok();
 
-  // Serialize
-  auto buff = new Buffer();
-  RETURN_NOT_OK_ELSE(metadata->serialize(buff), delete buff);
+  // Store the non-empty domain separately, so that fragments can be pruned
+  // without loading their metadata. It is written before the fragment
+  // metadata file, which marks the fragment as complete.
+  URI domain_uri = fragment_uri.join_path(constants::fragment_domain_filename);
+  Buffer domain_buff(
+      const_cast<void*>(metadata->non_empty_domain()),
+      2 * metadata->array_metadata()->coords_size(),
+      false);
+  RETURN_NOT_OK(write_to_file(domain_uri, &domain_buff));
+  RETURN_NOT_OK(close_file(domain_uri));
 
-  // Write to file
   URI fragment_metadata_uri = fragment_uri.join_path(
       std::string(constants::fragment_metadata_filename));
-  buff->reset_offset();
-  auto tile = new Tile(
-      constants::generic_tile_datatype,
-      constants::generic_tile_compressor,
-      constants::generic_tile_compression_level,
-      constants::generic_tile_cell_size,
-      0,
-      buff,
-      false);
-
   auto tile_io = new TileIO(this, fragment_metadata_uri);
-  Status st = tile_io->write_generic(tile);
 
-  delete tile;
+  // Serialize every section into a separate generic tile, so that the
+  // sections can be loaded independently
+  uint64_t section_num = metadata->section_num();
+  std::vector<uint64_t> section_sizes(section_num);
+  Buffer sections_buff;
+  Status st;
+  for (uint64_t i = 0; i < section_num; ++i) {
+    Buffer section_buff;
+    st = metadata->serialize_section(i, &section_buff);
+    if (!st.ok())
+      break;
+    section_buff.reset_offset();
+    Tile tile(
+        constants::generic_tile_datatype,
+        constants::generic_tile_compressor,
+        constants::generic_tile_compression_level,
+        constants::generic_tile_cell_size,
+        0,
+        &section_buff,
+        false);
+    uint64_t offset = sections_buff.size();
+    st = tile_io->serialize_generic(&tile, &sections_buff);
+    if (!st.ok())
+      break;
+    section_sizes[i] = sections_buff.size() - offset;
+  }
+
+  // Write the index, followed by the sections
+  Buffer index_buff;
+  if (st.ok())
+    st = metadata->serialize_index(section_sizes, &index_buff);
+  if (st.ok())
+    st = write_to_file(fragment_metadata_uri, &index_buff);
+  if (st.ok())
+    st = write_to_file(fragment_metadata_uri, &sections_buff);
+  if (st.ok())
+    st = tile_io->close();
+
   delete tile_io;
-  delete buff;
+
+  return st;
+}
+
+// ===== FORMAT =====
+// generation (uint64_t)
+// fragment_num (uint64_t)
+// fragment_name_size#1 (uint64_t) fragment_name#1 (char*) dense#1 (char)
+//     index_size#1 (uint64_t) index#1 (uint8_t*)
+// fragment_name_size#2 (uint64_t) fragment_name#2 (char*) dense#2 (char)
+//     index_size#2 (uint64_t) index#2 (uint8_t*)
+// ...
+Status StorageManager::store_consolidated_fragment_metadata(
+    const URI& array_uri) {
+  // Get the array subdirectories and the consolidated fragment metadata
+  // files of previous generations
+  std::vector<URI> uris;
+  std::vector<bool> is_dirs;
+  RETURN_NOT_OK(vfs_->ls_with_types(array_uri, &uris, &is_dirs));
+  std::vector<URI> candidates;
+  std::vector<URI> old_uris;
+  uint64_t generation = 0;
+  for (uint64_t i = 0; i < uris.size(); ++i) {
+    uint64_t file_generation;
+    if (is_dirs[i]) {
+      if (!utils::starts_with(uris[i].last_path_part(), "."))
+        candidates.push_back(uris[i]);
+    } else if (is_consolidated_fragment_metadata(uris[i], &file_generation)) {
+      old_uris.push_back(uris[i]);
+      generation = std::max(generation, file_generation);
+    }
+  }
+
+  // Read the fragment metadata index of every fragment concurrently.
+  // Fragments whose metadata are in the older single generic tile format
+  // are left out, and are loaded from their own files.
+  std::vector<std::vector<uint8_t>> indexes(candidates.size());
+  std::vector<uint8_t> dense(candidates.size(), 0);
+  RETURN_NOT_OK(utils::parallel_for(
+      candidates.size(),
+      config_.sm_params_.fragment_discovery_threads_,
+      [&](uint64_t i) {
+        if (!is_fragment(candidates[i]))
+          return Status::Ok();
+        Buffer index_buff;
+        RETURN_NOT_OK(read_fragment_metadata_index(candidates[i], &index_buff));
+        auto data = static_cast<uint8_t*>(index_buff.data());
+        indexes[i].assign(data, data + index_buff.size());
+        URI coords_uri = candidates[i].join_path(
+            std::string(constants::coords) + constants::file_suffix);
+        dense[i] = !vfs_->is_file(coords_uri);
+        return Status::Ok();
+      }));
+
+  // Serialize
+  ++generation;
+  uint64_t fragment_num = 0;
+  for (auto& index : indexes)
+    fragment_num += index.empty() ? 0 : 1;
+  Buffer buff;
+  RETURN_NOT_OK(buff.write(&generation, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff.write(&fragment_num, sizeof(uint64_t)));
+  for (uint64_t i = 0; i < candidates.size(); ++i) {
+    if (indexes[i].empty())
+      continue;
+    std::string fragment_name = candidates[i].last_path_part();
+    uint64_t fragment_name_size = fragment_name.size();
+    auto is_dense = (char)dense[i];
+    uint64_t index_size = indexes[i].size();
+    RETURN_NOT_OK(buff.write(&fragment_name_size, sizeof(uint64_t)));
+    RETURN_NOT_OK(buff.write(fragment_name.data(), fragment_name_size));
+    RETURN_NOT_OK(buff.write(&is_dense, sizeof(char)));
+    RETURN_NOT_OK(buff.write(&index_size, sizeof(uint64_t)));
+    RETURN_NOT_OK(buff.write(&indexes[i][0], index_size));
+  }
+
+  // Write to a new file, so that readers of the previous generation are not
+  // disturbed, and then remove the previous generations
+  URI uri = array_uri.join_path(
+      std::string(constants::consolidated_fragment_metadata_prefix) +
+      std::to_string(generation) + constants::file_suffix);
+  RETURN_NOT_OK(write_to_file(uri, &buff));
+  RETURN_NOT_OK(close_file(uri));
+  for (auto& old_uri : old_uris)
+    RETURN_NOT_OK(vfs_->remove_file(old_uri));
+
+  return Status::Ok();
+}
+
+Status StorageManager::store_zstd_dictionary(
+    const URI& array_uri, const Attribute* attr, Buffer* dict) {
+  // Lock mutex
+  open_array_mtx_.lock();
+
+  // Find the open array entry
+  auto it = open_arrays_.find(array_uri.to_string());
+  if (it == open_arrays_.end()) {
+    open_array_mtx_.unlock();
+    return LOG_STATUS(Status::StorageManagerError(
+        "Cannot store ZSTD dictionary; Open array entry not found"));
+  }
+  OpenArray* open_array = it->second;
+
+  // Lock the mutex of the array and unlock mutex
+  open_array->mtx_lock();
+  open_array_mtx_.unlock();
+
+  // The first dictionary stored wins, also across processes; it is written
+  // to a hidden file first, so that it appears complete, and is then moved
+  // in place unless another dictionary was moved there meanwhile
+  URI dict_uri = zstd_dictionary_uri(array_uri, attr->name());
+  Status st;
+  if (!is_file(dict_uri)) {
+    std::stringstream ss;
+    ss << "." << constants::zstd_dictionary_prefix << attr->name() << "_"
+       << getpid() << "_" << std::this_thread::get_id()
+       << constants::file_suffix;
+    URI tmp_uri = array_uri.join_path(ss.str());
+
+    dict->reset_offset();
+    auto tile = new Tile(
+        constants::generic_tile_datatype,
+        Compressor::NO_COMPRESSION,
+        constants::generic_tile_compression_level,
+        constants::generic_tile_cell_size,
+        0,
+        dict,
+        false);
+    auto tile_io = new TileIO(this, tmp_uri);
+    st = tile_io->write_generic(tile);
+    if (st.ok())
+      st = tile_io->close();
+    bool moved = false;
+    if (st.ok())
+      st = vfs_->move_file_no_replace(tmp_uri, dict_uri, &moved);
+    if (st.ok() && !moved)
+      st = vfs_->remove_file(tmp_uri);
+    delete tile;
+    delete tile_io;
+  }
+
+  // Load the stored dictionary
+  if (st.ok())
+    st = open_array_load_zstd_dictionary(open_array, attr);
+
+  // Unlock the mutex of the array
+  open_array->mtx_unlock();
 
   return st;
 }
@@ -450,20 +756,48 @@ Status StorageManager::sync(const URI& uri) {
   return vfs_->sync(uri);
 }
 
+TileCache* StorageManager::tile_cache() const {
+  return tile_cache_;
+}
+
+Status StorageManager::unmap_file(
+    const URI& uri, void* data, uint64_t size) const {
+  return vfs_->unmap_file(uri, data, size);
+}
+
+Status StorageManager::wait_reads(IOBatch* batch) const {
+  return vfs_->wait_reads(batch);
+}
+
 Status StorageManager::write_to_file(const URI& uri, Buffer* buffer) const {
   return vfs_->write_to_file(uri, buffer->data(), buffer->size());
 }
 
 ObjectType StorageManager::object_type(const URI& uri) const {
-  if (vfs_->is_file(uri.join_path(constants::group_filename))) {
-    return ObjectType::GROUP;
-  } else if (vfs_->is_file(uri.join_path(constants::array_metadata_filename))) {
+  // Arrays are checked first, as they are looked up on every open
+  if (vfs_->is_file(uri.join_path(constants::array_metadata_filename))) {
     return ObjectType::ARRAY;
+  } else if (vfs_->is_file(uri.join_path(constants::group_filename))) {
+    return ObjectType::GROUP;
   } else {
     return ObjectType::INVALID;
   }
 }
 
+const ZStdDictionary* StorageManager::zstd_dictionary(
+    const URI& array_uri, const std::string& attribute) {
+  std::lock_guard<std::mutex> lock(open_array_mtx_);
+  auto it = open_arrays_.find(array_uri.to_string());
+  if (it == open_arrays_.end())
+    return nullptr;
+
+  it->second->mtx_lock();
+  auto dict = it->second->zstd_dictionary(attribute);
+  it->second->mtx_unlock();
+
+  return dict;
+}
+
 /* ****************************** */
 /*         PRIVATE METHODS        */
 /* ****************************** */
@@ -496,15 +830,15 @@ Status StorageManager::array_close(
   for (auto& metadata : fragment_metadata)
     open_array->fragment_metadata_rm(metadata->fragment_uri());
 
-  // Potentially remove open array entry
+  // Unlock the mutex of the array
+  open_array->mtx_unlock();
+
+  // The entry of a closed array is retained, up to the cache budget
   if (open_array->cnt() == 0) {
-    // TODO: we may want to leave this to a cache manager
-    open_array->mtx_unlock();
-    delete open_array;
-    open_arrays_.erase(it);
-  } else {
-    // Unlock the mutex of the array
-    open_array->mtx_unlock();
+    uint64_t size = open_array->memory_size();
+    closed_arrays_.emplace_back(it->first, size);
+    closed_arrays_size_ += size;
+    open_array_cache_evict();
   }
 
   // Unlock mutex
@@ -557,6 +891,11 @@ Status StorageManager::array_open(
       array_open_error(open_array, *fragment_metadata));
   *array_metadata = open_array->array_metadata();
 
+  // Load the trained ZSTD dictionaries
+  RETURN_NOT_OK_ELSE(
+      open_array_load_zstd_dictionaries(open_array),
+      array_open_error(open_array, *fragment_metadata));
+
   // Get fragment metadata only in read mode
   if (type == QueryType::READ)
     RETURN_NOT_OK_ELSE(
@@ -611,25 +950,244 @@ void StorageManager::async_stop() {
 }
 
 Status StorageManager::get_fragment_uris(
-    const URI& array_uri,
+    OpenArray* open_array,
     const void* subarray,
-    std::vector<URI>* fragment_uris) const {
-  // Get all uris in the array directory
+    std::vector<URI>* fragment_uris) {
+  // Get all uris in the array directory, along with their types
   std::vector<URI> uris;
-  RETURN_NOT_OK(vfs_->ls(array_uri, &uris));
+  std::vector<bool> is_dirs;
+  RETURN_NOT_OK(vfs_->ls_with_types(open_array->array_uri(), &uris, &is_dirs));
+
+  // Only the visible subdirectories may be fragments. The latest
+  // consolidated fragment metadata file is looked up along the way.
+  std::vector<URI> candidates;
+  URI consolidated_uri;
+  uint64_t consolidated_generation = 0;
+  for (uint64_t i = 0; i < uris.size(); ++i) {
+    uint64_t generation;
+    if (!is_dirs[i]) {
+      if (is_consolidated_fragment_metadata(uris[i], &generation) &&
+          generation > consolidated_generation) {
+        consolidated_uri = uris[i];
+        consolidated_generation = generation;
+      }
+      continue;
+    }
+    if (!utils::starts_with(uris[i].last_path_part(), "."))
+      candidates.push_back(uris[i]);
+  }
 
-  // Get only the fragment uris
-  for (auto& uri : uris) {
-    // TODO: check here if the fragment overlaps subarray
-    if (utils::starts_with(uri.last_path_part(), "."))
+  // The metadata of the fragments in the consolidated file are loaded with
+  // a single read. If the file cannot be read (e.g., it was replaced by a
+  // newer generation in the meantime), the metadata it did not provide are
+  // loaded from the fragment metadata files, like those of newer fragments.
+  if (consolidated_generation > 0) {
+    Status st = load_consolidated_fragment_metadata(
+        open_array, consolidated_uri, consolidated_generation, candidates);
+    if (!st.ok())
+      LOG_STATUS(Status::StorageManagerError(
+          "Ignoring consolidated fragment metadata file '" +
+          consolidated_uri.to_string() + "'; " + st.to_string()));
+  }
+
+  // Those known from a previous open or from the consolidated file are
+  // fragments; the rest are checked concurrently, along with reading the
+  // non-empty domains not known yet
+  const auto& known = open_array->fragment_uris();
+  std::vector<uint8_t> found;
+  for (auto& candidate : candidates)
+    found.push_back(
+        known.count(candidate.to_string()) > 0 ||
+        open_array->fragment_metadata_loaded(candidate));
+  std::vector<std::vector<uint8_t>> domains(candidates.size());
+  RETURN_NOT_OK(utils::parallel_for(
+      candidates.size(),
+      config_.sm_params_.fragment_discovery_threads_,
+      [&](uint64_t i) {
+        if (!found[i])
+          found[i] = is_fragment(candidates[i]);
+        if (found[i] && subarray != nullptr &&
+            open_array->non_empty_domain(candidates[i].to_string()) ==
+                nullptr)
+          load_non_empty_domain(open_array, candidates[i], &domains[i]);
+        return Status::Ok();
+      }));
+
+  // Prune the fragments whose non-empty domain does not overlap the
+  // subarray, so that their metadata are never loaded. The domain of
+  // fragments written before domain files existed is unknown, so they are
+  // kept.
+  std::vector<URI> all_fragment_uris;
+  auto domain = open_array->array_metadata()->domain();
+  for (uint64_t i = 0; i < candidates.size(); ++i) {
+    if (!found[i])
       continue;
-    if (vfs_->is_file(uri.join_path(constants::fragment_metadata_filename)))
-      fragment_uris->push_back(uri);
+    all_fragment_uris.push_back(candidates[i]);
+    if (subarray != nullptr) {
+      auto uri = candidates[i].to_string();
+      if (!domains[i].empty())
+        open_array->non_empty_domain_add(uri, domains[i]);
+      auto non_empty_domain = open_array->non_empty_domain(uri);
+      if (non_empty_domain != nullptr &&
+          !domain->overlap(non_empty_domain, subarray))
+        continue;
+    }
+    fragment_uris->push_back(candidates[i]);
   }
+  open_array->set_fragment_uris(all_fragment_uris);
 
   return Status::Ok();
 }
 
+void StorageManager::open_array_cache_evict() {
+  uint64_t cache_size = config_.sm_params_.open_array_cache_size_;
+  while (!closed_arrays_.empty() &&
+         (closed_arrays_size_ > cache_size || cache_size == 0)) {
+    auto it = open_arrays_.find(closed_arrays_.front().first);
+    closed_arrays_size_ -= closed_arrays_.front().second;
+    delete it->second;
+    open_arrays_.erase(it);
+    closed_arrays_.pop_front();
+  }
+}
+
+void StorageManager::open_array_cache_rm(const URI& uri) {
+  std::string prefix = uri.to_string();
+  size_t n = prefix.size();
+
+  std::lock_guard<std::mutex> lock(open_array_mtx_);
+  for (auto it = closed_arrays_.begin(); it != closed_arrays_.end();) {
+    const std::string& closed_uri = it->first;
+    if (closed_uri.compare(0, n, prefix) == 0 &&
+        (closed_uri.size() == n || closed_uri[n] == '/')) {
+      auto entry = open_arrays_.find(closed_uri);
+      closed_arrays_size_ -= it->second;
+      delete entry->second;
+      open_arrays_.erase(entry);
+      it = closed_arrays_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool StorageManager::is_consolidated_fragment_metadata(
+    const URI& uri, uint64_t* generation) const {
+  std::string name = uri.last_path_part();
+  std::string prefix = constants::consolidated_fragment_metadata_prefix;
+  std::string suffix = constants::file_suffix;
+  if (name.size() <= prefix.size() + suffix.size() ||
+      !utils::starts_with(name, prefix) ||
+      name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+    return false;
+
+  std::string number = name.substr(
+      prefix.size(), name.size() - prefix.size() - suffix.size());
+  if (!utils::is_positive_integer(number.c_str()))
+    return false;
+  *generation = std::stoull(number);
+
+  return true;
+}
+
+Status StorageManager::load_consolidated_fragment_metadata(
+    OpenArray* open_array,
+    const URI& uri,
+    uint64_t generation,
+    const std::vector<URI>& fragment_uris) {
+  if (open_array->consolidated_generation() == generation)
+    return Status::Ok();
+
+  // Read the whole file at once
+  uint64_t file_size;
+  Buffer buff;
+  RETURN_NOT_OK(vfs_->file_size(uri, &file_size));
+  RETURN_NOT_OK(read_from_file(uri, 0, &buff, file_size));
+
+  uint64_t file_generation = 0;
+  uint64_t fragment_num = 0;
+  RETURN_NOT_OK(buff.read(&file_generation, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff.read(&fragment_num, sizeof(uint64_t)));
+  if (file_generation != generation)
+    return LOG_STATUS(Status::StorageManagerError(
+        "Cannot load consolidated fragment metadata; Generation mismatch"));
+
+  // Fragments deleted since the file was written are skipped
+  std::map<std::string, const URI*> listed;
+  for (auto& fragment_uri : fragment_uris)
+    listed[fragment_uri.last_path_part()] = &fragment_uri;
+
+  for (uint64_t i = 0; i < fragment_num; ++i) {
+    uint64_t fragment_name_size = 0;
+    char dense = 0;
+    uint64_t index_size = 0;
+    RETURN_NOT_OK(buff.read(&fragment_name_size, sizeof(uint64_t)));
+    std::string fragment_name(fragment_name_size, '\0');
+    RETURN_NOT_OK(buff.read(&fragment_name[0], fragment_name_size));
+    RETURN_NOT_OK(buff.read(&dense, sizeof(char)));
+    RETURN_NOT_OK(buff.read(&index_size, sizeof(uint64_t)));
+    if (index_size > buff.size() - buff.offset())
+      return LOG_STATUS(Status::StorageManagerError(
+          "Cannot load consolidated fragment metadata; Invalid index size"));
+    ConstBuffer index_cbuff(buff.cur_data(), index_size);
+    buff.advance_offset(index_size);
+
+    auto it = listed.find(fragment_name);
+    if (it == listed.end() || open_array->fragment_metadata_loaded(*it->second))
+      continue;
+    auto metadata = new FragmentMetadata(
+        open_array->array_metadata(), dense != 0, *it->second);
+    RETURN_NOT_OK_ELSE(
+        metadata->deserialize_index(this, &index_cbuff), delete metadata);
+    open_array->fragment_metadata_add(metadata, false);
+  }
+  open_array->set_consolidated_generation(generation);
+
+  return Status::Ok();
+}
+
+Status StorageManager::load_non_empty_domain(
+    OpenArray* open_array,
+    const URI& fragment_uri,
+    std::vector<uint8_t>* domain) const {
+  URI domain_uri = fragment_uri.join_path(constants::fragment_domain_filename);
+  uint64_t domain_size = 2 * open_array->array_metadata()->coords_size();
+  uint64_t file_size;
+  if (!vfs_->is_file(domain_uri) ||
+      !vfs_->file_size(domain_uri, &file_size).ok() ||
+      file_size != domain_size)
+    return Status::Ok();
+
+  Buffer buff;
+  RETURN_NOT_OK(read_from_file(domain_uri, 0, &buff, domain_size));
+  domain->assign(
+      static_cast<uint8_t*>(buff.data()),
+      static_cast<uint8_t*>(buff.data()) + domain_size);
+
+  return Status::Ok();
+}
+
+Status StorageManager::read_fragment_metadata_index(
+    const URI& fragment_uri, Buffer* buff) const {
+  URI fragment_metadata_uri = fragment_uri.join_path(
+      std::string(constants::fragment_metadata_filename));
+
+  // Get magic value and index size
+  uint64_t magic = 0;
+  uint64_t index_size = 0;
+  RETURN_NOT_OK(
+      read_from_file(fragment_metadata_uri, 0, buff, 2 * sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->read(&magic, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->read(&index_size, sizeof(uint64_t)));
+  if (magic != constants::fragment_metadata_index_magic) {
+    buff->reset_size();
+    buff->reset_offset();
+    return Status::Ok();
+  }
+
+  return read_from_file(fragment_metadata_uri, 0, buff, index_size);
+}
+
 Status StorageManager::open_array_get_entry(
     const URI& array_uri, OpenArray** open_array) {
   // Find the open array entry
@@ -640,6 +1198,17 @@ Status StorageManager::open_array_get_entry(
     open_arrays_[array_uri.to_string()] = *open_array;
   } else {
     *open_array = it->second;
+    // A retained closed array is reopened
+    if ((*open_array)->cnt() == 0) {
+      for (auto c_it = closed_arrays_.begin(); c_it != closed_arrays_.end();
+           ++c_it) {
+        if (c_it->first == it->first) {
+          closed_arrays_size_ -= c_it->second;
+          closed_arrays_.erase(c_it);
+          break;
+        }
+      }
+    }
   }
 
   return Status::Ok();
@@ -665,10 +1234,12 @@ Status StorageManager::open_array_load_fragment_metadata(
     std::vector<FragmentMetadata*>* fragment_metadata) {
   // Get all the fragment uris, sorted by timestamp
   std::vector<URI> fragment_uris;
-  const URI& array_uri = open_array->array_uri();
-  RETURN_NOT_OK(get_fragment_uris(array_uri, subarray, &fragment_uris));
+  RETURN_NOT_OK(get_fragment_uris(open_array, subarray, &fragment_uris));
   sort_fragment_uris(&fragment_uris);
 
+  // Free the retained metadata of fragments deleted since they were loaded
+  open_array->fragment_metadata_prune();
+
   if (fragment_uris.empty())
     return Status::Ok();
 
@@ -678,8 +1249,8 @@ Status StorageManager::open_array_load_fragment_metadata(
     auto metadata = open_array->fragment_metadata_get(uri);
     // If not found, load metadata and store in open array
     if (metadata == nullptr) {
-      URI coords_uri = uri.join_path(
-          std::string("/") + constants::coords + constants::file_suffix);
+      URI coords_uri =
+          uri.join_path(std::string(constants::coords) + constants::file_suffix);
       bool dense = !vfs_->is_file(coords_uri);
       metadata = new FragmentMetadata(open_array->array_metadata(), dense, uri);
       RETURN_NOT_OK_ELSE(load(metadata), delete metadata);
@@ -693,6 +1264,46 @@ Status StorageManager::open_array_load_fragment_metadata(
   return Status::Ok();
 }
 
+Status StorageManager::open_array_load_zstd_dictionary(
+    OpenArray* open_array, const Attribute* attr) {
+  // Do nothing if the dictionary is already loaded or not stored yet
+  if (open_array->zstd_dictionary(attr->name()) != nullptr)
+    return Status::Ok();
+  URI dict_uri = zstd_dictionary_uri(open_array->array_uri(), attr->name());
+  if (!is_file(dict_uri))
+    return Status::Ok();
+
+  // Read from file
+  auto tile_io = new TileIO(this, dict_uri);
+  auto tile = (Tile*)nullptr;
+  RETURN_NOT_OK_ELSE(tile_io->read_generic(&tile, 0), delete tile_io);
+  RETURN_NOT_OK_ELSE(tile_io->close(), delete tile; delete tile_io);
+
+  // Digest the dictionary
+  auto dict = new ZStdDictionary();
+  Status st = dict->init(tile->data(), tile->size(), attr->compression_level());
+  if (st.ok())
+    open_array->zstd_dictionary_add(attr->name(), dict);
+  else
+    delete dict;
+
+  delete tile;
+  delete tile_io;
+
+  return st;
+}
+
+Status StorageManager::open_array_load_zstd_dictionaries(
+    OpenArray* open_array) {
+  auto array_metadata = open_array->array_metadata();
+  for (auto attr : array_metadata->attributes()) {
+    if (attr->zstd_dictionary())
+      RETURN_NOT_OK(open_array_load_zstd_dictionary(open_array, attr));
+  }
+
+  return Status::Ok();
+}
+
 void StorageManager::sort_fragment_uris(std::vector<URI>* fragment_uris) const {
   // Do nothing if there are not enough fragments
   uint64_t fragment_num = fragment_uris->size();
@@ -726,4 +1337,10 @@ void StorageManager::sort_fragment_uris(std::vector<URI>* fragment_uris) const {
   *fragment_uris = fragment_uris_sorted;
 }
 
+URI StorageManager::zstd_dictionary_uri(
+    const URI& array_uri, const std::string& attribute) const {
+  return array_uri.join_path(
+      constants::zstd_dictionary_prefix + attribute + constants::file_suffix);
+}
+
 }  // namespace tiledb
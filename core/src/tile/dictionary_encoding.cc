@@ -0,0 +1,272 @@
+/**
+ * @file   dictionary_encoding.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class DictionaryEncoding.
+ */
+
+#include "dictionary_encoding.h"
+#include "constants.h"
+#include "logger.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiledb {
+
+namespace {
+
+/** Marks a tile stored as it is. */
+const char mode_plain = 0;
+
+/** Marks a dictionary-encoded tile. */
+const char mode_dictionary = 1;
+
+/** The size of the header of a dictionary-encoded tile. */
+const uint64_t header_size =
+    sizeof(char) + sizeof(uint64_t) + sizeof(uint8_t);
+
+/** Writes a tile as it is. */
+Status encode_plain(const Tile* values, Buffer* encoded) {
+  RETURN_NOT_OK(encoded->write(&mode_plain, sizeof(char)));
+  return encoded->write(values->data(), values->size());
+}
+
+/** Writes the codes of the cells with *T*-sized integers. */
+template <class T>
+void write_codes(const std::vector<uint32_t>& codes, char* out) {
+  auto out_t = reinterpret_cast<T*>(out);
+  for (uint64_t i = 0; i < codes.size(); ++i)
+    out_t[i] = (T)codes[i];
+}
+
+/**
+ * Computes the size of the cells whose codes are stored with *T*-sized
+ * integers, checking that the codes are valid.
+ */
+template <class T>
+Status values_size(
+    const char* in,
+    uint64_t code_num,
+    const std::vector<uint64_t>& entry_sizes,
+    uint64_t* size) {
+  T code;
+  *size = 0;
+  for (uint64_t i = 0; i < code_num; ++i) {
+    std::memcpy(&code, in + i * sizeof(T), sizeof(T));
+    if (code >= entry_sizes.size())
+      return LOG_STATUS(Status::TileError(
+          "Cannot decode dictionary-encoded tile; Invalid code"));
+    *size += entry_sizes[code];
+  }
+
+  return Status::Ok();
+}
+
+/** Expands the codes stored with *T*-sized integers to the cell values. */
+template <class T>
+void write_values(
+    const char* in,
+    uint64_t code_num,
+    const char* dict,
+    const std::vector<uint64_t>& entry_starts,
+    const std::vector<uint64_t>& entry_sizes,
+    char* out) {
+  T code;
+  for (uint64_t i = 0; i < code_num; ++i) {
+    std::memcpy(&code, in + i * sizeof(T), sizeof(T));
+    std::memcpy(out, dict + entry_starts[code], entry_sizes[code]);
+    out += entry_sizes[code];
+  }
+}
+
+}  // namespace
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+// ===== FORMAT =====
+// mode (char)
+// if mode is plain:
+//   values (char[])
+// if mode is dictionary:
+//   dict_num (uint64_t)
+//   code_size (uint8_t)
+//   size of entry #1 (uint64_t)
+//   size of entry #2 (uint64_t)
+//   ...
+//   entry #1 (char[])
+//   entry #2 (char[])
+//   ...
+//   code of cell #1 (code_size bytes)
+//   code of cell #2 (code_size bytes)
+//   ...
+Status DictionaryEncoding::encode(
+    const Tile* offsets, const Tile* values, Buffer* encoded) {
+  encoded->reset_offset();
+  encoded->reset_size();
+
+  // For easy reference
+  uint64_t cell_num = offsets->size() / constants::cell_var_offset_size;
+  uint64_t values_size = values->size();
+  auto off = static_cast<const uint64_t*>(offsets->data());
+  auto vals = static_cast<const char*>(values->data());
+  if (cell_num == 0)
+    return encode_plain(values, encoded);
+
+  // Build the dictionary, giving up once it outgrows the values
+  std::unordered_map<std::string, uint32_t> index;
+  std::vector<uint64_t> entry_starts;
+  std::vector<uint64_t> entry_sizes;
+  std::vector<uint32_t> codes(cell_num);
+  uint64_t dict_size = 0;
+  for (uint64_t i = 0; i < cell_num; ++i) {
+    uint64_t start = off[i] - off[0];
+    uint64_t end = (i + 1 < cell_num) ? off[i + 1] - off[0] : values_size;
+    std::string cell(vals + start, end - start);
+    auto it = index.find(cell);
+    if (it == index.end()) {
+      dict_size += sizeof(uint64_t) + cell.size();
+      if (dict_size >= values_size)
+        return encode_plain(values, encoded);
+      it = index.emplace(std::move(cell), (uint32_t)entry_sizes.size()).first;
+      entry_starts.push_back(start);
+      entry_sizes.push_back(end - start);
+    }
+    codes[i] = it->second;
+  }
+
+  // Store the tile as it is if it would not shrink
+  uint64_t dict_num = entry_sizes.size();
+  uint8_t code_size =
+      (dict_num <= 256) ? 1 : (dict_num <= 65536) ? 2 : sizeof(uint32_t);
+  uint64_t encoded_size = header_size + dict_size + cell_num * code_size;
+  if (encoded_size >= sizeof(char) + values_size)
+    return encode_plain(values, encoded);
+
+  // Write the header and the dictionary
+  RETURN_NOT_OK(encoded->realloc(encoded_size));
+  auto out = static_cast<char*>(encoded->data());
+  out[0] = mode_dictionary;
+  std::memcpy(out + sizeof(char), &dict_num, sizeof(uint64_t));
+  out[sizeof(char) + sizeof(uint64_t)] = (char)code_size;
+  out += header_size;
+  std::memcpy(out, &entry_sizes[0], dict_num * sizeof(uint64_t));
+  out += dict_num * sizeof(uint64_t);
+  for (uint64_t i = 0; i < dict_num; ++i) {
+    std::memcpy(out, vals + entry_starts[i], entry_sizes[i]);
+    out += entry_sizes[i];
+  }
+
+  // Write the codes
+  if (code_size == 1)
+    write_codes<uint8_t>(codes, out);
+  else if (code_size == 2)
+    write_codes<uint16_t>(codes, out);
+  else
+    write_codes<uint32_t>(codes, out);
+
+  encoded->set_size(encoded_size);
+  encoded->set_offset(encoded_size);
+
+  return Status::Ok();
+}
+
+Status DictionaryEncoding::decode(
+    const void* data, uint64_t nbytes, Buffer* values) {
+  values->reset_offset();
+  values->reset_size();
+
+  // Tile stored as it is
+  auto in = static_cast<const char*>(data);
+  if (nbytes > 0 && in[0] == mode_plain)
+    return values->write(in + sizeof(char), nbytes - sizeof(char));
+
+  // Read the header
+  if (nbytes < header_size || in[0] != mode_dictionary)
+    return LOG_STATUS(Status::TileError(
+        "Cannot decode dictionary-encoded tile; Invalid header"));
+  uint64_t dict_num;
+  std::memcpy(&dict_num, in + sizeof(char), sizeof(uint64_t));
+  uint8_t code_size = in[sizeof(char) + sizeof(uint64_t)];
+  if ((code_size != 1 && code_size != 2 && code_size != 4) ||
+      dict_num > (nbytes - header_size) / sizeof(uint64_t))
+    return LOG_STATUS(Status::TileError(
+        "Cannot decode dictionary-encoded tile; Invalid header"));
+  in += header_size;
+  nbytes -= header_size;
+
+  // Locate the dictionary entries
+  std::vector<uint64_t> entry_sizes(dict_num);
+  std::vector<uint64_t> entry_starts(dict_num);
+  if (dict_num > 0)
+    std::memcpy(&entry_sizes[0], in, dict_num * sizeof(uint64_t));
+  in += dict_num * sizeof(uint64_t);
+  nbytes -= dict_num * sizeof(uint64_t);
+  uint64_t dict_size = 0;
+  for (uint64_t i = 0; i < dict_num; ++i) {
+    if (entry_sizes[i] > nbytes - dict_size)
+      return LOG_STATUS(Status::TileError(
+          "Cannot decode dictionary-encoded tile; Invalid dictionary"));
+    entry_starts[i] = dict_size;
+    dict_size += entry_sizes[i];
+  }
+  const char* dict = in;
+  in += dict_size;
+  uint64_t code_num = (nbytes - dict_size) / code_size;
+
+  // Expand the codes
+  uint64_t size;
+  Status st;
+  if (code_size == 1)
+    st = values_size<uint8_t>(in, code_num, entry_sizes, &size);
+  else if (code_size == 2)
+    st = values_size<uint16_t>(in, code_num, entry_sizes, &size);
+  else
+    st = values_size<uint32_t>(in, code_num, entry_sizes, &size);
+  RETURN_NOT_OK(st);
+  if (size == 0)
+    return Status::Ok();
+  RETURN_NOT_OK(values->realloc(size));
+  auto out = static_cast<char*>(values->data());
+  if (code_size == 1)
+    write_values<uint8_t>(in, code_num, dict, entry_starts, entry_sizes, out);
+  else if (code_size == 2)
+    write_values<uint16_t>(in, code_num, dict, entry_starts, entry_sizes, out);
+  else
+    write_values<uint32_t>(in, code_num, dict, entry_starts, entry_sizes, out);
+  values->set_size(size);
+  values->set_offset(size);
+
+  return Status::Ok();
+}
+
+}  // namespace tiledb
@@ -49,6 +49,7 @@ Tile::Tile(unsigned int dim_num) {
   dim_num_ = dim_num;
   owns_buff_ = true;
   type_ = Datatype::INT32;
+  zstd_dictionary_ = nullptr;
 }
 
 Tile::Tile(
@@ -65,7 +66,8 @@ Tile::Tile(
     , compression_level_(compression_level)
     , dim_num_(dim_num)
     , owns_buff_(owns_buff)
-    , type_(type) {
+    , type_(type)
+    , zstd_dictionary_(nullptr) {
 }
 
 Tile::Tile(
@@ -79,7 +81,8 @@ Tile::Tile(
     , compressor_(compressor)
     , compression_level_(compression_level)
     , dim_num_(dim_num)
-    , type_(type) {
+    , type_(type)
+    , zstd_dictionary_(nullptr) {
   buffer_ = new Buffer();
   buffer_->realloc(tile_size);
   owns_buff_ = true;
@@ -93,7 +96,8 @@ Tile::Tile(
     : cell_size_(cell_size)
     , compressor_(compressor)
     , dim_num_(dim_num)
-    , type_(type) {
+    , type_(type)
+    , zstd_dictionary_(nullptr) {
   buffer_ = new Buffer();
   compression_level_ = -1;
   owns_buff_ = true;
@@ -140,6 +144,14 @@ unsigned int Tile::dim_num() const {
   return dim_num_;
 }
 
+bool Tile::filtered() const {
+  return compressor_ != Compressor::NO_COMPRESSION || !filters_.empty();
+}
+
+const FilterPipeline& Tile::filters() const {
+  return filters_;
+}
+
 bool Tile::empty() const {
   return buffer_->size() == 0;
 }
@@ -154,6 +166,12 @@ uint64_t Tile::offset() const {
 }
 
 Status Tile::realloc(uint64_t nbytes) {
+  // Replace a view with an owned buffer
+  if (owns_buff_ && !buffer_->owns_data()) {
+    delete buffer_;
+    buffer_ = new Buffer();
+  }
+
   return buffer_->realloc(nbytes);
 }
 
@@ -171,6 +189,10 @@ void Tile::reset_size() {
   buffer_->reset_size();
 }
 
+void Tile::set_filters(const FilterPipeline& filters) {
+  filters_ = filters;
+}
+
 void Tile::set_offset(uint64_t offset) {
   buffer_->set_offset(offset);
 }
@@ -179,6 +201,17 @@ void Tile::set_size(uint64_t size) {
   buffer_->set_size(size);
 }
 
+void Tile::set_view(void* data, uint64_t size) {
+  if (owns_buff_)
+    delete buffer_;
+  buffer_ = new Buffer(data, size, false);
+  owns_buff_ = true;
+}
+
+void Tile::set_zstd_dictionary(const ZStdDictionary* zstd_dictionary) {
+  zstd_dictionary_ = zstd_dictionary;
+}
+
 uint64_t Tile::size() const {
   return buffer_->size();
 }
@@ -218,6 +251,10 @@ Datatype Tile::type() const {
   return type_;
 }
 
+const ZStdDictionary* Tile::zstd_dictionary() const {
+  return zstd_dictionary_;
+}
+
 Status Tile::write(ConstBuffer* buf) {
   buffer_->write(buf);
 
@@ -0,0 +1,216 @@
+/**
+ * @file   tile_cache.cc
+ * @file   buffer.h
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * This file implements class TileCache.
+ */
+
+#include "tile_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+namespace tiledb {
+
+/* ****************************** */
+/*   CONSTRUCTORS & DESTRUCTORS   */
+/* ****************************** */
+
+TileCache::TileCache(uint64_t max_size, unsigned shard_num) {
+  if (shard_num == 0)
+    shard_num = 1;
+  shard_max_size_ = max_size / shard_num;
+  for (unsigned i = 0; i < shard_num; ++i) {
+    shards_.emplace_back(new Shard());
+    shards_.back()->size_ = 0;
+  }
+}
+
+TileCache::~TileCache() {
+  for (auto shard : shards_) {
+    for (auto tile : shard->lru_)
+      free_tile(tile);
+    delete shard;
+  }
+}
+
+/* ****************************** */
+/*               API              */
+/* ****************************** */
+
+bool TileCache::contains(
+    const URI& fragment_uri, unsigned int attribute_id, uint64_t tile_i) {
+  std::string k = key(fragment_uri, attribute_id, tile_i);
+  auto shard = this->shard(k);
+
+  std::lock_guard<std::mutex> lock(shard->mtx_);
+  return shard->index_.find(k) != shard->index_.end();
+}
+
+void TileCache::evict(const URI& uri) {
+  std::string prefix = uri.to_string();
+  size_t n = prefix.size();
+  for (auto shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mtx_);
+    for (auto it = shard->lru_.begin(); it != shard->lru_.end();) {
+      auto next = std::next(it);
+      const std::string& k = (*it)->key_;
+      if (k.size() > n && k.compare(0, n, prefix) == 0 &&
+          (k[n] == '|' || k[n] == '/'))
+        remove(shard, it);
+      it = next;
+    }
+  }
+}
+
+const CachedTile* TileCache::get(
+    const URI& fragment_uri, unsigned int attribute_id, uint64_t tile_i) {
+  std::string k = key(fragment_uri, attribute_id, tile_i);
+  auto shard = this->shard(k);
+
+  std::lock_guard<std::mutex> lock(shard->mtx_);
+  auto it = shard->index_.find(k);
+  if (it == shard->index_.end())
+    return nullptr;
+
+  // Move to the front of the LRU list
+  shard->lru_.splice(shard->lru_.begin(), shard->lru_, it->second);
+  CachedTile* tile = *(it->second);
+  ++tile->pins_;
+
+  return tile;
+}
+
+void TileCache::insert(
+    const URI& fragment_uri,
+    unsigned int attribute_id,
+    uint64_t tile_i,
+    const Tile* tile,
+    const Tile* tile_var) {
+  uint64_t size = tile->size();
+  uint64_t var_size = (tile_var != nullptr) ? tile_var->size() : 0;
+  if (size + var_size > shard_max_size_ || size == 0)
+    return;
+
+  std::string k = key(fragment_uri, attribute_id, tile_i);
+  auto shard = this->shard(k);
+  {
+    std::lock_guard<std::mutex> lock(shard->mtx_);
+    if (shard->index_.find(k) != shard->index_.end())
+      return;
+  }
+
+  // Copy the tile outside the lock
+  auto cached = new CachedTile();
+  cached->data_ = std::malloc(size);
+  cached->size_ = size;
+  cached->var_data_ = (var_size != 0) ? std::malloc(var_size) : nullptr;
+  cached->var_size_ = var_size;
+  cached->key_ = k;
+  cached->pins_ = 0;
+  cached->evicted_ = false;
+  if (cached->data_ == nullptr ||
+      (var_size != 0 && cached->var_data_ == nullptr)) {
+    free_tile(cached);
+    return;
+  }
+  std::memcpy(cached->data_, tile->data(), size);
+  if (var_size != 0)
+    std::memcpy(cached->var_data_, tile_var->data(), var_size);
+
+  std::lock_guard<std::mutex> lock(shard->mtx_);
+  if (shard->index_.find(k) != shard->index_.end()) {
+    free_tile(cached);
+    return;
+  }
+
+  // Evict the least recently used tiles
+  while (!shard->lru_.empty() &&
+         shard->size_ + size + var_size > shard_max_size_)
+    remove(shard, std::prev(shard->lru_.end()));
+
+  shard->lru_.push_front(cached);
+  shard->index_[k] = shard->lru_.begin();
+  shard->size_ += size + var_size;
+}
+
+void TileCache::release(const CachedTile* tile) {
+  if (tile == nullptr)
+    return;
+
+  auto cached = const_cast<CachedTile*>(tile);
+  auto shard = this->shard(cached->key_);
+  std::lock_guard<std::mutex> lock(shard->mtx_);
+  if (--cached->pins_ == 0 && cached->evicted_)
+    free_tile(cached);
+}
+
+uint64_t TileCache::size() {
+  uint64_t size = 0;
+  for (auto shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mtx_);
+    size += shard->size_;
+  }
+  return size;
+}
+
+/* ****************************** */
+/*         PRIVATE METHODS        */
+/* ****************************** */
+
+void TileCache::free_tile(CachedTile* tile) {
+  std::free(tile->data_);
+  std::free(tile->var_data_);
+  delete tile;
+}
+
+std::string TileCache::key(
+    const URI& fragment_uri, unsigned int attribute_id, uint64_t tile_i) {
+  return fragment_uri.to_string() + "|" + std::to_string(attribute_id) + "|" +
+         std::to_string(tile_i);
+}
+
+void TileCache::remove(Shard* shard, std::list<CachedTile*>::iterator it) {
+  CachedTile* tile = *it;
+  shard->size_ -= tile->size_ + tile->var_size_;
+  shard->index_.erase(tile->key_);
+  shard->lru_.erase(it);
+
+  if (tile->pins_ == 0)
+    free_tile(tile);
+  else
+    tile->evicted_ = true;
+}
+
+TileCache::Shard* TileCache::shard(const std::string& key) const {
+  return shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+
+}  // namespace tiledb
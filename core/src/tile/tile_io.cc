@@ -34,12 +34,17 @@
 #include "blosc_compressor.h"
 #include "bzip_compressor.h"
 #include "dd_compressor.h"
+#include "gorilla_compressor.h"
 #include "gzip_compressor.h"
 #include "logger.h"
 #include "lz4_compressor.h"
 #include "rle_compressor.h"
+#include "utils.h"
 #include "zstd_compressor.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <iostream>
 
 /* ****************************** */
@@ -56,45 +61,105 @@ namespace tiledb {
 
 TileIO::TileIO(StorageManager* storage_manager, const URI& uri)
     : uri_(uri)
+    , chunk_size_(constants::tile_chunk_size)
+    , map_data_(nullptr)
+    , map_failed_(false)
+    , map_size_(0)
     , storage_manager_(storage_manager) {
   buffer_ = new Buffer();
 }
 
 TileIO::~TileIO() {
   delete buffer_;
+  discard_prefetched();
+  if (map_data_ != nullptr)
+    storage_manager_->unmap_file(uri_, map_data_, map_size_);
 }
 
 /* ****************************** */
 /*               API              */
 /* ****************************** */
 
+Status TileIO::close() {
+  return storage_manager_->close_file(uri_);
+}
+
+void TileIO::coalesce(
+    const std::map<uint64_t, uint64_t>& ranges,
+    uint64_t max_gap,
+    uint64_t max_size,
+    std::vector<CoalescedRead>* reads) {
+  reads->clear();
+  for (auto& range : ranges) {
+    uint64_t range_end = range.first + range.second;
+    if (!reads->empty()) {
+      auto& read = reads->back();
+      uint64_t read_end = read.offset_ + read.nbytes_;
+      if (range.first <= read_end + max_gap &&
+          range_end - read.offset_ <= max_size) {
+        if (range_end > read_end)
+          read.nbytes_ = range_end - read.offset_;
+        ++read.range_num_;
+        continue;
+      }
+    }
+    CoalescedRead read = {range.first, range.second, 1};
+    reads->push_back(read);
+  }
+}
+
+void TileIO::discard_prefetched() {
+  pending_.clear();
+  for (auto& p : prefetched_)
+    release_chunk(p.second.chunk_);
+  prefetched_.clear();
+}
+
+void TileIO::discard_prefetched(uint64_t file_offset) {
+  pending_.erase(file_offset);
+  auto it = prefetched_.find(file_offset);
+  if (it == prefetched_.end())
+    return;
+  release_chunk(it->second.chunk_);
+  prefetched_.erase(it);
+}
+
 Status TileIO::file_size(uint64_t* size) const {
   return storage_manager_->file_size(uri_, size);
 }
 
+Status TileIO::prefetch(
+    Tile* tile, uint64_t file_offset, uint64_t compressed_size) {
+  if (compressed_size == 0)
+    return Status::Ok();
+  const Config::SMParams& params = storage_manager_->config().sm_params_;
+  if (!tile->filtered() && params.tile_io_mmap_ && map_file().ok())
+    return Status::Ok();
+  if (prefetched_.find(file_offset) == prefetched_.end())
+    pending_[file_offset] = compressed_size;
+
+  return Status::Ok();
+}
+
+uint64_t TileIO::prefetched_num() const {
+  return pending_.size() + prefetched_.size();
+}
+
 Status TileIO::read(
     Tile* tile,
     uint64_t file_offset,
     uint64_t compressed_size,
     uint64_t tile_size) {
-  // No compression
-  if (tile->compressor() == Compressor::NO_COMPRESSION)
-    return storage_manager_->read_from_file(
-        uri_, file_offset, tile->buffer(), tile_size);
-
-  // Compression
-  RETURN_NOT_OK(storage_manager_->read_from_file(
-      uri_, file_offset, buffer_, compressed_size));
-
-  // Decompress tile
-  tile->reset_offset();
-  tile->reset_size();
-  buffer_->reset_offset();
-  RETURN_NOT_OK(tile->realloc(tile_size));
-  RETURN_NOT_OK(decompress_tile(tile));
-  tile->reset_offset();
+  return read_tile(tile, file_offset, compressed_size, tile_size, nullptr);
+}
 
-  return Status::Ok();
+Status TileIO::read_into(
+    Tile* tile,
+    uint64_t file_offset,
+    uint64_t compressed_size,
+    uint64_t tile_size,
+    void* buffer) {
+  return read_tile(tile, file_offset, compressed_size, tile_size, buffer);
 }
 
 Status TileIO::read_generic(Tile** tile, uint64_t file_offset) {
@@ -125,47 +190,89 @@ Status TileIO::read_generic_tile_header(
   int compression_level;
 
   // Read header from file
-  auto header_buff = new Buffer();
-  RETURN_NOT_OK_ELSE(
-      storage_manager_->read_from_file(
-          uri_, file_offset, header_buff, *header_size),
-      delete header_buff);
+  Buffer header_buff;
+  RETURN_NOT_OK(storage_manager_->read_from_file(
+      uri_, file_offset, &header_buff, *header_size));
 
   // Read header individual values
-  RETURN_NOT_OK_ELSE(
-      header_buff->read(compressed_size, sizeof(uint64_t)), delete header_buff);
-  RETURN_NOT_OK_ELSE(
-      header_buff->read(tile_size, sizeof(uint64_t)), delete header_buff);
-  RETURN_NOT_OK_ELSE(
-      header_buff->read(&datatype, sizeof(char)), delete header_buff);
-  RETURN_NOT_OK_ELSE(
-      header_buff->read(&cell_size, sizeof(uint64_t)), delete header_buff);
-  RETURN_NOT_OK_ELSE(
-      header_buff->read(&compressor, sizeof(char)), delete header_buff);
-  RETURN_NOT_OK_ELSE(
-      header_buff->read(&compression_level, sizeof(int)), delete header_buff);
-
-  delete header_buff;
+  RETURN_NOT_OK(header_buff.read(compressed_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(header_buff.read(tile_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(header_buff.read(&datatype, sizeof(char)));
+  RETURN_NOT_OK(header_buff.read(&cell_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(header_buff.read(&compressor, sizeof(char)));
+  RETURN_NOT_OK(header_buff.read(&compression_level, sizeof(int)));
 
   *tile = new Tile((Datatype)datatype, (Compressor)compressor, cell_size, 0);
 
   return Status::Ok();
 }
 
+Status TileIO::serialize_generic(Tile* tile, Buffer* buff) {
+  // Reset the tile and buffer offset
+  tile->reset_offset();
+  buffer_->reset_size();
+  buffer_->reset_offset();
+
+  // Filter and compress tile
+  if (tile->filtered())
+    RETURN_NOT_OK(compress_tile(tile));
+
+  auto buffer = tile->filtered() ? buffer_ : tile->buffer();
+
+  RETURN_NOT_OK(serialize_generic_tile_header(tile, buffer->size(), buff));
+  return buff->write(buffer->data(), buffer->size());
+}
+
+void TileIO::set_chunk_size(uint64_t chunk_size) {
+  chunk_size_ = chunk_size;
+}
+
+Status TileIO::submit_prefetch(IOBatch* batch) {
+  if (pending_.empty())
+    return Status::Ok();
+
+  // Coalesce nearby tiles into larger reads
+  const Config::SMParams& params = storage_manager_->config().sm_params_;
+  std::vector<CoalescedRead> reads;
+  coalesce(
+      pending_,
+      params.tile_io_coalesce_gap_,
+      params.tile_io_coalesce_max_size_,
+      &reads);
+
+  Status st;
+  auto range_it = pending_.begin();
+  for (auto& read : reads) {
+    auto chunk = new Chunk();
+    chunk->buffer_ = new Buffer();
+    chunk->file_offset_ = read.offset_;
+    chunk->refs_ = read.range_num_;
+    for (uint64_t i = 0; i < read.range_num_; ++i, ++range_it) {
+      PrefetchedTile prefetched_tile = {chunk, range_it->second};
+      prefetched_[range_it->first] = prefetched_tile;
+    }
+    st = storage_manager_->read_async(
+        uri_, read.offset_, chunk->buffer_, read.nbytes_, batch);
+    if (!st.ok())
+      break;
+  }
+  pending_.clear();
+
+  return st;
+}
+
 Status TileIO::write(Tile* tile, uint64_t* bytes_written) {
   // Reset the tile and buffer offset
   tile->reset_offset();
   buffer_->reset_size();
   buffer_->reset_offset();
 
-  // Compress tile
-  Compressor compressor = tile->compressor();
-  if (compressor != Compressor::NO_COMPRESSION)
+  // Filter and compress tile
+  if (tile->filtered())
     RETURN_NOT_OK(compress_tile(tile));
 
   // Prepare to write
-  auto buffer =
-      (compressor == Compressor::NO_COMPRESSION) ? tile->buffer() : buffer_;
+  auto buffer = tile->filtered() ? buffer_ : tile->buffer();
   *bytes_written = buffer->size();
 
   RETURN_NOT_OK(storage_manager_->write_to_file(uri_, buffer));
@@ -179,13 +286,11 @@ Status TileIO::write_generic(Tile* tile) {
   buffer_->reset_size();
   buffer_->reset_offset();
 
-  // Compress tile
-  Compressor compressor = tile->compressor();
-  if (compressor != Compressor::NO_COMPRESSION)
+  // Filter and compress tile
+  if (tile->filtered())
     RETURN_NOT_OK(compress_tile(tile));
 
-  auto buffer =
-      (compressor == Compressor::NO_COMPRESSION) ? tile->buffer() : buffer_;
+  auto buffer = tile->filtered() ? buffer_ : tile->buffer();
 
   RETURN_NOT_OK(write_generic_tile_header(tile, buffer->size()));
   RETURN_NOT_OK(storage_manager_->write_to_file(uri_, buffer));
@@ -194,35 +299,27 @@ Status TileIO::write_generic(Tile* tile) {
 }
 
 Status TileIO::write_generic_tile_header(Tile* tile, uint64_t compressed_size) {
-  // Initializations
-  uint64_t tile_size = tile->size();
-  auto datatype = (char)tile->type();
-  uint64_t cell_size = tile->cell_size();
-  auto compressor = (char)tile->compressor();
-  int compression_level = tile->compression_level();
-
   // Write to buffer
-  auto buff = new Buffer();
-  RETURN_NOT_OK_ELSE(
-      buff->write(&compressed_size, sizeof(uint64_t)), delete buff);
-  RETURN_NOT_OK_ELSE(buff->write(&tile_size, sizeof(uint64_t)), delete buff);
-  RETURN_NOT_OK_ELSE(buff->write(&datatype, sizeof(char)), delete buff);
-  RETURN_NOT_OK_ELSE(buff->write(&cell_size, sizeof(uint64_t)), delete buff);
-  RETURN_NOT_OK_ELSE(buff->write(&compressor, sizeof(char)), delete buff);
-  RETURN_NOT_OK_ELSE(buff->write(&compression_level, sizeof(int)), delete buff);
+  Buffer buff;
+  RETURN_NOT_OK(serialize_generic_tile_header(tile, compressed_size, &buff));
 
   // Write to file
-  Status st = storage_manager_->write_to_file(uri_, buff);
-
-  delete buff;
-
-  return st;
+  return storage_manager_->write_to_file(uri_, &buff);
 }
 
 /* ****************************** */
 /*          PRIVATE METHODS       */
 /* ****************************** */
 
+Status TileIO::alloc_tile(Tile* tile, uint64_t tile_size, void* buffer) {
+  if (buffer == nullptr)
+    return tile->realloc(tile_size);
+
+  tile->set_view(buffer, tile_size);
+  tile->reset_size();
+  return Status::Ok();
+}
+
 Status TileIO::compress_tile(Tile* tile) {
   // Simple case - No coordinates
   if (!tile->stores_coords())
@@ -246,6 +343,8 @@ Status TileIO::compress_tile(Tile* tile) {
         dim_num,
         buff,
         false);
+    dim_tile->set_filters(tile->filters());
+    dim_tile->set_zstd_dictionary(tile->zstd_dictionary());
     st = compress_one_tile(dim_tile);
     delete buff;
     delete dim_tile;
@@ -256,105 +355,159 @@ Status TileIO::compress_tile(Tile* tile) {
   return Status::Ok();
 }
 
-Status TileIO::compress_one_tile(Tile* tile) {
+Status TileIO::compress_chunk(
+    Tile* tile, const void* data, uint64_t nbytes, Buffer* output) const {
   // For easy reference
   auto level = tile->compression_level();
   auto type_size = datatype_size(tile->type());
   auto compressor = tile->compressor();
   auto type = tile->type();
   auto cell_size = tile->cell_size();
-  auto tile_size = tile->size();
-
-  // Compute necessary info for chunking
-  uint64_t chunk_num, max_chunk_size, overhead;
-  RETURN_NOT_OK(
-      compute_chunking_info(tile, &chunk_num, &max_chunk_size, &overhead));
-
-  // Properly reallocate buffer
-  RETURN_NOT_OK(buffer_->realloc(buffer_->size() + tile_size + overhead));
+  const FilterPipeline& filters = tile->filters();
+
+  // Run the filters first, into a pooled scratch buffer
+  BufferPool* pool = storage_manager_->buffer_pool();
+  Buffer* filtered = nullptr;
+  if (!filters.empty()) {
+    filtered = pool->acquire();
+    ConstBuffer unfiltered(data, nbytes);
+    RETURN_NOT_OK_ELSE(
+        filters.run_forward(type, &unfiltered, filtered),
+        pool->release(filtered));
+    data = filtered->data();
+    nbytes = filtered->size();
+  }
 
-  // Write number of chunks
-  RETURN_NOT_OK(buffer_->write(&chunk_num, sizeof(uint64_t)));
+  // Create const buffer
+  ConstBuffer input(data, nbytes);
+  auto input_buffer = &input;
 
-  // Compress in chunks
+  // Invoke the proper compressor
   Status st;
-  uint64_t compressed_chunk_size = 0;
-  uint64_t buffer_offset;
-  uint64_t left_to_compress = tile_size;
-  for (uint64_t i = 0; i < chunk_num; ++i) {
-    // Write chunk info
-    auto chunk_size = MIN(left_to_compress, max_chunk_size);
-
-    RETURN_NOT_OK(buffer_->write(&chunk_size, sizeof(uint64_t)));
-    buffer_offset = buffer_->offset();  // Will be used later
-    RETURN_NOT_OK(buffer_->write(&compressed_chunk_size, sizeof(uint64_t)));
-
-    // Create const buffer
-    auto input_buffer = new ConstBuffer(tile->cur_data(), chunk_size);
-
-    // Invoke the proper compressor
-    switch (compressor) {
-      case Compressor::GZIP:
-        st = GZip::compress(level, input_buffer, buffer_);
-        break;
-      case Compressor::ZSTD:
-        st = ZStd::compress(level, input_buffer, buffer_);
-        break;
-      case Compressor::LZ4:
-        st = LZ4::compress(level, input_buffer, buffer_);
-        break;
-      case Compressor::BLOSC:
-        st =
-            Blosc::compress("blosclz", type_size, level, input_buffer, buffer_);
-        break;
+  switch (compressor) {
+    case Compressor::NO_COMPRESSION:
+      st = output->write(input_buffer, nbytes);
+      break;
+    case Compressor::GZIP:
+      st = GZip::compress(level, input_buffer, output);
+      break;
+    case Compressor::ZSTD:
+      st = ZStd::compress(
+          level, input_buffer, output, tile->zstd_dictionary());
+      break;
+    case Compressor::LZ4:
+      st = LZ4::compress(level, input_buffer, output);
+      break;
+    case Compressor::BLOSC:
+      st = Blosc::compress("blosclz", type_size, level, input_buffer, output);
+      break;
 #undef BLOSC_LZ4
-      case Compressor::BLOSC_LZ4:
-        st = Blosc::compress("lz4", type_size, level, input_buffer, buffer_);
-        break;
+    case Compressor::BLOSC_LZ4:
+      st = Blosc::compress("lz4", type_size, level, input_buffer, output);
+      break;
 #undef BLOSC_LZ4HC
-      case Compressor::BLOSC_LZ4HC:
-        st = Blosc::compress("lz4hc", type_size, level, input_buffer, buffer_);
-        break;
+    case Compressor::BLOSC_LZ4HC:
+      st = Blosc::compress("lz4hc", type_size, level, input_buffer, output);
+      break;
 #undef BLOSC_SNAPPY
-      case Compressor::BLOSC_SNAPPY:
-        st = Blosc::compress("snappy", type_size, level, input_buffer, buffer_);
-        break;
+    case Compressor::BLOSC_SNAPPY:
+      st = Blosc::compress("snappy", type_size, level, input_buffer, output);
+      break;
 #undef BLOSC_ZLIB
-      case Compressor::BLOSC_ZLIB:
-        st = Blosc::compress("zlib", type_size, level, input_buffer, buffer_);
-        break;
+    case Compressor::BLOSC_ZLIB:
+      st = Blosc::compress("zlib", type_size, level, input_buffer, output);
+      break;
 #undef BLOSC_ZSTD
-      case Compressor::BLOSC_ZSTD:
-        st = Blosc::compress("zstd", type_size, level, input_buffer, buffer_);
-        break;
-      case Compressor::RLE:
-        st = RLE::compress(cell_size, input_buffer, buffer_);
-        break;
-      case Compressor::BZIP2:
-        st = BZip::compress(level, input_buffer, buffer_);
-        break;
-      case Compressor::DOUBLE_DELTA:
-        st = DoubleDelta::compress(type, input_buffer, buffer_);
-        break;
-      default:
-        assert(0);
-    }
+    case Compressor::BLOSC_ZSTD:
+      st = Blosc::compress("zstd", type_size, level, input_buffer, output);
+      break;
+    case Compressor::RLE:
+      st = RLE::compress(cell_size, input_buffer, output);
+      break;
+    case Compressor::BZIP2:
+      st = BZip::compress(level, input_buffer, output);
+      break;
+    case Compressor::DOUBLE_DELTA:
+      st = DoubleDelta::compress(type, input_buffer, output);
+      break;
+    case Compressor::GORILLA:
+      st = Gorilla::compress(type, input_buffer, output);
+      break;
+  }
 
-    delete input_buffer;
-    RETURN_NOT_OK(st);
+  pool->release(filtered);
+
+  return st;
+}
+
+Status TileIO::compress_one_tile(Tile* tile) {
+  // For easy reference
+  auto tile_size = tile->size();
+  auto data = (const char*)tile->cur_data();
+
+  // Compute necessary info for chunking
+  uint64_t chunk_num, max_chunk_size, overhead;
+  RETURN_NOT_OK(
+      compute_chunking_info(tile, &chunk_num, &max_chunk_size, &overhead));
 
-    // Write compressed chunk size
+  // Compress a single chunk in place
+  if (chunk_num == 1) {
+    RETURN_NOT_OK(buffer_->realloc(buffer_->size() + tile_size + overhead));
+    RETURN_NOT_OK(buffer_->write(&chunk_num, sizeof(uint64_t)));
+    RETURN_NOT_OK(buffer_->write(&tile_size, sizeof(uint64_t)));
+    uint64_t buffer_offset = buffer_->offset();
+    uint64_t compressed_chunk_size = 0;
+    RETURN_NOT_OK(buffer_->write(&compressed_chunk_size, sizeof(uint64_t)));
+    RETURN_NOT_OK(compress_chunk(tile, data, tile_size, buffer_));
     compressed_chunk_size =
         buffer_->size() - (buffer_offset + sizeof(uint64_t));
     std::memcpy(
         buffer_->data(buffer_offset), &compressed_chunk_size, sizeof(uint64_t));
+    tile->advance_offset(tile_size);
+    return Status::Ok();
+  }
 
-    // Update
-    left_to_compress -= chunk_size;
-    tile->advance_offset(chunk_size);
+  // Compress the chunks in parallel, each into its own pooled buffer
+  BufferPool* pool = storage_manager_->buffer_pool();
+  std::vector<Buffer*> chunks(chunk_num, nullptr);
+  const Config::SMParams& params = storage_manager_->config().sm_params_;
+  uint64_t thread_num = (tile_size < params.tile_chunk_parallel_min_size_) ?
+                            1 :
+                            params.tile_chunk_threads_;
+  Status st = utils::parallel_for(chunk_num, thread_num, [&](uint64_t i) {
+    uint64_t offset = i * max_chunk_size;
+    uint64_t chunk_size = MIN(tile_size - offset, max_chunk_size);
+    chunks[i] = pool->acquire();
+    RETURN_NOT_OK(
+        chunks[i]->realloc(chunk_size + this->overhead(tile, chunk_size)));
+    return compress_chunk(tile, data + offset, chunk_size, chunks[i]);
+  });
+
+  // Stitch the chunks into the chunked layout: the number of chunks,
+  // followed by the original size, the compressed size and the compressed
+  // data of each chunk
+  uint64_t total_size = sizeof(uint64_t);
+  for (auto chunk : chunks)
+    total_size += 2 * sizeof(uint64_t) + (chunk ? chunk->size() : 0);
+  if (st.ok())
+    st = buffer_->realloc(buffer_->size() + total_size);
+  if (st.ok())
+    st = buffer_->write(&chunk_num, sizeof(uint64_t));
+  for (uint64_t i = 0; i < chunk_num && st.ok(); ++i) {
+    uint64_t chunk_size = MIN(tile_size - i * max_chunk_size, max_chunk_size);
+    uint64_t compressed_chunk_size = chunks[i]->size();
+    st = buffer_->write(&chunk_size, sizeof(uint64_t));
+    if (st.ok())
+      st = buffer_->write(&compressed_chunk_size, sizeof(uint64_t));
+    if (st.ok())
+      st = buffer_->write(chunks[i]->data(), compressed_chunk_size);
   }
 
-  assert(left_to_compress == 0);
+  for (auto chunk : chunks)
+    pool->release(chunk);
+  RETURN_NOT_OK(st);
+
+  tile->advance_offset(tile_size);
 
   return Status::Ok();
 }
@@ -368,23 +521,26 @@ Status TileIO::compute_chunking_info(
   auto cell_size = tile->cell_size();
   auto tile_size = tile->size();
 
-  // Compute max chunk size
-  *max_chunk_size = MIN(constants::tile_chunk_size, tile_size);
-  *max_chunk_size = *max_chunk_size / cell_size * cell_size;
+  // Compute max chunk size, in whole cells
+  *max_chunk_size = MIN(chunk_size_, tile_size);
+  *max_chunk_size =
+      std::max<uint64_t>(*max_chunk_size / cell_size, 1) * cell_size;
   uint64_t chunk_overhead = this->overhead(tile, *max_chunk_size);
 
-  // Adjust max chunk size
-  if (*max_chunk_size + chunk_overhead > constants::tile_chunk_size) {
-    *max_chunk_size -= chunk_overhead;
+  // The compressors take int sizes, so a compressed chunk must fit in one
+  if (*max_chunk_size + chunk_overhead > INT_MAX) {
+    *max_chunk_size = uint64_t(
+        double(INT_MAX) * (*max_chunk_size) /
+        (*max_chunk_size + chunk_overhead));
     *max_chunk_size = (*max_chunk_size) / cell_size * cell_size;
     chunk_overhead = this->overhead(tile, *max_chunk_size);
   }
 
   // Handle special error
-  if (*max_chunk_size + chunk_overhead > constants::tile_chunk_size) {
+  if (*max_chunk_size == 0 || *max_chunk_size + chunk_overhead > INT_MAX) {
     return LOG_STATUS(
         Status::TileIOError("Compute chunking info failed; Consider adjusting "
-                            "constants::tile_chunk_size"));
+                            "the chunk size"));
   }
 
   // Compute number of chunks
@@ -395,102 +551,160 @@ Status TileIO::compute_chunking_info(
   // values per chunk that store the original and compressed chunk size,
   // plus a single value in the beginning for the total number of chunks.
   *overhead =
-      (*chunk_num) * chunk_overhead * 2 * sizeof(uint64_t) + sizeof(uint64_t);
-
-  return Status::Ok();
-}
-
-Status TileIO::decompress_tile(Tile* tile) {
-  // Simple case - No coordinates
-  if (!tile->stores_coords())
-    return decompress_one_tile(tile);
-
-  // Decompress each dimension tile
-  auto dim_num = tile->dim_num();
-  for (unsigned int i = 0; i < dim_num; ++i)
-    RETURN_NOT_OK(decompress_one_tile(tile));
-
-  // Zip coordinates
-  tile->zip_coordinates();
+      (*chunk_num) * (chunk_overhead + 2 * sizeof(uint64_t)) + sizeof(uint64_t);
 
   return Status::Ok();
 }
 
-Status TileIO::decompress_one_tile(Tile* tile) {
-  // Read number of chunks
-  uint64_t chunk_num;
-
-  RETURN_NOT_OK(buffer_->read(&chunk_num, sizeof(uint64_t)));
-  assert(chunk_num > 0);
+Status TileIO::decompress_chunk(
+    Tile* tile, const CompressedChunk& chunk) const {
+  // Filtered chunks are decompressed into a scratch buffer first, and the
+  // filters are then reversed into the tile
+  const FilterPipeline& filters = tile->filters();
+  BufferPool* pool = storage_manager_->buffer_pool();
+  Buffer* decompressed = nullptr;
+  if (!filters.empty()) {
+    decompressed = pool->acquire();
+    RETURN_NOT_OK_ELSE(
+        decompressed->realloc(chunk.size_ + filters.overhead(chunk.size_)),
+        pool->release(decompressed));
+  }
 
+  // The chunk is decompressed in place, in a view of its part of the tile
+  ConstBuffer input(
+      (char*)buffer_->data() + chunk.input_offset_, chunk.compressed_size_);
+  Buffer output((char*)tile->data() + chunk.output_offset_, chunk.size_, false);
+  auto input_buffer = &input;
+  auto output_buffer = &output;
+  output_buffer->reset_size();
+  if (decompressed == nullptr)
+    decompressed = output_buffer;
+
+  // Invoke the proper decompressor
   Status st;
   Datatype type = tile->type();
-  for (uint64_t i = 0; i < chunk_num; ++i) {
-    // Read original and compressed chunk size
-    uint64_t chunk_size, compressed_chunk_size;
-    RETURN_NOT_OK(buffer_->read(&chunk_size, sizeof(uint64_t)));
-    RETURN_NOT_OK(buffer_->read(&compressed_chunk_size, sizeof(uint64_t)));
-
-    auto input_buffer =
-        new ConstBuffer(buffer_->cur_data(), compressed_chunk_size);
-
-    // Invoke the proper decompressor
-    switch (tile->compressor()) {
-      case Compressor::NO_COMPRESSION:
-        assert(0);
-        break;
-      case Compressor::GZIP:
-        st = GZip::decompress(input_buffer, tile->buffer());
-        break;
-      case Compressor::ZSTD:
-        st = ZStd::decompress(input_buffer, tile->buffer());
-        break;
-      case Compressor::LZ4:
-        st = LZ4::decompress(input_buffer, tile->buffer());
-        break;
-      case Compressor::BLOSC:
+  switch (tile->compressor()) {
+    case Compressor::NO_COMPRESSION:
+      st = decompressed->write(input_buffer, chunk.compressed_size_);
+      break;
+    case Compressor::GZIP:
+      st = GZip::decompress(input_buffer, decompressed);
+      break;
+    case Compressor::ZSTD:
+      st = ZStd::decompress(
+          input_buffer, decompressed, tile->zstd_dictionary());
+      break;
+    case Compressor::LZ4:
+      st = LZ4::decompress(input_buffer, decompressed);
+      break;
+    case Compressor::BLOSC:
 #undef BLOSC_LZ4
-      case Compressor::BLOSC_LZ4:
+    case Compressor::BLOSC_LZ4:
 #undef BLOSC_LZ4HC
-      case Compressor::BLOSC_LZ4HC:
+    case Compressor::BLOSC_LZ4HC:
 #undef BLOSC_SNAPPY
-      case Compressor::BLOSC_SNAPPY:
+    case Compressor::BLOSC_SNAPPY:
 #undef BLOSC_ZLIB
-      case Compressor::BLOSC_ZLIB:
+    case Compressor::BLOSC_ZLIB:
 #undef BLOSC_ZSTD
-      case Compressor::BLOSC_ZSTD:
-        st = Blosc::decompress(input_buffer, tile->buffer());
-        break;
-      case Compressor::RLE:
-        st = RLE::decompress(tile->cell_size(), input_buffer, tile->buffer());
-        break;
-      case Compressor::BZIP2:
-        st = BZip::decompress(input_buffer, tile->buffer());
-        break;
-      case Compressor::DOUBLE_DELTA:
-        st = DoubleDelta::decompress(type, input_buffer, tile->buffer());
-        break;
+    case Compressor::BLOSC_ZSTD:
+      st = Blosc::decompress(input_buffer, decompressed);
+      break;
+    case Compressor::RLE:
+      st = RLE::decompress(tile->cell_size(), input_buffer, decompressed);
+      break;
+    case Compressor::BZIP2:
+      st = BZip::decompress(input_buffer, decompressed);
+      break;
+    case Compressor::DOUBLE_DELTA:
+      st = DoubleDelta::decompress(type, input_buffer, decompressed);
+      break;
+    case Compressor::GORILLA:
+      st = Gorilla::decompress(type, input_buffer, decompressed);
+      break;
+  }
+
+  // Reverse the filters
+  if (decompressed != output_buffer) {
+    if (st.ok()) {
+      ConstBuffer filtered(decompressed);
+      st = filters.run_reverse(type, &filtered, output_buffer);
     }
+    pool->release(decompressed);
+  }
 
-    delete input_buffer;
-    RETURN_NOT_OK(st);
+  if (st.ok() && output_buffer->size() != chunk.size_)
+    st = LOG_STATUS(Status::TileIOError(
+        "Cannot decompress tile; Chunk size mismatch"));
 
-    buffer_->advance_offset(compressed_chunk_size);
-  }
+  return st;
+}
 
+Status TileIO::decompress_tile(Tile* tile) {
+  // Locate the chunks of each dimension tile (or of the single tile)
+  unsigned int tile_num = tile->stores_coords() ? tile->dim_num() : 1;
+  uint64_t tile_size = 0;
+  std::vector<CompressedChunk> chunks;
+  for (unsigned int i = 0; i < tile_num; ++i)
+    RETURN_NOT_OK(read_chunk_headers(&tile_size, &chunks));
+  if (tile_size > tile->buffer()->alloced_size())
+    return LOG_STATUS(Status::TileIOError(
+        "Cannot decompress tile; Decompressed size exceeds tile size"));
+
+  // Decompress all chunks in parallel, straight into the tile
+  const Config::SMParams& params = storage_manager_->config().sm_params_;
+  uint64_t thread_num = (tile_size < params.tile_chunk_parallel_min_size_) ?
+                            1 :
+                            params.tile_chunk_threads_;
+  RETURN_NOT_OK(utils::parallel_for(
+      chunks.size(), thread_num, [&](uint64_t i) {
+        return decompress_chunk(tile, chunks[i]);
+      }));
+  tile->set_size(tile_size);
+  tile->set_offset(tile_size);
+
+  // Zip coordinates
+  if (tile->stores_coords())
+    tile->zip_coordinates();
+
+  return Status::Ok();
+}
+
+Status TileIO::map_file() {
+  if (map_data_ != nullptr)
+    return Status::Ok();
+  if (map_failed_)
+    return Status::TileIOError("Cannot map file; Mapping previously failed");
+
+  Status st = storage_manager_->map_file(uri_, &map_data_, &map_size_);
+  if (!st.ok()) {
+    map_data_ = nullptr;
+    map_failed_ = true;
+  }
   return st;
 }
 
+void TileIO::release_chunk(Chunk* chunk) {
+  if (--chunk->refs_ > 0)
+    return;
+  delete chunk->buffer_;
+  delete chunk;
+}
+
 uint64_t TileIO::overhead(Tile* tile, uint64_t nbytes) const {
+  // The compressor takes the (possibly larger) filtered data
+  uint64_t filter_overhead = tile->filters().overhead(nbytes);
+  nbytes += filter_overhead;
+
   switch (tile->compressor()) {
     case Compressor::NO_COMPRESSION:
-      return 0;
+      return filter_overhead;
     case Compressor::GZIP:
-      return GZip::overhead(nbytes);
+      return filter_overhead + GZip::overhead(nbytes);
     case Compressor::ZSTD:
-      return ZStd::overhead(nbytes);
+      return filter_overhead + ZStd::overhead(nbytes);
     case Compressor::LZ4:
-      return LZ4::overhead(nbytes);
+      return filter_overhead + LZ4::overhead(nbytes);
     case Compressor::BLOSC:
 #undef BLOSC_LZ4
     case Compressor::BLOSC_LZ4:
@@ -502,14 +716,135 @@ uint64_t TileIO::overhead(Tile* tile, uint64_t nbytes) const {
     case Compressor::BLOSC_ZLIB:
 #undef BLOSC_ZSTD
     case Compressor::BLOSC_ZSTD:
-      return Blosc::overhead(nbytes);
+      return filter_overhead + Blosc::overhead(nbytes);
     case Compressor::RLE:
-      return RLE::overhead(nbytes, tile->cell_size());
+      return filter_overhead + RLE::overhead(nbytes, tile->cell_size());
     case Compressor::BZIP2:
-      return BZip::overhead(nbytes);
+      return filter_overhead + BZip::overhead(nbytes);
     case Compressor::DOUBLE_DELTA:
-      return DoubleDelta::overhead(nbytes);
+      return filter_overhead + DoubleDelta::overhead(nbytes);
+    case Compressor::GORILLA:
+      return filter_overhead + Gorilla::overhead(nbytes);
+  }
+}
+
+Status TileIO::read_chunk_headers(
+    uint64_t* output_offset, std::vector<CompressedChunk>* chunks) {
+  // Read number of chunks
+  uint64_t chunk_num;
+  RETURN_NOT_OK(buffer_->read(&chunk_num, sizeof(uint64_t)));
+  assert(chunk_num > 0);
+
+  // Read original and compressed size of each chunk
+  for (uint64_t i = 0; i < chunk_num; ++i) {
+    CompressedChunk chunk;
+    RETURN_NOT_OK(buffer_->read(&chunk.size_, sizeof(uint64_t)));
+    RETURN_NOT_OK(buffer_->read(&chunk.compressed_size_, sizeof(uint64_t)));
+    chunk.input_offset_ = buffer_->offset();
+    chunk.output_offset_ = *output_offset;
+    if (chunk.input_offset_ + chunk.compressed_size_ > buffer_->size())
+      return LOG_STATUS(Status::TileIOError(
+          "Cannot decompress tile; Chunk exceeds compressed tile"));
+    chunks->push_back(chunk);
+    buffer_->advance_offset(chunk.compressed_size_);
+    *output_offset += chunk.size_;
+  }
+
+  return Status::Ok();
+}
+
+Status TileIO::read_tile(
+    Tile* tile,
+    uint64_t file_offset,
+    uint64_t compressed_size,
+    uint64_t tile_size,
+    void* buffer) {
+  // Locate the tile data if fetched ahead
+  Chunk* chunk = nullptr;
+  void* prefetched = nullptr;
+  auto it = prefetched_.find(file_offset);
+  if (it != prefetched_.end()) {
+    if (it->second.size_ == compressed_size) {
+      chunk = it->second.chunk_;
+      prefetched =
+          (char*)chunk->buffer_->data() + (file_offset - chunk->file_offset_);
+    } else {
+      release_chunk(it->second.chunk_);
+    }
+    prefetched_.erase(it);
+  }
+
+  // No compression or filters
+  if (!tile->filtered()) {
+    // Zero-copy view into the mapped file
+    if (prefetched == nullptr && buffer == nullptr &&
+        storage_manager_->config().sm_params_.tile_io_mmap_ &&
+        map_file().ok() && file_offset + tile_size <= map_size_) {
+      tile->set_view((char*)map_data_ + file_offset, tile_size);
+      return Status::Ok();
+    }
+
+    if (prefetched == nullptr) {
+      RETURN_NOT_OK(alloc_tile(tile, tile_size, buffer));
+      return storage_manager_->read_from_file(
+          uri_, file_offset, tile->buffer(), tile_size);
+    }
+    Status st = alloc_tile(tile, tile_size, buffer);
+    if (st.ok()) {
+      std::memcpy(tile->data(), prefetched, tile_size);
+      tile->set_size(tile_size);
+      tile->reset_offset();
+    }
+    release_chunk(chunk);
+    return st;
+  }
+
+  // Compression - prefetched data are decompressed in place
+  Buffer* scratch = nullptr;
+  if (prefetched == nullptr) {
+    RETURN_NOT_OK(storage_manager_->read_from_file(
+        uri_, file_offset, buffer_, compressed_size));
+  } else {
+    scratch = buffer_;
+    buffer_ = new Buffer(prefetched, compressed_size, false);
+  }
+
+  // Decompress tile
+  tile->reset_offset();
+  tile->reset_size();
+  buffer_->reset_offset();
+  Status st = alloc_tile(tile, tile_size, buffer);
+  if (st.ok())
+    st = decompress_tile(tile);
+  tile->reset_offset();
+
+  if (scratch != nullptr) {
+    delete buffer_;
+    buffer_ = scratch;
+    release_chunk(chunk);
   }
+
+  return st;
+}
+
+Status TileIO::serialize_generic_tile_header(
+    Tile* tile, uint64_t compressed_size, Buffer* buff) const {
+  // Initializations
+  uint64_t tile_size = tile->size();
+  auto datatype = (char)tile->type();
+  uint64_t cell_size = tile->cell_size();
+  auto compressor = (char)tile->compressor();
+  int compression_level = tile->compression_level();
+
+  // Write to buffer
+  RETURN_NOT_OK(buff->write(&compressed_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->write(&tile_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->write(&datatype, sizeof(char)));
+  RETURN_NOT_OK(buff->write(&cell_size, sizeof(uint64_t)));
+  RETURN_NOT_OK(buff->write(&compressor, sizeof(char)));
+  RETURN_NOT_OK(buff->write(&compression_level, sizeof(int)));
+
+  return Status::Ok();
 }
 
 }  // namespace tiledb
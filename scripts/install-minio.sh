@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Installs MinIO and starts a local S3-compatible server for the S3 tests
+# (test/src/s3-unit-filesystem.cc, built with -DUSE_S3=ON).
+
+function install_minio {
+  sudo mkdir -p /usr/local/minio
+  sudo chown -R $(whoami) /usr/local/minio
+  curl -L https://dl.min.io/server/minio/release/linux-amd64/minio \
+    -o /usr/local/minio/minio
+  chmod +x /usr/local/minio/minio
+}
+
+function run_minio {
+  mkdir -p /tmp/minio-data
+  MINIO_ROOT_USER=minioadmin MINIO_ROOT_PASSWORD=minioadmin \
+    /usr/local/minio/minio server --address localhost:9999 /tmp/minio-data &
+}
+
+install_minio
+run_minio
+
+export AWS_ACCESS_KEY_ID=minioadmin
+export AWS_SECRET_ACCESS_KEY=minioadmin
@@ -0,0 +1,233 @@
+/**
+ * @file   s3-unit-filesystem.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the S3 filesystem backend, run against a local S3-compatible
+ * store (see scripts/install-minio.sh).
+ */
+
+#include "catch.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "s3_filesystem.h"
+
+using namespace tiledb;
+
+struct S3Fx {
+  const std::string BUCKET = "s3://tiledb-test-bucket";
+
+  S3 s3_;
+
+  S3Fx()
+      : s3_(s3_params()) {
+    setenv("AWS_ACCESS_KEY_ID", "minioadmin", 0);
+    setenv("AWS_SECRET_ACCESS_KEY", "minioadmin", 0);
+    REQUIRE(s3_.connect().ok());
+
+    if (s3_.is_bucket(URI(BUCKET)))
+      REQUIRE(s3_.remove_path(URI(BUCKET)).ok());
+    REQUIRE(s3_.create_bucket(URI(BUCKET)).ok());
+  }
+
+  ~S3Fx() {
+    CHECK(s3_.remove_path(URI(BUCKET)).ok());
+  }
+
+  /**
+   * Returns the parameters of the local test server, with parts of the
+   * minimum size uploaded two at a time.
+   */
+  static Config::S3Params s3_params() {
+    Config::S3Params params;
+    params.endpoint_override_ = "localhost:9999";
+    params.max_parallel_ops_ = 2;
+    params.multipart_part_size_ = 5 * 1024 * 1024;
+    params.scheme_ = "http";
+    return params;
+  }
+};
+
+TEST_CASE_METHOD(S3Fx, "Test S3 filesystem", "[s3]") {
+  URI dir(BUCKET + "/tiledb_test_dir");
+  URI file(BUCKET + "/tiledb_test_dir/tiledb_test_file");
+  const char data[] = "abcdefghijklmnopqrstuvwxyz";
+
+  // Directories exist once objects are written under them
+  CHECK(s3_.create_dir(dir).ok());
+  CHECK(!s3_.is_dir(dir));
+  CHECK(s3_.create_file(URI(BUCKET + "/tiledb_test_dir/empty")).ok());
+  CHECK(s3_.is_dir(dir));
+  CHECK(!s3_.create_dir(dir).ok());
+
+  // Objects become visible when flushed, and cannot be appended to then
+  CHECK(s3_.write_to_file(file, data, 10).ok());
+  CHECK(s3_.write_to_file(file, data + 10, 16).ok());
+  CHECK(!s3_.is_file(file));
+  CHECK(s3_.flush(dir).ok());
+  CHECK(s3_.is_file(file));
+  CHECK(!s3_.is_dir(file));
+  CHECK(!s3_.write_to_file(file, data, 1).ok());
+  uint64_t nbytes = 0;
+  CHECK(s3_.file_size(file, &nbytes).ok());
+  CHECK(nbytes == 26);
+
+  // Ranged reads
+  char buff[26];
+  CHECK(s3_.read_from_file(file, 11, buff, 5).ok());
+  CHECK(!std::memcmp(buff, data + 11, 5));
+  CHECK(!s3_.read_from_file(file, 20, buff, 10).ok());
+
+  // Listing returns objects and directories, sorted
+  CHECK(s3_.write_to_file(URI(BUCKET + "/tiledb_test_dir/a/b"), data, 1).ok());
+  CHECK(s3_.flush(URI(BUCKET + "/tiledb_test_dir/a/b")).ok());
+  std::vector<std::string> paths;
+  CHECK(s3_.ls(dir, &paths).ok());
+  REQUIRE(paths.size() == 3);
+  CHECK(paths[0] == BUCKET + "/tiledb_test_dir/a");
+  CHECK(paths[1] == BUCKET + "/tiledb_test_dir/empty");
+  CHECK(paths[2] == BUCKET + "/tiledb_test_dir/tiledb_test_file");
+
+  // Moving a directory moves all objects under it
+  URI new_dir(BUCKET + "/tiledb_test_dir2");
+  CHECK(s3_.move_path(dir, new_dir).ok());
+  CHECK(!s3_.is_dir(dir));
+  CHECK(s3_.is_file(URI(BUCKET + "/tiledb_test_dir2/a/b")));
+  CHECK(s3_.file_size(URI(BUCKET + "/tiledb_test_dir2/tiledb_test_file"), &nbytes)
+            .ok());
+  CHECK(nbytes == 26);
+
+  CHECK(s3_.remove_file(URI(BUCKET + "/tiledb_test_dir2/empty")).ok());
+  CHECK(!s3_.remove_file(URI(BUCKET + "/tiledb_test_dir2/empty")).ok());
+  CHECK(!s3_.remove_path(URI(BUCKET + "/tiledb_test_dir2/i_dont_exist")).ok());
+  CHECK(s3_.remove_path(new_dir).ok());
+  CHECK(!s3_.is_dir(new_dir));
+}
+
+TEST_CASE_METHOD(S3Fx, "Test S3 multipart upload", "[s3]") {
+  URI file(BUCKET + "/tiledb_test_file");
+
+  // Two parts are uploaded along the way, the rest when flushed
+  uint64_t chunk_size = 1024 * 1024;
+  uint64_t chunk_num = 12;
+  std::vector<char> chunk(chunk_size);
+  for (uint64_t i = 0; i < chunk_num; ++i) {
+    std::memset(&chunk[0], 'a' + (int)i, chunk_size);
+    CHECK(s3_.write_to_file(file, &chunk[0], chunk_size).ok());
+  }
+  CHECK(!s3_.is_file(file));
+  CHECK(s3_.flush(file).ok());
+  uint64_t nbytes = 0;
+  CHECK(s3_.file_size(file, &nbytes).ok());
+  CHECK(nbytes == chunk_size * chunk_num);
+
+  // Read the last byte of every chunk in parallel
+  std::vector<char> buff(chunk_num);
+  CHECK(s3_.parallel(chunk_num, [&](uint64_t i) {
+              return s3_.read_from_file(
+                  file, (i + 1) * chunk_size - 1, &buff[i], 1);
+            }).ok());
+  bool allok = true;
+  for (uint64_t i = 0; i < chunk_num; ++i)
+    allok &= (buff[i] == 'a' + (int)i);
+  CHECK(allok);
+}
+
+TEST_CASE_METHOD(S3Fx, "Test concurrent S3 uploads", "[s3]") {
+  std::string dir = BUCKET + "/tiledb_test_dir";
+  const int thread_num = 4;
+  const int write_num = 100;
+  char data[10];
+  std::memset(data, 'a', sizeof(data));
+
+  // Writers append to their own objects while other uploads are flushed
+  // and discarded
+  std::vector<std::thread> threads;
+  std::vector<int> failed(thread_num, 0);
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t]() {
+      URI file(dir + "/w/" + std::to_string(t));
+      for (int i = 0; i < write_num; ++i)
+        failed[t] += !s3_.write_to_file(file, data, sizeof(data)).ok();
+    });
+  }
+  for (int i = 0; i < write_num; ++i) {
+    URI file(dir + "/f/" + std::to_string(i));
+    CHECK(s3_.write_to_file(file, data, sizeof(data)).ok());
+    if (i % 2 == 0) {
+      // The object was never flushed, so only its upload is removed
+      CHECK(!s3_.remove_file(file).ok());
+      CHECK(!s3_.is_file(file));
+    } else {
+      CHECK(s3_.flush(URI(dir + "/f")).ok());
+      CHECK(s3_.is_file(file));
+    }
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  CHECK(s3_.flush(URI(dir)).ok());
+  for (int t = 0; t < thread_num; ++t) {
+    CHECK(failed[t] == 0);
+    uint64_t nbytes = 0;
+    CHECK(
+        s3_.file_size(URI(dir + "/w/" + std::to_string(t)), &nbytes).ok());
+    CHECK(nbytes == write_num * sizeof(data));
+  }
+}
+
+TEST_CASE_METHOD(S3Fx, "Test moving S3 objects without replacing", "[s3]") {
+  URI a(BUCKET + "/tiledb_test_dir/a");
+  URI b(BUCKET + "/tiledb_test_dir/b");
+  URI c(BUCKET + "/tiledb_test_dir/c");
+  char data[] = "abcdefghij";
+  CHECK(s3_.write_to_file(a, data, 10).ok());
+  CHECK(s3_.write_to_file(b, data, 5).ok());
+  CHECK(s3_.flush(URI(BUCKET + "/tiledb_test_dir")).ok());
+
+  // An existing object is not replaced
+  bool moved = true;
+  CHECK(s3_.move_file_no_replace(a, b, &moved).ok());
+  CHECK(!moved);
+  uint64_t nbytes = 0;
+  CHECK(s3_.file_size(a, &nbytes).ok());
+  CHECK(nbytes == 10);
+  CHECK(s3_.file_size(b, &nbytes).ok());
+  CHECK(nbytes == 5);
+
+  // The object is copied within the store and then removed
+  CHECK(s3_.move_file_no_replace(a, c, &moved).ok());
+  CHECK(moved);
+  CHECK(!s3_.is_file(a));
+  char buff[10];
+  CHECK(s3_.read_from_file(c, 0, buff, 10).ok());
+  CHECK(std::memcmp(buff, data, 10) == 0);
+}
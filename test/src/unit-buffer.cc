@@ -1,5 +1,6 @@
 #include <buffer.h>
 #include <catch.hpp>
+#include <cstring>
 
 using namespace tiledb;
 
@@ -41,3 +42,30 @@ TEST_CASE("Buffer: Test default constructor with write void*", "[buffer]") {
 
   delete buff;
 }
+
+TEST_CASE("Buffer: Test reserving and committing in place", "[buffer]") {
+  // Reserving reallocates only if needed
+  Buffer buff;
+  REQUIRE(buff.write("ab", 2).ok());
+  REQUIRE(buff.reserve(3).ok());
+  CHECK(buff.alloced_size() == 5);
+  CHECK(buff.size() == 2);
+  REQUIRE(buff.reserve(2).ok());
+  CHECK(buff.alloced_size() == 5);
+
+  // Committing appends the bytes written in place
+  auto data = (char*)buff.cur_data();
+  data[0] = 'c';
+  data[1] = 'd';
+  buff.commit(2);
+  CHECK(buff.offset() == 4);
+  CHECK(buff.size() == 4);
+  CHECK(std::memcmp(buff.data(), "abcd", 4) == 0);
+
+  // Views cannot grow past their capacity
+  char view_data[4];
+  Buffer view(view_data, sizeof(view_data), false);
+  view.reset_size();
+  CHECK(view.reserve(4).ok());
+  CHECK(!view.reserve(5).ok());
+}
@@ -0,0 +1,118 @@
+/**
+ * @file   unit-buffer_pool.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the scratch buffer pool.
+ */
+
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "catch.hpp"
+#include "constants.h"
+
+using namespace tiledb;
+
+TEST_CASE("BufferPool: Test reuse of released buffers", "[buffer_pool]") {
+  BufferPool pool(
+      constants::buffer_pool_max_num, constants::buffer_pool_max_size);
+  CHECK(pool.pooled_num() == 0);
+
+  Buffer* buff = pool.acquire();
+  REQUIRE(buff != nullptr);
+  CHECK(buff->size() == 0);
+  REQUIRE(buff->realloc(1024).ok());
+  int value = 5;
+  REQUIRE(buff->write(&value, sizeof(int)).ok());
+  void* data = buff->data();
+
+  // Released buffers keep their memory, but are handed out empty
+  pool.release(buff);
+  CHECK(pool.pooled_num() == 1);
+  Buffer* again = pool.acquire();
+  CHECK(again == buff);
+  CHECK(again->data() == data);
+  CHECK(again->size() == 0);
+  CHECK(again->offset() == 0);
+  CHECK(again->alloced_size() == 1024);
+  CHECK(pool.pooled_num() == 0);
+  pool.release(again);
+
+  // Releasing nullptr is a no-op
+  pool.release(nullptr);
+  CHECK(pool.pooled_num() == 1);
+}
+
+TEST_CASE("BufferPool: Test pool limits", "[buffer_pool]") {
+  uint64_t max_num = 4, max_size = 1024;
+  BufferPool pool(max_num, max_size);
+
+  // Oversized buffers are freed
+  Buffer* big = pool.acquire();
+  REQUIRE(big->realloc(max_size + 1).ok());
+  pool.release(big);
+  CHECK(pool.pooled_num() == 0);
+
+  // Views are never pooled
+  char data[8];
+  pool.release(new Buffer(data, sizeof(data), false));
+  CHECK(pool.pooled_num() == 0);
+
+  // At most max_num buffers are kept
+  std::vector<Buffer*> buffers;
+  for (uint64_t i = 0; i < max_num + 2; ++i)
+    buffers.push_back(pool.acquire());
+  for (auto buff : buffers)
+    pool.release(buff);
+  CHECK(pool.pooled_num() == max_num);
+}
+
+TEST_CASE("BufferPool: Test concurrent use", "[buffer_pool]") {
+  BufferPool pool(
+      constants::buffer_pool_max_num, constants::buffer_pool_max_size);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, t]() {
+      for (int i = 0; i < 100; ++i) {
+        Buffer* buff = pool.acquire();
+        int value = t * 100 + i;
+        if (buff->write(&value, sizeof(int)).ok() &&
+            buff->value<int>(0) == value)
+          pool.release(buff);
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  // Every buffer was handed back, and at most one per thread is in use at
+  // any time
+  CHECK(pool.pooled_num() >= 1);
+  CHECK(pool.pooled_num() <= 4);
+}
@@ -37,6 +37,7 @@
 #include <cstring>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "catch.hpp"
 #include "posix_filesystem.h"
@@ -425,3 +426,126 @@ TEST_CASE_METHOD(
   rc = tiledb_array_metadata_free(ctx_, array_metadata);
   REQUIRE(rc == TILEDB_OK);
 }
+
+TEST_CASE_METHOD(
+    ArraySchemaFx, "C API: Test attribute filters", "[metadata]") {
+  int rc;
+
+  // Create array metadata
+  rc = tiledb_array_metadata_create(ctx_, &array_metadata_, ARRAY_PATH.c_str());
+  REQUIRE(rc == TILEDB_OK);
+  tiledb_domain_t* domain;
+  rc = tiledb_domain_create(ctx_, &domain, DIM_TYPE);
+  REQUIRE(rc == TILEDB_OK);
+  int64_t dim_domain[] = {1, 1000};
+  int64_t tile_extent = 100;
+  rc = tiledb_domain_add_dimension(
+      ctx_, domain, DIM1_NAME, &dim_domain[0], &tile_extent);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_array_metadata_set_domain(ctx_, array_metadata_, domain);
+  REQUIRE(rc == TILEDB_OK);
+
+  // Set attribute with filters
+  tiledb_attribute_t* attr;
+  rc = tiledb_attribute_create(ctx_, &attr, ATTR_NAME, ATTR_TYPE);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_attribute_add_filter(ctx_, attr, TILEDB_DELTA);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_attribute_add_filter(ctx_, attr, TILEDB_BIT_WIDTH_REDUCTION);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_attribute_set_compressor(ctx_, attr, TILEDB_RLE, -1);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_array_metadata_add_attribute(ctx_, array_metadata_, attr);
+  REQUIRE(rc == TILEDB_OK);
+
+  // Bit width reduction cannot be followed by RLE
+  rc = tiledb_array_metadata_check(ctx_, array_metadata_);
+  CHECK(rc != TILEDB_OK);
+  tiledb_array_metadata_free(ctx_, array_metadata_);
+  rc = tiledb_array_metadata_create(ctx_, &array_metadata_, ARRAY_PATH.c_str());
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_array_metadata_set_domain(ctx_, array_metadata_, domain);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_attribute_set_compressor(ctx_, attr, TILEDB_ZSTD, -1);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_array_metadata_add_attribute(ctx_, array_metadata_, attr);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_array_create(ctx_, array_metadata_);
+  REQUIRE(rc == TILEDB_OK);
+  tiledb_attribute_free(ctx_, attr);
+  tiledb_domain_free(ctx_, domain);
+
+  // Check the loaded filters
+  tiledb_array_metadata_t* array_metadata;
+  rc = tiledb_array_metadata_load(ctx_, &array_metadata, ARRAY_PATH.c_str());
+  REQUIRE(rc == TILEDB_OK);
+  tiledb_attribute_iter_t* attr_it;
+  rc = tiledb_attribute_iter_create(ctx_, array_metadata, &attr_it);
+  REQUIRE(rc == TILEDB_OK);
+  const tiledb_attribute_t* loaded_attr;
+  rc = tiledb_attribute_iter_here(ctx_, attr_it, &loaded_attr);
+  REQUIRE(rc == TILEDB_OK);
+  unsigned int filter_num;
+  rc = tiledb_attribute_get_filter_num(ctx_, loaded_attr, &filter_num);
+  REQUIRE(rc == TILEDB_OK);
+  CHECK(filter_num == 2);
+  tiledb_filter_type_t filter;
+  rc = tiledb_attribute_get_filter(ctx_, loaded_attr, 0, &filter);
+  REQUIRE(rc == TILEDB_OK);
+  CHECK(filter == TILEDB_DELTA);
+  rc = tiledb_attribute_get_filter(ctx_, loaded_attr, 1, &filter);
+  REQUIRE(rc == TILEDB_OK);
+  CHECK(filter == TILEDB_BIT_WIDTH_REDUCTION);
+  rc = tiledb_attribute_get_filter(ctx_, loaded_attr, 2, &filter);
+  CHECK(rc != TILEDB_OK);
+  tiledb_attribute_iter_free(ctx_, attr_it);
+  tiledb_array_metadata_free(ctx_, array_metadata);
+
+  // Write and read back the array
+  const uint64_t cell_num = 1000;
+  std::vector<int> data(cell_num);
+  for (uint64_t i = 0; i < cell_num; ++i)
+    data[i] = 5000 + (int)(i * 3 % 17);
+  const char* attributes[] = {ATTR_NAME};
+  void* write_buffers[] = {&data[0]};
+  uint64_t write_buffer_sizes[] = {cell_num * sizeof(int)};
+  tiledb_query_t* query;
+  rc = tiledb_query_create(
+      ctx_,
+      &query,
+      ARRAY_PATH.c_str(),
+      TILEDB_WRITE,
+      TILEDB_GLOBAL_ORDER,
+      nullptr,
+      attributes,
+      1,
+      write_buffers,
+      write_buffer_sizes);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_query_submit(ctx_, query);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_query_free(ctx_, query);
+  REQUIRE(rc == TILEDB_OK);
+
+  std::vector<int> result(cell_num);
+  void* read_buffers[] = {&result[0]};
+  uint64_t read_buffer_sizes[] = {cell_num * sizeof(int)};
+  rc = tiledb_query_create(
+      ctx_,
+      &query,
+      ARRAY_PATH.c_str(),
+      TILEDB_READ,
+      TILEDB_GLOBAL_ORDER,
+      dim_domain,
+      attributes,
+      1,
+      read_buffers,
+      read_buffer_sizes);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_query_submit(ctx_, query);
+  REQUIRE(rc == TILEDB_OK);
+  rc = tiledb_query_free(ctx_, query);
+  REQUIRE(rc == TILEDB_OK);
+  CHECK(read_buffer_sizes[0] == cell_num * sizeof(int));
+  CHECK(result == data);
+}
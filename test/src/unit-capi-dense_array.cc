@@ -36,6 +36,7 @@
 #include "tiledb.h"
 
 #include <sys/time.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <ctime>
@@ -247,6 +248,19 @@ struct DenseArrayFx {
     REQUIRE(rc == TILEDB_OK);
   }
 
+  /** Returns the paths of the fragment directories of the current array. */
+  std::vector<std::string> fragment_dirs() {
+    std::vector<std::string> paths, dirs;
+    std::string array_dir = array_name_.substr(URI_PREFIX.size());
+    REQUIRE(tiledb::posix::ls(array_dir, &paths).ok());
+    for (auto& path : paths) {
+      if (tiledb::posix::is_dir(path) &&
+          path.compare(path.rfind('/') + 1, 2, "__") == 0)
+        dirs.push_back(path);
+    }
+    return dirs;
+  }
+
   /**
    * Generates a 1D buffer containing the cell values of a 2D array.
    * Each cell value equals (row index * total number of columns + col index).
@@ -876,3 +890,190 @@ TEST_CASE_METHOD(DenseArrayFx, "C API: Test random dense updates", "[dense]") {
   delete[] buffer_a1;
   delete[] buffer_coords;
 }
+
+/**
+ * Tests that the fragments whose non-empty domain does not overlap the
+ * subarray of a read are never loaded. A fragment whose metadata cannot be
+ * loaded is used to tell whether it was.
+ */
+TEST_CASE_METHOD(
+    DenseArrayFx, "C API: Test pruning fragments by subarray", "[dense]") {
+  int64_t domain_size_0 = 100;
+  int64_t domain_size_1 = 100;
+  set_array_name("dense_pruning");
+  create_dense_array_2D(
+      10,
+      10,
+      0,
+      domain_size_0 - 1,
+      0,
+      domain_size_1 - 1,
+      1000,
+      TILEDB_ROW_MAJOR,
+      TILEDB_ROW_MAJOR);
+
+  // Two fragments with disjoint domains, rows [0,9] and rows [10,19]
+  std::vector<std::string> fragments;
+  for (int64_t row = 0; row < 20; row += 10) {
+    int64_t subarray[] = {row, row + 9, 0, domain_size_1 - 1};
+    auto buffer = generate_1D_int_buffer(10, domain_size_1);
+    for (int64_t i = 0; i < 10 * domain_size_1; ++i)
+      buffer[i] += (int)(row * domain_size_1);
+    uint64_t buffer_sizes[] = {10 * domain_size_1 * sizeof(int)};
+    int rc = write_dense_subarray_2D(
+        subarray, TILEDB_WRITE, TILEDB_ROW_MAJOR, buffer, buffer_sizes);
+    REQUIRE(rc == TILEDB_OK);
+    delete[] buffer;
+
+    for (auto& dir : fragment_dirs()) {
+      if (std::find(fragments.begin(), fragments.end(), dir) ==
+          fragments.end())
+        fragments.push_back(dir);
+    }
+  }
+  REQUIRE(fragments.size() == 2);
+  std::string metadata_file = fragments[1] + "/__fragment_metadata.tdb";
+  std::string domain_file = fragments[1] + "/__non_empty_domain.tdb";
+
+  // Reads rows [row_lo, row_hi] with a new context, so that no fragment
+  // metadata are retained from previous reads. Returns false if the read
+  // fails.
+  auto read_rows = [&](int64_t row_lo, int64_t row_hi) {
+    tiledb_ctx_free(ctx_);
+    REQUIRE(tiledb_ctx_create(&ctx_) == TILEDB_OK);
+    int* buffer = read_dense_array_2D(
+        row_lo,
+        row_hi,
+        0,
+        domain_size_1 - 1,
+        TILEDB_READ,
+        TILEDB_ROW_MAJOR);
+    if (buffer == nullptr)
+      return false;
+    bool allok = true;
+    int64_t index = 0;
+    for (int64_t r = row_lo; r <= row_hi; ++r)
+      for (int64_t c = 0; c < domain_size_1; ++c)
+        allok = allok && (buffer[index++] == r * domain_size_1 + c);
+    CHECK(allok);
+    delete[] buffer;
+    return true;
+  };
+
+  SECTION("- disjoint fragment is not loaded") {
+    // The second fragment can no longer be loaded
+    std::string cmd = ": > " + metadata_file;
+    REQUIRE(system(cmd.c_str()) == 0);
+
+    // Its domain starts right after the subarray, so it is pruned
+    CHECK(read_rows(0, 9));
+    CHECK(read_rows(2, 5));
+
+    // Subarrays touching its first row need it
+    CHECK(!read_rows(9, 10));
+    CHECK(!read_rows(10, 10));
+  }
+
+  SECTION("- fragment without a domain file") {
+    // Fragments written before domain files existed are always loaded
+    std::string cmd = "rm -f " + domain_file;
+    REQUIRE(system(cmd.c_str()) == 0);
+    CHECK(read_rows(0, 9));
+    CHECK(read_rows(5, 14));
+    CHECK(read_rows(10, 19));
+
+    cmd = ": > " + metadata_file;
+    REQUIRE(system(cmd.c_str()) == 0);
+    CHECK(!read_rows(0, 9));
+  }
+}
+
+TEST_CASE_METHOD(
+    DenseArrayFx,
+    "C API: Test reading whole tiles through different buffers",
+    "[dense]") {
+  // Two 10x10 tiles side by side
+  int64_t domain_size_0 = 10;
+  int64_t domain_size_1 = 20;
+  set_array_name("dense_whole_tiles");
+  create_dense_array_2D(
+      10,
+      10,
+      0,
+      domain_size_0 - 1,
+      0,
+      domain_size_1 - 1,
+      100,
+      TILEDB_ROW_MAJOR,
+      TILEDB_ROW_MAJOR);
+  int64_t subarray[] = {0, domain_size_0 - 1, 0, domain_size_1 - 1};
+  auto buffer = generate_1D_int_buffer(domain_size_0, domain_size_1);
+  uint64_t write_sizes[] = {domain_size_0 * domain_size_1 * sizeof(int)};
+  REQUIRE(
+      write_dense_subarray_2D(
+          subarray, TILEDB_WRITE, TILEDB_ROW_MAJOR, buffer, write_sizes) ==
+      TILEDB_OK);
+  delete[] buffer;
+
+  // Checks that a buffer holds the first rows of a tile in global order
+  auto check_tile = [&](const int* buffer, int64_t tile, int64_t row_num) {
+    bool allok = true;
+    for (int64_t r = 0; r < row_num; ++r)
+      for (int64_t c = 0; c < 10; ++c)
+        allok = allok &&
+                (buffer[r * 10 + c] == r * domain_size_1 + tile * 10 + c);
+    CHECK(allok);
+  };
+
+  // Each buffer holds a single tile, so every submit reads a whole tile
+  // straight into a different buffer
+  const char* attributes[] = {ATTR_NAME};
+  auto buffer_1 = new int[100];
+  void* buffers[] = {buffer_1};
+  uint64_t buffer_sizes[] = {100 * sizeof(int)};
+  tiledb_query_t* query;
+  REQUIRE(
+      tiledb_query_create(
+          ctx_,
+          &query,
+          array_name_.c_str(),
+          TILEDB_READ,
+          TILEDB_GLOBAL_ORDER,
+          subarray,
+          attributes,
+          1,
+          buffers,
+          buffer_sizes) == TILEDB_OK);
+  REQUIRE(tiledb_query_submit(ctx_, query) == TILEDB_OK);
+  tiledb_query_status_t status;
+  REQUIRE(
+      tiledb_query_get_attribute_status(ctx_, query, ATTR_NAME, &status) ==
+      TILEDB_OK);
+  CHECK(status == TILEDB_INCOMPLETE);
+  CHECK(buffer_sizes[0] == 100 * sizeof(int));
+  check_tile(buffer_1, 0, 10);
+
+  // The first tile is not copied again, nor read from the freed buffer
+  delete[] buffer_1;
+  auto buffer_2 = new int[100];
+  buffers[0] = buffer_2;
+  buffer_sizes[0] = 100 * sizeof(int);
+  REQUIRE(
+      tiledb_query_reset_buffers(ctx_, query, buffers, buffer_sizes) ==
+      TILEDB_OK);
+  REQUIRE(tiledb_query_submit(ctx_, query) == TILEDB_OK);
+  REQUIRE(
+      tiledb_query_get_attribute_status(ctx_, query, ATTR_NAME, &status) ==
+      TILEDB_OK);
+  CHECK(status == TILEDB_COMPLETED);
+  CHECK(buffer_sizes[0] == 100 * sizeof(int));
+  check_tile(buffer_2, 1, 10);
+  REQUIRE(tiledb_query_free(ctx_, query) == TILEDB_OK);
+
+  // A partial read of the first tile does not see the freed buffer either
+  int* rows = read_dense_array_2D(0, 4, 0, 9, TILEDB_READ, TILEDB_ROW_MAJOR);
+  REQUIRE(rows != nullptr);
+  check_tile(rows, 0, 5);
+  delete[] rows;
+  delete[] buffer_2;
+}
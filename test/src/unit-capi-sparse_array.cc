@@ -42,6 +42,7 @@
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <vector>
 
 struct SparseArrayFx {
   // Constant parameters
@@ -195,6 +196,19 @@ struct SparseArrayFx {
     REQUIRE(rc == TILEDB_OK);
   }
 
+  /** Returns the paths of the fragment directories of the current array. */
+  std::vector<std::string> fragment_dirs() {
+    std::vector<std::string> paths, dirs;
+    std::string array_dir = array_name_.substr(URI_PREFIX.size());
+    REQUIRE(tiledb::posix::ls(array_dir, &paths).ok());
+    for (auto& path : paths) {
+      if (tiledb::posix::is_dir(path) &&
+          path.compare(path.rfind('/') + 1, 2, "__") == 0)
+        dirs.push_back(path);
+    }
+    return dirs;
+  }
+
   /**
    * Reads a subarray oriented by the input boundaries and outputs the buffer
    * containing the attribute values of the corresponding cells.
@@ -610,3 +624,116 @@ TEST_CASE_METHOD(
     CHECK(test_random_subarrays(domain_size_0, domain_size_1, ntests));
   }
 }
+
+TEST_CASE_METHOD(
+    SparseArrayFx,
+    "C API: Test consolidated fragment metadata",
+    "[sparse][consolidated-metadata]") {
+  // Parameters used in this test
+  int64_t domain_size_0 = 100;
+  int64_t domain_size_1 = 100;
+  std::string array_dir = TEMP_DIR + GROUP + "sparse_consolidated_metadata";
+  set_array_name("sparse_consolidated_metadata");
+  create_sparse_array_2D(
+      10,
+      10,
+      0,
+      domain_size_0 - 1,
+      0,
+      domain_size_1 - 1,
+      100,
+      TILEDB_NO_COMPRESSION,
+      TILEDB_ROW_MAJOR,
+      TILEDB_ROW_MAJOR);
+
+  // Pack the metadata of two fragments, and then write a newer fragment
+  // that is not in the consolidated file
+  REQUIRE(
+      write_sparse_array_unsorted_2D(domain_size_0, domain_size_1) ==
+      TILEDB_OK);
+  REQUIRE(
+      write_sparse_array_unsorted_2D(domain_size_0, domain_size_1) ==
+      TILEDB_OK);
+  int rc = tiledb_array_consolidate_metadata(ctx_, array_name_.c_str());
+  REQUIRE(rc == TILEDB_OK);
+  std::string cmd = "test -f " + array_dir +
+                    "/__consolidated_fragment_metadata_1.tdb";
+  CHECK(system(cmd.c_str()) == 0);
+  REQUIRE(
+      write_sparse_array_unsorted_2D(domain_size_0, domain_size_1) ==
+      TILEDB_OK);
+
+  // A new context opens the array cold, loading the metadata of the first
+  // two fragments from the consolidated file and of the last one from its
+  // own file
+  for (int i = 0; i < 2; ++i) {
+    tiledb_ctx_free(ctx_);
+    REQUIRE(tiledb_ctx_create(&ctx_) == TILEDB_OK);
+    int* buffer = read_sparse_array_2D(
+        10, 19, 20, 39, TILEDB_READ, TILEDB_ROW_MAJOR);
+    REQUIRE(buffer != nullptr);
+    int64_t index = 0;
+    bool allok = true;
+    for (int64_t r = 10; r <= 19; ++r)
+      for (int64_t c = 20; c <= 39; ++c)
+        allok = allok && (buffer[index++] == r * domain_size_1 + c);
+    CHECK(allok);
+    delete[] buffer;
+
+    // The next generation replaces the previous one
+    rc = tiledb_array_consolidate_metadata(ctx_, array_name_.c_str());
+    REQUIRE(rc == TILEDB_OK);
+  }
+  std::string consolidated_file =
+      array_dir + "/__consolidated_fragment_metadata_3.tdb";
+  cmd = "test -f " + consolidated_file;
+  CHECK(system(cmd.c_str()) == 0);
+  cmd = "test -f " + array_dir + "/__consolidated_fragment_metadata_2.tdb";
+  CHECK(system(cmd.c_str()) != 0);
+
+  // Reads the subarray with a new context, which opens the array cold.
+  // Returns false if the read fails.
+  auto read_cold = [&]() {
+    tiledb_ctx_free(ctx_);
+    REQUIRE(tiledb_ctx_create(&ctx_) == TILEDB_OK);
+    int* buffer = read_sparse_array_2D(
+        10, 19, 20, 39, TILEDB_READ, TILEDB_ROW_MAJOR);
+    if (buffer == nullptr)
+      return false;
+    int64_t index = 0;
+    bool allok = true;
+    for (int64_t r = 10; r <= 19; ++r)
+      for (int64_t c = 20; c <= 39; ++c)
+        allok = allok && (buffer[index++] == r * domain_size_1 + c);
+    CHECK(allok);
+    delete[] buffer;
+    return true;
+  };
+
+  // The index size of a fragment is set past the end of its own file, so
+  // that its index cannot be read from it, while its sections are left
+  // intact. The array still opens, since the index is taken from the
+  // consolidated file.
+  auto fragments = fragment_dirs();
+  REQUIRE(fragments.size() == 3);
+  std::string metadata_file = fragments[0] + "/__fragment_metadata.tdb";
+  std::string backup_file = TEMP_DIR + GROUP + "fragment_metadata.bak";
+  cmd = "cp " + metadata_file + " " + backup_file;
+  REQUIRE(system(cmd.c_str()) == 0);
+  uint64_t index_size = 1024 * 1024;
+  FILE* file = fopen(metadata_file.c_str(), "r+b");
+  REQUIRE(file != nullptr);
+  CHECK(fseek(file, sizeof(uint64_t), SEEK_SET) == 0);
+  CHECK(fwrite(&index_size, sizeof(uint64_t), 1, file) == 1);
+  CHECK(fclose(file) == 0);
+  CHECK(read_cold());
+
+  // An unreadable consolidated file is ignored, and the metadata are loaded
+  // from the fragment metadata files
+  cmd = ": > " + consolidated_file;
+  REQUIRE(system(cmd.c_str()) == 0);
+  CHECK(!read_cold());
+  cmd = "cp " + backup_file + " " + metadata_file;
+  REQUIRE(system(cmd.c_str()) == 0);
+  CHECK(read_cold());
+}
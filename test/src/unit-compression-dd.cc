@@ -32,10 +32,14 @@
  * Tests the double delta compression.
  */
 
+#include "bit_packing.h"
 #include "catch.hpp"
 #include "dd_compressor.h"
 
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <vector>
 
 TEST_CASE("Compression-DoubleDelta: Test 1-element case", "[double-delta]") {
   // Compress
@@ -196,3 +200,126 @@ TEST_CASE("Compression-DoubleDelta: Test n-element case", "[double-delta]") {
   delete decomp_out_buff;
   delete[] data;
 }
+
+/** Compresses and decompresses values, returning the compressed size. */
+template <class T>
+uint64_t check_dd_round_trip(tiledb::Datatype type, const std::vector<T>& data) {
+  uint64_t nbytes = data.size() * sizeof(T);
+  tiledb::ConstBuffer comp_in_buff(&data[0], nbytes);
+  tiledb::Buffer comp_out_buff;
+  auto st = tiledb::DoubleDelta::compress(type, &comp_in_buff, &comp_out_buff);
+  REQUIRE(st.ok());
+  CHECK(
+      comp_out_buff.size() <= nbytes + tiledb::DoubleDelta::overhead(nbytes));
+
+  tiledb::ConstBuffer decomp_in_buff(&comp_out_buff);
+  tiledb::Buffer decomp_out_buff;
+  st = tiledb::DoubleDelta::decompress(type, &decomp_in_buff, &decomp_out_buff);
+  REQUIRE(st.ok());
+  REQUIRE(decomp_out_buff.size() == nbytes);
+  CHECK(std::memcmp(&data[0], decomp_out_buff.data(), nbytes) == 0);
+
+  return comp_out_buff.size();
+}
+
+TEST_CASE(
+    "Compression-DoubleDelta: Test the full value range", "[double-delta]") {
+  std::vector<int64_t> data;
+  for (int i = 0; i < 1000; ++i) {
+    data.push_back(std::numeric_limits<int64_t>::max() - i);
+    data.push_back(std::numeric_limits<int64_t>::min() + i);
+    data.push_back(i);
+  }
+  check_dd_round_trip(tiledb::Datatype::INT64, data);
+
+  std::vector<uint64_t> udata;
+  for (int i = 0; i < 1000; ++i) {
+    udata.push_back(std::numeric_limits<uint64_t>::max() - i * i);
+    udata.push_back(i);
+  }
+  check_dd_round_trip(tiledb::Datatype::UINT64, udata);
+
+  std::vector<int8_t> bytes;
+  for (int i = 0; i < 1001; ++i)
+    bytes.push_back((int8_t)((i % 2) ? 127 - i % 5 : -128 + i % 3));
+  check_dd_round_trip(tiledb::Datatype::INT8, bytes);
+
+  std::vector<uint16_t> shorts;
+  for (int i = 0; i < 999; ++i)
+    shorts.push_back((uint16_t)(i * 7919));
+  check_dd_round_trip(tiledb::Datatype::UINT16, shorts);
+}
+
+TEST_CASE(
+    "Compression-DoubleDelta: Test block-wise bit widths", "[double-delta]") {
+  // Nearly evenly spaced coordinates with one outlier take 3 bits per value,
+  // except in the blocks of the outlier
+  std::vector<int64_t> data;
+  for (int64_t i = 0; i < 12800; ++i)
+    data.push_back(1000000000 + 10 * i + (i % 3));
+  data[5000] = 0;
+  uint64_t size = check_dd_round_trip(tiledb::Datatype::INT64, data);
+  CHECK(size < data.size() * sizeof(int64_t) / 12);
+
+  // Random values
+  std::srand(std::time(0));
+  std::vector<int> random(100001);
+  for (auto& v : random)
+    v = std::rand() - RAND_MAX / 2;
+  check_dd_round_trip(tiledb::Datatype::INT32, random);
+}
+
+TEST_CASE(
+    "Compression-DoubleDelta: Test SIMD and scalar bit packing agree",
+    "[double-delta]") {
+  std::srand(std::time(0));
+  uint64_t rows = 37;
+  std::vector<uint64_t> values(rows * tiledb::BitPacking::LANE_NUM);
+  std::vector<uint64_t> unpacked(values.size());
+  for (int width = 0; width <= 64; ++width) {
+    uint64_t mask = (width == 64) ? ~0ULL : ((1ULL << width) - 1);
+    for (auto& v : values)
+      v = (((uint64_t)std::rand() << 32) ^ (uint64_t)std::rand()) & mask;
+
+    uint64_t size = tiledb::BitPacking::packed_size(rows, width);
+    std::vector<uint64_t> packed[2];
+    for (int simd = 0; simd < 2; ++simd) {
+      packed[simd].resize(size / sizeof(uint64_t) + 1);
+      tiledb::BitPacking::pack(
+          &values[0], rows, width, &packed[simd][0], simd == 1);
+      tiledb::BitPacking::unpack(
+          &packed[simd][0], rows, width, &unpacked[0], simd == 1);
+      CHECK(unpacked == values);
+    }
+    CHECK_FALSE(memcmp(&packed[0][0], &packed[1][0], size));
+  }
+}
+
+TEST_CASE(
+    "Compression-DoubleDelta: Test decompressing the earlier format",
+    "[double-delta]") {
+  // Bitsize, number of values, first two values and 64-bit chunks holding
+  // the sign and absolute value of each double delta, from the MSB
+  int first[] = {1, 2};
+  uint64_t chunks[] = {0, uint64_t(1) << 62, uint64_t(3) << 62};
+  uint64_t num[] = {4, 3, 3};
+  int expected[][4] = {{1, 2, 3, 4}, {1, 2, 4, 0}, {1, 2, 2, 0}};
+  for (int t = 0; t < 3; ++t) {
+    tiledb::Buffer comp_buff;
+    char bitsize = 1;
+    REQUIRE(comp_buff.write(&bitsize, sizeof(char)).ok());
+    REQUIRE(comp_buff.write(&num[t], sizeof(uint64_t)).ok());
+    REQUIRE(comp_buff.write(first, sizeof(first)).ok());
+    REQUIRE(comp_buff.write(&chunks[t], sizeof(uint64_t)).ok());
+
+    tiledb::ConstBuffer decomp_in_buff(&comp_buff);
+    tiledb::Buffer decomp_out_buff;
+    REQUIRE(decomp_out_buff.realloc(num[t] * sizeof(int)).ok());
+    auto st = tiledb::DoubleDelta::decompress(
+        tiledb::Datatype::INT32, &decomp_in_buff, &decomp_out_buff);
+    REQUIRE(st.ok());
+    REQUIRE(decomp_out_buff.size() == num[t] * sizeof(int));
+    CHECK(!std::memcmp(
+        decomp_out_buff.data(), expected[t], num[t] * sizeof(int)));
+  }
+}
@@ -0,0 +1,125 @@
+/**
+ * @file   unit-compression-gorilla.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ * @copyright Copyright (c) 2016 MIT and Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the Gorilla compression.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "catch.hpp"
+#include "gorilla_compressor.h"
+
+using namespace tiledb;
+
+/** Compresses and decompresses values, returning the compressed size. */
+template <class T>
+uint64_t check_gorilla_round_trip(Datatype type, const std::vector<T>& data) {
+  uint64_t nbytes = data.size() * sizeof(T);
+  ConstBuffer input(data.empty() ? nullptr : &data[0], nbytes);
+  Buffer compressed;
+  REQUIRE(Gorilla::compress(type, &input, &compressed).ok());
+  CHECK(compressed.size() <= nbytes + Gorilla::overhead(nbytes));
+
+  ConstBuffer compressed_input(&compressed);
+  Buffer decompressed;
+  REQUIRE(Gorilla::decompress(type, &compressed_input, &decompressed).ok());
+  REQUIRE(decompressed.size() == nbytes);
+  if (nbytes > 0)
+    CHECK_FALSE(std::memcmp(&data[0], decompressed.data(), nbytes));
+
+  return compressed.size();
+}
+
+TEST_CASE("Compression-Gorilla: Test round trips", "[gorilla]") {
+  // Small inputs
+  for (int n = 0; n < 10; ++n) {
+    std::vector<double> data;
+    for (int i = 0; i < n; ++i)
+      data.push_back(1.5 * i);
+    check_gorilla_round_trip(Datatype::FLOAT64, data);
+  }
+
+  // Special values
+  std::vector<float> special = {0.0f,
+                                -0.0f,
+                                std::numeric_limits<float>::infinity(),
+                                -std::numeric_limits<float>::infinity(),
+                                std::numeric_limits<float>::quiet_NaN(),
+                                std::numeric_limits<float>::denorm_min(),
+                                std::numeric_limits<float>::max(),
+                                std::numeric_limits<float>::lowest()};
+  check_gorilla_round_trip(Datatype::FLOAT32, special);
+
+  // Random values
+  std::srand(std::time(0));
+  std::vector<double> random(10001);
+  std::vector<float> random_float(10003);
+  for (auto& v : random)
+    v = std::rand() * 1e-3 - std::rand();
+  for (auto& v : random_float)
+    v = (float)std::rand() / (float)(std::rand() + 1);
+  check_gorilla_round_trip(Datatype::FLOAT64, random);
+  check_gorilla_round_trip(Datatype::FLOAT32, random_float);
+}
+
+TEST_CASE("Compression-Gorilla: Test slowly varying values", "[gorilla]") {
+  // A sensor reading in steps of a quarter degree
+  std::vector<double> data(100000);
+  for (uint64_t i = 0; i < data.size(); ++i)
+    data[i] = 20.0 + 0.25 * (int)(8 * std::sin(i / 1000.0));
+  uint64_t size = check_gorilla_round_trip(Datatype::FLOAT64, data);
+  CHECK(size < data.size() * sizeof(double) / 8);
+}
+
+TEST_CASE("Compression-Gorilla: Test invalid input", "[gorilla]") {
+  // Integer values
+  int ints[] = {1, 2, 3};
+  ConstBuffer input(ints, sizeof(ints));
+  Buffer compressed;
+  CHECK(!Gorilla::compress(Datatype::INT32, &input, &compressed).ok());
+
+  // Partial values
+  ConstBuffer partial(ints, sizeof(ints) - 1);
+  CHECK(!Gorilla::compress(Datatype::FLOAT32, &partial, &compressed).ok());
+
+  // Truncated input
+  std::vector<double> data(1000);
+  for (uint64_t i = 0; i < data.size(); ++i)
+    data[i] = 1.0 / (i + 1);
+  ConstBuffer values(&data[0], data.size() * sizeof(double));
+  REQUIRE(Gorilla::compress(Datatype::FLOAT64, &values, &compressed).ok());
+  ConstBuffer truncated(compressed.data(), compressed.size() / 2);
+  Buffer decompressed;
+  CHECK(!Gorilla::decompress(Datatype::FLOAT64, &truncated, &decompressed)
+             .ok());
+}
@@ -33,6 +33,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #include "catch.hpp"
 #include "rle_compressor.h"
@@ -276,3 +277,38 @@ TEST_CASE(
   delete compressed;
   delete decompressed;
 }
+
+TEST_CASE("Compression-RLE: Test SIMD and scalar paths agree", "[rle]") {
+  uint64_t value_sizes[] = {1, 2, 3, 4, 8};
+  for (auto value_size : value_sizes) {
+    // Runs of lengths around the vector widths, and one over the maximum
+    std::vector<unsigned char> data;
+    uint64_t run_lens[] = {1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 65, 70000, 5};
+    unsigned char v = 0;
+    for (auto run_len : run_lens) {
+      for (uint64_t i = 0; i < run_len; ++i)
+        for (uint64_t b = 0; b < value_size; ++b)
+          data.push_back((unsigned char)(v + b * 17));
+      v += 3;
+    }
+
+    Buffer compressed[2];
+    for (int simd = 0; simd < 2; ++simd) {
+      ConstBuffer input(&data[0], data.size());
+      REQUIRE(
+          RLE::compress(value_size, &input, &compressed[simd], simd == 1)
+              .ok());
+      CHECK(compressed[simd].size() == 14 * (value_size + 2));
+
+      ConstBuffer compressed_input(&compressed[simd]);
+      Buffer decompressed;
+      REQUIRE(RLE::decompress(
+                  value_size, &compressed_input, &decompressed, simd == 1)
+                  .ok());
+      REQUIRE(decompressed.size() == data.size());
+      CHECK_FALSE(memcmp(&data[0], decompressed.data(), data.size()));
+    }
+    CHECK_FALSE(memcmp(
+        compressed[0].data(), compressed[1].data(), compressed[0].size()));
+  }
+}
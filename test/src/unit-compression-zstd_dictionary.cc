@@ -0,0 +1,136 @@
+/**
+ * @file   unit-compression-zstd_dictionary.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ * @copyright Copyright (c) 2016 MIT and Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the ZSTD compression with trained dictionaries.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "zstd_compressor.h"
+#include "zstd_dictionary.h"
+
+using namespace tiledb;
+
+/** Produces a small tile of log-like records. */
+std::string make_tile(int seed) {
+  static const char* levels[] = {"INFO", "WARN", "ERROR", "DEBUG"};
+  std::string tile;
+  for (int i = 0; i < 20; ++i) {
+    int r = (seed * 31 + i * 17) % 1000;
+    tile += std::string("{\"level\":\"") + levels[r % 4] +
+            "\",\"service\":\"storage-" + std::to_string(r % 7) +
+            "\",\"latency_ms\":" + std::to_string(r) + "}\n";
+  }
+  return tile;
+}
+
+/** Compresses and decompresses a tile, returning the compressed size. */
+uint64_t check_zstd_round_trip(
+    const std::string& tile, const ZStdDictionary* dict) {
+  ConstBuffer input(tile.data(), tile.size());
+  Buffer compressed;
+  REQUIRE(compressed.realloc(tile.size() + ZStd::overhead(tile.size())).ok());
+  REQUIRE(ZStd::compress(-1, &input, &compressed, dict).ok());
+
+  ConstBuffer compressed_input(compressed.data(), compressed.size());
+  Buffer decompressed;
+  REQUIRE(decompressed.realloc(tile.size()).ok());
+  REQUIRE(ZStd::decompress(&compressed_input, &decompressed, dict).ok());
+  REQUIRE(decompressed.size() == tile.size());
+  CHECK_FALSE(std::memcmp(tile.data(), decompressed.data(), tile.size()));
+
+  return compressed.size();
+}
+
+TEST_CASE(
+    "Compression-ZStd: Test trained dictionaries", "[zstd][dictionary]") {
+  // Train on sample tiles
+  Buffer samples;
+  std::vector<size_t> sample_sizes;
+  for (int i = 0; i < 500; ++i) {
+    std::string tile = make_tile(i);
+    REQUIRE(samples.write(tile.data(), tile.size()).ok());
+    sample_sizes.push_back(tile.size());
+  }
+  Buffer dict_data;
+  REQUIRE(
+      ZStdDictionary::train(&samples, sample_sizes, 16 * 1024, &dict_data)
+          .ok());
+  ZStdDictionary dict;
+  REQUIRE(dict.init(dict_data.data(), dict_data.size(), -1).ok());
+  CHECK(dict.id() != 0);
+
+  // Small tiles compress better with the dictionary
+  uint64_t size = 0, size_dict = 0;
+  for (int i = 1000; i < 1010; ++i) {
+    std::string tile = make_tile(i);
+    size += check_zstd_round_trip(tile, nullptr);
+    size_dict += check_zstd_round_trip(tile, &dict);
+  }
+  CHECK(size_dict < size);
+
+  // Tiles compressed without the dictionary decompress with it
+  std::string tile = make_tile(2000);
+  ConstBuffer input(tile.data(), tile.size());
+  Buffer compressed;
+  REQUIRE(compressed.realloc(tile.size() + ZStd::overhead(tile.size())).ok());
+  REQUIRE(ZStd::compress(-1, &input, &compressed).ok());
+  ConstBuffer compressed_input(compressed.data(), compressed.size());
+  Buffer decompressed;
+  REQUIRE(decompressed.realloc(tile.size()).ok());
+  REQUIRE(ZStd::decompress(&compressed_input, &decompressed, &dict).ok());
+  CHECK(decompressed.size() == tile.size());
+
+  // Tiles compressed with the dictionary need it
+  compressed.reset_offset();
+  compressed.reset_size();
+  REQUIRE(ZStd::compress(-1, &input, &compressed, &dict).ok());
+  ConstBuffer compressed_dict(compressed.data(), compressed.size());
+  decompressed.reset_offset();
+  decompressed.reset_size();
+  CHECK(!ZStd::decompress(&compressed_dict, &decompressed).ok());
+}
+
+TEST_CASE(
+    "Compression-ZStd: Test invalid dictionaries", "[zstd][dictionary]") {
+  // No samples
+  Buffer samples, dict_data;
+  std::vector<size_t> sample_sizes;
+  CHECK(!ZStdDictionary::train(&samples, sample_sizes, 1024, &dict_data).ok());
+
+  // Not a dictionary
+  ZStdDictionary dict;
+  char data[64] = {0};
+  CHECK(!dict.init(data, sizeof(data), -1).ok());
+}
@@ -0,0 +1,153 @@
+/**
+ * @file   unit-dictionary_encoding.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the dictionary encoding of variable-sized tiles.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "constants.h"
+#include "dictionary_encoding.h"
+
+using namespace tiledb;
+
+/**
+ * Encodes and decodes the cells, with offsets shifted by *shift*, returning
+ * the encoded size.
+ */
+uint64_t check_dictionary_round_trip(
+    const std::vector<std::string>& cells, uint64_t shift) {
+  std::vector<uint64_t> offsets;
+  std::string values;
+  for (auto& cell : cells) {
+    offsets.push_back(shift + values.size());
+    values += cell;
+  }
+
+  auto offsets_buff = new Buffer(
+      offsets.empty() ? nullptr : &offsets[0],
+      offsets.size() * sizeof(uint64_t),
+      false);
+  auto values_buff = new Buffer(&values[0], values.size(), false);
+  Tile offsets_tile(
+      Datatype::UINT64,
+      Compressor::NO_COMPRESSION,
+      -1,
+      constants::cell_var_offset_size,
+      0,
+      offsets_buff,
+      true);
+  Tile values_tile(
+      Datatype::CHAR,
+      Compressor::NO_COMPRESSION,
+      -1,
+      sizeof(char),
+      0,
+      values_buff,
+      true);
+
+  Buffer encoded;
+  REQUIRE(DictionaryEncoding::encode(&offsets_tile, &values_tile, &encoded)
+              .ok());
+  CHECK(encoded.size() <= values.size() + 1);
+
+  Buffer decoded;
+  REQUIRE(
+      DictionaryEncoding::decode(encoded.data(), encoded.size(), &decoded)
+          .ok());
+  REQUIRE(decoded.size() == values.size());
+  if (!values.empty())
+    CHECK_FALSE(std::memcmp(&values[0], decoded.data(), values.size()));
+
+  return encoded.size();
+}
+
+TEST_CASE(
+    "Dictionary encoding: Test round trips", "[dictionary_encoding]") {
+  // Empty and single cells
+  check_dictionary_round_trip({}, 0);
+  check_dictionary_round_trip({""}, 0);
+  check_dictionary_round_trip({"a"}, 7);
+
+  // Distinct values are stored as they are
+  std::vector<std::string> distinct;
+  for (int i = 0; i < 1000; ++i)
+    distinct.push_back(std::to_string(i));
+  CHECK(check_dictionary_round_trip(distinct, 0) == 1 + 2890);
+
+  // Empty cells among repeated values
+  check_dictionary_round_trip({"", "abc", "", "abc", "", "abc", "abc"}, 16);
+
+  // One-, two- and four-byte codes
+  for (int dict_num : {10, 1000, 70000}) {
+    std::vector<std::string> cells;
+    for (int i = 0; i < 4 * dict_num; ++i)
+      cells.push_back("value_" + std::to_string(i % dict_num) + "_name");
+    check_dictionary_round_trip(cells, 100);
+  }
+}
+
+TEST_CASE(
+    "Dictionary encoding: Test low cardinality", "[dictionary_encoding]") {
+  std::vector<std::string> colors = {"red", "green", "blue", "yellow"};
+  std::vector<std::string> cells;
+  for (int i = 0; i < 10000; ++i)
+    cells.push_back(colors[(i * 7) % colors.size()]);
+  uint64_t size = check_dictionary_round_trip(cells, 0);
+  CHECK(size < 10000 + 100);
+}
+
+TEST_CASE(
+    "Dictionary encoding: Test invalid input", "[dictionary_encoding]") {
+  Buffer decoded;
+
+  // Unknown mode
+  char bad_mode[] = {5, 'a', 'b'};
+  CHECK(!DictionaryEncoding::decode(bad_mode, sizeof(bad_mode), &decoded).ok());
+
+  // Code past the end of the dictionary
+  std::vector<char> bad_code(1 + sizeof(uint64_t) + 1 + sizeof(uint64_t) + 2);
+  uint64_t dict_num = 1, entry_size = 1;
+  bad_code[0] = 1;
+  std::memcpy(&bad_code[1], &dict_num, sizeof(uint64_t));
+  bad_code[1 + sizeof(uint64_t)] = 1;
+  std::memcpy(&bad_code[2 + sizeof(uint64_t)], &entry_size, sizeof(uint64_t));
+  bad_code[2 + 2 * sizeof(uint64_t)] = 'x';
+  bad_code[3 + 2 * sizeof(uint64_t)] = 1;
+  CHECK(!DictionaryEncoding::decode(&bad_code[0], bad_code.size(), &decoded)
+             .ok());
+
+  // Truncated dictionary
+  CHECK(!DictionaryEncoding::decode(
+             &bad_code[0], 1 + sizeof(uint64_t) + 1, &decoded)
+             .ok());
+}
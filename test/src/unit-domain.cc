@@ -0,0 +1,86 @@
+/**
+ * @file   unit-domain.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the Domain class.
+ */
+
+#include "catch.hpp"
+#include "domain.h"
+
+using namespace tiledb;
+
+TEST_CASE("Domain: Test subarray overlap", "[domain]") {
+  // Integer domain
+  int64_t dim_domain[] = {0, 99, 0, 99};
+  int64_t tile_extent = 10;
+  Domain domain(Datatype::INT64);
+  REQUIRE(domain.add_dimension("x", &dim_domain[0], &tile_extent).ok());
+  REQUIRE(domain.add_dimension("y", &dim_domain[2], &tile_extent).ok());
+
+  int64_t a[] = {0, 9, 0, 99};
+  int64_t touching[] = {9, 19, 50, 50};
+  int64_t adjacent[] = {10, 19, 0, 99};
+  int64_t other_column[] = {0, 9, 100, 100};
+  CHECK(domain.overlap(a, a));
+  CHECK(domain.overlap(a, touching));
+  CHECK(domain.overlap(touching, a));
+  CHECK(!domain.overlap(a, adjacent));
+  CHECK(!domain.overlap(adjacent, a));
+
+  // Both dimensions must intersect
+  CHECK(!domain.overlap(a, other_column));
+  CHECK(domain.overlap((const void*)a, (const void*)touching));
+  CHECK(!domain.overlap((const void*)a, (const void*)adjacent));
+
+  // Real domains
+  double real_domain[] = {0.0, 1.0, 0.0, 1.0};
+  double real_tile_extent = 0.5;
+  Domain real(Datatype::FLOAT64);
+  REQUIRE(real.add_dimension("x", &real_domain[0], &real_tile_extent).ok());
+  REQUIRE(real.add_dimension("y", &real_domain[2], &real_tile_extent).ok());
+
+  double b[] = {0.0, 0.5, 0.0, 1.0};
+  double touching_b[] = {0.5, 1.0, 0.25, 0.25};
+  double after_b[] = {0.5000001, 1.0, 0.0, 1.0};
+  double point[] = {0.25, 0.25, 0.75, 0.75};
+  CHECK(real.overlap((const void*)b, (const void*)touching_b));
+  CHECK(!real.overlap((const void*)b, (const void*)after_b));
+  CHECK(real.overlap((const void*)b, (const void*)point));
+  CHECK(!real.overlap((const void*)after_b, (const void*)point));
+
+  float float_domain[] = {-1.0f, 1.0f};
+  float float_tile_extent = 0.5f;
+  Domain single(Datatype::FLOAT32);
+  REQUIRE(single.add_dimension("x", &float_domain[0], &float_tile_extent).ok());
+  float c[] = {-1.0f, -0.25f};
+  float touching_c[] = {-0.25f, 0.0f};
+  float after_c[] = {-0.2f, 0.0f};
+  CHECK(single.overlap((const void*)c, (const void*)touching_c));
+  CHECK(!single.overlap((const void*)c, (const void*)after_c));
+}
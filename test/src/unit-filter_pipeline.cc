@@ -0,0 +1,161 @@
+/**
+ * @file   unit-filter_pipeline.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the FilterPipeline class.
+ */
+
+#include "catch.hpp"
+#include "filter_pipeline.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace tiledb;
+
+/** Runs data through a pipeline and back, returning the filtered size. */
+uint64_t check_round_trip(
+    const FilterPipeline& filters,
+    Datatype type,
+    const void* data,
+    uint64_t nbytes) {
+  ConstBuffer input(data, nbytes);
+  Buffer filtered;
+  REQUIRE(filters.run_forward(type, &input, &filtered).ok());
+  CHECK(filtered.size() <= nbytes + filters.overhead(nbytes));
+
+  ConstBuffer filtered_input(&filtered);
+  Buffer output;
+  REQUIRE(filters.run_reverse(type, &filtered_input, &output).ok());
+  REQUIRE(output.size() == nbytes);
+  CHECK(std::memcmp(output.data(), data, nbytes) == 0);
+
+  return filtered.size();
+}
+
+TEST_CASE("FilterPipeline: Test round trips", "[filter]") {
+  const uint64_t value_num = 1000;
+  std::vector<int32_t> ints(value_num);
+  std::vector<int64_t> longs(value_num);
+  std::vector<uint8_t> bytes(value_num);
+  std::vector<double> doubles(value_num);
+  for (uint64_t i = 0; i < value_num; ++i) {
+    ints[i] = (int32_t)(i * 37 % 101) - 50;
+    longs[i] = (int64_t)(i * i) - 1000000000000LL;
+    bytes[i] = (uint8_t)(i * 7);
+    doubles[i] = 0.5 * i;
+  }
+
+  FilterType filter_types[] = {FilterType::BYTESHUFFLE,
+                               FilterType::BITSHUFFLE,
+                               FilterType::DELTA,
+                               FilterType::BIT_WIDTH_REDUCTION};
+  for (auto filter_type : filter_types) {
+    FilterPipeline filters;
+    filters.add_filter(filter_type);
+    check_round_trip(
+        filters, Datatype::INT32, &ints[0], value_num * sizeof(int32_t));
+    check_round_trip(
+        filters, Datatype::INT64, &longs[0], value_num * sizeof(int64_t));
+    check_round_trip(filters, Datatype::UINT8, &bytes[0], value_num);
+    check_round_trip(
+        filters, Datatype::FLOAT64, &doubles[0], value_num * sizeof(double));
+
+    // Trailing bytes that do not make a whole value
+    check_round_trip(
+        filters, Datatype::INT32, &ints[0], value_num * sizeof(int32_t) - 3);
+
+    // Empty input
+    check_round_trip(filters, Datatype::INT32, &ints[0], 0);
+  }
+
+  // A chain of filters
+  FilterPipeline filters;
+  filters.add_filter(FilterType::DELTA);
+  filters.add_filter(FilterType::BIT_WIDTH_REDUCTION);
+  filters.add_filter(FilterType::BYTESHUFFLE);
+  filters.add_filter(FilterType::BITSHUFFLE);
+  check_round_trip(
+      filters, Datatype::INT64, &longs[0], value_num * sizeof(int64_t));
+}
+
+TEST_CASE("FilterPipeline: Test bit width reduction", "[filter]") {
+  // Values within a small range take a few bits each
+  const uint64_t value_num = 1024;
+  std::vector<int32_t> values(value_num);
+  for (uint64_t i = 0; i < value_num; ++i)
+    values[i] = -100000 + (int32_t)(i % 16);
+
+  FilterPipeline filters;
+  filters.add_filter(FilterType::BIT_WIDTH_REDUCTION);
+  uint64_t size = check_round_trip(
+      filters, Datatype::INT32, &values[0], value_num * sizeof(int32_t));
+  CHECK(size < value_num * sizeof(int32_t) / 4);
+
+  // Increasing values take a few bits each after delta encoding
+  for (uint64_t i = 0; i < value_num; ++i)
+    values[i] = 1000000 + (int32_t)(3 * i);
+  FilterPipeline delta_filters;
+  delta_filters.add_filter(FilterType::DELTA);
+  delta_filters.add_filter(FilterType::BIT_WIDTH_REDUCTION);
+  size = check_round_trip(
+      delta_filters, Datatype::INT32, &values[0], value_num * sizeof(int32_t));
+  CHECK(size < value_num * sizeof(int32_t) / 4);
+
+  // Truncated input
+  ConstBuffer input(&values[0], value_num * sizeof(int32_t));
+  Buffer filtered;
+  REQUIRE(filters.run_forward(Datatype::INT32, &input, &filtered).ok());
+  ConstBuffer truncated(filtered.data(), filtered.size() / 2);
+  Buffer output;
+  CHECK(!filters.run_reverse(Datatype::INT32, &truncated, &output).ok());
+}
+
+TEST_CASE("FilterPipeline: Test serialization", "[filter]") {
+  FilterPipeline filters;
+  filters.add_filter(FilterType::DELTA);
+  filters.add_filter(FilterType::BYTESHUFFLE);
+  Buffer buff;
+  REQUIRE(filters.serialize(&buff).ok());
+
+  ConstBuffer input(&buff);
+  FilterPipeline loaded;
+  REQUIRE(loaded.deserialize(&input).ok());
+  REQUIRE(loaded.filter_num() == 2);
+  CHECK(loaded.filter(0) == FilterType::DELTA);
+  CHECK(loaded.filter(1) == FilterType::BYTESHUFFLE);
+
+  // Unknown filter type
+  unsigned int filter_num = 1;
+  char filter = 100;
+  Buffer invalid;
+  REQUIRE(invalid.write(&filter_num, sizeof(unsigned int)).ok());
+  REQUIRE(invalid.write(&filter, sizeof(char)).ok());
+  ConstBuffer invalid_input(&invalid);
+  CHECK(!loaded.deserialize(&invalid_input).ok());
+}
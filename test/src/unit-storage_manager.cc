@@ -0,0 +1,468 @@
+/**
+ * @file   unit-storage_manager.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the StorageManager class.
+ */
+
+#include "catch.hpp"
+#include "constants.h"
+#include "posix_filesystem.h"
+#include "storage_manager.h"
+#include "tile_io.h"
+#include "vfs.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace tiledb;
+
+struct StorageManagerFx {
+  // Workspace folder name
+  const std::string TEMP_DIR =
+      "file://" + posix::current_dir() + "/tiledb_test_storage_manager/";
+
+  // Storage manager under test
+  StorageManager* storage_manager_;
+
+  StorageManagerFx() {
+    storage_manager_ = new StorageManager();
+    REQUIRE(storage_manager_->init().ok());
+    remove_dir(TEMP_DIR);
+    REQUIRE(storage_manager_->create_dir(URI(TEMP_DIR)).ok());
+  }
+
+  ~StorageManagerFx() {
+    remove_dir(TEMP_DIR);
+    delete storage_manager_;
+  }
+
+  void remove_dir(const std::string& path) {
+    URI uri(path);
+    if (storage_manager_->is_dir(uri))
+      CHECK(posix::remove_path(uri.to_path()).ok());
+  }
+
+  /**
+   * Creates a 2D sparse array with domain [0,99] x [0,99], tiles of 10 x 10
+   * cells and two int32 attributes, "a" and "b".
+   */
+  void create_array(const std::string& array_name) {
+    int64_t dim_domain[] = {0, 99, 0, 99};
+    int64_t tile_extent = 10;
+    Domain domain(Datatype::INT64);
+    REQUIRE(domain.add_dimension("x", &dim_domain[0], &tile_extent).ok());
+    REQUIRE(domain.add_dimension("y", &dim_domain[2], &tile_extent).ok());
+    Attribute a("a", Datatype::INT32);
+    Attribute b("b", Datatype::INT32);
+
+    URI array_uri(array_name);
+    ArrayMetadata array_metadata(array_uri);
+    array_metadata.set_array_type(ArrayType::SPARSE);
+    array_metadata.set_capacity(10);
+    array_metadata.add_attribute(&a);
+    array_metadata.add_attribute(&b);
+    array_metadata.set_domain(&domain);
+    REQUIRE(storage_manager_->array_create(&array_metadata).ok());
+  }
+
+  /** Recreates the storage manager with some open array cache size. */
+  void set_open_array_cache_size(uint64_t open_array_cache_size) {
+    delete storage_manager_;
+    Config config;
+    config.sm_params_.open_array_cache_size_ = open_array_cache_size;
+    storage_manager_ = new StorageManager(config);
+    REQUIRE(storage_manager_->init().ok());
+  }
+
+  /** Returns the URIs of the fragments of an array. */
+  std::vector<URI> fragment_uris(const std::string& array_name) {
+    VFS vfs;
+    std::vector<URI> uris, fragment_uris;
+    REQUIRE(vfs.ls(URI(array_name), &uris).ok());
+    for (auto& uri : uris) {
+      if (storage_manager_->is_fragment(uri))
+        fragment_uris.push_back(uri);
+    }
+    return fragment_uris;
+  }
+
+  /**
+   * Reads both attributes of the cells in the input subarray.
+   *
+   * @param array_name The array name.
+   * @param subarray The subarray to read.
+   * @param values The values of attribute "a" of the cells read.
+   * @param fragment_num The number of fragments the query was opened with.
+   */
+  void read(
+      const std::string& array_name,
+      const int64_t* subarray,
+      std::vector<int>* values,
+      unsigned* fragment_num = nullptr) {
+    const char* attributes[] = {"a", "b"};
+    std::vector<int> buffer_a(100 * 100), buffer_b(100 * 100);
+    void* buffers[] = {&buffer_a[0], &buffer_b[0]};
+    uint64_t buffer_sizes[] = {buffer_a.size() * sizeof(int),
+                               buffer_b.size() * sizeof(int)};
+
+    Query query;
+    REQUIRE(storage_manager_
+                ->query_init(
+                    &query,
+                    array_name.c_str(),
+                    QueryType::READ,
+                    Layout::ROW_MAJOR,
+                    subarray,
+                    attributes,
+                    2,
+                    buffers,
+                    buffer_sizes)
+                .ok());
+    REQUIRE(storage_manager_->query_submit(&query).ok());
+    if (fragment_num != nullptr)
+      *fragment_num = query.fragment_num();
+    REQUIRE(storage_manager_->query_finalize(&query).ok());
+
+    values->assign(
+        buffer_a.begin(), buffer_a.begin() + buffer_sizes[0] / sizeof(int));
+  }
+
+  /**
+   * Writes a fragment with the cells of rows [row_lo, row_hi] and columns
+   * [0, 9], where attribute "a" of cell (x, y) is x * 100 + y + offset.
+   */
+  void write(
+      const std::string& array_name,
+      int64_t row_lo,
+      int64_t row_hi,
+      int offset = 0) {
+    std::vector<int> buffer_a, buffer_b;
+    std::vector<int64_t> buffer_coords;
+    for (int64_t x = row_lo; x <= row_hi; ++x) {
+      for (int64_t y = 0; y < 10; ++y) {
+        buffer_a.push_back((int)(x * 100 + y) + offset);
+        buffer_b.push_back(-(int)(x * 100 + y));
+        buffer_coords.push_back(x);
+        buffer_coords.push_back(y);
+      }
+    }
+    void* buffers[] = {&buffer_a[0], &buffer_b[0], &buffer_coords[0]};
+    uint64_t buffer_sizes[] = {buffer_a.size() * sizeof(int),
+                               buffer_b.size() * sizeof(int),
+                               buffer_coords.size() * sizeof(int64_t)};
+
+    Query query;
+    REQUIRE(storage_manager_
+                ->query_init(
+                    &query,
+                    array_name.c_str(),
+                    QueryType::WRITE,
+                    Layout::UNORDERED,
+                    nullptr,
+                    nullptr,
+                    0,
+                    buffers,
+                    buffer_sizes,
+                    URI())
+                .ok());
+    REQUIRE(storage_manager_->query_submit(&query).ok());
+    REQUIRE(storage_manager_->query_finalize(&query).ok());
+  }
+};
+
+TEST_CASE_METHOD(
+    StorageManagerFx,
+    "StorageManager: Test closed array retention",
+    "[storage_manager]") {
+  std::string array_a = TEMP_DIR + "array_a";
+  std::string array_b = TEMP_DIR + "array_b";
+  create_array(array_a);
+  create_array(array_b);
+  write(array_a, 0, 9);
+  write(array_b, 0, 9);
+  CHECK(storage_manager_->closed_array_num() == 2);
+
+  int64_t subarray[] = {0, 9, 0, 9};
+  std::vector<int> values;
+  read(array_a, subarray, &values);
+  REQUIRE(values.size() == 100);
+  CHECK(values[23] == 203);
+
+  // The closed arrays are retained, along with their fragment metadata
+  uint64_t closed_array_num = storage_manager_->closed_array_num();
+  uint64_t closed_array_size = storage_manager_->closed_array_size();
+  CHECK(closed_array_num == 2);
+  CHECK(closed_array_size > 0);
+
+  // Reading again reuses the retained entry
+  read(array_a, subarray, &values);
+  CHECK(values.size() == 100);
+  CHECK(storage_manager_->closed_array_num() == closed_array_num);
+  CHECK(storage_manager_->closed_array_size() == closed_array_size);
+
+  SECTION("- budget eviction") {
+    // Only one of the two (equally sized) arrays fits, so the least
+    // recently closed one is evicted when the other is closed
+    read(array_b, subarray, &values);
+    read(array_a, subarray, &values);
+    uint64_t size_a = storage_manager_->closed_array_size() / 2;
+    set_open_array_cache_size(size_a + size_a / 2);
+    read(array_a, subarray, &values);
+    CHECK(storage_manager_->closed_array_num() == 1);
+    read(array_b, subarray, &values);
+    CHECK(storage_manager_->closed_array_num() == 1);
+    CHECK(storage_manager_->closed_array_size() <= size_a + size_a / 2);
+
+    // Array "b" is the retained one, so opening it leaves no closed array
+    const char* attributes[] = {"a"};
+    std::vector<int> buffer(100);
+    void* buffers[] = {&buffer[0]};
+    uint64_t buffer_sizes[] = {buffer.size() * sizeof(int)};
+    Query query;
+    REQUIRE(storage_manager_
+                ->query_init(
+                    &query,
+                    array_b.c_str(),
+                    QueryType::READ,
+                    Layout::ROW_MAJOR,
+                    subarray,
+                    attributes,
+                    1,
+                    buffers,
+                    buffer_sizes)
+                .ok());
+    CHECK(storage_manager_->closed_array_num() == 0);
+    CHECK(storage_manager_->closed_array_size() == 0);
+    REQUIRE(storage_manager_->query_finalize(&query).ok());
+    CHECK(storage_manager_->closed_array_num() == 1);
+
+    // Nothing is retained with a zero budget
+    set_open_array_cache_size(0);
+    read(array_a, subarray, &values);
+    CHECK(values.size() == 100);
+    CHECK(storage_manager_->closed_array_num() == 0);
+    CHECK(storage_manager_->closed_array_size() == 0);
+  }
+
+  SECTION("- revalidation after a fragment is deleted") {
+    write(array_a, 10, 19);
+    int64_t both[] = {0, 19, 0, 9};
+    unsigned fragment_num = 0;
+    read(array_a, both, &values, &fragment_num);
+    CHECK(fragment_num == 2);
+    CHECK(values.size() == 200);
+
+    // The fragment is removed behind the storage manager's back
+    auto uris = fragment_uris(array_a);
+    REQUIRE(uris.size() == 2);
+    std::sort(uris.begin(), uris.end(), [](const URI& a, const URI& b) {
+      return a.to_string() < b.to_string();
+    });
+    CHECK(posix::remove_path(uris[1].to_path()).ok());
+
+    read(array_a, both, &values, &fragment_num);
+    CHECK(fragment_num == 1);
+    REQUIRE(values.size() == 100);
+    CHECK(values[99] == 909);
+    CHECK(storage_manager_->closed_array_num() == 2);
+  }
+
+  SECTION("- drop on array create, remove and move") {
+    std::string array_c = TEMP_DIR + "array_c";
+    CHECK(storage_manager_->move(URI(array_a), URI(array_c)).ok());
+    CHECK(storage_manager_->closed_array_num() == 1);
+    read(array_c, subarray, &values);
+    CHECK(storage_manager_->closed_array_num() == 2);
+    CHECK(storage_manager_->remove_path(URI(array_c)).ok());
+    CHECK(storage_manager_->closed_array_num() == 1);
+
+    // An array recreated at the URI of a retained one does not see its
+    // stale fragments
+    remove_dir(array_b);
+    CHECK(storage_manager_->closed_array_num() == 1);
+    create_array(array_b);
+    CHECK(storage_manager_->closed_array_num() == 0);
+    CHECK(storage_manager_->closed_array_size() == 0);
+    write(array_b, 0, 9, 1000000);
+    read(array_b, subarray, &values);
+    REQUIRE(values.size() == 100);
+    CHECK(values[23] == 1000203);
+  }
+}
+
+TEST_CASE_METHOD(
+    StorageManagerFx,
+    "StorageManager: Test loading fragment metadata sections",
+    "[storage_manager]") {
+  std::string array_name = TEMP_DIR + "array";
+  create_array(array_name);
+  write(array_name, 0, 19);
+  auto uris = fragment_uris(array_name);
+  REQUIRE(uris.size() == 1);
+  URI fragment_uri = uris[0];
+  URI metadata_uri =
+      fragment_uri.join_path(constants::fragment_metadata_filename);
+
+  URI array_uri(array_name);
+  ArrayMetadata array_metadata(array_uri);
+  REQUIRE(storage_manager_->load(array_name, &array_metadata).ok());
+  unsigned int attribute_num = array_metadata.attribute_num();
+
+  // The file starts with the index, followed by the sections
+  VFS vfs;
+  uint64_t header[2];
+  REQUIRE(vfs.read_from_file(metadata_uri, 0, header, sizeof(header)).ok());
+  CHECK(header[0] == constants::fragment_metadata_index_magic);
+
+  // Only the index is loaded at first; the number of tiles is known before
+  // the MBRs are loaded
+  FragmentMetadata metadata(&array_metadata, false, fragment_uri);
+  REQUIRE(storage_manager_->load(&metadata).ok());
+  uint64_t section_num = metadata.section_num();
+  CHECK(section_num == 2 + (attribute_num + 1) + 2 * attribute_num);
+  CHECK(metadata.section_offset(0) == header[1]);
+  for (uint64_t i = 1; i < section_num; ++i)
+    CHECK(metadata.section_offset(i) > metadata.section_offset(i - 1));
+  CHECK(metadata.non_empty_domain() != nullptr);
+  CHECK(metadata.last_tile_cell_num() == 10);
+  CHECK(metadata.mbrs().empty());
+  CHECK(metadata.tile_num() == 20);
+  CHECK(metadata.memory_size() == 0);
+
+  // Each section is loaded on its own
+  REQUIRE(metadata.load_tile_offsets(1).ok());
+  CHECK(metadata.tile_offsets()[0].empty());
+  CHECK(metadata.tile_offsets()[1].size() == 20);
+  CHECK(metadata.tile_offsets()[2].empty());
+  CHECK(metadata.mbrs().empty());
+  REQUIRE(metadata.load_mbrs().ok());
+  CHECK(metadata.mbrs().size() == 20);
+  CHECK(metadata.bounding_coords().empty());
+  CHECK(metadata.tile_num() == 20);
+
+  // Reading a single attribute loads only its offsets
+  int64_t subarray[] = {0, 19, 0, 9};
+  const char* attributes[] = {"b"};
+  std::vector<int> buffer(200);
+  void* buffers[] = {&buffer[0]};
+  uint64_t buffer_sizes[] = {buffer.size() * sizeof(int)};
+  Query query;
+  REQUIRE(storage_manager_
+              ->query_init(
+                  &query,
+                  array_name.c_str(),
+                  QueryType::READ,
+                  Layout::ROW_MAJOR,
+                  subarray,
+                  attributes,
+                  1,
+                  buffers,
+                  buffer_sizes)
+              .ok());
+  REQUIRE(storage_manager_->query_submit(&query).ok());
+  REQUIRE(query.fragment_metadata().size() == 1);
+  auto read_metadata = query.fragment_metadata()[0];
+  CHECK(read_metadata->tile_offsets()[0].empty());
+  CHECK(read_metadata->tile_offsets()[1].size() == 20);
+  CHECK(read_metadata->tile_var_offsets()[1].empty());
+  REQUIRE(storage_manager_->query_finalize(&query).ok());
+  CHECK(buffer_sizes[0] == 200 * sizeof(int));
+  CHECK(buffer[123] == -1203);
+
+  // Older fragments store the metadata as a single generic tile, with the
+  // non-empty domain first and the last tile cell number last
+  REQUIRE(metadata.load_bounding_coords().ok());
+  for (unsigned int i = 0; i < attribute_num + 1; ++i)
+    REQUIRE(metadata.load_tile_offsets(i).ok());
+  for (unsigned int i = 0; i < attribute_num; ++i) {
+    REQUIRE(metadata.load_tile_var_offsets(i).ok());
+    REQUIRE(metadata.load_tile_var_sizes(i).ok());
+  }
+  Buffer legacy_buff;
+  uint64_t domain_size = 2 * array_metadata.coords_size();
+  REQUIRE(legacy_buff.write(&domain_size, sizeof(uint64_t)).ok());
+  REQUIRE(legacy_buff.write(metadata.non_empty_domain(), domain_size).ok());
+  for (uint64_t i = 0; i < section_num; ++i)
+    REQUIRE(metadata.serialize_section(i, &legacy_buff).ok());
+  uint64_t last_tile_cell_num = metadata.last_tile_cell_num();
+  REQUIRE(legacy_buff.write(&last_tile_cell_num, sizeof(uint64_t)).ok());
+
+  // A new storage manager, which has no descriptors open for the file
+  StorageManager legacy_storage_manager;
+  REQUIRE(legacy_storage_manager.init().ok());
+  REQUIRE(posix::remove_file(metadata_uri.to_path()).ok());
+  legacy_buff.reset_offset();
+  Tile tile(
+      constants::generic_tile_datatype,
+      constants::generic_tile_compressor,
+      constants::generic_tile_compression_level,
+      constants::generic_tile_cell_size,
+      0,
+      &legacy_buff,
+      false);
+  TileIO tile_io(&legacy_storage_manager, metadata_uri);
+  REQUIRE(tile_io.write_generic(&tile).ok());
+  REQUIRE(tile_io.close().ok());
+
+  // It is deserialized eagerly
+  FragmentMetadata legacy(&array_metadata, false, fragment_uri);
+  REQUIRE(legacy_storage_manager.load(&legacy).ok());
+  CHECK(legacy.mbrs().size() == 20);
+  CHECK(legacy.bounding_coords().size() == 20);
+  CHECK(legacy.tile_num() == 20);
+  CHECK(legacy.last_tile_cell_num() == 10);
+  for (unsigned int i = 0; i < attribute_num + 1; ++i)
+    CHECK(legacy.tile_offsets()[i] == metadata.tile_offsets()[i]);
+  CHECK(legacy.memory_size() == metadata.memory_size());
+
+  // Loading a section of it is a no-op
+  CHECK(legacy.load_tile_offsets(0).ok());
+  CHECK(legacy.tile_offsets()[0].size() == 20);
+
+  // It can be read
+  attributes[0] = "a";
+  buffer_sizes[0] = buffer.size() * sizeof(int);
+  Query legacy_query;
+  REQUIRE(legacy_storage_manager
+              .query_init(
+                  &legacy_query,
+                  array_name.c_str(),
+                  QueryType::READ,
+                  Layout::ROW_MAJOR,
+                  subarray,
+                  attributes,
+                  1,
+                  buffers,
+                  buffer_sizes)
+              .ok());
+  REQUIRE(legacy_storage_manager.query_submit(&legacy_query).ok());
+  REQUIRE(legacy_storage_manager.query_finalize(&legacy_query).ok());
+  CHECK(buffer_sizes[0] == 200 * sizeof(int));
+  CHECK(buffer[123] == 1203);
+}
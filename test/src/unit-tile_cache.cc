@@ -0,0 +1,128 @@
+/**
+ * @file   unit-tile_cache.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the tile cache.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "catch.hpp"
+#include "tile_cache.h"
+
+using namespace tiledb;
+
+TEST_CASE("TileCache: Test get and insert", "[tile_cache]") {
+  TileCache cache(1024 * 1024, 4);
+  URI fragment("file:///tmp/array/__fragment");
+
+  std::vector<int> data = {1, 2, 3, 4};
+  Tile tile(Datatype::INT32, Compressor::NO_COMPRESSION, sizeof(int), 0);
+  tile.set_view(data.data(), data.size() * sizeof(int));
+
+  CHECK(cache.get(fragment, 0, 0) == nullptr);
+  CHECK(!cache.contains(fragment, 0, 0));
+  cache.insert(fragment, 0, 0, &tile);
+  CHECK(cache.contains(fragment, 0, 0));
+  CHECK(!cache.contains(fragment, 1, 0));
+  CHECK(!cache.contains(fragment, 0, 1));
+  CHECK(cache.size() == data.size() * sizeof(int));
+
+  // The cached tile is a copy
+  data[0] = 10;
+  auto cached = cache.get(fragment, 0, 0);
+  REQUIRE(cached != nullptr);
+  CHECK(cached->size_ == data.size() * sizeof(int));
+  CHECK(static_cast<int*>(cached->data_)[0] == 1);
+  CHECK(cached->var_data_ == nullptr);
+  cache.release(cached);
+
+  // Variable-sized tiles hold both the offsets and the values
+  std::vector<uint64_t> offsets = {0, 1, 3};
+  std::string values = "abbccc";
+  Tile tile_offsets(
+      Datatype::UINT64, Compressor::NO_COMPRESSION, sizeof(uint64_t), 0);
+  tile_offsets.set_view(offsets.data(), offsets.size() * sizeof(uint64_t));
+  Tile tile_values(Datatype::CHAR, Compressor::NO_COMPRESSION, 1, 0);
+  tile_values.set_view(&values[0], values.size());
+  cache.insert(fragment, 1, 0, &tile_offsets, &tile_values);
+  cached = cache.get(fragment, 1, 0);
+  REQUIRE(cached != nullptr);
+  CHECK(cached->size_ == offsets.size() * sizeof(uint64_t));
+  CHECK(cached->var_size_ == values.size());
+  CHECK(std::memcmp(cached->var_data_, values.data(), values.size()) == 0);
+  cache.release(cached);
+
+  // Evicting a directory evicts the tiles of its fragments
+  URI other("file:///tmp/array/__fragment_other");
+  cache.insert(other, 0, 0, &tile);
+  cache.evict(fragment);
+  CHECK(!cache.contains(fragment, 0, 0));
+  CHECK(!cache.contains(fragment, 1, 0));
+  CHECK(cache.contains(other, 0, 0));
+  cache.evict(URI("file:///tmp/array"));
+  CHECK(!cache.contains(other, 0, 0));
+  CHECK(cache.size() == 0);
+}
+
+TEST_CASE("TileCache: Test LRU eviction and pinning", "[tile_cache]") {
+  // A single shard that fits two tiles
+  std::vector<char> data(100, 'a');
+  Tile tile(Datatype::CHAR, Compressor::NO_COMPRESSION, 1, 0);
+  tile.set_view(data.data(), data.size());
+  TileCache cache(250, 1);
+  URI fragment("file:///tmp/array/__fragment");
+
+  cache.insert(fragment, 0, 0, &tile);
+  cache.insert(fragment, 0, 1, &tile);
+
+  // Touch tile 0, so that tile 1 is evicted next
+  auto pinned = cache.get(fragment, 0, 0);
+  REQUIRE(pinned != nullptr);
+  cache.insert(fragment, 0, 2, &tile);
+  CHECK(cache.contains(fragment, 0, 0));
+  CHECK(!cache.contains(fragment, 0, 1));
+  CHECK(cache.contains(fragment, 0, 2));
+  CHECK(cache.size() == 200);
+
+  // A pinned tile stays valid after it is evicted
+  cache.insert(fragment, 0, 3, &tile);
+  cache.insert(fragment, 0, 4, &tile);
+  CHECK(!cache.contains(fragment, 0, 0));
+  CHECK(pinned->size_ == 100);
+  CHECK(static_cast<char*>(pinned->data_)[99] == 'a');
+  cache.release(pinned);
+
+  // Tiles larger than a shard are not cached
+  std::vector<char> big(300, 'b');
+  Tile big_tile(Datatype::CHAR, Compressor::NO_COMPRESSION, 1, 0);
+  big_tile.set_view(big.data(), big.size());
+  cache.insert(fragment, 1, 0, &big_tile);
+  CHECK(!cache.contains(fragment, 1, 0));
+}
@@ -0,0 +1,328 @@
+/**
+ * @file   unit-tile_io.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the TileIO class.
+ */
+
+#include "catch.hpp"
+#include "constants.h"
+#include "storage_manager.h"
+#include "tile_io.h"
+#include "vfs.h"
+
+#include <cstring>
+
+using namespace tiledb;
+
+TEST_CASE("TileIO: Test read coalescing", "[tile_io]") {
+  std::vector<TileIO::CoalescedRead> reads;
+
+  // No ranges
+  std::map<uint64_t, uint64_t> ranges;
+  TileIO::coalesce(ranges, 10, 100, &reads);
+  CHECK(reads.empty());
+
+  // Adjacent ranges, a gap within the threshold and a gap above it
+  ranges = {{0, 10}, {10, 5}, {25, 5}, {41, 9}};
+  TileIO::coalesce(ranges, 10, 100, &reads);
+  REQUIRE(reads.size() == 2);
+  CHECK(reads[0].offset_ == 0);
+  CHECK(reads[0].nbytes_ == 30);
+  CHECK(reads[0].range_num_ == 3);
+  CHECK(reads[1].offset_ == 41);
+  CHECK(reads[1].nbytes_ == 9);
+  CHECK(reads[1].range_num_ == 1);
+
+  // No gaps allowed
+  TileIO::coalesce(ranges, 0, 100, &reads);
+  CHECK(reads.size() == 3);
+
+  // Reads are split at the maximum size, but large ranges are kept whole
+  ranges = {{0, 10}, {10, 10}, {20, 10}, {30, 50}};
+  TileIO::coalesce(ranges, 0, 20, &reads);
+  REQUIRE(reads.size() == 3);
+  CHECK(reads[0].nbytes_ == 20);
+  CHECK(reads[1].offset_ == 20);
+  CHECK(reads[1].nbytes_ == 10);
+  CHECK(reads[2].offset_ == 30);
+  CHECK(reads[2].nbytes_ == 50);
+
+  // Overlapping ranges
+  ranges = {{0, 20}, {5, 5}, {18, 4}};
+  TileIO::coalesce(ranges, 0, 100, &reads);
+  REQUIRE(reads.size() == 1);
+  CHECK(reads[0].nbytes_ == 22);
+  CHECK(reads[0].range_num_ == 3);
+}
+
+TEST_CASE("TileIO: Test chunked compression", "[tile_io]") {
+  // Small chunks, so that the tile is (de)compressed in parallel in 40
+  // chunks
+  Config config;
+  config.sm_params_.tile_chunk_parallel_min_size_ = 0;
+  StorageManager storage_manager(config);
+  REQUIRE(storage_manager.init().ok());
+  VFS vfs;
+  URI uri("mem://tiledb_test_tile_io");
+
+  const uint64_t cell_num = 10000;
+  std::vector<int> data(cell_num);
+  for (uint64_t i = 0; i < cell_num; ++i)
+    data[i] = (int)(i / 7);
+  uint64_t tile_size = cell_num * sizeof(int);
+
+  Compressor compressors[] = {Compressor::GZIP,
+                              Compressor::ZSTD,
+                              Compressor::LZ4,
+                              Compressor::RLE,
+                              Compressor::DOUBLE_DELTA};
+  for (auto compressor : compressors) {
+    Tile tile(Datatype::INT32, compressor, -1, tile_size, sizeof(int), 0);
+    ConstBuffer buff(&data[0], tile_size);
+    REQUIRE(tile.write(&buff).ok());
+
+    TileIO tile_io(&storage_manager, uri);
+    tile_io.set_chunk_size(1000);
+    REQUIRE(tile_io.write_generic(&tile).ok());
+
+    // The chunked layout starts right after the generic tile header
+    uint64_t header_size =
+        3 * sizeof(uint64_t) + 2 * sizeof(char) + sizeof(int);
+    uint64_t chunk_num = 0;
+    CHECK(vfs.read_from_file(uri, header_size, &chunk_num, sizeof(uint64_t))
+              .ok());
+    CHECK(chunk_num == 40);
+
+    Tile* read_tile = nullptr;
+    REQUIRE(tile_io.read_generic(&read_tile, 0).ok());
+    CHECK(read_tile->size() == tile_size);
+    CHECK(std::memcmp(read_tile->data(), &data[0], tile_size) == 0);
+    delete read_tile;
+
+    CHECK(vfs.remove_file(uri).ok());
+  }
+
+  // Coordinates are split into per-dimension tiles, whose chunks are all
+  // decompressed in parallel before the coordinates are zipped back
+  std::vector<int> coords(2 * cell_num);
+  for (uint64_t i = 0; i < cell_num; ++i) {
+    coords[2 * i] = (int)(i / 100);
+    coords[2 * i + 1] = (int)(i % 100);
+  }
+  Tile tile(
+      Datatype::INT32, Compressor::ZSTD, -1, 2 * tile_size, 2 * sizeof(int), 2);
+  ConstBuffer buff(&coords[0], 2 * tile_size);
+  REQUIRE(tile.write(&buff).ok());
+  TileIO tile_io(&storage_manager, uri);
+  tile_io.set_chunk_size(1000);
+  uint64_t bytes_written;
+  REQUIRE(tile_io.write(&tile, &bytes_written).ok());
+  Tile read_tile(Datatype::INT32, Compressor::ZSTD, 2 * sizeof(int), 2);
+  REQUIRE(tile_io.read(&read_tile, 0, bytes_written, 2 * tile_size).ok());
+  CHECK(read_tile.size() == 2 * tile_size);
+  CHECK(std::memcmp(read_tile.data(), &coords[0], 2 * tile_size) == 0);
+  CHECK(vfs.remove_file(uri).ok());
+}
+
+TEST_CASE("TileIO: Test reading into a caller buffer", "[tile_io]") {
+  StorageManager storage_manager;
+  REQUIRE(storage_manager.init().ok());
+  VFS vfs;
+  URI uri("mem://tiledb_test_tile_io");
+
+  const uint64_t cell_num = 1000;
+  std::vector<int> data(cell_num);
+  for (uint64_t i = 0; i < cell_num; ++i)
+    data[i] = (int)(i / 3);
+  uint64_t tile_size = cell_num * sizeof(int);
+
+  Compressor compressors[] = {Compressor::NO_COMPRESSION, Compressor::ZSTD};
+  for (auto compressor : compressors) {
+    Tile tile(Datatype::INT32, compressor, -1, tile_size, sizeof(int), 0);
+    ConstBuffer buff(&data[0], tile_size);
+    REQUIRE(tile.write(&buff).ok());
+    TileIO tile_io(&storage_manager, uri);
+    uint64_t bytes_written;
+    REQUIRE(tile_io.write(&tile, &bytes_written).ok());
+
+    // The tile is decompressed (or read) in place into the caller buffer
+    std::vector<int> result(cell_num + 1, -1);
+    Tile read_tile(Datatype::INT32, compressor, sizeof(int), 0);
+    REQUIRE(
+        tile_io.read_into(&read_tile, 0, bytes_written, tile_size, &result[1])
+            .ok());
+    CHECK(read_tile.data() == &result[1]);
+    CHECK(read_tile.size() == tile_size);
+    CHECK(result[0] == -1);
+    CHECK(std::memcmp(&result[1], &data[0], tile_size) == 0);
+
+    // A regular read afterwards does not write into the caller buffer
+    REQUIRE(tile_io.read(&read_tile, 0, bytes_written, tile_size).ok());
+    CHECK(read_tile.data() != &result[1]);
+    CHECK(std::memcmp(read_tile.data(), &data[0], tile_size) == 0);
+
+    CHECK(vfs.remove_file(uri).ok());
+  }
+}
+
+TEST_CASE("TileIO: Test discarding prefetched tiles", "[tile_io]") {
+  StorageManager storage_manager;
+  REQUIRE(storage_manager.init().ok());
+  VFS vfs;
+  URI uri("mem://tiledb_test_tile_io");
+
+  const uint64_t cell_num = 1000;
+  std::vector<int> data(cell_num);
+  for (uint64_t i = 0; i < cell_num; ++i)
+    data[i] = (int)(i / 3);
+  uint64_t tile_size = cell_num * sizeof(int);
+
+  // Two adjacent tiles, fetched ahead with a single read
+  TileIO tile_io(&storage_manager, uri);
+  uint64_t offsets[2], sizes[2], bytes_written;
+  for (int i = 0; i < 2; ++i) {
+    Tile tile(Datatype::INT32, Compressor::ZSTD, -1, tile_size, sizeof(int), 0);
+    ConstBuffer buff(&data[0], tile_size);
+    REQUIRE(tile.write(&buff).ok());
+    REQUIRE(tile_io.write(&tile, &bytes_written).ok());
+    offsets[i] = (i == 0) ? 0 : sizes[0];
+    sizes[i] = bytes_written;
+  }
+
+  Tile read_tile(Datatype::INT32, Compressor::ZSTD, sizeof(int), 0);
+  for (int i = 0; i < 2; ++i)
+    REQUIRE(tile_io.prefetch(&read_tile, offsets[i], sizes[i]).ok());
+  CHECK(tile_io.prefetched_num() == 2);
+  IOBatch batch;
+  REQUIRE(tile_io.submit_prefetch(&batch).ok());
+  REQUIRE(storage_manager.wait_reads(&batch).ok());
+  CHECK(tile_io.prefetched_num() == 2);
+
+  // A tile served from elsewhere is dropped without freeing the shared read
+  tile_io.discard_prefetched(offsets[0]);
+  CHECK(tile_io.prefetched_num() == 1);
+  tile_io.discard_prefetched(offsets[0]);
+  CHECK(tile_io.prefetched_num() == 1);
+  REQUIRE(tile_io.read(&read_tile, offsets[1], sizes[1], tile_size).ok());
+  CHECK(tile_io.prefetched_num() == 0);
+  CHECK(std::memcmp(read_tile.data(), &data[0], tile_size) == 0);
+
+  // Queued tiles are dropped too
+  REQUIRE(tile_io.prefetch(&read_tile, offsets[0], sizes[0]).ok());
+  tile_io.discard_prefetched(offsets[0]);
+  CHECK(tile_io.prefetched_num() == 0);
+
+  CHECK(vfs.remove_file(uri).ok());
+}
+
+TEST_CASE("TileIO: Test filtered tiles", "[tile_io]") {
+  StorageManager storage_manager;
+  REQUIRE(storage_manager.init().ok());
+  VFS vfs;
+  URI uri("mem://tiledb_test_tile_io");
+
+  // Split into several chunks, each filtered on its own
+  const uint64_t cell_num = 10000;
+  std::vector<double> data(cell_num);
+  for (uint64_t i = 0; i < cell_num; ++i)
+    data[i] = 20.0 + 0.25 * (i % 64);
+  uint64_t tile_size = cell_num * sizeof(double);
+
+  // Filters followed by a compressor, and filters alone
+  Compressor compressors[] = {Compressor::ZSTD, Compressor::NO_COMPRESSION};
+  for (auto compressor : compressors) {
+    FilterPipeline filters;
+    filters.add_filter(FilterType::BYTESHUFFLE);
+    if (compressor == Compressor::NO_COMPRESSION)
+      filters.add_filter(FilterType::DELTA);
+    Tile tile(
+        Datatype::FLOAT64, compressor, -1, tile_size, sizeof(double), 0);
+    tile.set_filters(filters);
+    ConstBuffer buff(&data[0], tile_size);
+    REQUIRE(tile.write(&buff).ok());
+
+    TileIO tile_io(&storage_manager, uri);
+    tile_io.set_chunk_size(1000);
+    uint64_t bytes_written;
+    REQUIRE(tile_io.write(&tile, &bytes_written).ok());
+
+    Tile read_tile(Datatype::FLOAT64, compressor, sizeof(double), 0);
+    read_tile.set_filters(filters);
+    REQUIRE(tile_io.read(&read_tile, 0, bytes_written, tile_size).ok());
+    CHECK(read_tile.size() == tile_size);
+    CHECK(std::memcmp(read_tile.data(), &data[0], tile_size) == 0);
+
+    CHECK(vfs.remove_file(uri).ok());
+  }
+}
+
+TEST_CASE("TileIO: Test serializing generic tiles", "[tile_io]") {
+  StorageManager storage_manager;
+  REQUIRE(storage_manager.init().ok());
+  VFS vfs;
+  URI uri("mem://tiledb_test_tile_io");
+
+  std::vector<uint64_t> data_1(100, 7);
+  std::vector<uint64_t> data_2(10);
+  for (uint64_t i = 0; i < data_2.size(); ++i)
+    data_2[i] = i;
+
+  // Serialize both tiles into a single buffer
+  TileIO tile_io(&storage_manager, uri);
+  Buffer buff;
+  std::vector<uint64_t> offsets;
+  for (auto data : {&data_1, &data_2}) {
+    uint64_t tile_size = data->size() * sizeof(uint64_t);
+    Buffer tile_buff(&(*data)[0], tile_size, false);
+    Tile tile(
+        constants::generic_tile_datatype,
+        constants::generic_tile_compressor,
+        constants::generic_tile_compression_level,
+        constants::generic_tile_cell_size,
+        0,
+        &tile_buff,
+        false);
+    offsets.push_back(buff.size());
+    REQUIRE(tile_io.serialize_generic(&tile, &buff).ok());
+  }
+  REQUIRE(storage_manager.write_to_file(uri, &buff).ok());
+
+  // Each tile is read back at its offset
+  Tile* read_tile = nullptr;
+  REQUIRE(tile_io.read_generic(&read_tile, offsets[1]).ok());
+  CHECK(read_tile->size() == data_2.size() * sizeof(uint64_t));
+  CHECK(std::memcmp(read_tile->data(), &data_2[0], read_tile->size()) == 0);
+  delete read_tile;
+  REQUIRE(tile_io.read_generic(&read_tile, offsets[0]).ok());
+  CHECK(read_tile->size() == data_1.size() * sizeof(uint64_t));
+  CHECK(std::memcmp(read_tile->data(), &data_1[0], read_tile->size()) == 0);
+  delete read_tile;
+
+  CHECK(vfs.remove_file(uri).ok());
+}
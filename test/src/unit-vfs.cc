@@ -0,0 +1,634 @@
+/**
+ * @file   unit-vfs.cc
+ *
+ * @section LICENSE
+ *
+ * The MIT License
+ *
+ * @copyright Copyright (c) 2017 TileDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tests for the VFS and its POSIX backend.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "catch.hpp"
+#include "constants.h"
+#include "disk_cache.h"
+#include "fd_cache.h"
+#include "posix_filesystem.h"
+#include "thread_pool_io_engine.h"
+#include "uring_io_engine.h"
+#include "vfs.h"
+
+using namespace tiledb;
+
+struct VFSFx {
+  const std::string TEMP_DIR = posix::current_dir() + "/tiledb_test_vfs";
+  const std::string URI_PREFIX = "file://";
+
+  VFS* vfs_;
+
+  VFSFx() {
+    vfs_ = new VFS();
+    if (posix::is_dir(TEMP_DIR))
+      REQUIRE(posix::remove_path(TEMP_DIR).ok());
+    REQUIRE(posix::create_dir(TEMP_DIR).ok());
+  }
+
+  ~VFSFx() {
+    delete vfs_;
+    REQUIRE(posix::remove_path(TEMP_DIR).ok());
+  }
+
+  URI file_uri(const std::string& name) const {
+    return URI(URI_PREFIX + TEMP_DIR + "/" + name);
+  }
+
+  /** Recreates the VFS with some write buffer size. */
+  void set_write_buffer_size(uint64_t write_buffer_size) {
+    delete vfs_;
+    Config::VFSParams params;
+    params.write_buffer_size_ = write_buffer_size;
+    vfs_ = new VFS(params);
+  }
+};
+
+TEST_CASE_METHOD(
+    VFSFx, "VFS: Test POSIX reads and writes through the fd cache", "[vfs]") {
+  URI uri = file_uri("file");
+  const char data[] = "0123456789";
+  set_write_buffer_size(0);
+  auto fd_cache = vfs_->fd_cache();
+
+  // Appends reuse the same descriptor
+  CHECK(vfs_->write_to_file(uri, data, 5).ok());
+  CHECK(vfs_->write_to_file(uri, data + 5, 5).ok());
+  CHECK(fd_cache->misses() == 1);
+  CHECK(fd_cache->hits() == 1);
+  CHECK(vfs_->sync(uri).ok());
+  CHECK(fd_cache->hits() == 2);
+
+  // Reads open a separate, read-only descriptor once
+  uint64_t size = 0;
+  CHECK(vfs_->file_size(uri, &size).ok());
+  CHECK(size == 10);
+  char buff[4];
+  CHECK(vfs_->read_from_file(uri, 3, buff, 4).ok());
+  CHECK(!std::memcmp(buff, data + 3, 4));
+  CHECK(vfs_->read_from_file(uri, 0, buff, 2).ok());
+  CHECK(!std::memcmp(buff, data, 2));
+  CHECK(fd_cache->misses() == 2);
+  CHECK(fd_cache->hits() == 4);
+  CHECK(fd_cache->size() == 1);
+
+  // Reading past the end fails
+  CHECK(!vfs_->read_from_file(uri, 8, buff, 4).ok());
+
+  // Closing the file drops it from the cache
+  CHECK(vfs_->close_file(uri).ok());
+  CHECK(fd_cache->size() == 0);
+  CHECK(vfs_->read_from_file(uri, 0, buff, 2).ok());
+  CHECK(fd_cache->misses() == 3);
+
+  // Removing the file drops it as well, and a new file is not read stale
+  CHECK(vfs_->remove_file(uri).ok());
+  CHECK(fd_cache->size() == 0);
+  CHECK(vfs_->write_to_file(uri, data + 5, 5).ok());
+  CHECK(vfs_->read_from_file(uri, 0, buff, 2).ok());
+  CHECK(!std::memcmp(buff, data + 5, 2));
+
+  // Removing the parent directory closes nested files
+  CHECK(vfs_->remove_path(URI(URI_PREFIX + TEMP_DIR)).ok());
+  CHECK(fd_cache->size() == 0);
+  CHECK(posix::create_dir(TEMP_DIR).ok());
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test buffered writes", "[vfs]") {
+  URI uri = file_uri("file");
+  const char data[] = "0123456789";
+  std::string path = TEMP_DIR + "/file";
+  set_write_buffer_size(8);
+
+  // Small writes are buffered, but the file exists from the first write
+  CHECK(vfs_->write_to_file(uri, data, 3).ok());
+  CHECK(vfs_->write_to_file(uri, data + 3, 3).ok());
+  CHECK(vfs_->is_file(uri));
+  uint64_t size = 0;
+  CHECK(posix::file_size(path, &size).ok());
+  CHECK(size == 0);
+
+  // Exceeding the buffer size flushes
+  CHECK(vfs_->write_to_file(uri, data + 6, 3).ok());
+  CHECK(posix::file_size(path, &size).ok());
+  CHECK(size == 6);
+
+  // Reads see buffered data
+  char buff[10];
+  CHECK(vfs_->read_from_file(uri, 0, buff, 9).ok());
+  CHECK(!std::memcmp(buff, data, 9));
+
+  // Large writes go through directly, after the buffered data
+  CHECK(vfs_->write_to_file(uri, data, 1).ok());
+  CHECK(vfs_->write_to_file(uri, data, 10).ok());
+  CHECK(posix::file_size(path, &size).ok());
+  CHECK(size == 20);
+
+  // Syncing the parent directory and closing flush
+  CHECK(vfs_->write_to_file(uri, data, 2).ok());
+  CHECK(vfs_->sync(URI(URI_PREFIX + TEMP_DIR)).ok());
+  CHECK(posix::file_size(path, &size).ok());
+  CHECK(size == 22);
+  CHECK(vfs_->write_to_file(uri, data, 2).ok());
+  CHECK(vfs_->close_file(uri).ok());
+  CHECK(posix::file_size(path, &size).ok());
+  CHECK(size == 24);
+
+  // A failed flush keeps the data, so that flushing can be retried
+  std::string dir = TEMP_DIR + "/dir";
+  REQUIRE(posix::create_dir(dir).ok());
+  URI nested_uri = file_uri("dir/file");
+  CHECK(vfs_->write_to_file(nested_uri, data, 3).ok());
+  REQUIRE(posix::remove_path(dir).ok());
+  CHECK(!vfs_->close_file(nested_uri).ok());
+  REQUIRE(posix::create_dir(dir).ok());
+  CHECK(vfs_->close_file(nested_uri).ok());
+  CHECK(posix::file_size(dir + "/file", &size).ok());
+  CHECK(size == 3);
+
+  // Closing concurrently with appends loses no data
+  CHECK(vfs_->remove_file(uri).ok());
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 4; ++i) {
+    writers.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j)
+        CHECK(vfs_->write_to_file(uri, data, 3).ok());
+    });
+  }
+  for (int j = 0; j < 1000; ++j)
+    CHECK(vfs_->close_file(uri).ok());
+  for (auto& writer : writers)
+    writer.join();
+  CHECK(vfs_->close_file(uri).ok());
+  CHECK(posix::file_size(path, &size).ok());
+  CHECK(size == 4 * 1000 * 3);
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test fd cache eviction", "[vfs]") {
+  FDCache fd_cache(2);
+  FDCache::Entry* entry[3];
+  int fd[3];
+  std::string path[3];
+  for (int i = 0; i < 3; ++i) {
+    path[i] = TEMP_DIR + "/file_" + std::to_string(i);
+    REQUIRE(posix::create_file(path[i]).ok());
+  }
+
+  // Unpinned entries are evicted in LRU order
+  for (int i = 0; i < 3; ++i) {
+    REQUIRE(fd_cache.acquire(path[i], FDCache::Mode::READ, &entry[i], &fd[i])
+                .ok());
+    fd_cache.release(entry[i]);
+  }
+  CHECK(fd_cache.size() == 2);
+  CHECK(fd_cache.misses() == 3);
+  REQUIRE(fd_cache.acquire(path[2], FDCache::Mode::READ, &entry[2], &fd[2])
+              .ok());
+  fd_cache.release(entry[2]);
+  CHECK(fd_cache.hits() == 1);
+  REQUIRE(fd_cache.acquire(path[0], FDCache::Mode::READ, &entry[0], &fd[0])
+              .ok());
+  fd_cache.release(entry[0]);
+  CHECK(fd_cache.misses() == 4);
+
+  // Pinned entries are never evicted
+  for (int i = 0; i < 3; ++i)
+    REQUIRE(
+        fd_cache.acquire(path[i], FDCache::Mode::APPEND, &entry[i], &fd[i])
+            .ok());
+  CHECK(fd_cache.size() == 3);
+  for (int i = 0; i < 3; ++i) {
+    CHECK(posix::write_to_file(fd[i], "a", 1).ok());
+    fd_cache.release(entry[i]);
+  }
+  CHECK(fd_cache.size() == 2);
+
+  // Closing a pinned file defers closing until it is released
+  REQUIRE(fd_cache.acquire(path[1], FDCache::Mode::READ, &entry[1], &fd[1])
+              .ok());
+  CHECK(fd_cache.close(path[1]).ok());
+  CHECK(fd_cache.size() == 1);
+  char c;
+  CHECK(posix::read_from_file(fd[1], 0, &c, 1).ok());
+  CHECK(c == 'a');
+  fd_cache.release(entry[1]);
+
+  // Opening a missing file fails
+  CHECK(!fd_cache
+             .acquire(
+                 TEMP_DIR + "/missing", FDCache::Mode::READ, &entry[0], &fd[0])
+             .ok());
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test listing with types", "[vfs]") {
+  std::string prefixes[] = {URI_PREFIX + TEMP_DIR, "mem://tiledb_test_ls"};
+  for (auto& prefix : prefixes) {
+    URI dir(prefix);
+    if (!vfs_->is_dir(dir))
+      REQUIRE(vfs_->create_dir(dir).ok());
+    REQUIRE(vfs_->create_dir(URI(prefix + "/d")).ok());
+    REQUIRE(vfs_->create_file(URI(prefix + "/f")).ok());
+
+    std::vector<URI> uris;
+    std::vector<bool> is_dirs;
+    CHECK(vfs_->ls_with_types(dir, &uris, &is_dirs).ok());
+    REQUIRE(uris.size() == 2);
+    REQUIRE(is_dirs.size() == 2);
+    for (uint64_t i = 0; i < uris.size(); ++i)
+      CHECK(is_dirs[i] == (uris[i].last_path_part() == "d"));
+
+    CHECK(vfs_->remove_path(URI(prefix + "/d")).ok());
+    CHECK(vfs_->remove_file(URI(prefix + "/f")).ok());
+  }
+  CHECK(vfs_->remove_path(URI(prefixes[1])).ok());
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test moving files without replacing", "[vfs]") {
+  std::string prefixes[] = {URI_PREFIX + TEMP_DIR, "mem://tiledb_test_mv"};
+  for (auto& prefix : prefixes) {
+    URI dir(prefix);
+    if (!vfs_->is_dir(dir))
+      REQUIRE(vfs_->create_dir(dir).ok());
+    URI a(prefix + "/a"), b(prefix + "/b"), c(prefix + "/c");
+    REQUIRE(vfs_->write_to_file(a, "a", 1).ok());
+    REQUIRE(vfs_->write_to_file(b, "b", 1).ok());
+
+    // The first move wins
+    bool moved = false;
+    CHECK(vfs_->move_file_no_replace(a, c, &moved).ok());
+    CHECK(moved);
+    CHECK(!vfs_->is_file(a));
+    CHECK(vfs_->move_file_no_replace(b, c, &moved).ok());
+    CHECK(!moved);
+    CHECK(vfs_->is_file(b));
+    char data;
+    CHECK(vfs_->read_from_file(c, 0, &data, 1).ok());
+    CHECK(data == 'a');
+
+    // Moving a missing file fails
+    CHECK(!vfs_->move_file_no_replace(a, URI(prefix + "/d"), &moved).ok());
+
+    CHECK(vfs_->remove_file(b).ok());
+    CHECK(vfs_->remove_file(c).ok());
+  }
+  CHECK(vfs_->remove_path(URI(prefixes[1])).ok());
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test disk cache", "[vfs]") {
+  std::string dir = TEMP_DIR + "/cache";
+  URI uri("s3://bucket/array/fragment/a.tdb");
+  std::string data(9500, 0);
+  for (uint64_t i = 0; i < data.size(); ++i)
+    data[i] = (char)(i % 251);
+  int fetches = 0;
+  auto fetch = [&](uint64_t offset, void* buffer, uint64_t nbytes) {
+    ++fetches;
+    std::memcpy(buffer, &data[offset], nbytes);
+    return Status::Ok();
+  };
+  char buffer[3000];
+
+  // Consecutive missing blocks are fetched together
+  DiskCache cache(dir, 3500, 1000);
+  REQUIRE(cache.init().ok());
+  CHECK(cache.read(uri, data.size(), 1500, buffer, 1000, fetch).ok());
+  CHECK(std::memcmp(buffer, &data[1500], 1000) == 0);
+  CHECK(fetches == 1);
+  CHECK(cache.misses() == 2);
+  CHECK(cache.size() == 2000);
+  CHECK(cache.read(uri, data.size(), 1500, buffer, 1000, fetch).ok());
+  CHECK(std::memcmp(buffer, &data[1500], 1000) == 0);
+  CHECK(fetches == 1);
+  CHECK(cache.hits() == 2);
+  CHECK(cache.read(uri, data.size(), 0, buffer, 3000, fetch).ok());
+  CHECK(std::memcmp(buffer, &data[0], 3000) == 0);
+  CHECK(fetches == 2);
+  CHECK(cache.misses() == 3);
+  CHECK(cache.hits() == 4);
+
+  // The last block is partial
+  CHECK(cache.read(uri, data.size(), 9000, buffer, 500, fetch).ok());
+  CHECK(std::memcmp(buffer, &data[9000], 500) == 0);
+  CHECK(cache.size() == 3500);
+
+  // Blocks are evicted in LRU order to stay within budget
+  CHECK(cache.read(uri, data.size(), 5000, buffer, 1000, fetch).ok());
+  CHECK(cache.size() == 3500);
+  CHECK(fetches == 4);
+  CHECK(cache.read(uri, data.size(), 2000, buffer, 1000, fetch).ok());
+  CHECK(fetches == 4);
+  CHECK(cache.read(uri, data.size(), 0, buffer, 1000, fetch).ok());
+  CHECK(std::memcmp(buffer, &data[0], 1000) == 0);
+  CHECK(fetches == 5);
+
+  // Reads past the end of the file fail
+  CHECK(!cache.read(uri, data.size(), 9000, buffer, 1000, fetch).ok());
+
+  // The cached blocks survive the cache
+  DiskCache cache2(dir, 3500, 1000);
+  REQUIRE(cache2.init().ok());
+  CHECK(cache2.size() == 3500);
+  CHECK(cache2.read(uri, data.size(), 0, buffer, 1000, fetch).ok());
+  CHECK(std::memcmp(buffer, &data[0], 1000) == 0);
+  CHECK(fetches == 5);
+  CHECK(cache2.hits() == 1);
+
+  // Mutable directory marks expire, and are cleared by immutable ones
+  URI fragment_uri = uri.parent();
+  CHECK(!cache2.is_mutable(fragment_uri));
+  cache2.set_mutable(fragment_uri, 0);
+  CHECK(!cache2.is_mutable(fragment_uri));
+  cache2.set_mutable(fragment_uri, 60 * 1000);
+  CHECK(cache2.is_mutable(fragment_uri));
+  cache2.set_immutable(fragment_uri);
+  CHECK(!cache2.is_mutable(fragment_uri));
+  CHECK(cache2.is_immutable(fragment_uri));
+  cache2.set_mutable(URI("s3://bucket/array/fragment_2"), 60 * 1000);
+
+  // Removing a directory drops the blocks of its files
+  cache2.remove(URI("s3://bucket/array"));
+  CHECK(cache2.size() == 0);
+  CHECK(!cache2.is_immutable(fragment_uri));
+  CHECK(!cache2.is_mutable(URI("s3://bucket/array/fragment_2")));
+  CHECK(cache2.read(uri, data.size(), 0, buffer, 1000, fetch).ok());
+  CHECK(fetches == 6);
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test POSIX batched reads", "[vfs]") {
+  URI uri = file_uri("file");
+  const char data[] = "0123456789abcdef";
+  REQUIRE(vfs_->write_to_file(uri, data, 16).ok());
+
+  // Adjacent, non-adjacent and empty ranges
+  char b0[3], b1[2], b2[4], b3[1];
+  std::vector<VFS::ReadRange> ranges = {
+      {1, 3, b0}, {4, 2, b1}, {10, 4, b2}, {14, 0, nullptr}, {0, 1, b3}};
+  CHECK(vfs_->read_batch(uri, ranges).ok());
+  CHECK(!std::memcmp(b0, data + 1, 3));
+  CHECK(!std::memcmp(b1, data + 4, 2));
+  CHECK(!std::memcmp(b2, data + 10, 4));
+  CHECK(b3[0] == data[0]);
+
+  // A range past the end of the file fails
+  ranges = {{14, 2, b1}, {16, 1, b3}};
+  CHECK(!vfs_->read_batch(uri, ranges).ok());
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test POSIX memory mapping", "[vfs]") {
+  URI uri = file_uri("file");
+  const char data[] = "0123456789";
+
+  // Empty and missing files cannot be mapped
+  void* map_data = nullptr;
+  uint64_t map_size = 0;
+  CHECK(!vfs_->map_file(uri, &map_data, &map_size).ok());
+  REQUIRE(vfs_->create_file(uri).ok());
+  CHECK(!vfs_->map_file(uri, &map_data, &map_size).ok());
+
+  REQUIRE(vfs_->write_to_file(uri, data, 10).ok());
+  REQUIRE(vfs_->map_file(uri, &map_data, &map_size).ok());
+  CHECK(map_size == 10);
+  CHECK(!std::memcmp(map_data, data, 10));
+
+  // Writes to the mapping do not reach the file
+  ((char*)map_data)[0] = 'x';
+  char c;
+  CHECK(vfs_->read_from_file(uri, 0, &c, 1).ok());
+  CHECK(c == '0');
+
+  CHECK(vfs_->unmap_file(uri, map_data, map_size).ok());
+}
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test POSIX asynchronous reads", "[vfs]") {
+  URI uri = file_uri("file");
+  const char data[] = "0123456789abcdef";
+  REQUIRE(vfs_->write_to_file(uri, data, 16).ok());
+
+  // Reads through the VFS engine pin the descriptor until waited on
+  char b0[3], b1[8], b2[1];
+  std::vector<VFS::ReadRange> ranges = {
+      {1, 3, b0}, {8, 8, b1}, {5, 0, nullptr}, {0, 1, b2}};
+  IOBatch batch;
+  CHECK(vfs_->read_async(uri, ranges, &batch).ok());
+  CHECK(vfs_->close_file(uri).ok());
+  CHECK(vfs_->wait_reads(&batch).ok());
+  CHECK(batch.pending() == 0);
+  CHECK(!std::memcmp(b0, data + 1, 3));
+  CHECK(!std::memcmp(b1, data + 8, 8));
+  CHECK(b2[0] == data[0]);
+
+  // A read past the end of the file fails the batch
+  ranges = {{2, 2, b0}, {12, 8, b1}};
+  CHECK(vfs_->read_async(uri, ranges, &batch).ok());
+  CHECK(!vfs_->wait_reads(&batch).ok());
+  CHECK(!std::memcmp(b0, data + 2, 2));
+
+  // Every engine completes many concurrent reads
+  std::vector<IOEngine*> engines = {new ThreadPoolIOEngine(4)};
+#ifdef HAVE_IO_URING
+  auto uring = new UringIOEngine();
+  if (uring->init(8).ok())
+    engines.push_back(uring);
+  else
+    delete uring;
+#endif
+  int fd = ::open((TEMP_DIR + "/file").c_str(), O_RDONLY);
+  REQUIRE(fd != -1);
+  for (auto engine : engines) {
+    char buff[16 * 100];
+    std::vector<IORequest> requests;
+    for (int i = 0; i < 100; ++i) {
+      uint64_t offset = i % 16;
+      IORequest request = {fd, offset, 16 - offset, buff + i * 16, &batch};
+      requests.push_back(request);
+    }
+    batch.expect(requests.size());
+    CHECK(engine->submit(requests).ok());
+    CHECK(batch.wait().ok());
+    for (int i = 0; i < 100; ++i)
+      CHECK(!std::memcmp(buff + i * 16, data + i % 16, 16 - i % 16));
+    delete engine;
+  }
+  ::close(fd);
+}
+
+#ifdef HAVE_IO_URING
+/** An io_uring engine whose kernel entries fail after the first entry. */
+class FailingUringIOEngine : public UringIOEngine {
+ protected:
+  Status enter(unsigned n) {
+    if (n <= 1)
+      return UringIOEngine::enter(n);
+    RETURN_NOT_OK(UringIOEngine::enter(1));
+    return Status::IOError("Injected submission failure");
+  }
+};
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test io_uring submission failures", "[vfs]") {
+  URI uri = file_uri("file");
+  const char data[] = "0123456789abcdef";
+  REQUIRE(vfs_->write_to_file(uri, data, 16).ok());
+  REQUIRE(vfs_->close_file(uri).ok());
+  auto engine = new FailingUringIOEngine();
+  if (!engine->init(8).ok()) {
+    delete engine;
+    return;
+  }
+  int fd = ::open((TEMP_DIR + "/file").c_str(), O_RDONLY);
+  REQUIRE(fd != -1);
+
+  // The requests queued behind the failure and those never queued are
+  // completed with the error, so waiting does not block
+  IOBatch batch;
+  char buff[16 * 20];
+  std::vector<IORequest> requests;
+  for (int i = 0; i < 20; ++i) {
+    IORequest request = {fd, 0, 16, buff + i * 16, &batch};
+    requests.push_back(request);
+  }
+  batch.expect(requests.size());
+  CHECK(!engine->submit(requests).ok());
+  CHECK(!batch.wait().ok());
+  CHECK(batch.pending() == 0);
+  CHECK(!std::memcmp(buff, data, 16));
+
+  // The ring is still usable
+  requests.resize(1);
+  requests[0].buffer = buff + 16;
+  batch.expect(1);
+  CHECK(engine->submit(requests).ok());
+  CHECK(batch.wait().ok());
+  CHECK(!std::memcmp(buff + 16, data, 16));
+
+  delete engine;
+  ::close(fd);
+}
+#endif
+
+TEST_CASE_METHOD(VFSFx, "VFS: Test in-memory backend", "[vfs]") {
+  URI dir("mem://tiledb_test_vfs");
+  const char data[] = "0123456789";
+  if (vfs_->is_dir(dir))
+    CHECK(vfs_->remove_path(dir).ok());
+
+  // Files need an existing parent
+  CHECK(!vfs_->create_file(URI("mem://tiledb_test_vfs/a/file")).ok());
+  CHECK(vfs_->create_dir(dir).ok());
+  CHECK(!vfs_->create_dir(dir).ok());
+  CHECK(vfs_->create_dir(URI("mem://tiledb_test_vfs/a")).ok());
+  CHECK(vfs_->is_dir(URI("mem://tiledb_test_vfs/a")));
+
+  // Writes append, reads are positional
+  URI uri("mem://tiledb_test_vfs/a/file");
+  CHECK(vfs_->write_to_file(uri, data, 4).ok());
+  CHECK(vfs_->write_to_file(uri, data + 4, 6).ok());
+  CHECK(vfs_->is_file(uri));
+  CHECK(!vfs_->is_dir(uri));
+  uint64_t size = 0;
+  CHECK(vfs_->file_size(uri, &size).ok());
+  CHECK(size == 10);
+  char buff[10];
+  CHECK(vfs_->read_from_file(uri, 2, buff, 5).ok());
+  CHECK(!std::memcmp(buff, data + 2, 5));
+  CHECK(!vfs_->read_from_file(uri, 8, buff, 4).ok());
+  CHECK(vfs_->sync(uri).ok());
+
+  // Batched reads
+  std::vector<VFS::ReadRange> ranges = {{0, 2, buff}, {6, 3, buff + 2}};
+  CHECK(vfs_->read_batch(uri, ranges).ok());
+  CHECK(!std::memcmp(buff, "01678", 5));
+
+  // Listing is sorted
+  CHECK(vfs_->create_file(URI("mem://tiledb_test_vfs/b")).ok());
+  std::vector<URI> uris;
+  CHECK(vfs_->ls(dir, &uris).ok());
+  REQUIRE(uris.size() == 2);
+  CHECK(uris[0].to_string() == "mem://tiledb_test_vfs/a");
+  CHECK(uris[1].to_string() == "mem://tiledb_test_vfs/b");
+
+  // Moving a directory moves its contents
+  CHECK(vfs_->move_path(
+                 URI("mem://tiledb_test_vfs/a"), URI("mem://tiledb_test_vfs/c"))
+            .ok());
+  CHECK(!vfs_->is_file(uri));
+  uri = URI("mem://tiledb_test_vfs/c/file");
+  CHECK(vfs_->file_size(uri, &size).ok());
+  CHECK(size == 10);
+
+  // Shared locks do not block each other
+  int fd1, fd2;
+  CHECK(vfs_->filelock_lock(uri, &fd1, true).ok());
+  CHECK(vfs_->filelock_lock(uri, &fd2, true).ok());
+  CHECK(vfs_->filelock_unlock(uri, fd1).ok());
+  CHECK(vfs_->filelock_unlock(uri, fd2).ok());
+  CHECK(vfs_->filelock_lock(uri, &fd1, false).ok());
+  CHECK(vfs_->filelock_unlock(uri, fd1).ok());
+
+  // Contents are shared by all VFS instances of the process
+  VFS vfs;
+  CHECK(vfs.is_file(uri));
+
+  // Siblings whose names extend a directory name with bytes sorting before
+  // '/' are neither moved nor removed with it
+  std::string x = "mem://tiledb_test_vfs/x";
+  CHECK(vfs_->create_dir(URI(x)).ok());
+  CHECK(vfs_->create_file(URI(x + "/f")).ok());
+  CHECK(vfs_->create_file(URI(x + "-1")).ok());
+  CHECK(vfs_->create_file(URI(x + ".y")).ok());
+  CHECK(vfs_->create_dir(URI(x + "z")).ok());
+  CHECK(vfs_->create_file(URI(x + "z/g")).ok());
+  CHECK(vfs_->create_dir(URI(x + "z.y")).ok());
+  CHECK(!vfs_->move_path(URI(x + "z.y"), URI(x + "z")).ok());
+  CHECK(vfs_->move_path(URI(x), URI(x + "w")).ok());
+  CHECK(!vfs_->is_dir(URI(x)));
+  CHECK(!vfs_->is_file(URI(x + "/f")));
+  CHECK(vfs_->is_file(URI(x + "w/f")));
+  CHECK(vfs_->is_file(URI(x + "-1")));
+  CHECK(vfs_->is_file(URI(x + ".y")));
+  CHECK(vfs_->remove_path(URI(x + "w")).ok());
+  CHECK(!vfs_->is_file(URI(x + "w/f")));
+  CHECK(vfs_->remove_path(URI(x + "z")).ok());
+  CHECK(!vfs_->is_file(URI(x + "z/g")));
+  CHECK(vfs_->is_dir(URI(x + "z.y")));
+  CHECK(vfs_->is_file(URI(x + "-1")));
+  CHECK(vfs_->is_file(URI(x + ".y")));
+
+  CHECK(vfs_->remove_file(uri).ok());
+  CHECK(!vfs_->is_file(uri));
+  CHECK(vfs_->remove_path(dir).ok());
+  CHECK(!vfs_->is_dir(dir));
+}